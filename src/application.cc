@@ -69,4 +69,47 @@ Application *Application::create(int argc, char **argv,
   return Application::_instance.get();
 }
 
+void Application::publish_metrics(main_loop::clock::duration interval,
+                                  const std::string &path) {
+  if (this->_metrics_timer) {
+    this->_main_loop.cancel_timer(*this->_metrics_timer);
+  }
+  this->_metrics_file.reset();
+  if (!path.empty()) {
+    this->_metrics_file = std::make_unique<std::ofstream>(path, std::ios::app);
+    if (!*this->_metrics_file) {
+      throw ApplicationError("can not open metrics file: " + path);
+    }
+  }
+  this->_metrics_interval = interval;
+  // deferrable, runs only when the loop has nothing else to do
+  this->_metrics_timer = this->_main_loop.post_after(
+      interval, [this]() { this->_publish_metrics(); }, Lane::kIdle);
+}
+
+void Application::_publish_metrics() {
+  auto metrics = Metrics::get();
+  for (auto [lane, name] : {std::make_pair(Lane::kHigh, "high"),
+                            std::make_pair(Lane::kNormal, "normal"),
+                            std::make_pair(Lane::kIdle, "idle")}) {
+    auto stats = this->_main_loop.stats(lane);
+    auto prefix = std::string("main_loop.") + name;
+    metrics->gauge(prefix + "_depth").set(int64_t(stats.depth));
+    metrics->gauge(prefix + "_latency_p99_us")
+        .set(int64_t(stats.latency_p99_us));
+  }
+
+  auto snapshot = metrics->snapshot();
+  if (this->_metrics_file) {
+    snapshot.write_json(*this->_metrics_file);
+    this->_metrics_file->flush();
+  }
+  this->post<MetricsSnapshot>(std::move(snapshot));
+
+  this->_metrics_timer =
+      this->_main_loop.post_after(this->_metrics_interval,
+                                  [this]() { this->_publish_metrics(); },
+                                  Lane::kIdle);
+}
+
 } // namespace my
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <fstream>
+#include <optional>
+
 #include <core/config.hpp>
 #include <core/coordination.hpp>
 #include <core/event_bus.hpp>
 #include <core/logger.hpp>
+#include <core/metrics.hpp>
 #include <storage/resource_service.hpp>
+#include <window/headless/headless_window_service.hpp>
 #include <window/window_service.hpp>
 
 namespace my {
@@ -44,6 +49,29 @@ public:
 
   coordination_type coordination() { return this->_main_loop.coordination(); };
 
+  // lanes, timers and their stats of the application thread
+  main_loop &loop() { return this->_main_loop; }
+
+  /**
+   * @brief      handle typed input, e.g. MouseMotionEvent, on the high lane
+   *             of the application thread
+   */
+  template <typename T, typename Func>
+  TypedDispatcher::handler_id on_input(Func &&func) {
+    return this->on_dispatch<T>(
+        [this, func = std::forward<Func>(func)](const TypedEvent<T> &e) {
+          this->_main_loop.post([func, e]() { func(e); }, Lane::kHigh);
+        });
+  }
+
+  /**
+   * @brief      every interval, post a MetricsSnapshot on the bus and append
+   *             it to path as one JSON line, unless path is empty; runs on
+   *             the idle lane
+   */
+  void publish_metrics(main_loop::clock::duration interval,
+                       const std::string &path = {});
+
   template <typename Service, typename = std::enable_if_t<
                                   std::is_base_of_v<BasicService, Service>>>
   Service *service() {
@@ -76,7 +104,12 @@ protected:
   Application(int argc, char **argv, options_description const &opts_desc) {
     pthread_setname_np(pthread_self(), "application service");
     this->parse_program_options(argc, argv, opts_desc);
-    this->register_service(WindowService::create());
+    po::variable_value headless;
+    if (this->program_option("headless", headless) && headless.as<bool>()) {
+      this->register_service(WindowService::create_headless());
+    } else {
+      this->register_service(WindowService::create());
+    }
     this->register_service(ResourceService::create());
   };
 
@@ -87,6 +120,12 @@ private:
   po::variables_map _program_option_map;
   std::map<std::type_index, unique_ptr<BasicService>> _services;
 
+  main_loop::clock::duration _metrics_interval{};
+  std::optional<main_loop::timer_id> _metrics_timer;
+  unique_ptr<std::ofstream> _metrics_file;
+
+  void _publish_metrics();
+
   template <typename Service, typename = std::enable_if_t<
                                   std::is_base_of_v<BasicService, Service>>>
   void register_service(unique_ptr<Service> service) {
@@ -119,7 +158,19 @@ private:
       unique_ptr<_Observable> const &observable,
       typename std::enable_if_t<std::is_base_of_v<Observable, _Observable>> * =
           0) {
-    this->subscribe(observable.get());
+    if constexpr (std::is_base_of_v<WindowService, _Observable>) {
+      this->subscribe_input(observable.get());
+    } else {
+      this->subscribe(observable.get());
+    }
+  }
+
+  // input reaches the bus from the high lane, ahead of resource callbacks
+  // and other normal work
+  void subscribe_input(Observable *observable) {
+    observable->event_source().subscribe([this](auto e) {
+      this->_main_loop.post([this, e]() { this->repost(e); }, Lane::kHigh);
+    });
   }
 
   template <typename _Observable>
@@ -130,8 +181,12 @@ private:
 
   void parse_program_options(int argc, char **argv,
                              options_description const &opts) {
+    options_description all;
+    all.add(opts);
+    all.add_options()("headless", po::bool_switch(),
+                      "windows in memory, for runs without a display");
     po::store(po::command_line_parser(argc, argv)
-                  .options(opts)
+                  .options(all)
                   .allow_unregistered()
                   .run(),
               this->_program_option_map);
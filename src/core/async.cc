@@ -0,0 +1,40 @@
+#include "async.hpp"
+
+namespace {
+using namespace my;
+
+thread_local Fiber *tl_fiber{nullptr};
+
+} // namespace
+
+namespace my {
+
+Fiber *Fiber::current() { return tl_fiber; }
+
+void Fiber::suspend() { (*this->_yield)(); }
+
+void Fiber::resume() {
+    this->_strand->post([self = this->shared_from_this()]() { self->_run(); });
+}
+
+void Fiber::_start(Task body) {
+    this->_coro = std::make_unique<coro_type::push_type>(
+        [this, body = std::move(body)](coro_type::pull_type &yield) mutable {
+            this->_yield = &yield;
+            body();
+        });
+    this->resume();
+}
+
+void Fiber::_run() {
+    auto prev = tl_fiber;
+    tl_fiber = this;
+    (*this->_coro)();
+    tl_fiber = prev;
+    if (!*this->_coro) {
+        // finished, free the stack right away
+        this->_coro.reset();
+    }
+}
+
+} // namespace my
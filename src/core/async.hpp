@@ -0,0 +1,187 @@
+#pragma once
+
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <variant>
+
+#include <boost/coroutine2/all.hpp>
+
+#include <core/executor.hpp>
+
+namespace my {
+
+class AsyncError : public std::runtime_error {
+  public:
+    AsyncError(const std::string &msg) : std::runtime_error(msg), _msg(msg) {}
+
+    const char *what() const noexcept override { return this->_msg.c_str(); }
+
+  private:
+    std::string _msg;
+};
+
+/**
+ * @brief      value or exception of a finished Async<T>
+ */
+template <typename T> class AsyncResult {
+  public:
+    template <typename Func> void capture(Func &func) {
+        try {
+            if constexpr (std::is_void_v<T>) {
+                func();
+                this->_v.template emplace<1>();
+            } else {
+                this->_v.template emplace<1>(func());
+            }
+        } catch (...) {
+            this->_v.template emplace<2>(std::current_exception());
+        }
+    }
+
+    void set_exception(std::exception_ptr e) {
+        this->_v.template emplace<2>(std::move(e));
+    }
+
+    /**
+     * @brief      the value, rethrows the exception
+     */
+    T get() {
+        if (auto e = std::get_if<2>(&this->_v)) {
+            std::rethrow_exception(*e);
+        }
+        if constexpr (!std::is_void_v<T>) {
+            return std::move(std::get<1>(this->_v));
+        }
+    }
+
+  private:
+    struct Void {};
+    using value_type = std::conditional_t<std::is_void_v<T>, Void, T>;
+    std::variant<std::monostate, value_type, std::exception_ptr> _v;
+};
+
+/**
+ * @brief      a service call which starts when awaited
+ *
+ * The counterpart of the future returned by schedule(): instead of a
+ * thread blocking on get(), the continuation runs on the service once the
+ * call finished. Inside a Fiber, await() suspends until then.
+ */
+template <typename T> class Async {
+  public:
+    using result_type = AsyncResult<T>;
+    using continuation_type = std::function<void(result_type &)>;
+    using launcher_type = std::function<void(continuation_type)>;
+
+    explicit Async(launcher_type launch) : _launch(std::move(launch)) {}
+
+    /**
+     * @brief      start the call, k runs in the service's context
+     */
+    void then(continuation_type k) && { this->_launch(std::move(k)); }
+
+  private:
+    launcher_type _launch;
+};
+
+/**
+ * @brief      stackful coroutine resumed on a Strand
+ *
+ * A fiber runs until it awaits an Async, then gives its strand back. When
+ * the call finished, resuming is posted to the same strand, so the code
+ * after await() runs on the caller's executor and never concurrently with
+ * the strand's other tasks. A single strand can keep any number of fibers
+ * waiting without blocking a thread.
+ */
+class Fiber : public std::enable_shared_from_this<Fiber> {
+  public:
+    /**
+     * @brief      run func as a fiber on strand
+     *
+     * @return     func's result, broken if the fiber was dropped while
+     *             waiting for a call that never finished
+     */
+    template <typename Func, typename R = std::invoke_result_t<Func &>>
+    static std::future<R> spawn(std::shared_ptr<Strand> strand, Func &&func) {
+        auto p = std::make_shared<std::promise<R>>();
+        auto f = p->get_future();
+        auto fiber = std::shared_ptr<Fiber>(new Fiber(std::move(strand)));
+        fiber->_start([p, func = std::forward<Func>(func)]() mutable {
+            try {
+                if constexpr (std::is_void_v<R>) {
+                    func();
+                    p->set_value();
+                } else {
+                    p->set_value(func());
+                }
+            } catch (const boost::context::detail::forced_unwind &) {
+                throw;
+            } catch (...) {
+                p->set_exception(std::current_exception());
+            }
+        });
+        return f;
+    }
+
+    template <typename Func>
+    static auto spawn(Executor &executor, Func &&func) {
+        return spawn(Strand::make(executor), std::forward<Func>(func));
+    }
+
+    /**
+     * @brief      fiber running on the calling thread, or nullptr
+     */
+    static Fiber *current();
+
+    Strand &strand() { return *this->_strand; }
+
+    /**
+     * @brief      suspend until resume(), from inside the fiber only
+     */
+    void suspend();
+
+    /**
+     * @brief      continue the fiber on its strand
+     */
+    void resume();
+
+  private:
+    using coro_type = boost::coroutines2::coroutine<void>;
+
+    std::shared_ptr<Strand> _strand;
+    std::unique_ptr<coro_type::push_type> _coro;
+    coro_type::pull_type *_yield{};
+
+    explicit Fiber(std::shared_ptr<Strand> strand)
+        : _strand(std::move(strand)) {}
+
+    void _start(Task body);
+    void _run();
+};
+
+/**
+ * @brief      wait for op inside a fiber, without blocking the thread
+ *
+ * @return     op's value, rethrows its exception
+ */
+template <typename T> T await(Async<T> op) {
+    auto fiber = Fiber::current();
+    if (!fiber) {
+        throw AsyncError("await() outside of a fiber");
+    }
+
+    std::optional<AsyncResult<T>> result;
+    std::move(op).then(
+        [&result, self = fiber->shared_from_this()](AsyncResult<T> &r) {
+            result.emplace(std::move(r));
+            self->resume();
+        });
+    fiber->suspend();
+    return result->get();
+}
+
+} // namespace my
@@ -1,8 +1,12 @@
 #pragma once
 
 #include <any>
+#include <cassert>
 
+#include <core/async.hpp>
 #include <core/coordination.hpp>
+#include <core/executor.hpp>
+#include <core/profiler.hpp>
 
 // Experimental begin
 #define DECL_API(service, name, ret, args...) virtual ret name(args) = 0;
@@ -41,10 +45,33 @@ template <typename... Args> struct ServiceRequestEvent {
           params(std::forward<Args>(args)...) {}
 };
 
+/**
+ * @brief      a service runs its scheduled work serially, either on an own
+ *             thread or on a Strand of a shared Executor
+ */
 class BasicService {
   public:
-    virtual ~BasicService() = default;
-    observe_on_one_thread &coordination() { return this->coordination_; }
+    BasicService() : _coordination(std::make_unique<observe_on_one_thread>()) {}
+    /**
+     * @brief      run on a strand of executor instead of an own thread, for
+     *             services without thread affinity
+     */
+    explicit BasicService(Executor &executor)
+        : _strand(Strand::make(executor)) {}
+
+    virtual ~BasicService() {
+        if (this->_strand) {
+            this->_strand->close();
+        }
+    }
+
+    /**
+     * @brief      the own thread, only for services not on a strand
+     */
+    observe_on_one_thread &coordination() {
+        assert(this->_coordination);
+        return *this->_coordination;
+    }
 
     using DEFAULT_EXIT_FUNCTION_TYPE = std::function<void()>;
     template <typename Before = DEFAULT_EXIT_FUNCTION_TYPE,
@@ -55,60 +82,95 @@ class BasicService {
             [this, before = std::forward<Before>(before),
              after = std::forward<After>(after)]() -> void {
                 before();
-                this->coordination().coordinator_state().unsubscribe();
+                if (this->_strand) {
+                    this->_strand->close();
+                } else {
+                    this->coordination().coordinator_state().unsubscribe();
+                }
                 after();
             });
     }
 
   protected:
-    template <typename T, typename Func>
-    future<T> schedule(Func &&func,
-                       typename std::enable_if_t<std::is_void_v<T>> * = 0) {
-        auto p = std::make_shared<promise<T>>();
-        if (this->coordination().get_thread_info().thread_id ==
-            std::this_thread::get_id()) {
-            func();
-            p->set_value();
+    template <typename T, typename Func> future<T> schedule(Func &&func) {
+        promise<T> p;
+        auto f = p.get_future();
+        if (this->_in_service_context()) {
+            _fulfil(p, func);
+            return f;
+        }
+
+        auto task = [p = std::move(p),
+                     func = std::forward<Func>(func)]() mutable {
+            MY_PROFILE_ZONE_C("service", "BasicService::schedule");
+            try {
+                _fulfil(p, func);
+            } catch (...) {
+                try {
+                    p.set_exception(std::current_exception());
+                } catch (...) {
+                }
+            }
+        };
+        this->_post(std::move(task));
+        return f;
+    }
+
+    /**
+     * @brief      like schedule(), but nothing blocks on the result
+     *
+     * The call starts when the Async is awaited in a Fiber or given a
+     * continuation with then(), the continuation runs in this service.
+     */
+    template <typename T, typename Func> Async<T> async(Func &&func) {
+        return Async<T>([this, func = std::forward<Func>(func)](
+                            typename Async<T>::continuation_type k) {
+            auto task = [func, k = std::move(k)]() mutable {
+                MY_PROFILE_ZONE_C("service", "BasicService::async");
+                AsyncResult<T> result;
+                result.capture(func);
+                k(result);
+            };
+            if (this->_in_service_context()) {
+                task();
+            } else {
+                this->_post(std::move(task));
+            }
+        });
+    }
+
+  private:
+    unique_ptr<observe_on_one_thread> _coordination;
+    shared_ptr<Strand> _strand;
+
+    bool _in_service_context() {
+        if (this->_strand) {
+            return this->_strand->running_in_this_thread();
+        }
+        return this->coordination().get_thread_info().thread_id ==
+               std::this_thread::get_id();
+    }
+
+    template <typename Func> void _post(Func &&task) {
+        if (this->_strand) {
+            this->_strand->post(std::forward<Func>(task));
         } else {
+            // rx wants a copyable action
+            auto shared_task = std::make_shared<std::decay_t<Func>>(
+                std::forward<Func>(task));
             this->coordination().coordinator().get_worker().schedule(
-                [p, func](auto) {
-                    try {
-                        func();
-                        p->set_value();
-                    } catch (...) {
-                        try {
-                            p->set_exception(std::current_exception());
-                        } catch (...) {
-                        }
-                    }
-                });
+                [shared_task](auto) { (*shared_task)(); });
         }
-        return p->get_future();
     }
+
     template <typename T, typename Func>
-    future<T> schedule(Func &&func,
-                       typename std::enable_if_t<!std::is_void_v<T>> * = 0) {
-        auto p = std::make_shared<promise<T>>();
-        if (this->coordination().get_thread_info().thread_id ==
-            std::this_thread::get_id()) {
-            p->set_value(func());
+    static void _fulfil(promise<T> &p, Func &func) {
+        if constexpr (std::is_void_v<T>) {
+            func();
+            p.set_value();
         } else {
-            this->coordination().coordinator().get_worker().schedule(
-                [p, func = std::forward<Func>(func)](auto) {
-                    try {
-                        p->set_value(func());
-                    } catch (...) {
-                        try {
-                            p->set_exception(std::current_exception());
-                        } catch (...) {
-                        }
-                    }
-                });
+            p.set_value(func());
         }
-        return p->get_future();
     }
-
-  private:
-    observe_on_one_thread coordination_;
 };
 } // namespace my
@@ -1,7 +1,10 @@
 #pragma once
 
 #include <core/config.hpp>
+#include <core/lane_queue.hpp>
+#include <core/timer_wheel.hpp>
 #include <core/type.hpp>
+#include <util/event_count.hpp>
 
 namespace my {
 
@@ -71,47 +74,186 @@ class observe_on_one_thread {
     }
 };
 
+/**
+ * @brief      the application thread's loop
+ *
+ * Work arrives through three lanes and the rx run_loop. Every pass fires
+ * due timers, then runs the high lane empty before each normal task or rx
+ * action, and gives idle tasks at most the idle budget once nothing else
+ * is pending. Between passes the thread sleeps until the next timer or
+ * rx action is due or something is posted.
+ */
 class main_loop {
     using run_loop_type = rx::schedulers::run_loop;
 
   public:
     using coordination_type = rx::observe_on_one_worker;
+    using clock = std::chrono::steady_clock;
+    using timer_id = TimerWheel<std::pair<Task, Lane>>::timer_id;
+
     main_loop() {
-        _rl.set_notify_earlier_wakeup([this](auto) { this->_cv.notify_one(); });
+        _rl.set_notify_earlier_wakeup([this](auto) { this->_wakeup.notify(); });
     }
 
     coordination_type coordination() {
         return rx::observe_on_run_loop(this->_rl);
     }
 
+    /**
+     * @brief      run task on the loop thread, from any thread
+     */
+    void post(Task task, Lane lane = Lane::kNormal) {
+        this->_lane(lane).push(std::move(task));
+        this->_wakeup.notify();
+    }
+
+    /**
+     * @brief      post task to lane once delay passed
+     */
+    timer_id post_after(clock::duration delay, Task task,
+                        Lane lane = Lane::kNormal) {
+        timer_id id;
+        {
+            std::unique_lock<std::mutex> l_lock(this->_timer_lock);
+            id = this->_timers.add(clock::now() + delay,
+                                   {std::move(task), lane});
+        }
+        this->_wakeup.notify();
+        return id;
+    }
+
+    bool cancel_timer(timer_id id) {
+        std::unique_lock<std::mutex> l_lock(this->_timer_lock);
+        return this->_timers.cancel(id);
+    }
+
+    /**
+     * @brief      longest time idle tasks may take per pass
+     */
+    void idle_budget(clock::duration budget) { this->_idle_budget = budget; }
+    clock::duration idle_budget() const { return this->_idle_budget; }
+
+    LaneStats stats(Lane lane) { return this->_lane(lane).stats(); }
+
     void quit() {
         this->_need_quit = true;
-        this->_cv.notify_one();
+        this->_wakeup.notify();
     }
 
     void run() {
         while (!this->_need_quit) {
-            while (!this->_need_quit && !this->_rl.empty() &&
-                   this->_rl.peek().when < this->_rl.now()) {
-                this->_rl.dispatch();
+            this->_fire_timers();
+            this->_run_high();
+
+            // rx actions count as normal work
+            bool busy = false;
+            Task task;
+            while (!this->_need_quit) {
+                if (this->_normal.try_pop(task)) {
+                    task();
+                    task.reset();
+                } else if (this->_rx_due()) {
+                    this->_rl.dispatch();
+                } else {
+                    break;
+                }
+                busy = true;
+                this->_run_high();
+            }
+
+            if (!busy) {
+                this->_run_idle();
             }
 
-            std::unique_lock<std::mutex> l_lock(this->_lock);
-            if (!this->_rl.empty() && this->_rl.peek().when > this->_rl.now()) {
-                this->_cv.wait_until(l_lock, this->_rl.peek().when);
+            auto key = this->_wakeup.prepare_wait();
+            if (this->_need_quit || this->_has_work()) {
+                this->_wakeup.cancel_wait(key);
+                continue;
+            }
+            auto deadline = this->_next_deadline();
+            if (deadline) {
+                this->_wakeup.wait_until(key, *deadline);
             } else {
-                this->_cv.wait(l_lock, [this]() {
-                    return this->_need_quit || !this->_rl.empty();
-                });
+                this->_wakeup.wait(key);
             }
         }
     }
 
   private:
     run_loop_type _rl;
-    std::condition_variable _cv;
-    std::mutex _lock;
-    bool _need_quit{false};
+    EventCount _wakeup;
+    std::atomic<bool> _need_quit{false};
+
+    LaneQueue _high;
+    LaneQueue _normal;
+    LaneQueue _idle;
+    clock::duration _idle_budget{std::chrono::milliseconds(4)};
+
+    std::mutex _timer_lock;
+    TimerWheel<std::pair<Task, Lane>> _timers;
+
+    LaneQueue &_lane(Lane lane) {
+        switch (lane) {
+        case Lane::kHigh:
+            return this->_high;
+        case Lane::kIdle:
+            return this->_idle;
+        default:
+            return this->_normal;
+        }
+    }
+
+    void _fire_timers() {
+        std::unique_lock<std::mutex> l_lock(this->_timer_lock);
+        this->_timers.advance(clock::now(), [this](auto &&timer) {
+            this->_lane(timer.second).push(std::move(timer.first));
+        });
+    }
+
+    void _run_high() {
+        Task task;
+        while (!this->_need_quit && this->_high.try_pop(task)) {
+            task();
+            task.reset();
+        }
+    }
+
+    void _run_idle() {
+        auto until = clock::now() + this->_idle_budget;
+        Task task;
+        while (!this->_need_quit && this->_high.empty() &&
+               this->_normal.empty() && this->_idle.try_pop(task)) {
+            task();
+            task.reset();
+            if (clock::now() >= until) {
+                break;
+            }
+        }
+    }
+
+    bool _rx_due() {
+        return !this->_rl.empty() && this->_rl.peek().when <= this->_rl.now();
+    }
+
+    bool _has_work() {
+        return !this->_high.empty() || !this->_normal.empty() ||
+               !this->_idle.empty() || this->_rx_due();
+    }
+
+    std::optional<clock::time_point> _next_deadline() {
+        std::optional<clock::time_point> deadline;
+        {
+            std::unique_lock<std::mutex> l_lock(this->_timer_lock);
+            deadline = this->_timers.next_deadline();
+        }
+        if (!this->_rl.empty()) {
+            auto when = this->_rl.peek().when;
+            if (!deadline || when < *deadline) {
+                deadline = when;
+            }
+        }
+        return deadline;
+    }
 };
 
 } // namespace my
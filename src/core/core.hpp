@@ -4,7 +4,10 @@
 #include <core/type.hpp>
 #include <core/signal.hpp>
 #include <core/logger.hpp>
+#include <core/profiler.hpp>
+#include <core/metrics.hpp>
 #include <core/basic_service.hpp>
 #include <core/async_task.hpp>
+#include <core/async.hpp>
 #include <core/event_bus.hpp>
 #include <core/coordination.hpp>
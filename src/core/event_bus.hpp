@@ -3,7 +3,9 @@
 #include <typeindex>
 
 #include <core/config.hpp>
+#include <core/metrics.hpp>
 #include <core/type.hpp>
+#include <core/typed_event.hpp>
 
 namespace my {
 class IEvent {
@@ -107,12 +109,49 @@ template <typename T> inline decltype(auto) on_event(Observable *o) {
 class EventBus : public Subject, public Observer {
   public:
     void subscribe(Observable *observable) override {
-        observable->event_source().subscribe([this](auto e) { this->post(e); });
+        observable->event_source().subscribe(
+            [this](auto e) { this->repost(e); });
+    }
+
+    /**
+     * @brief      allocation free channel for high rate events
+     *
+     * Events dispatched here are delivered to typed subscribers only, they
+     * never enter the rx event source and vice versa.
+     */
+    TypedDispatcher &typed() { return this->_typed; }
+
+    template <typename T, typename... Args> size_t dispatch(Args &&...args) {
+        auto delivered = this->_typed.post<T>(std::forward<Args>(args)...);
+        this->_dispatched.add();
+        this->_deliveries.add(delivered);
+        return delivered;
+    }
+
+    template <typename T, typename Func>
+    TypedDispatcher::handler_id on_dispatch(Func &&func) {
+        return this->_typed.subscribe<T>(std::forward<Func>(func));
     }
 
     static std::unique_ptr<EventBus> create() {
         return std::make_unique<EventBus>();
     }
+
+  protected:
+    /**
+     * @brief      post an event of a subscribed observable to this bus
+     */
+    void repost(const dynamic_event_type &e) {
+        this->_events.add();
+        this->post(e);
+    }
+
+  private:
+    TypedDispatcher _typed;
+
+    Counter &_events{Metrics::get()->counter("event_bus.events")};
+    Counter &_dispatched{Metrics::get()->counter("event_bus.dispatched")};
+    Counter &_deliveries{Metrics::get()->counter("event_bus.deliveries")};
 };
 
 } // namespace my
@@ -0,0 +1,285 @@
+#include "executor.hpp"
+
+#include <exception>
+
+#include <pthread.h>
+
+#include <core/logger.hpp>
+
+namespace {
+using namespace my;
+
+// worker of the calling thread, if it belongs to an executor
+thread_local const Executor *tl_executor{nullptr};
+thread_local size_t tl_worker{0};
+// strand whose task the calling thread is running
+thread_local const Strand *tl_strand{nullptr};
+
+void run_task(Task &task) {
+    try {
+        task();
+    } catch (const std::exception &e) {
+        // tasks report failures through their own promise, whatever gets
+        // here would be lost without a trace
+        GLOG_E("executor task failed: %1%", e.what());
+    } catch (...) {
+        GLOG_E("executor task failed with an unknown exception");
+    }
+    task.reset();
+}
+
+// outlives the parallel_for call, helpers may start after it returned
+struct ParallelFor {
+    const std::function<void(size_t)> *job;
+    size_t count;
+    std::atomic<size_t> next{0};
+
+    std::mutex lock;
+    std::condition_variable idle;
+    // helpers which may still call job
+    size_t active{0};
+    // set once the caller ran out of indices, later helpers return
+    bool closed{false};
+    std::exception_ptr error;
+
+    void work() {
+        try {
+            for (auto i = this->next.fetch_add(1, std::memory_order_relaxed);
+                 i < this->count;
+                 i = this->next.fetch_add(1, std::memory_order_relaxed)) {
+                (*this->job)(i);
+            }
+        } catch (...) {
+            // the other threads stop at their next claim
+            this->next.store(this->count, std::memory_order_relaxed);
+            std::unique_lock<std::mutex> l_lock(this->lock);
+            if (!this->error) {
+                this->error = std::current_exception();
+            }
+        }
+    }
+};
+
+} // namespace
+
+namespace my {
+
+Executor::Executor(size_t concurrency, const std::string &name) {
+    concurrency = std::max<size_t>(concurrency, 1);
+    for (size_t i = 0; i < concurrency; ++i) {
+        this->_workers.push_back(std::make_unique<Worker>());
+    }
+    // start after all workers exist, they steal from each other
+    for (size_t i = 0; i < concurrency; ++i) {
+        auto &thread = this->_workers[i]->thread;
+        thread = std::thread([this, i]() { this->_run(i); });
+        // thread names are limited to 15 characters
+        auto thread_name = (name + " " + std::to_string(i)).substr(0, 15);
+        pthread_setname_np(thread.native_handle(), thread_name.c_str());
+    }
+}
+
+Executor::~Executor() {
+    this->_stop = true;
+    this->_idle.notify();
+    for (auto &worker : this->_workers) {
+        worker->thread.join();
+    }
+}
+
+void Executor::post(Task task) {
+    if (tl_executor != this ||
+        !this->_workers[tl_worker]->local.try_push(std::move(task))) {
+        std::unique_lock<std::mutex> l_lock(this->_inject_lock);
+        this->_inject.push_back(std::move(task));
+        this->_inject_size.fetch_add(1, std::memory_order_seq_cst);
+    }
+    if (this->_searching.load(std::memory_order_seq_cst) == 0) {
+        this->_idle.notify();
+    }
+}
+
+bool Executor::running_in_this_thread() const { return tl_executor == this; }
+
+Executor::Stats Executor::stats() const {
+    Stats stats;
+    for (auto &worker : this->_workers) {
+        stats.executed += worker->executed.load(std::memory_order_relaxed);
+        stats.stolen += worker->stolen.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+Executor *Executor::shared() {
+    static Executor executor(default_concurrency(), "shared executor");
+    return &executor;
+}
+
+void Executor::_run(size_t index) {
+    tl_executor = this;
+    tl_worker = index;
+    auto &worker = *this->_workers[index];
+
+    Task task;
+    this->_searching.fetch_add(1, std::memory_order_seq_cst);
+    while (true) {
+        if (this->_find(index, task)) {
+            // the last searcher going to work wakes a replacement
+            if (this->_searching.fetch_sub(1, std::memory_order_seq_cst) ==
+                1) {
+                this->_idle.notify();
+            }
+            run_task(task);
+            worker.executed.fetch_add(1, std::memory_order_relaxed);
+            this->_searching.fetch_add(1, std::memory_order_seq_cst);
+            continue;
+        }
+        if (this->_stop.load(std::memory_order_acquire)) {
+            break;
+        }
+
+        // stop counting as searcher before the last check, a post() that
+        // still saw us searching happened before it and is found there
+        auto key = this->_idle.prepare_wait();
+        this->_searching.fetch_sub(1, std::memory_order_seq_cst);
+        if (this->_find(index, task) ||
+            this->_stop.load(std::memory_order_acquire)) {
+            this->_idle.cancel_wait(key);
+            if (task) {
+                run_task(task);
+                worker.executed.fetch_add(1, std::memory_order_relaxed);
+            }
+        } else {
+            this->_idle.wait(key);
+        }
+        this->_searching.fetch_add(1, std::memory_order_seq_cst);
+    }
+    this->_searching.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+bool Executor::_find(size_t index, Task &task) {
+    auto &workers = this->_workers;
+    if (workers[index]->local.try_pop(task) || this->_pop_injected(task)) {
+        return true;
+    }
+    for (size_t i = 1; i < workers.size(); ++i) {
+        if (workers[(index + i) % workers.size()]->local.try_pop(task)) {
+            workers[index]->stolen.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Executor::_pop_injected(Task &task) {
+    if (this->_inject_size.load(std::memory_order_seq_cst) == 0) {
+        return false;
+    }
+    std::unique_lock<std::mutex> l_lock(this->_inject_lock);
+    if (this->_inject.empty()) {
+        return false;
+    }
+    task = std::move(this->_inject.front());
+    this->_inject.pop_front();
+    this->_inject_size.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+void Strand::post(Task task) {
+    {
+        std::unique_lock<std::mutex> l_lock(this->_lock);
+        if (this->_closed.load(std::memory_order_relaxed)) {
+            return;
+        }
+        this->_pending.push_back(std::move(task));
+        if (this->_scheduled) {
+            return;
+        }
+        this->_scheduled = true;
+    }
+    this->_executor.post(
+        [self = this->shared_from_this()]() { self->_drain(); });
+}
+
+bool Strand::running_in_this_thread() const { return tl_strand == this; }
+
+void Strand::close() {
+    std::unique_lock<std::mutex> l_lock(this->_lock);
+    this->_closed.store(true, std::memory_order_relaxed);
+    this->_pending.clear();
+    // a worker waiting could be the one the drain is queued on
+    if (!this->_executor.running_in_this_thread()) {
+        this->_idle_cv.wait(l_lock, [this]() { return !this->_scheduled; });
+    }
+}
+
+void Strand::_drain() {
+    {
+        std::unique_lock<std::mutex> l_lock(this->_lock);
+        this->_running.swap(this->_pending);
+    }
+
+    auto prev = tl_strand;
+    tl_strand = this;
+    for (auto &task : this->_running) {
+        // a task may have closed the strand, drop the rest of the batch
+        if (this->_closed.load(std::memory_order_relaxed)) {
+            break;
+        }
+        run_task(task);
+    }
+    tl_strand = prev;
+    this->_running.clear();
+
+    {
+        std::unique_lock<std::mutex> l_lock(this->_lock);
+        if (this->_pending.empty()) {
+            this->_scheduled = false;
+            this->_idle_cv.notify_all();
+            return;
+        }
+    }
+    this->_executor.post(
+        [self = this->shared_from_this()]() { self->_drain(); });
+}
+
+void parallel_for(Executor &executor, size_t count, size_t threads,
+                  const std::function<void(size_t)> &job) {
+    threads = std::min(threads, count);
+    if (threads <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            job(i);
+        }
+        return;
+    }
+
+    auto state = std::make_shared<ParallelFor>();
+    state->job = &job;
+    state->count = count;
+    for (size_t i = 1; i < threads; ++i) {
+        executor.post([state]() {
+            {
+                std::unique_lock<std::mutex> l_lock(state->lock);
+                if (state->closed) {
+                    return;
+                }
+                ++state->active;
+            }
+            state->work();
+            std::unique_lock<std::mutex> l_lock(state->lock);
+            if (--state->active == 0) {
+                state->idle.notify_all();
+            }
+        });
+    }
+    state->work();
+
+    std::unique_lock<std::mutex> l_lock(state->lock);
+    state->closed = true;
+    state->idle.wait(l_lock, [&state]() { return state->active == 0; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+} // namespace my
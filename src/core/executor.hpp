@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <core/task.hpp>
+#include <util/event_count.hpp>
+#include <util/queue.hpp>
+
+namespace my {
+
+/**
+ * @brief      work-stealing thread pool
+ *
+ * Every worker owns a bounded lock-free queue. Tasks posted from a worker
+ * go to its own queue, tasks posted from other threads (or when the own
+ * queue is full) go to a shared injection queue. An idle worker takes from
+ * its own queue, then the injection queue, then steals from the others,
+ * and only sleeps when all of them are empty. Posting does not wake
+ * anybody while some worker is still searching for work.
+ */
+class Executor {
+  public:
+    struct Stats {
+        uint64_t executed{};
+        uint64_t stolen{};
+    };
+
+    explicit Executor(size_t concurrency = default_concurrency(),
+                      const std::string &name = "executor");
+    /**
+     * @brief      runs the tasks still queued, then joins the workers
+     */
+    ~Executor();
+
+    Executor(const Executor &) = delete;
+    Executor &operator=(const Executor &) = delete;
+
+    void post(Task task);
+
+    size_t concurrency() const { return this->_workers.size(); }
+
+    bool running_in_this_thread() const;
+
+    Stats stats() const;
+
+    static size_t default_concurrency() {
+        return std::max(2u, std::thread::hardware_concurrency());
+    }
+
+    /**
+     * @brief      the pool services attach their strands to by default
+     */
+    static Executor *shared();
+
+  private:
+    static constexpr size_t kLocalCapacity = 256;
+
+    struct Worker {
+        Queue<Task, kLocalCapacity> local;
+        std::thread thread;
+        std::atomic<uint64_t> executed{0};
+        std::atomic<uint64_t> stolen{0};
+    };
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+
+    std::mutex _inject_lock;
+    std::deque<Task> _inject;
+    std::atomic<size_t> _inject_size{0};
+
+    EventCount _idle;
+    // workers awake and looking for a task
+    std::atomic<size_t> _searching{0};
+    std::atomic<bool> _stop{false};
+
+    void _run(size_t index);
+    bool _find(size_t index, Task &task);
+    bool _pop_injected(Task &task);
+};
+
+/**
+ * @brief      runs job(i) for every i < count on the calling thread and up
+ *             to threads - 1 helper tasks of the executor
+ *
+ * The indices are claimed one by one, whoever is free takes the next. The
+ * caller only waits for helpers which started before it ran out of
+ * indices, a helper still queued behind other tasks finds nothing left and
+ * returns, so a busy executor never blocks the call. The first exception
+ * thrown by job is rethrown once no helper runs job any more.
+ */
+void parallel_for(Executor &executor, size_t count, size_t threads,
+                  const std::function<void(size_t)> &job);
+
+/**
+ * @brief      runs its tasks one at a time and in post order on an Executor
+ *
+ * Strands share the executor's workers instead of owning a thread, a
+ * strand only occupies a worker while it has pending tasks. After each
+ * batch of tasks the strand goes back to the end of the executor's queue,
+ * so a busy strand cannot starve the others.
+ */
+class Strand : public std::enable_shared_from_this<Strand> {
+  public:
+    static std::shared_ptr<Strand> make(Executor &executor) {
+        return std::shared_ptr<Strand>(new Strand(executor));
+    }
+
+    void post(Task task);
+
+    /**
+     * @brief      whether the calling thread is running a task of this strand
+     */
+    bool running_in_this_thread() const;
+
+    /**
+     * @brief      drop pending tasks and ignore later posts
+     *
+     * Waits for the running batch to finish, unless called from a worker of
+     * the executor, e.g. from inside the batch.
+     */
+    void close();
+
+    Executor &executor() { return this->_executor; }
+
+  private:
+    explicit Strand(Executor &executor) : _executor(executor) {}
+
+    Executor &_executor;
+    std::mutex _lock;
+    std::condition_variable _idle_cv;
+    std::vector<Task> _pending;
+    // batch taken out of _pending by the running drain
+    std::vector<Task> _running;
+    bool _scheduled{false};
+    std::atomic<bool> _closed{false};
+
+    void _drain();
+};
+
+} // namespace my
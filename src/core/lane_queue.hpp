@@ -0,0 +1,166 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+
+#include <core/task.hpp>
+#include <util/queue.hpp>
+
+namespace my {
+
+/**
+ * @brief      priority lanes of the main loop
+ */
+enum class Lane {
+    // input and everything the user waits for
+    kHigh,
+    kNormal,
+    // runs only when nothing else is pending, within the idle budget
+    kIdle,
+};
+
+struct LaneStats {
+    uint64_t posted{};
+    uint64_t dispatched{};
+    size_t depth{};
+    size_t max_depth{};
+    // post to dispatch, upper bounds of power of two microsecond buckets
+    double latency_p50_us{};
+    double latency_p99_us{};
+    double latency_max_us{};
+};
+
+/**
+ * @brief      tasks of one lane, posted from any thread and run by one
+ *
+ * A lock-free ring takes the tasks, a locked overflow list keeps the order
+ * when a burst outgrows it. Records depth and post to dispatch latency.
+ */
+class LaneQueue {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    void push(Task task) {
+        Entry entry{std::move(task), clock::now()};
+        // once tasks overflowed, later ones queue behind them
+        if (this->_overflow_size.load(std::memory_order_acquire) != 0 ||
+            !this->_ring.try_push(std::move(entry))) {
+            std::unique_lock<std::mutex> l_lock(this->_overflow_lock);
+            this->_overflow.push_back(std::move(entry));
+            this->_overflow_size.fetch_add(1, std::memory_order_release);
+        }
+        auto depth = this->_depth.fetch_add(1, std::memory_order_relaxed) + 1;
+        auto max = this->_max_depth.load(std::memory_order_relaxed);
+        while (depth > max && !this->_max_depth.compare_exchange_weak(
+                                  max, depth, std::memory_order_relaxed)) {
+        }
+        this->_posted.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief      take the oldest task, consumer thread only
+     */
+    bool try_pop(Task &task) {
+        Entry entry;
+        if (!this->_ring.try_pop(entry) && !this->_pop_overflow(entry)) {
+            return false;
+        }
+        task = std::move(entry.task);
+        this->_depth.fetch_sub(1, std::memory_order_relaxed);
+        this->_dispatched.fetch_add(1, std::memory_order_relaxed);
+        this->_record(clock::now() - entry.posted);
+        return true;
+    }
+
+    size_t depth() const {
+        return this->_depth.load(std::memory_order_relaxed);
+    }
+    bool empty() const { return this->depth() == 0; }
+
+    LaneStats stats() const {
+        LaneStats stats;
+        stats.posted = this->_posted.load(std::memory_order_relaxed);
+        stats.dispatched = this->_dispatched.load(std::memory_order_relaxed);
+        stats.depth = this->depth();
+        stats.max_depth = this->_max_depth.load(std::memory_order_relaxed);
+        stats.latency_p50_us = this->_latency_percentile(50);
+        stats.latency_p99_us = this->_latency_percentile(99);
+        stats.latency_max_us =
+            double(this->_latency_max_us.load(std::memory_order_relaxed));
+        return stats;
+    }
+
+  private:
+    static constexpr size_t kRingCapacity = 512;
+    static constexpr size_t kBuckets = 32;
+
+    struct Entry {
+        Task task;
+        clock::time_point posted;
+    };
+
+    Queue<Entry, kRingCapacity> _ring;
+    std::mutex _overflow_lock;
+    std::deque<Entry> _overflow;
+    std::atomic<size_t> _overflow_size{0};
+
+    std::atomic<size_t> _depth{0};
+    std::atomic<size_t> _max_depth{0};
+    std::atomic<uint64_t> _posted{0};
+    std::atomic<uint64_t> _dispatched{0};
+    // bucket i counts latencies below 2^i us
+    std::array<std::atomic<uint64_t>, kBuckets> _latency{};
+    std::atomic<uint64_t> _latency_max_us{0};
+
+    bool _pop_overflow(Entry &entry) {
+        if (this->_overflow_size.load(std::memory_order_acquire) == 0) {
+            return false;
+        }
+        std::unique_lock<std::mutex> l_lock(this->_overflow_lock);
+        if (this->_overflow.empty()) {
+            return false;
+        }
+        entry = std::move(this->_overflow.front());
+        this->_overflow.pop_front();
+        this->_overflow_size.fetch_sub(1, std::memory_order_release);
+        return true;
+    }
+
+    void _record(clock::duration latency) {
+        auto us = uint64_t(
+            std::chrono::duration_cast<std::chrono::microseconds>(latency)
+                .count());
+        size_t bucket = 0;
+        while (bucket + 1 < kBuckets && (uint64_t(1) << bucket) <= us) {
+            ++bucket;
+        }
+        this->_latency[bucket].fetch_add(1, std::memory_order_relaxed);
+        if (us > this->_latency_max_us.load(std::memory_order_relaxed)) {
+            this->_latency_max_us.store(us, std::memory_order_relaxed);
+        }
+    }
+
+    double _latency_percentile(double p) const {
+        uint64_t total = 0;
+        for (auto &bucket : this->_latency) {
+            total += bucket.load(std::memory_order_relaxed);
+        }
+        if (total == 0) {
+            return 0;
+        }
+        auto rank = uint64_t(p / 100.0 * double(total - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            seen += this->_latency[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                return double(uint64_t(1) << i);
+            }
+        }
+        return double(uint64_t(1) << (kBuckets - 1));
+    }
+};
+
+} // namespace my
@@ -1,8 +1,14 @@
 #include "logger.hpp"
 
+#include <algorithm>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 
+#include <pthread.h>
+
+#include <core/profiler.hpp>
+
 namespace {
 using namespace my;
 class StdLoggerOutput : public Logger::LoggerOutput {
@@ -11,56 +17,230 @@ class StdLoggerOutput : public Logger::LoggerOutput {
         : Logger::LoggerOutput(level) {}
     ~StdLoggerOutput() override = default;
     void operator()(const Logger::LogMsg &msg) override {
-        std::cout << msg.format() << std::endl;
+        std::cout << msg.format() << '\n';
         if (msg.level == Logger::kError) {
+            std::cout.flush();
             std::terminate();
         }
     };
+    void flush() override { std::cout.flush(); }
 };
 
 class FileLoggerOutput : public Logger::LoggerOutput {
   public:
-    explicit FileLoggerOutput(const my::fs::path &path,
+    explicit FileLoggerOutput(const std::filesystem::path &path,
                               Logger::Level level = Logger::kInfo)
         : Logger::LoggerOutput(level) {
-        my::fs::remove(path);
+        std::filesystem::remove(path);
         this->_ofs.exceptions(std::ios::failbit | std::ios::badbit);
         this->_ofs.open(path);
     }
     ~FileLoggerOutput() override = default;
     void operator()(const Logger::LogMsg &msg) override {
-        this->_ofs << msg.format() << std::endl;
-        this->_ofs.flush();
+        this->_ofs << msg.format() << '\n';
         if (msg.level == Logger::kError) {
+            this->_ofs.flush();
             std::terminate();
         }
     };
+    void flush() override { this->_ofs.flush(); }
 
   private:
     std::ofstream _ofs;
 };
 
+std::atomic<uint64_t> next_logger_id{1};
+
+// ring of the calling thread for the logger it last logged to
+struct ThreadRing {
+    uint64_t logger_id{0};
+    std::shared_ptr<void> ring;
+};
+thread_local ThreadRing tl_ring;
+
+// the logger whose thread this is
+thread_local const my::Logger *tl_logger_thread = nullptr;
+
 } // namespace
 
 namespace my {
-Logger::Logger() {
-    // init output target
-    this->addLogOutputTarget(std::make_shared<StdLoggerOutput>(Logger::kDebug));
-    this->addLogOutputTarget(
-        std::make_shared<FileLoggerOutput>("log.txt", Logger::kDebug));
-    pthread_setname_np(this->coordination().get_thread_info().handle,
-                       "logger service");
+Logger::Logger()
+    : Logger({std::make_shared<StdLoggerOutput>(Logger::kDebug),
+              std::make_shared<FileLoggerOutput>("log.txt", Logger::kDebug)}) {
+}
+
+Logger::Logger(const std::vector<std::shared_ptr<LoggerOutput>> &outputs)
+    : _id(next_logger_id++), _outputs(outputs) {
+    this->_thread = std::thread([this]() { this->_run(); });
+    pthread_setname_np(this->_thread.native_handle(), "logger service");
+}
+
+Logger::~Logger() {
+    this->_stop = true;
+    this->_wakeup.notify();
+    this->_thread.join();
+}
+
+void Logger::addLogOutputTarget(const std::shared_ptr<LoggerOutput> &output) {
+    std::unique_lock<std::mutex> l_lock(this->_lock);
+    this->_outputs.push_back(output);
 }
 
-void Logger::addLogOutputTarget(const shared_ptr<LoggerOutput> &output) {
-    this->log_source()
-        .get_observable()
-        .observe_on(this->coordination().get())
-        .filter([output, this](const shared_ptr<LogMsg> &msg) {
-            return msg->level >= output->limit_level &&
-                   msg->level >= this->_level;
-        })
-        .subscribe(
-            [output](const shared_ptr<LogMsg> &msg) { (*output)(*msg); });
+void Logger::flush() {
+    if (tl_logger_thread == this) {
+        // an output logging an error, the logger cannot wait for itself
+        return;
+    }
+    auto target = this->_pushed.load(std::memory_order_acquire);
+    this->_wakeup.notify();
+    while (true) {
+        auto key = this->_written_event.prepare_wait();
+        if (this->_written.load(std::memory_order_acquire) >= target) {
+            this->_written_event.cancel_wait(key);
+            return;
+        }
+        this->_wakeup.notify();
+        this->_written_event.wait(key);
+    }
+}
+
+Logger::Ring &Logger::_ring() {
+    if (tl_ring.logger_id == this->_id) {
+        return *static_cast<Ring *>(tl_ring.ring.get());
+    }
+    std::unique_lock<std::mutex> l_lock(this->_lock);
+    auto &ring = this->_rings[std::this_thread::get_id()];
+    if (!ring) {
+        ring = std::make_shared<Ring>();
+    }
+    tl_ring = {this->_id, ring};
+    return *ring;
+}
+
+void Logger::_push(detail::LogRecord &&record) {
+    auto level = record.level;
+    auto &ring = this->_ring();
+    if (!ring.records.try_push(std::move(record))) {
+        if (level < kWarn) {
+            this->_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (tl_logger_thread == this) {
+            // an output logging, only this thread empties its own ring
+            this->_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        do {
+            this->_wakeup.notify();
+            std::this_thread::yield();
+        } while (!ring.records.try_push(std::move(record)));
+    }
+    this->_pushed.fetch_add(1, std::memory_order_release);
+    if (level >= kWarn) {
+        this->_wakeup.notify();
+    }
+}
+
+void Logger::_run() {
+    tl_logger_thread = this;
+    std::vector<detail::LogRecord> batch;
+    while (true) {
+        auto key = this->_wakeup.prepare_wait();
+        // a stop seen before draining still gets everything logged before it
+        auto stop = this->_stop.load(std::memory_order_acquire);
+        auto n = this->_drain(batch);
+        if (stop) {
+            this->_wakeup.cancel_wait(key);
+            break;
+        }
+        if (n) {
+            this->_wakeup.cancel_wait(key);
+            continue;
+        }
+        this->_wakeup.wait_until(key, std::chrono::steady_clock::now() +
+                                          kFlushInterval);
+    }
+}
+
+size_t Logger::_drain(std::vector<detail::LogRecord> &batch) {
+    {
+        // formatting and output run unlocked, a thread's first log call
+        // never waits on I/O and an output may log itself
+        std::unique_lock<std::mutex> l_lock(this->_lock);
+        for (auto it = this->_rings.begin(); it != this->_rings.end();) {
+            // only the registry holds the ring of an exited thread
+            if (it->second.use_count() == 1 && it->second->records.empty()) {
+                it = this->_rings.erase(it);
+            } else {
+                this->_drain_rings.push_back(it->second);
+                ++it;
+            }
+        }
+        this->_drain_outputs = this->_outputs;
+    }
+    batch.clear();
+    for (auto &ring : this->_drain_rings) {
+        detail::LogRecord record;
+        while (ring->records.try_pop(record)) {
+            batch.push_back(std::move(record));
+        }
+    }
+    this->_drain_rings.clear();
+    // rings are drained one after the other, restore the call order
+    std::stable_sort(
+        batch.begin(), batch.end(),
+        [](const auto &a, const auto &b) { return a.time < b.time; });
+
+    if (batch.empty() &&
+        this->_dropped.load(std::memory_order_relaxed) ==
+            this->_reported_dropped) {
+        this->_written_event.notify();
+        return 0;
+    }
+    MY_PROFILE_ZONE_C("logger", "Logger::write");
+    HistogramTimer l_batch_time(this->_batch_us);
+
+    auto write = [this](const LogMsg &msg) {
+        for (auto &output : this->_drain_outputs) {
+            if (msg.level >= output->limit_level) {
+                (*output)(msg);
+            }
+        }
+    };
+    auto dropped = this->_dropped.load(std::memory_order_relaxed);
+    if (dropped != this->_reported_dropped) {
+        write(LogMsg(kWarn,
+                     (boost::format("%1% log records dropped, ring full") %
+                      (dropped - this->_reported_dropped))
+                         .str(),
+                     __FILE__, __LINE__));
+        this->_dropped_records.add(dropped - this->_reported_dropped);
+        this->_reported_dropped = dropped;
+    }
+    for (auto &record : batch) {
+        std::string msg;
+        try {
+            msg = record.format();
+        } catch (std::exception &e) {
+            msg = std::string("<log format error: ") + e.what() + ">";
+        }
+        write(LogMsg(Level(record.level), std::move(msg), record.file_name,
+                     record.file_line));
+    }
+    if (!batch.empty()) {
+        for (auto &output : this->_drain_outputs) {
+            output->flush();
+        }
+    }
+    auto n = batch.size();
+    batch.clear();
+
+    this->_records.add(n);
+    auto written = this->_written.fetch_add(n, std::memory_order_release) + n;
+    // a record is counted as pushed only after it could be written
+    auto pushed = this->_pushed.load(std::memory_order_relaxed);
+    this->_pending.set(pushed > written ? int64_t(pushed - written) : 0);
+    this->_written_event.notify();
+    return n;
 }
 } // namespace my
@@ -1,13 +1,168 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
 #include <boost/format.hpp>
 
-#include <core/basic_service.hpp>
 #include <core/config.hpp>
+#include <core/metrics.hpp>
+#include <core/type.hpp>
+#include <util/event_count.hpp>
+#include <util/queue.hpp>
+
+// calls below this level are compiled out, 0 debug, 1 info, 2 warn, 3 error
+#ifndef MY_LOG_MIN_LEVEL
+#define MY_LOG_MIN_LEVEL 0
+#endif
+
 namespace my {
-class Logger : public my::BasicService {
-    typedef my::BasicService base_type;
 
+namespace detail {
+
+// literal format strings are kept as pointer, anything else is copied
+struct LogLiteral {
+    const char *s;
+    const char *c_str() const { return this->s; }
+};
+
+template <size_t N> LogLiteral log_format(const char (&s)[N]) { return {s}; }
+
+template <typename T, typename A = std::remove_reference_t<T>,
+          typename = std::enable_if_t<
+              !std::is_array_v<A> ||
+              !std::is_const_v<std::remove_extent_t<A>>>>
+std::string log_format(T &&s) {
+    return std::string(s);
+}
+
+// C strings may not outlive the call, capture them as std::string
+template <typename T> auto log_capture(T &&v) {
+    using D = std::decay_t<T>;
+    if constexpr (std::is_same_v<D, const char *> ||
+                  std::is_same_v<D, char *>) {
+        const char *s = v;
+        return std::string(s ? s : "(null)");
+    } else {
+        return D(std::forward<T>(v));
+    }
+}
+
+/**
+ * @brief      one log call with its arguments, formatted later
+ *
+ * The arguments live inline up to kInlineSize bytes, so recording a call
+ * does not allocate unless it captures strings or large objects.
+ */
+class LogRecord {
+  public:
+    static constexpr size_t kInlineSize = 160;
+    using time_point = std::chrono::steady_clock::time_point;
+
+    int level{};
+    int file_line{};
+    const char *file_name{};
+    time_point time;
+
+    LogRecord() = default;
+
+    template <typename Func>
+    LogRecord(int level, const char *file_name, int file_line, Func &&format)
+        : level(level), file_line(file_line), file_name(file_name),
+          time(std::chrono::steady_clock::now()) {
+        using F = std::decay_t<Func>;
+        if constexpr (sizeof(F) <= kInlineSize &&
+                      alignof(F) <= alignof(std::max_align_t) &&
+                      std::is_nothrow_move_constructible_v<F>) {
+            new (this->_storage) F(std::forward<Func>(format));
+            this->_ops = &inline_ops<F>;
+        } else {
+            *reinterpret_cast<F **>(this->_storage) =
+                new F(std::forward<Func>(format));
+            this->_ops = &heap_ops<F>;
+        }
+    }
+
+    LogRecord(LogRecord &&other) noexcept { this->_take(other); }
+
+    LogRecord &operator=(LogRecord &&other) noexcept {
+        if (this != &other) {
+            this->_reset();
+            this->_take(other);
+        }
+        return *this;
+    }
+
+    ~LogRecord() { this->_reset(); }
+
+    std::string format() { return this->_ops->format(this->_storage); }
+
+  private:
+    struct Ops {
+        std::string (*format)(void *);
+        void (*relocate)(void *dst, void *src);
+        void (*destroy)(void *);
+    };
+
+    template <typename F>
+    static constexpr Ops inline_ops{
+        [](void *p) { return (*static_cast<F *>(p))(); },
+        [](void *dst, void *src) {
+            new (dst) F(std::move(*static_cast<F *>(src)));
+            static_cast<F *>(src)->~F();
+        },
+        [](void *p) { static_cast<F *>(p)->~F(); }};
+
+    template <typename F>
+    static constexpr Ops heap_ops{
+        [](void *p) { return (**static_cast<F **>(p))(); },
+        [](void *dst, void *src) {
+            *static_cast<F **>(dst) = *static_cast<F **>(src);
+        },
+        [](void *p) { delete *static_cast<F **>(p); }};
+
+    alignas(std::max_align_t) unsigned char _storage[kInlineSize];
+    const Ops *_ops{};
+
+    void _reset() {
+        if (this->_ops) {
+            this->_ops->destroy(this->_storage);
+            this->_ops = nullptr;
+        }
+    }
+
+    void _take(LogRecord &other) noexcept {
+        this->level = other.level;
+        this->file_line = other.file_line;
+        this->file_name = other.file_name;
+        this->time = other.time;
+        if (other._ops) {
+            other._ops->relocate(this->_storage, other._storage);
+            this->_ops = other._ops;
+            other._ops = nullptr;
+        }
+    }
+};
+
+} // namespace detail
+
+/**
+ * @brief      asynchronous logger
+ *
+ * A call below the level is dropped before its arguments are touched.
+ * Otherwise the format string and the arguments are recorded into a
+ * lock-free ring of the calling thread, the logger thread formats them in
+ * batches and flushes the outputs once per batch. When a ring is full,
+ * debug and info records are dropped and counted, warnings and errors
+ * wait for space. An error returns only once it reached the outputs.
+ */
+class Logger {
   public:
     enum Level { kDebug, kInfo, kWarn, kError };
 
@@ -24,7 +179,10 @@ class Logger : public my::BasicService {
         std::string format() const {
             // TODO: In order to obtain temporary short path
             auto file_name = std::string(this->file_name);
-            file_name = file_name.substr(file_name.rfind("src"));
+            auto src = file_name.rfind("src");
+            if (src != std::string::npos) {
+                file_name = file_name.substr(src);
+            }
 
             std::ostringstream os;
             os << "[" << Logger::to_level_str(this->level) << "]"
@@ -37,26 +195,58 @@ class Logger : public my::BasicService {
       public:
         explicit LoggerOutput(Level level = kInfo) : limit_level(level) {}
         virtual void operator()(const Logger::LogMsg &msg) = 0;
+        /**
+         * @brief      called after each batch of messages
+         */
+        virtual void flush() {}
         virtual ~LoggerOutput() = default;
         Logger::Level limit_level;
     };
 
-    typedef rxcpp::subjects::subject<shared_ptr<LogMsg>> observable_type;
-
+    /**
+     * @brief      logs to stdout and log.txt
+     */
     Logger();
-    ~Logger() { this->logger_exit(); }
+    explicit Logger(
+        const std::vector<std::shared_ptr<LoggerOutput>> &outputs);
+    ~Logger();
+
+    void addLogOutputTarget(const std::shared_ptr<LoggerOutput> &output);
 
-    void addLogOutputTarget(const shared_ptr<LoggerOutput> &output);
+    bool enabled(Level level) const {
+        return level >= this->_level.load(std::memory_order_relaxed);
+    }
 
-    template <typename... Args>
-    void Log(Logger::Level type, const char *file_name, int file_len,
-             const char *fmt, Args &&... args) {
-        auto log_msg = std::make_shared<LogMsg>(
-            type, (boost::format(fmt) % ... % std::forward<Args>(args)).str(),
-            file_name, file_len);
-        this->log_source().get_subscriber().on_next(log_msg);
+    template <typename Fmt, typename... Args>
+    void Log(Logger::Level level, const char *file_name, int file_len,
+             Fmt &&fmt, Args &&... args) {
+        if (!this->enabled(level)) {
+            return;
+        }
+        this->_push(detail::LogRecord(
+            level, file_name, file_len,
+            [fmt = detail::log_format(std::forward<Fmt>(fmt)),
+             args = std::make_tuple(
+                 detail::log_capture(std::forward<Args>(args))...)]() {
+                boost::format f(fmt.c_str());
+                std::apply(
+                    [&f](const auto &... a) {
+                        static_cast<void>((f % ... % a));
+                    },
+                    args);
+                return f.str();
+            }));
+        if (level == kError) {
+            // errors are fatal for the default outputs, on this thread
+            this->flush();
+        }
     }
 
+    /**
+     * @brief      wait until everything logged so far reached the outputs
+     */
+    void flush();
+
     static Logger *get() {
         static Logger instance;
         return &instance;
@@ -64,6 +254,13 @@ class Logger : public my::BasicService {
 
     void set_level(Level level) { this->_level = level; }
 
+    /**
+     * @brief      records dropped because a ring was full
+     */
+    uint64_t dropped() const {
+        return this->_dropped.load(std::memory_order_relaxed);
+    }
+
     static const std::string &to_level_str(Logger::Level l) {
         static const std::map<Logger::Level, const std::string> _level_str = {
             {Logger::kDebug, "DEBUG"},
@@ -74,31 +271,67 @@ class Logger : public my::BasicService {
     }
 
   private:
-    Level _level{kDebug};
+    static constexpr size_t kRingCapacity = 1024;
+    static constexpr auto kFlushInterval = std::chrono::milliseconds(10);
 
-    std::set<rxcpp::composite_subscription> _output_targets;
+    struct Ring {
+        Queue<detail::LogRecord, kRingCapacity, QueueKind::kSPSC> records;
+    };
 
-    observable_type _log_source;
+    std::atomic<int> _level{kDebug};
+    // tells this logger apart from an earlier one at the same address
+    uint64_t _id;
 
-    observable_type &log_source() { return this->_log_source; }
+    std::mutex _lock;
+    std::vector<std::shared_ptr<LoggerOutput>> _outputs;
+    std::unordered_map<std::thread::id, std::shared_ptr<Ring>> _rings;
+    // snapshots of the logger thread, taken under _lock
+    std::vector<std::shared_ptr<Ring>> _drain_rings;
+    std::vector<std::shared_ptr<LoggerOutput>> _drain_outputs;
 
-    void logger_exit() {
-        this->log_source().get_observable().subscribe();
-        this->log_source().get_subscriber().on_completed();
-    }
+    std::atomic<uint64_t> _dropped{0};
+    uint64_t _reported_dropped{0};
+    std::atomic<uint64_t> _pushed{0};
+    std::atomic<uint64_t> _written{0};
+
+    Counter &_records{Metrics::get()->counter("logger.records")};
+    Counter &_dropped_records{Metrics::get()->counter("logger.dropped")};
+    Gauge &_pending{Metrics::get()->gauge("logger.pending")};
+    Histogram &_batch_us{Metrics::get()->histogram("logger.batch_us")};
+
+    EventCount _wakeup;
+    EventCount _written_event;
+    std::atomic<bool> _stop{false};
+    std::thread _thread;
+
+    Ring &_ring();
+    void _push(detail::LogRecord &&record);
+    void _run();
+    size_t _drain(std::vector<detail::LogRecord> &batch);
 };
 } // namespace my
+
+#define MY_LOG_AT(logger, level, fmt, args...)                                 \
+    do {                                                                       \
+        if constexpr (level >= MY_LOG_MIN_LEVEL) {                             \
+            auto my_log_logger_ = (logger);                                    \
+            if (my_log_logger_->enabled(level)) {                              \
+                my_log_logger_->Log(level, __FILE__, __LINE__, fmt, ##args);   \
+            }                                                                  \
+        }                                                                      \
+    } while (0)
+
 #define LOG_D(logger, fmt, args...)                                            \
-    (logger)->Log(my::Logger::kDebug, __FILE__, __LINE__, fmt, ##args)
+    MY_LOG_AT(logger, my::Logger::kDebug, fmt, ##args)
 
 #define LOG_I(logger, fmt, args...)                                            \
-    (logger)->Log(my::Logger::kInfo, __FILE__, __LINE__, fmt, ##args)
+    MY_LOG_AT(logger, my::Logger::kInfo, fmt, ##args)
 
 #define LOG_W(logger, fmt, args...)                                            \
-    (logger)->Log(my::Logger::kWarn, __FILE__, __LINE__, fmt, ##args)
+    MY_LOG_AT(logger, my::Logger::kWarn, fmt, ##args)
 
 #define LOG_E(logger, fmt, args...)                                            \
-    (logger)->Log(my::Logger::kError, __FILE__, __LINE__, fmt, ##args)
+    MY_LOG_AT(logger, my::Logger::kError, fmt, ##args)
 
 #define GLOG_D(fmt, args...) LOG_D(my::Logger::get(), fmt, ##args)
 
@@ -0,0 +1,137 @@
+#include "metrics.hpp"
+
+#include <cstdio>
+
+namespace {
+
+void write_json_key(std::ostream &os, const std::string &name) {
+    os << '"';
+    for (auto c : name) {
+        if (c == '"' || c == '\\') {
+            os << '\\';
+        }
+        os << c;
+    }
+    os << "\":";
+}
+
+} // namespace
+
+namespace my {
+
+uint64_t Histogram::percentile(double p) const {
+    auto total = this->count();
+    if (total == 0) {
+        return 0;
+    }
+    auto rank = uint64_t(p / 100.0 * double(total - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += this->_counts[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            // the bucket bound may lie above anything recorded
+            return std::min(upper_bound_of(i), this->max());
+        }
+    }
+    return this->max();
+}
+
+HistogramSummary Histogram::summary() const {
+    HistogramSummary summary;
+    summary.count = this->count();
+    if (summary.count) {
+        summary.mean = double(this->_sum.load(std::memory_order_relaxed)) /
+                       double(summary.count);
+    }
+    summary.p50 = this->percentile(50);
+    summary.p90 = this->percentile(90);
+    summary.p99 = this->percentile(99);
+    summary.max = this->max();
+    return summary;
+}
+
+void MetricsSnapshot::write_json(std::ostream &os) const {
+    os << "{\"time_ms\":"
+       << std::chrono::duration_cast<std::chrono::milliseconds>(
+              this->time.time_since_epoch())
+              .count();
+    os << ",\"counters\":{";
+    const char *separator = "";
+    for (auto &[name, value] : this->counters) {
+        os << separator;
+        write_json_key(os, name);
+        os << value;
+        separator = ",";
+    }
+    os << "},\"gauges\":{";
+    separator = "";
+    for (auto &[name, value] : this->gauges) {
+        os << separator;
+        write_json_key(os, name);
+        os << value;
+        separator = ",";
+    }
+    os << "},\"histograms\":{";
+    separator = "";
+    for (auto &[name, h] : this->histograms) {
+        char mean[32];
+        std::snprintf(mean, sizeof(mean), "%.3f", h.mean);
+        os << separator;
+        write_json_key(os, name);
+        os << "{\"count\":" << h.count << ",\"mean\":" << mean
+           << ",\"p50\":" << h.p50 << ",\"p90\":" << h.p90
+           << ",\"p99\":" << h.p99 << ",\"max\":" << h.max << "}";
+        separator = ",";
+    }
+    os << "}}\n";
+}
+
+Counter &Metrics::counter(const std::string &name) {
+    return this->_find_or_add(this->_counters, name);
+}
+
+Gauge &Metrics::gauge(const std::string &name) {
+    return this->_find_or_add(this->_gauges, name);
+}
+
+Histogram &Metrics::histogram(const std::string &name) {
+    return this->_find_or_add(this->_histograms, name);
+}
+
+MetricsSnapshot Metrics::snapshot() {
+    MetricsSnapshot snapshot;
+    snapshot.time = std::chrono::system_clock::now();
+    std::unique_lock<std::mutex> l_lock(this->_lock);
+    for (auto &[name, counter] : this->_counters) {
+        snapshot.counters.emplace(name, counter->value());
+    }
+    for (auto &[name, gauge] : this->_gauges) {
+        snapshot.gauges.emplace(name, gauge->value());
+    }
+    for (auto &[name, histogram] : this->_histograms) {
+        snapshot.histograms.emplace(name, histogram->summary());
+    }
+    return snapshot;
+}
+
+template <typename T>
+T &Metrics::_find_or_add(std::map<std::string, std::unique_ptr<T>> &metrics,
+                         const std::string &name) {
+    std::unique_lock<std::mutex> l_lock(this->_lock);
+    auto it = metrics.find(name);
+    if (it != metrics.end()) {
+        return *it->second;
+    }
+    auto taken = [&name, &metrics](const auto &other) {
+        return static_cast<const void *>(&other) !=
+                   static_cast<const void *>(&metrics) &&
+               other.count(name);
+    };
+    if (taken(this->_counters) || taken(this->_gauges) ||
+        taken(this->_histograms)) {
+        throw MetricsError("metric of another kind: " + name);
+    }
+    return *metrics.emplace(name, std::make_unique<T>()).first->second;
+}
+
+} // namespace my
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+namespace my {
+
+class MetricsError : public std::runtime_error {
+  public:
+    MetricsError(const std::string &msg)
+        : std::runtime_error(msg), _msg(msg) {}
+
+    const char *what() const noexcept override { return this->_msg.c_str(); }
+
+  private:
+    std::string _msg;
+};
+
+/**
+ * @brief      monotonic count, e.g. cache hits
+ */
+class Counter {
+  public:
+    void add(uint64_t n = 1) {
+        this->_value.fetch_add(n, std::memory_order_relaxed);
+    }
+    uint64_t value() const {
+        return this->_value.load(std::memory_order_relaxed);
+    }
+
+  private:
+    std::atomic<uint64_t> _value{0};
+};
+
+/**
+ * @brief      current level, e.g. a queue depth
+ */
+class Gauge {
+  public:
+    void set(int64_t v) { this->_value.store(v, std::memory_order_relaxed); }
+    void add(int64_t n) {
+        this->_value.fetch_add(n, std::memory_order_relaxed);
+    }
+    int64_t value() const {
+        return this->_value.load(std::memory_order_relaxed);
+    }
+
+  private:
+    std::atomic<int64_t> _value{0};
+};
+
+struct HistogramSummary {
+    uint64_t count{};
+    double mean{};
+    uint64_t p50{};
+    uint64_t p90{};
+    uint64_t p99{};
+    uint64_t max{};
+};
+
+/**
+ * @brief      lock-free log-linear histogram of unsigned values
+ *
+ * Values below kSubBuckets are counted exactly, larger ones in kSubBuckets
+ * linear buckets per power of two, like an HDR histogram with two
+ * significant digits: a percentile is off by at most 1 / kSubBuckets of
+ * its value. The unit is up to the publisher, by convention a suffix of
+ * the name such as _us.
+ */
+class Histogram {
+  public:
+    static constexpr size_t kSubBits = 5;
+    static constexpr size_t kSubBuckets = size_t(1) << kSubBits;
+    static constexpr size_t kBuckets = (64 - kSubBits + 1) * kSubBuckets;
+
+    void record(uint64_t v) {
+        this->_counts[index_of(v)].fetch_add(1, std::memory_order_relaxed);
+        this->_count.fetch_add(1, std::memory_order_relaxed);
+        this->_sum.fetch_add(v, std::memory_order_relaxed);
+        auto max = this->_max.load(std::memory_order_relaxed);
+        while (v > max && !this->_max.compare_exchange_weak(
+                              max, v, std::memory_order_relaxed)) {
+        }
+    }
+
+    uint64_t count() const {
+        return this->_count.load(std::memory_order_relaxed);
+    }
+
+    uint64_t max() const { return this->_max.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief      upper bound of the bucket holding the p-th percentile
+     */
+    uint64_t percentile(double p) const;
+
+    HistogramSummary summary() const;
+
+    static size_t index_of(uint64_t v) {
+        if (v < kSubBuckets) {
+            return size_t(v);
+        }
+        auto msb = size_t(63 - __builtin_clzll(v));
+        auto shift = msb - kSubBits;
+        return (shift + 1) * kSubBuckets +
+               size_t((v >> shift) - kSubBuckets);
+    }
+
+    static uint64_t upper_bound_of(size_t index) {
+        if (index < kSubBuckets) {
+            return index;
+        }
+        auto shift = index / kSubBuckets - 1;
+        auto lower = (uint64_t(kSubBuckets + index % kSubBuckets)) << shift;
+        return lower + ((uint64_t(1) << shift) - 1);
+    }
+
+  private:
+    std::array<std::atomic<uint64_t>, kBuckets> _counts{};
+    std::atomic<uint64_t> _count{0};
+    std::atomic<uint64_t> _sum{0};
+    std::atomic<uint64_t> _max{0};
+};
+
+/**
+ * @brief      records the lifetime of the scope in microseconds
+ */
+class HistogramTimer {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    explicit HistogramTimer(Histogram &histogram)
+        : _histogram(histogram), _begin(clock::now()) {}
+
+    ~HistogramTimer() {
+        this->_histogram.record(uint64_t(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                clock::now() - this->_begin)
+                .count()));
+    }
+
+    HistogramTimer(const HistogramTimer &) = delete;
+    HistogramTimer &operator=(const HistogramTimer &) = delete;
+
+  private:
+    Histogram &_histogram;
+    clock::time_point _begin;
+};
+
+/**
+ * @brief      values of all metrics at one point in time
+ */
+struct MetricsSnapshot {
+    std::chrono::system_clock::time_point time;
+    std::map<std::string, uint64_t> counters;
+    std::map<std::string, int64_t> gauges;
+    std::map<std::string, HistogramSummary> histograms;
+
+    /**
+     * @brief      one JSON object on one line
+     */
+    void write_json(std::ostream &os) const;
+};
+
+/**
+ * @brief      named metrics of the process
+ *
+ * Looking a metric up takes a lock, publishers keep the returned
+ * reference, which stays valid for the registry's lifetime. Updating a
+ * metric is a relaxed atomic operation.
+ */
+class Metrics {
+  public:
+    static Metrics *get() {
+        static Metrics instance;
+        return &instance;
+    }
+
+    /**
+     * @brief      the metric called name, created on first use
+     *
+     * @throw      MetricsError if name is a metric of another kind
+     */
+    Counter &counter(const std::string &name);
+    Gauge &gauge(const std::string &name);
+    Histogram &histogram(const std::string &name);
+
+    MetricsSnapshot snapshot();
+
+  private:
+    std::mutex _lock;
+    std::map<std::string, std::unique_ptr<Counter>> _counters;
+    std::map<std::string, std::unique_ptr<Gauge>> _gauges;
+    std::map<std::string, std::unique_ptr<Histogram>> _histograms;
+
+    template <typename T>
+    T &_find_or_add(std::map<std::string, std::unique_ptr<T>> &metrics,
+                    const std::string &name);
+};
+
+} // namespace my
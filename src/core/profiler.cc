@@ -0,0 +1,173 @@
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+#include <pthread.h>
+
+namespace {
+using namespace my;
+
+// ring of the calling thread, the registry keeps it after the thread exits
+thread_local std::shared_ptr<void> tl_ring;
+
+void write_json_string(std::ostream &os, const char *s) {
+    os << '"';
+    for (; *s; ++s) {
+        auto c = static_cast<unsigned char>(*s);
+        switch (c) {
+        case '"':
+            os << "\\\"";
+            break;
+        case '\\':
+            os << "\\\\";
+            break;
+        case '\n':
+            os << "\\n";
+            break;
+        default:
+            if (c < 0x20) {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                os << buf;
+            } else {
+                os << *s;
+            }
+        }
+    }
+    os << '"';
+}
+
+// microseconds with nanosecond precision, the unit of the trace format
+void write_us(std::ostream &os, uint64_t ns) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%llu.%03llu",
+                  static_cast<unsigned long long>(ns / 1000),
+                  static_cast<unsigned long long>(ns % 1000));
+    os << buf;
+}
+
+} // namespace
+
+namespace my {
+
+void Profiler::start() {
+    std::unique_lock<std::mutex> l_lock(this->_lock);
+    ProfileEvent event;
+    for (auto &thread : this->_threads) {
+        while (thread.ring->events.try_pop(event)) {
+        }
+        thread.events.clear();
+    }
+    this->_dropped = 0;
+    this->_capturing = true;
+}
+
+void Profiler::stop() {
+    this->_capturing = false;
+    this->collect();
+}
+
+void Profiler::record(const ProfileEvent &event) {
+    if (!this->_ring().events.try_push(event)) {
+        this->_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Profiler::collect() {
+    std::unique_lock<std::mutex> l_lock(this->_lock);
+    for (auto it = this->_threads.begin(); it != this->_threads.end();) {
+        ProfileEvent event;
+        while (it->ring->events.try_pop(event)) {
+            it->events.push_back(event);
+        }
+        // only the registry holds the ring of an exited thread
+        if (it->ring.use_count() == 1 && it->events.empty()) {
+            it = this->_threads.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void Profiler::set_thread_name(const std::string &name) {
+    auto &ring = this->_ring();
+    std::unique_lock<std::mutex> l_lock(this->_lock);
+    for (auto &thread : this->_threads) {
+        if (thread.ring.get() == &ring) {
+            thread.name = name;
+        }
+    }
+}
+
+size_t Profiler::size() {
+    std::unique_lock<std::mutex> l_lock(this->_lock);
+    size_t n = 0;
+    for (auto &thread : this->_threads) {
+        n += thread.events.size();
+    }
+    return n;
+}
+
+void Profiler::write_chrome_trace(std::ostream &os) {
+    this->collect();
+    std::unique_lock<std::mutex> l_lock(this->_lock);
+    os << "{\"traceEvents\":[";
+    bool first = true;
+    auto separator = [&os, &first]() {
+        if (!first) {
+            os << ",\n";
+        }
+        first = false;
+    };
+    for (size_t i = 0; i < this->_threads.size(); ++i) {
+        auto &thread = this->_threads[i];
+        auto tid = i + 1;
+        separator();
+        os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+           << tid << ",\"args\":{\"name\":";
+        write_json_string(os, thread.name.c_str());
+        os << "}}";
+        for (auto &event : thread.events) {
+            separator();
+            os << "{\"name\":";
+            write_json_string(os, event.name);
+            os << ",\"cat\":";
+            write_json_string(os, event.category);
+            os << ",\"ph\":\"X\",\"ts\":";
+            write_us(os, event.begin_ns);
+            os << ",\"dur\":";
+            write_us(os, event.end_ns - event.begin_ns);
+            os << ",\"pid\":1,\"tid\":" << tid << "}";
+        }
+    }
+    os << "],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+void Profiler::save_chrome_trace(const std::string &path) {
+    std::ofstream ofs(path);
+    if (!ofs) {
+        throw ProfilerError("can not open trace file: " + path);
+    }
+    this->write_chrome_trace(ofs);
+    if (!ofs) {
+        throw ProfilerError("can not write trace file: " + path);
+    }
+}
+
+Profiler::Ring &Profiler::_ring() {
+    if (tl_ring) {
+        return *static_cast<Ring *>(tl_ring.get());
+    }
+    auto ring = std::make_shared<Ring>();
+    char name[16] = {};
+    pthread_getname_np(pthread_self(), name, sizeof(name));
+
+    std::unique_lock<std::mutex> l_lock(this->_lock);
+    this->_threads.push_back({ring, name, {}});
+    tl_ring = ring;
+    return *ring;
+}
+
+} // namespace my
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <util/queue.hpp>
+
+// 0 compiles the MY_PROFILE_* macros out
+#ifndef MY_PROFILE
+#define MY_PROFILE 1
+#endif
+
+namespace my {
+
+class ProfilerError : public std::runtime_error {
+  public:
+    ProfilerError(const std::string &msg)
+        : std::runtime_error(msg), _msg(msg) {}
+
+    const char *what() const noexcept override { return this->_msg.c_str(); }
+
+  private:
+    std::string _msg;
+};
+
+/**
+ * @brief      one finished zone, names are string literals
+ */
+struct ProfileEvent {
+    const char *name{};
+    const char *category{};
+    // since the profiler started
+    uint64_t begin_ns{};
+    uint64_t end_ns{};
+};
+
+/**
+ * @brief      collects zones of all threads while capturing
+ *
+ * A finished zone goes to a lock-free ring of its thread, collect() moves
+ * the rings' contents into the capture. Zones of a thread whose ring is
+ * full are dropped and counted, so long captures should collect()
+ * periodically, e.g. once per frame. Outside of a capture a zone costs a
+ * relaxed load.
+ */
+class Profiler {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    static Profiler *get() {
+        static Profiler instance;
+        return &instance;
+    }
+
+    /**
+     * @brief      start a new capture, events of an earlier one are dropped
+     */
+    void start();
+
+    /**
+     * @brief      stop capturing and collect what was recorded
+     */
+    void stop();
+
+    bool capturing() const {
+        return this->_capturing.load(std::memory_order_relaxed);
+    }
+
+    uint64_t now_ns() const {
+        return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            clock::now() - this->_epoch)
+                            .count());
+    }
+
+    void record(const ProfileEvent &event);
+
+    /**
+     * @brief      move the events of all rings into the capture
+     */
+    void collect();
+
+    /**
+     * @brief      name of the calling thread in the trace, defaults to its
+     *             pthread name
+     */
+    void set_thread_name(const std::string &name);
+
+    /**
+     * @brief      events of the capture, collected so far
+     */
+    size_t size();
+
+    uint64_t dropped() const {
+        return this->_dropped.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief      write the capture as Chrome trace event JSON
+     */
+    void write_chrome_trace(std::ostream &os);
+
+    void save_chrome_trace(const std::string &path);
+
+  private:
+    static constexpr size_t kRingCapacity = 8192;
+
+    struct Ring {
+        Queue<ProfileEvent, kRingCapacity, QueueKind::kSPSC> events;
+    };
+
+    struct Thread {
+        std::shared_ptr<Ring> ring;
+        std::string name;
+        std::vector<ProfileEvent> events;
+    };
+
+    const clock::time_point _epoch{clock::now()};
+    std::atomic<bool> _capturing{false};
+    std::atomic<uint64_t> _dropped{0};
+
+    std::mutex _lock;
+    std::vector<Thread> _threads;
+
+    Profiler() = default;
+
+    Ring &_ring();
+};
+
+/**
+ * @brief      records the scope it lives in as a zone
+ */
+class ProfileZone {
+  public:
+    explicit ProfileZone(const char *name, const char *category = "app") {
+        auto profiler = Profiler::get();
+        if (profiler->capturing()) {
+            this->_event = {name, category, profiler->now_ns(), 0};
+        }
+    }
+
+    ~ProfileZone() {
+        if (this->_event.name) {
+            auto profiler = Profiler::get();
+            this->_event.end_ns = profiler->now_ns();
+            profiler->record(this->_event);
+        }
+    }
+
+    ProfileZone(const ProfileZone &) = delete;
+    ProfileZone &operator=(const ProfileZone &) = delete;
+
+  private:
+    ProfileEvent _event;
+};
+
+} // namespace my
+
+#if MY_PROFILE
+
+#define MY_PROFILE_CONCAT_(a, b) a##b
+#define MY_PROFILE_CONCAT(a, b) MY_PROFILE_CONCAT_(a, b)
+
+#define MY_PROFILE_ZONE_C(category, name)                                      \
+    my::ProfileZone MY_PROFILE_CONCAT(my_profile_zone_, __LINE__)(name,        \
+                                                                  category)
+
+#define MY_PROFILE_THREAD(name) my::Profiler::get()->set_thread_name(name)
+
+#else
+
+#define MY_PROFILE_ZONE_C(category, name)                                      \
+    do {                                                                       \
+    } while (0)
+
+#define MY_PROFILE_THREAD(name)                                                \
+    do {                                                                       \
+    } while (0)
+
+#endif
+
+#define MY_PROFILE_ZONE(name) MY_PROFILE_ZONE_C("app", name)
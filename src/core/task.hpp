@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace my {
+
+/**
+ * @brief      move-only void() callable with inline storage
+ *
+ * Callables up to kInlineSize bytes, e.g. a lambda holding a promise and a
+ * few pointers, live inside the Task, larger ones are moved to the heap.
+ * Unlike std::function the callable does not need to be copyable.
+ */
+class Task {
+  public:
+    static constexpr size_t kInlineSize = 56;
+
+    Task() = default;
+
+    template <typename Func,
+              typename F = std::decay_t<Func>,
+              typename = std::enable_if_t<!std::is_same_v<F, Task> &&
+                                          std::is_invocable_v<F &>>>
+    Task(Func &&func) {
+        if constexpr (is_inline<F>()) {
+            new (this->_storage) F(std::forward<Func>(func));
+            this->_ops = &inline_ops<F>;
+        } else {
+            *reinterpret_cast<F **>(this->_storage) =
+                new F(std::forward<Func>(func));
+            this->_ops = &heap_ops<F>;
+        }
+    }
+
+    Task(Task &&other) noexcept { this->_take(other); }
+
+    Task &operator=(Task &&other) noexcept {
+        if (this != &other) {
+            this->reset();
+            this->_take(other);
+        }
+        return *this;
+    }
+
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+
+    ~Task() { this->reset(); }
+
+    void operator()() { this->_ops->call(this->_storage); }
+
+    void reset() {
+        if (this->_ops) {
+            this->_ops->destroy(this->_storage);
+            this->_ops = nullptr;
+        }
+    }
+
+    explicit operator bool() const noexcept { return this->_ops != nullptr; }
+
+    /**
+     * @brief      whether a callable of type F is stored without allocating
+     */
+    template <typename F> static constexpr bool is_inline() {
+        return sizeof(F) <= kInlineSize &&
+               alignof(F) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible_v<F>;
+    }
+
+  private:
+    struct Ops {
+        void (*call)(void *);
+        // move constructs into dst and destroys src
+        void (*relocate)(void *dst, void *src);
+        void (*destroy)(void *);
+    };
+
+    template <typename F>
+    static constexpr Ops inline_ops{
+        [](void *p) { (*static_cast<F *>(p))(); },
+        [](void *dst, void *src) {
+            new (dst) F(std::move(*static_cast<F *>(src)));
+            static_cast<F *>(src)->~F();
+        },
+        [](void *p) { static_cast<F *>(p)->~F(); }};
+
+    template <typename F>
+    static constexpr Ops heap_ops{
+        [](void *p) { (**static_cast<F **>(p))(); },
+        [](void *dst, void *src) {
+            *static_cast<F **>(dst) = *static_cast<F **>(src);
+        },
+        [](void *p) { delete *static_cast<F **>(p); }};
+
+    alignas(std::max_align_t) unsigned char _storage[kInlineSize];
+    const Ops *_ops{nullptr};
+
+    void _take(Task &other) noexcept {
+        if (other._ops) {
+            other._ops->relocate(this->_storage, other._storage);
+            this->_ops = other._ops;
+            other._ops = nullptr;
+        }
+    }
+};
+
+} // namespace my
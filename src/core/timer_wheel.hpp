@@ -0,0 +1,266 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace my {
+
+/**
+ * @brief      hierarchical timing wheel
+ *
+ * kLevels wheels of kSlots slots, each slot of a level spans a whole turn
+ * of the level below. Adding and cancelling a timer is O(1), advancing
+ * fires the slot of each passed tick and moves the timers of a higher
+ * slot one level down when the lower wheel wraps. Deadlines are rounded
+ * up to the resolution, so a timer never fires early. Not thread-safe.
+ */
+template <typename T> class TimerWheel {
+  public:
+    using clock = std::chrono::steady_clock;
+    using timer_id = uint64_t;
+
+    static constexpr size_t kSlotBits = 6;
+    static constexpr size_t kSlots = size_t(1) << kSlotBits;
+    static constexpr size_t kLevels = 4;
+
+    explicit TimerWheel(
+        clock::duration resolution = std::chrono::milliseconds(1),
+        clock::time_point start = clock::now())
+        : _resolution(resolution), _start(start) {
+        for (auto &level : this->_slots) {
+            level.fill(kNil);
+        }
+    }
+
+    timer_id add(clock::time_point deadline, T value) {
+        auto index = this->_alloc();
+        auto &node = this->_nodes[index];
+        node.value = std::move(value);
+        // at least one tick ahead, a timer added while advancing fires on
+        // a later advance()
+        node.expires = std::max(this->_tick_of(deadline), this->_now + 1);
+        this->_insert(index);
+        ++this->_size;
+        return (timer_id(node.generation) << 32) | index;
+    }
+
+    /**
+     * @brief      remove a pending timer
+     *
+     * @return     false if it already fired or was cancelled
+     */
+    bool cancel(timer_id id) {
+        auto index = uint32_t(id);
+        if (index >= this->_nodes.size()) {
+            return false;
+        }
+        auto &node = this->_nodes[index];
+        if (node.generation != uint32_t(id >> 32) || node.slot == kNil) {
+            return false;
+        }
+        this->_unlink(index);
+        node.value = T();
+        this->_free(index);
+        --this->_size;
+        return true;
+    }
+
+    /**
+     * @brief      fire every timer due at now, calls expired(T &&)
+     *
+     * @return     number of fired timers
+     */
+    template <typename Func>
+    size_t advance(clock::time_point now, Func &&expired) {
+        auto target = this->_floor_tick(now);
+        size_t fired = 0;
+        while (this->_now < target) {
+            if (this->_size == 0) {
+                this->_now = target;
+                break;
+            }
+            ++this->_now;
+            this->_cascade();
+
+            auto &head = this->_slots[0][this->_now & kMask];
+            this->_occupied[0] &= ~(uint64_t(1) << (this->_now & kMask));
+            auto index = std::exchange(head, kNil);
+            while (index != kNil) {
+                auto &node = this->_nodes[index];
+                auto next = node.next;
+                node.slot = kNil;
+                auto value = std::move(node.value);
+                node.value = T();
+                this->_free(index);
+                --this->_size;
+                ++fired;
+                expired(std::move(value));
+                index = next;
+            }
+        }
+        return fired;
+    }
+
+    /**
+     * @brief      time by which advance() has to be called next
+     *
+     * Exact for timers within one turn of the lowest wheel, otherwise the
+     * time their slot moves down, which is never later than they are due.
+     */
+    std::optional<clock::time_point> next_deadline() const {
+        if (this->_size == 0) {
+            return std::nullopt;
+        }
+        auto next = ~uint64_t(0);
+        for (size_t level = 0; level < kLevels; ++level) {
+            auto shift = level * kSlotBits;
+            auto pos = (this->_now >> shift) & kMask;
+            auto bits = this->_occupied[level];
+            if (!bits) {
+                continue;
+            }
+            // distance from the slot after the current one
+            auto rotated = rotr(bits, (pos + 1) & kMask);
+            auto distance = uint64_t(__builtin_ctzll(rotated)) + 1;
+            next = std::min(next, ((this->_now >> shift) + distance) << shift);
+        }
+        return this->_start + this->_resolution * next;
+    }
+
+    size_t size() const { return this->_size; }
+    bool empty() const { return this->_size == 0; }
+
+    clock::duration resolution() const { return this->_resolution; }
+
+  private:
+    static constexpr uint32_t kNil = ~uint32_t(0);
+    static constexpr uint64_t kMask = kSlots - 1;
+
+    struct Node {
+        T value{};
+        uint64_t expires{};
+        uint32_t prev{kNil};
+        uint32_t next{kNil};
+        // level * kSlots + slot, kNil while not in the wheel
+        uint32_t slot{kNil};
+        uint32_t generation{};
+    };
+
+    clock::duration _resolution;
+    clock::time_point _start;
+    uint64_t _now{0};
+    size_t _size{0};
+
+    std::array<std::array<uint32_t, kSlots>, kLevels> _slots;
+    std::array<uint64_t, kLevels> _occupied{};
+    std::vector<Node> _nodes;
+    uint32_t _free_head{kNil};
+
+    static uint64_t rotr(uint64_t v, uint64_t n) {
+        return n ? (v >> n) | (v << (64 - n)) : v;
+    }
+
+    uint64_t _floor_tick(clock::time_point t) const {
+        return t <= this->_start ? 0 : (t - this->_start) / this->_resolution;
+    }
+
+    uint64_t _tick_of(clock::time_point t) const {
+        if (t <= this->_start) {
+            return 0;
+        }
+        auto d = t - this->_start;
+        return (d + this->_resolution - clock::duration(1)) /
+               this->_resolution;
+    }
+
+    uint32_t _alloc() {
+        if (this->_free_head == kNil) {
+            this->_nodes.emplace_back();
+            return uint32_t(this->_nodes.size() - 1);
+        }
+        auto index = this->_free_head;
+        this->_free_head = this->_nodes[index].next;
+        return index;
+    }
+
+    void _free(uint32_t index) {
+        auto &node = this->_nodes[index];
+        ++node.generation;
+        node.slot = kNil;
+        node.prev = kNil;
+        node.next = this->_free_head;
+        this->_free_head = index;
+    }
+
+    void _insert(uint32_t index) {
+        auto &node = this->_nodes[index];
+        auto diff = node.expires > this->_now ? node.expires - this->_now : 0;
+        size_t level = 0;
+        while (level + 1 < kLevels &&
+               diff >= (uint64_t(1) << ((level + 1) * kSlotBits))) {
+            ++level;
+        }
+        auto shift = level * kSlotBits;
+        uint64_t slot;
+        if (diff >= (uint64_t(1) << (kLevels * kSlotBits))) {
+            // beyond the top wheel, park in its last slot and re-insert
+            // from there
+            slot = ((this->_now >> shift) + kMask) & kMask;
+        } else {
+            slot = (node.expires >> shift) & kMask;
+        }
+
+        auto &head = this->_slots[level][slot];
+        node.slot = uint32_t(level * kSlots + slot);
+        node.prev = kNil;
+        node.next = head;
+        if (head != kNil) {
+            this->_nodes[head].prev = index;
+        }
+        head = index;
+        this->_occupied[level] |= uint64_t(1) << slot;
+    }
+
+    void _unlink(uint32_t index) {
+        auto &node = this->_nodes[index];
+        auto level = node.slot / kSlots;
+        auto slot = node.slot % kSlots;
+        if (node.prev != kNil) {
+            this->_nodes[node.prev].next = node.next;
+        } else {
+            this->_slots[level][slot] = node.next;
+        }
+        if (node.next != kNil) {
+            this->_nodes[node.next].prev = node.prev;
+        }
+        if (this->_slots[level][slot] == kNil) {
+            this->_occupied[level] &= ~(uint64_t(1) << slot);
+        }
+        node.slot = kNil;
+    }
+
+    // move the slots that reach their turn one level down
+    void _cascade() {
+        for (size_t level = 1; level < kLevels; ++level) {
+            auto shift = level * kSlotBits;
+            if (this->_now & ((uint64_t(1) << shift) - 1)) {
+                break;
+            }
+            auto slot = (this->_now >> shift) & kMask;
+            this->_occupied[level] &= ~(uint64_t(1) << slot);
+            auto index = std::exchange(this->_slots[level][slot], kNil);
+            while (index != kNil) {
+                auto next = this->_nodes[index].next;
+                this->_insert(index);
+                index = next;
+            }
+        }
+    }
+};
+
+} // namespace my
@@ -0,0 +1,354 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace my {
+
+namespace detail {
+
+template <typename T> class TypedEventPool;
+
+template <typename T> struct TypedEventNode {
+    std::atomic<uint32_t> refs{0};
+    std::chrono::steady_clock::time_point timestamp;
+    TypedEventNode *next{};
+    // the pool of the thread which allocated the node
+    typename TypedEventPool<T>::Pool *pool{};
+    alignas(T) unsigned char storage[sizeof(T)];
+
+    T *data() { return std::launder(reinterpret_cast<T *>(this->storage)); }
+};
+
+/**
+ * @brief      thread local pools of event nodes per payload type
+ *
+ * A node always returns to the pool of the thread which allocated it, so
+ * events created on one thread and released on another (SDL thread to main
+ * loop) are recycled instead of allocated anew. Other threads push onto the
+ * pool's lock-free remote stack, the owning thread takes the whole stack in
+ * acquire() once its own list is empty. Every list keeps at most kMaxFree
+ * nodes. A pool outlives its thread until its last node is released.
+ */
+template <typename T> class TypedEventPool {
+  public:
+    using node_type = TypedEventNode<T>;
+    static constexpr size_t kMaxFree = 256;
+
+    struct Pool {
+        node_type *head{};
+        size_t size{};
+        std::atomic<node_type *> remote{nullptr};
+        // live nodes plus one for the owning thread
+        std::atomic<size_t> refs{1};
+    };
+
+    template <typename... Args> static node_type *acquire(Args &&...args) {
+        auto &pool = local_pool();
+        if (!pool.head) {
+            drain(pool);
+        }
+        node_type *node = pool.head;
+        if (node) {
+            pool.head = node->next;
+            --pool.size;
+        } else {
+            node = new node_type;
+            node->pool = &pool;
+            pool.refs.fetch_add(1, std::memory_order_relaxed);
+            _allocated.fetch_add(1, std::memory_order_relaxed);
+        }
+        try {
+            if constexpr (std::is_constructible_v<T, Args...>) {
+                new (node->storage) T(std::forward<Args>(args)...);
+            } else {
+                // aggregates
+                new (node->storage) T{std::forward<Args>(args)...};
+            }
+        } catch (...) {
+            recycle(node);
+            throw;
+        }
+        node->refs.store(1, std::memory_order_relaxed);
+        node->timestamp = std::chrono::steady_clock::now();
+        return node;
+    }
+
+    static void release(node_type *node) {
+        if (node->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+        node->data()->~T();
+        recycle(node);
+    }
+
+    /**
+     * @brief      nodes allocated so far by all threads
+     */
+    static size_t allocated() {
+        return _allocated.load(std::memory_order_relaxed);
+    }
+
+  private:
+    static inline std::atomic<size_t> _allocated{0};
+
+    // the remote stack of a pool whose thread exited
+    static node_type *closed() {
+        static node_type sentinel;
+        return &sentinel;
+    }
+
+    struct Owner {
+        Pool *pool{new Pool};
+
+        ~Owner() {
+            auto pool = this->pool;
+            free_nodes(pool->head);
+            pool->head = nullptr;
+            // later remote releases free their node themselves
+            free_nodes(
+                pool->remote.exchange(closed(), std::memory_order_acquire));
+            unref(pool);
+        }
+    };
+
+    static Pool &local_pool() {
+        thread_local Owner owner;
+        return *owner.pool;
+    }
+
+    static void unref(Pool *pool) {
+        if (pool->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete pool;
+        }
+    }
+
+    static void free_node(node_type *node) {
+        auto pool = node->pool;
+        delete node;
+        unref(pool);
+    }
+
+    static void free_nodes(node_type *node) {
+        while (node) {
+            auto next = node->next;
+            free_node(node);
+            node = next;
+        }
+    }
+
+    static void drain(Pool &pool) {
+        auto node = pool.remote.exchange(nullptr, std::memory_order_acquire);
+        while (node) {
+            auto next = node->next;
+            if (pool.size < kMaxFree) {
+                node->next = pool.head;
+                pool.head = node;
+                ++pool.size;
+            } else {
+                free_node(node);
+            }
+            node = next;
+        }
+    }
+
+    static void recycle(node_type *node) {
+        auto &pool = local_pool();
+        if (node->pool == &pool) {
+            if (pool.size >= kMaxFree) {
+                free_node(node);
+                return;
+            }
+            node->next = pool.head;
+            pool.head = node;
+            ++pool.size;
+            return;
+        }
+
+        auto &remote = node->pool->remote;
+        auto head = remote.load(std::memory_order_relaxed);
+        do {
+            if (head == closed()) {
+                free_node(node);
+                return;
+            }
+            node->next = head;
+        } while (!remote.compare_exchange_weak(head, node,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed));
+    }
+};
+
+} // namespace detail
+
+/**
+ * @brief      reference counted handle of a pooled event
+ *
+ * The payload is constructed in place inside a pooled node, so creating an
+ * event allocates nothing once the pool of the posting thread is warm,
+ * wherever the event is released.
+ * Handlers may keep a copy of the handle past their call.
+ */
+template <typename T> class TypedEvent {
+  public:
+    using data_type = T;
+    using time_point = std::chrono::steady_clock::time_point;
+
+    TypedEvent() = default;
+
+    TypedEvent(const TypedEvent &other) : _node(other._node) {
+        if (this->_node) {
+            this->_node->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    TypedEvent(TypedEvent &&other) noexcept : _node(other._node) {
+        other._node = nullptr;
+    }
+
+    TypedEvent &operator=(TypedEvent other) noexcept {
+        std::swap(this->_node, other._node);
+        return *this;
+    }
+
+    ~TypedEvent() { this->reset(); }
+
+    template <typename... Args> static TypedEvent make(Args &&...args) {
+        return TypedEvent(pool_type::acquire(std::forward<Args>(args)...));
+    }
+
+    void reset() {
+        if (this->_node) {
+            pool_type::release(this->_node);
+            this->_node = nullptr;
+        }
+    }
+
+    const data_type &data() const { return *this->_node->data(); }
+    const data_type *operator->() const noexcept { return this->_node->data(); }
+    const data_type &operator*() const noexcept { return this->data(); }
+
+    time_point timestamp() const { return this->_node->timestamp; }
+
+    explicit operator bool() const noexcept { return this->_node != nullptr; }
+
+  private:
+    using pool_type = detail::TypedEventPool<T>;
+    typename pool_type::node_type *_node{};
+
+    explicit TypedEvent(typename pool_type::node_type *node) : _node(node) {}
+};
+
+/**
+ * @brief      synchronous event dispatch indexed by payload type
+ *
+ * Unlike the rx chain of Subject, where every on_event<T>() subscriber
+ * filters every event, a post only looks up the subscribers of its own
+ * type and calls them directly on the posting thread. Nothing is allocated
+ * when nobody subscribed to the type. Subscribing copies the handler list
+ * of the type, so posting never waits for (un)subscription and a handler
+ * may still see one in-flight event after unsubscribe() returned.
+ */
+class TypedDispatcher {
+  public:
+    using handler_id = uint64_t;
+
+    template <typename T, typename Func> handler_id subscribe(Func &&func) {
+        auto id = ++this->_next_id;
+        Handler handler{id, [func = std::forward<Func>(func)](const void *e) {
+                            func(*static_cast<const TypedEvent<T> *>(e));
+                        }};
+
+        std::unique_lock<std::shared_mutex> l_lock(this->_lock);
+        auto &handlers = this->_slots[typeid(T)];
+        auto list = handlers ? std::make_shared<handler_list>(*handlers)
+                             : std::make_shared<handler_list>();
+        list->push_back(std::move(handler));
+        handlers = std::move(list);
+        this->_owners.emplace(id, typeid(T));
+        return id;
+    }
+
+    void unsubscribe(handler_id id) {
+        std::unique_lock<std::shared_mutex> l_lock(this->_lock);
+        auto owner = this->_owners.find(id);
+        if (owner == this->_owners.end()) {
+            return;
+        }
+        auto &handlers = this->_slots[owner->second];
+        auto list = std::make_shared<handler_list>(*handlers);
+        list->erase(std::remove_if(
+                        list->begin(), list->end(),
+                        [id](const Handler &h) { return h.id == id; }),
+                    list->end());
+        handlers = std::move(list);
+        this->_owners.erase(owner);
+    }
+
+    /**
+     * @brief      construct a T from args and deliver it
+     *
+     * @return     number of handlers called
+     */
+    template <typename T, typename... Args> size_t post(Args &&...args) {
+        auto handlers = this->_handlers(typeid(T));
+        if (!handlers || handlers->empty()) {
+            return 0;
+        }
+        return deliver(*handlers,
+                       TypedEvent<T>::make(std::forward<Args>(args)...));
+    }
+
+    /**
+     * @brief      deliver an existing event, e.g. one kept by a handler
+     */
+    template <typename T> size_t post_event(const TypedEvent<T> &e) {
+        auto handlers = this->_handlers(typeid(T));
+        return handlers ? deliver(*handlers, e) : 0;
+    }
+
+    template <typename T> size_t subscriber_count() const {
+        auto handlers = this->_handlers(typeid(T));
+        return handlers ? handlers->size() : 0;
+    }
+
+  private:
+    struct Handler {
+        handler_id id;
+        std::function<void(const void *)> call;
+    };
+    using handler_list = std::vector<Handler>;
+
+    mutable std::shared_mutex _lock;
+    std::unordered_map<std::type_index, std::shared_ptr<const handler_list>>
+        _slots;
+    std::unordered_map<handler_id, std::type_index> _owners;
+    std::atomic<handler_id> _next_id{0};
+
+    std::shared_ptr<const handler_list>
+    _handlers(const std::type_index &type) const {
+        std::shared_lock<std::shared_mutex> l_lock(this->_lock);
+        auto it = this->_slots.find(type);
+        return it == this->_slots.end() ? nullptr : it->second;
+    }
+
+    template <typename T>
+    static size_t deliver(const handler_list &handlers, const TypedEvent<T> &e) {
+        for (const auto &handler : handlers) {
+            handler.call(&e);
+        }
+        return handlers.size();
+    }
+};
+
+} // namespace my
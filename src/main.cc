@@ -1,3 +1,5 @@
+#include <fstream>
+
 #include <application.hpp>
 #include <render/render.hpp>
 
@@ -6,11 +8,29 @@ using namespace my;
 int main(int argc, char **argv) {
   // try {
   GLOG_D("application run");
-  auto app = Application::create(argc, argv);
+  po::options_description opts("render options");
+  opts.add_options()("render", po::value<std::string>()->default_value("gl"),
+                     "render backend: gl or raster")(
+      "render-threads", po::value<size_t>()->default_value(1),
+      "raster backend: bands drawn in parallel")(
+      "input-script", po::value<std::string>(),
+      "with --headless: input to play, see InputScript");
+  auto app = Application::create(argc, argv, opts);
 
   auto win =
       app->service<WindowService>()->create_window("my gui", {512, 512}).get();
 
+  po::variable_value value;
+  auto headless =
+      dynamic_cast<HeadlessWindowService *>(app->service<WindowService>());
+  if (headless && app->program_option("input-script", value)) {
+    std::ifstream is(value.as<std::string>());
+    if (!is) {
+      throw ApplicationError("can not open " + value.as<std::string>());
+    }
+    headless->play(InputScript::parse(is));
+  }
+
   // auto tree = NodeViewTree::make();
   // {
   //   auto root = NodeView::make(IRect::MakeSize({400, 400}));
@@ -37,7 +57,17 @@ int main(int argc, char **argv) {
   //   }
   // }
 
-  // auto render = RenderService::make(win);
+  RenderOptions render_options;
+  if (app->program_option("render", value)) {
+    render_options.backend =
+        RenderOptions::backend_from(value.as<std::string>());
+  }
+  if (app->program_option("render-threads", value)) {
+    render_options.raster_threads = value.as<size_t>();
+  }
+  render_options.refresh_rate =
+      app->service<WindowService>()->display_mode().get().refresh_rate;
+  auto render = RenderService::make(win, render_options);
 
   // render->run_at([tree](RenderService *render) {
   //   tree->connect(render);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <SDL2/SDL.h>
+#include <core/metrics.hpp>
 #include <my_render.hpp>
 #include <render/window/window_mgr.h>
 #include <storage/image.hpp>
@@ -312,7 +313,8 @@ class AVPlayer {
     std::shared_ptr<VideoDecCtx> _video_dec_ctx{};
     std::shared_ptr<AudioDecCtx> _audio_dec_ctx{};
 
-    typedef Queue<std::shared_ptr<Frame>, 15> Queue_t;
+    // filled by the read frame thread, drained by one timer chain each
+    typedef Queue<std::shared_ptr<Frame>, 15, QueueKind::kSPSC> Queue_t;
     std::shared_ptr<Queue_t> _video_queue{};
     std::shared_ptr<Queue_t> _audio_queue{};
 
@@ -329,6 +331,12 @@ class AVPlayer {
 
     std::function<void (std::shared_ptr<SkBitmap>)> _render_cb;
 
+    Gauge &_video_queue_depth{Metrics::get()->gauge("media.video_queue")};
+    Gauge &_audio_queue_depth{Metrics::get()->gauge("media.audio_queue")};
+    Counter &_late_video_frames{
+        Metrics::get()->counter("media.late_video_frames")};
+    Histogram &_decode_us{Metrics::get()->histogram("media.decode_us")};
+
     void _handle_audio_frame(std::shared_ptr<boost::asio::steady_timer> timer) {
         cpu_timer cpu_timer;
         auto frame =
@@ -360,6 +368,7 @@ class AVPlayer {
         auto wait_timer = next_pts - pts - elapsed.count();
         GLOG_D("handle audio frame pts %d, next_pts %d, wait_timer %d", pts,
                next_pts, wait_timer);
+        this->_audio_queue_depth.set(int64_t(this->_audio_queue->size()));
         if (wait_timer < 0) {
             wait_timer = 0;
         }
@@ -402,7 +411,9 @@ class AVPlayer {
         GLOG_D("handle video frame: pts %d, next_pts %d, elapsed %d, "
                "wait_timer %d",
                pts, next_pts, elapsed.count(), wait_timer);
+        this->_video_queue_depth.set(int64_t(this->_video_queue->size()));
         if (wait_timer < 0) {
+            this->_late_video_frames.add();
             wait_timer = 0;
         }
         timer->expires_after(std::chrono::milliseconds(wait_timer));
@@ -436,7 +447,11 @@ class AVPlayer {
                 frame = std::make_shared<AudioFrame>();
             }
 
-            if ((ret = dec_ctx->decode(pkt, frame)) < 0) {
+            {
+                HistogramTimer l_decode_time(this->_decode_us);
+                ret = dec_ctx->decode(pkt, frame);
+            }
+            if (ret < 0) {
                 if (ret == AVERROR(EAGAIN)) {
                     GLOG_D("EAGAIN");
                     continue;
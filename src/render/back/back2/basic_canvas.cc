@@ -0,0 +1,366 @@
+#include "basic_canvas.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+namespace my {
+
+namespace {
+/**
+ * @brief      small index per live thread, reused once the thread exited
+ */
+class ThreadIndex {
+  public:
+    static uint32_t get() {
+        thread_local ThreadIndex index;
+        return index._value;
+    }
+
+  private:
+    uint32_t _value;
+
+    ThreadIndex() {
+        std::lock_guard<std::mutex> l_lock(lock());
+        auto &free = free_list();
+        if (free.empty()) {
+            this->_value = next()++;
+        } else {
+            this->_value = free.back();
+            free.pop_back();
+        }
+    }
+
+    ~ThreadIndex() {
+        std::lock_guard<std::mutex> l_lock(lock());
+        free_list().push_back(this->_value);
+    }
+
+    static std::mutex &lock() {
+        static std::mutex lock;
+        return lock;
+    }
+    static std::vector<uint32_t> &free_list() {
+        static std::vector<uint32_t> free;
+        return free;
+    }
+    static uint32_t &next() {
+        static uint32_t next{0};
+        return next;
+    }
+};
+
+int64_t area(const IRect &rect) {
+    return rect.isEmpty() ? 0 : int64_t(rect.width()) * rect.height();
+}
+
+// a and b share a whole edge, so their union is a rectangle
+bool adjacent(const IRect &a, const IRect &b) {
+    if (a.top() == b.top() && a.bottom() == b.bottom()) {
+        return a.right() == b.left() || b.right() == a.left();
+    }
+    if (a.left() == b.left() && a.right() == b.right()) {
+        return a.bottom() == b.top() || b.bottom() == a.top();
+    }
+    return false;
+}
+} // namespace
+
+BasicCanvas::BasicCanvas() {}
+
+BasicCanvas::~BasicCanvas() {
+    auto node = this->_recorders.load(std::memory_order_acquire);
+    while (node) {
+        auto next = node->next;
+        delete node;
+        node = next;
+    }
+}
+
+DrawList *BasicCanvas::make_recorder(int order) {
+    return this->_push_recorder(order)->list.get();
+}
+
+BasicCanvas::Recorder *BasicCanvas::_push_recorder(int order) {
+    auto node = new Recorder{std::make_unique<DrawList>(order),
+                             this->_recorder_seq.fetch_add(1), nullptr,
+                             nullptr};
+    node->list->default_font(this->_default_font);
+
+    node->next = this->_recorders.load(std::memory_order_relaxed);
+    while (!this->_recorders.compare_exchange_weak(
+        node->next, node, std::memory_order_release,
+        std::memory_order_relaxed)) {
+    }
+    return node;
+}
+
+DrawList &BasicCanvas::recorder(int order) {
+    // a thread index is held by one thread at a time, so its slot needs no
+    // lock; a later thread with the same index continues its lists, which
+    // the exited thread no longer uses
+    auto index = ThreadIndex::get();
+    if (index < kThreadSlots) {
+        auto &head = this->_thread_recorders[index];
+        for (auto node = head; node; node = node->thread_next) {
+            if (node->list->order() == order) {
+                return *node->list;
+            }
+        }
+        auto node = this->_push_recorder(order);
+        node->thread_next = head;
+        head = node;
+        return *node->list;
+    }
+
+    std::lock_guard<std::mutex> l_lock(this->_overflow_lock);
+    auto &list =
+        this->_overflow_recorders[{std::this_thread::get_id(), order}];
+    if (!list) {
+        list = this->make_recorder(order);
+    }
+    return *list;
+}
+
+future<std::shared_ptr<RGBAImage>>
+BasicCanvas::get_image_data(const IPoint2D &offset, const ISize2D &size) {
+    Readback readback{IRect::MakeXYWH(offset.x(), offset.y(), size.width(),
+                                      size.height()),
+                      {}};
+    auto result = readback.result.get_future();
+    std::lock_guard<std::mutex> l_lock(this->_pending_lock);
+    this->_readbacks.push_back(std::move(readback));
+    return result;
+}
+
+void BasicCanvas::put_image_data(std::shared_ptr<RGBAImage> data,
+                                 const IPoint2D &offset) {
+    if (!data || data->width() == 0 || data->height() == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> l_lock(this->_pending_lock);
+    this->_uploads.push_back({std::move(data), offset});
+}
+
+void BasicCanvas::clear() {
+    std::unique_lock<std::shared_mutex> l_lock(this->_lock);
+    this->_draw_data.clear();
+    for (auto node = this->_recorders.load(std::memory_order_acquire); node;
+         node = node->next) {
+        node->list->clear();
+    }
+}
+
+void BasicCanvas::_merge_recorders() {
+    auto now = std::chrono::steady_clock::now();
+    if (this->_last_merge != std::chrono::steady_clock::time_point{}) {
+        this->_frame_interval_us.record(uint64_t(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                now - this->_last_merge)
+                .count()));
+    }
+    this->_last_merge = now;
+
+    this->_draw_data.clear();
+    this->_merge_nodes.clear();
+    for (auto node = this->_recorders.load(std::memory_order_acquire); node;
+         node = node->next) {
+        if (!node->list->empty()) {
+            this->_merge_nodes.push_back(node);
+        }
+    }
+    if (this->_merge_nodes.empty()) {
+        this->_draw_cmds.set(0);
+        this->_draw_vertices.set(0);
+        return;
+    }
+
+    // nodes are pushed front, the creation sequence keeps the order stable
+    std::sort(this->_merge_nodes.begin(), this->_merge_nodes.end(),
+              [](const Recorder *a, const Recorder *b) {
+                  if (a->list->order() != b->list->order()) {
+                      return a->list->order() < b->list->order();
+                  }
+                  return a->seq < b->seq;
+              });
+
+    this->_merge_order.clear();
+    for (auto node : this->_merge_nodes) {
+        this->_merge_order.push_back(node->list.get());
+    }
+    this->_draw_data.merge(this->_merge_order);
+    for (auto list : this->_merge_order) {
+        list->clear();
+    }
+    this->_draw_cmds.set(int64_t(this->_draw_data.cmd_list.size()));
+    this->_draw_vertices.set(int64_t(this->_draw_data.vtx_list.size()));
+}
+
+RGBAImage::view_t BasicCanvas::_staging_view(const ISize2D &size) {
+    size_t bytes = size_t(size.width()) * size.height() * 4;
+    if (this->_staging.size() < bytes) {
+        this->_staging.resize(bytes);
+    }
+    return boost::gil::interleaved_view(
+        size.width(), size.height(),
+        reinterpret_cast<boost::gil::rgba8_pixel_t *>(this->_staging.data()),
+        size_t(size.width()) * 4);
+}
+
+void BasicCanvas::_flush_uploads() {
+    {
+        std::lock_guard<std::mutex> l_lock(this->_pending_lock);
+        std::swap(this->_uploads, this->_flushing_uploads);
+    }
+    auto &uploads = this->_flushing_uploads;
+    auto &groups = this->_upload_groups;
+    this->_image_data_stats.uploads = uploads.size();
+    this->_image_data_stats.upload_writes = 0;
+    if (uploads.empty()) {
+        return;
+    }
+
+    auto target = IRect::MakeSize(this->_target_size());
+    groups.clear();
+    for (const auto &upload : uploads) {
+        auto rect = IRect::MakeXYWH(upload.offset.x(), upload.offset.y(),
+                                    upload.data->width(),
+                                    upload.data->height());
+        if (rect.intersect(target)) {
+            groups.push_back({rect, {{&upload, rect}}});
+        }
+    }
+
+    // an upload completely covered by a later one is never visible
+    for (size_t i = 0; i < groups.size(); ++i) {
+        for (size_t j = i + 1; j < groups.size(); ++j) {
+            if (groups[j].rect.contains(groups[i].rect)) {
+                groups[i].rect.setEmpty();
+                break;
+            }
+        }
+    }
+    groups.erase(std::remove_if(groups.begin(), groups.end(),
+                                [](const UploadGroup &group) {
+                                    return group.rect.isEmpty();
+                                }),
+                 groups.end());
+
+    // the write order only matters between overlapping uploads, so only
+    // a disjoint batch is coalesced
+    bool disjoint = true;
+    for (size_t i = 0; i < groups.size() && disjoint; ++i) {
+        for (size_t j = i + 1; j < groups.size() && disjoint; ++j) {
+            disjoint = !IRect::Intersects(groups[i].rect, groups[j].rect);
+        }
+    }
+    for (bool merged = disjoint; merged;) {
+        merged = false;
+        for (size_t i = 0; i < groups.size(); ++i) {
+            for (size_t j = i + 1; j < groups.size(); ++j) {
+                if (!adjacent(groups[i].rect, groups[j].rect)) {
+                    continue;
+                }
+                groups[i].rect.join(groups[j].rect);
+                groups[i].members.insert(groups[i].members.end(),
+                                         groups[j].members.begin(),
+                                         groups[j].members.end());
+                groups.erase(groups.begin() + j);
+                merged = true;
+                --j;
+            }
+        }
+    }
+
+    for (const auto &group : groups) {
+        auto source = [](const Upload *upload, const IRect &rect) {
+            return boost::gil::subimage_view(
+                boost::gil::const_view(*upload->data),
+                rect.x() - upload->offset.x(), rect.y() - upload->offset.y(),
+                rect.width(), rect.height());
+        };
+        if (group.members.size() == 1) {
+            const auto &[upload, rect] = group.members.front();
+            this->_write_pixels(source(upload, rect), rect.topLeft());
+        } else {
+            auto staging = this->_staging_view(
+                ISize2D::Make(group.rect.width(), group.rect.height()));
+            for (const auto &[upload, rect] : group.members) {
+                boost::gil::copy_pixels(
+                    source(upload, rect),
+                    boost::gil::subimage_view(
+                        staging, rect.x() - group.rect.x(),
+                        rect.y() - group.rect.y(), rect.width(),
+                        rect.height()));
+            }
+            this->_write_pixels(staging, group.rect.topLeft());
+        }
+        ++this->_image_data_stats.upload_writes;
+    }
+    groups.clear();
+    uploads.clear();
+}
+
+void BasicCanvas::_flush_readbacks() {
+    {
+        std::lock_guard<std::mutex> l_lock(this->_pending_lock);
+        std::swap(this->_readbacks, this->_flushing_readbacks);
+    }
+    auto &readbacks = this->_flushing_readbacks;
+    this->_image_data_stats.readbacks = readbacks.size();
+    this->_image_data_stats.readback_reads = 0;
+    if (readbacks.empty()) {
+        return;
+    }
+
+    auto target = IRect::MakeSize(this->_target_size());
+    auto bounds = IRect::MakeEmpty();
+    int64_t total = 0;
+    for (auto &readback : readbacks) {
+        if (!readback.rect.intersect(target)) {
+            readback.rect.setEmpty();
+        }
+        bounds.join(readback.rect);
+        total += area(readback.rect);
+    }
+
+    try {
+        // one read of the bounds unless it fetches much more than the
+        // separate reads would
+        bool batched = readbacks.size() > 1 && !bounds.isEmpty() &&
+                       area(bounds) <= 2 * total;
+        RGBAImage::view_t staging;
+        if (batched) {
+            staging = this->_staging_view(
+                ISize2D::Make(bounds.width(), bounds.height()));
+            this->_read_pixels(bounds, staging);
+            ++this->_image_data_stats.readback_reads;
+        }
+        for (auto &readback : readbacks) {
+            const auto &rect = readback.rect;
+            auto image = std::make_shared<RGBAImage>(rect.width(),
+                                                     rect.height());
+            if (batched && !rect.isEmpty()) {
+                boost::gil::copy_pixels(
+                    boost::gil::subimage_view(staging, rect.x() - bounds.x(),
+                                              rect.y() - bounds.y(),
+                                              rect.width(), rect.height()),
+                    boost::gil::view(*image));
+            } else if (!rect.isEmpty()) {
+                this->_read_pixels(rect, boost::gil::view(*image));
+                ++this->_image_data_stats.readback_reads;
+            }
+            readback.result.set_value(std::move(image));
+        }
+    } catch (...) {
+        for (auto &readback : readbacks) {
+            try {
+                readback.result.set_exception(std::current_exception());
+            } catch (const std::future_error &) {
+                // already resolved before the failing read
+            }
+        }
+    }
+    readbacks.clear();
+}
+
+} // namespace my
@@ -0,0 +1,325 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/gil.hpp>
+#include <glm/glm.hpp>
+#include <core/metrics.hpp>
+#include <my_gui.hpp>
+#include <render/back/back2/draw_list.hpp>
+
+namespace my {
+
+using RGBAImage = boost::gil::rgba8_image_t;
+
+/**
+ * @brief      drawing API shared by every canvas backend
+ *
+ * Draw calls are recorded into DrawLists without locking and merged into
+ * one DrawData at render(), image data requests are queued and served by
+ * render() as well. Backends only have to turn that DrawData into pixels
+ * and give access to those pixels.
+ */
+class BasicCanvas {
+  public:
+    virtual ~BasicCanvas();
+
+    /**
+     * @brief      DrawList owned by this canvas and merged at render()
+     *
+     * Recording into different lists never locks. Lists are merged by
+     * (order, creation sequence), so threads that need a deterministic
+     * draw order should each record into a list with a distinct order.
+     * render() must not overlap with recording of the same frame.
+     */
+    DrawList *make_recorder(int order = 0);
+
+    /**
+     * @brief      DrawList of the calling thread for order, created on
+     *             first use
+     *
+     * The drawing methods of the canvas record into recorder(0). Lists of
+     * the same order are merged in the order they were created, which for
+     * lists of different threads depends on which thread drew first: when
+     * several threads draw into one frame, give each a distinct order and
+     * record through recorder(order).
+     */
+    DrawList &recorder(int order = 0);
+
+    BasicCanvas &fill_rect(const glm::vec2 &a, const glm::vec2 &c,
+                           const ColorRGBAub &col) {
+        this->recorder().fill_rect(a, c, col);
+        return *this;
+    }
+
+    BasicCanvas &stroke_rect(const glm::vec2 &a, const glm::vec2 &c,
+                             const ColorRGBAub &col, float line_width) {
+        this->recorder().stroke_rect(a, c, col, line_width);
+        return *this;
+    }
+
+    BasicCanvas &begin_path(const glm::vec2 &pos) {
+        this->recorder().begin_path(pos);
+        return *this;
+    }
+
+    BasicCanvas &move_to(const glm::vec2 &pos) {
+        this->recorder().move_to(pos);
+        return *this;
+    }
+
+    BasicCanvas &line_to(const glm::vec2 &pos) {
+        this->recorder().line_to(pos);
+        return *this;
+    }
+
+    BasicCanvas &quad_to(const glm::vec2 &c, const glm::vec2 &pos) {
+        this->recorder().quad_to(c, pos);
+        return *this;
+    }
+
+    BasicCanvas &bezier_to(const glm::vec2 &c1, const glm::vec2 &c2,
+                           const glm::vec2 &pos) {
+        this->recorder().bezier_to(c1, c2, pos);
+        return *this;
+    }
+
+    BasicCanvas &arc(const glm::vec2 &center, float radius,
+                     float start_angle, float end_angle,
+                     bool anticlockwise = false) {
+        this->recorder().arc(center, radius, start_angle, end_angle,
+                             anticlockwise);
+        return *this;
+    }
+
+    BasicCanvas &arc_to(const glm::vec2 &p1, const glm::vec2 &p2,
+                        float radius) {
+        this->recorder().arc_to(p1, p2, radius);
+        return *this;
+    }
+
+    BasicCanvas &ellipse(const glm::vec2 &center, const glm::vec2 &radii,
+                         float rotation, float start_angle, float end_angle,
+                         bool anticlockwise = false) {
+        this->recorder().ellipse(center, radii, rotation, start_angle,
+                                 end_angle, anticlockwise);
+        return *this;
+    }
+
+    BasicCanvas &rect(const glm::vec2 &a, const glm::vec2 &c) {
+        this->recorder().rect(a, c);
+        return *this;
+    }
+
+    BasicCanvas &close_path() {
+        this->recorder().close_path();
+        return *this;
+    }
+
+    BasicCanvas &line_join(LineJoin join) {
+        this->recorder().line_join(join);
+        return *this;
+    }
+
+    BasicCanvas &line_cap(LineCap cap) {
+        this->recorder().line_cap(cap);
+        return *this;
+    }
+
+    BasicCanvas &miter_limit(float limit) {
+        this->recorder().miter_limit(limit);
+        return *this;
+    }
+
+    BasicCanvas &fill(const ColorRGBAub &col,
+                      FillRule rule = FillRule::kNonZero) {
+        this->recorder().fill(col, rule);
+        return *this;
+    }
+
+    BasicCanvas &stroke(const ColorRGBAub &col, float line_width) {
+        this->recorder().stroke(col, line_width);
+        return *this;
+    }
+
+    BasicCanvas &draw_image(std::shared_ptr<Image> image,
+                            const glm::vec2 &p_min, const glm::vec2 &p_max,
+                            const glm::vec2 &uv_min = {0, 0},
+                            const glm::vec2 &uv_max = {1, 1},
+                            uint8_t alpha = 255) {
+        this->recorder().draw_image(image, p_min, p_max, uv_min, uv_max,
+                                    alpha);
+        return *this;
+    }
+
+    BasicCanvas &fill_text(const std::string &text, const glm::vec2 &pos,
+                           my::Font *font = nullptr, float font_size = 16,
+                           const ColorRGBAub &color = {255, 255, 255, 255}) {
+        this->recorder().fill_text(text, pos, font, font_size, color);
+        return *this;
+    }
+
+    /**
+     * @brief      read back a rectangle of the rendered pixels
+     *
+     * Never waits for the renderer: the copy is made into a staging buffer
+     * at the end of the next render(), once the frame finished drawing, and
+     * the future resolves then. Readbacks of one frame are served with as
+     * few reads as possible. The rectangle is clipped to the canvas, an
+     * empty image means it was entirely outside.
+     */
+    future<std::shared_ptr<RGBAImage>> get_image_data(const IPoint2D &offset,
+                                                      const ISize2D &size);
+
+    /**
+     * @brief      write data into the canvas with its top left at offset
+     *
+     * Uploads are queued and applied at the start of the next render(),
+     * before the frame is drawn. Uploads completely overwritten by a later
+     * one are dropped and edge adjacent ones are coalesced into one write.
+     */
+    void put_image_data(std::shared_ptr<RGBAImage> data,
+                        const IPoint2D &offset);
+
+    /**
+     * @brief      image data traffic of the last render()
+     */
+    struct ImageDataStats {
+        // put_image_data calls and backend writes they turned into
+        size_t uploads{};
+        size_t upload_writes{};
+        // get_image_data calls and backend reads they turned into
+        size_t readbacks{};
+        size_t readback_reads{};
+    };
+
+    const ImageDataStats &image_data_stats() const {
+        return this->_image_data_stats;
+    }
+
+    /**
+     * @brief      merge every recorder and draw the frame
+     *
+     * Recording threads must be done with the frame before render() is
+     * called, the canvas only synchronizes render with image data access.
+     */
+    virtual void render() = 0;
+
+    /**
+     * @brief      drop everything recorded so far
+     */
+    virtual void clear();
+
+  protected:
+    BasicCanvas();
+
+    my::Font *_default_font{};
+    DrawData _draw_data;
+    std::shared_mutex _lock;
+    // duration of render(), backends time it, shared by all canvases
+    Histogram &_render_us{Metrics::get()->histogram("canvas.render_us")};
+
+    /**
+     * @brief      replace _draw_data with the lists recorded since the
+     *             last merge and reset those lists
+     */
+    void _merge_recorders();
+
+    /**
+     * @brief      size of the pixels image data is read from and written to
+     */
+    virtual ISize2D _target_size() = 0;
+
+    /**
+     * @brief      copy rect of the target into dst, which has rect's size
+     */
+    virtual void _read_pixels(const IRect &rect,
+                              const RGBAImage::view_t &dst) = 0;
+
+    /**
+     * @brief      copy src into the target with its top left at pos
+     */
+    virtual void _write_pixels(const RGBAImage::const_view_t &src,
+                               const IPoint2D &pos) = 0;
+
+    /**
+     * @brief      apply the queued put_image_data calls, called by render()
+     *             with _lock held before drawing
+     */
+    void _flush_uploads();
+
+    /**
+     * @brief      serve the queued get_image_data calls, called by render()
+     *             with _lock held once the frame finished drawing
+     */
+    void _flush_readbacks();
+
+  private:
+    // threads with a smaller thread index find their recorders without a
+    // lock, see recorder()
+    static constexpr uint32_t kThreadSlots = 64;
+
+    struct Recorder {
+        std::unique_ptr<DrawList> list;
+        uint64_t seq;
+        Recorder *next;
+        // next recorder() list of the same thread slot
+        Recorder *thread_next;
+    };
+    // lock-free push only list, nodes live as long as the canvas
+    std::atomic<Recorder *> _recorders{nullptr};
+    std::atomic<uint64_t> _recorder_seq{0};
+    std::vector<Recorder *> _merge_nodes;
+    std::vector<DrawList *> _merge_order;
+    // recorder() lists by thread index, a slot is only touched by the
+    // thread holding that index
+    std::array<Recorder *, kThreadSlots> _thread_recorders{};
+    std::mutex _overflow_lock;
+    std::map<std::pair<std::thread::id, int>, DrawList *> _overflow_recorders;
+
+    Recorder *_push_recorder(int order);
+
+    // frame pacing and size, updated by _merge_recorders()
+    Histogram &_frame_interval_us{
+        Metrics::get()->histogram("canvas.frame_interval_us")};
+    Gauge &_draw_cmds{Metrics::get()->gauge("canvas.draw_cmds")};
+    Gauge &_draw_vertices{Metrics::get()->gauge("canvas.draw_vertices")};
+    std::chrono::steady_clock::time_point _last_merge{};
+
+    struct Upload {
+        std::shared_ptr<RGBAImage> data;
+        IPoint2D offset;
+    };
+    struct UploadGroup {
+        IRect rect;
+        // clipped target rect of every member upload
+        std::vector<std::pair<const Upload *, IRect>> members;
+    };
+    struct Readback {
+        IRect rect;
+        promise<std::shared_ptr<RGBAImage>> result;
+    };
+    // requests are queued without touching _lock so callers never wait for
+    // a frame being rendered
+    std::mutex _pending_lock;
+    std::vector<Upload> _uploads;
+    std::vector<Readback> _readbacks;
+    std::vector<Upload> _flushing_uploads;
+    std::vector<Readback> _flushing_readbacks;
+    std::vector<UploadGroup> _upload_groups;
+    std::vector<uint8_t> _staging;
+    ImageDataStats _image_data_stats;
+
+    RGBAImage::view_t _staging_view(const ISize2D &size);
+};
+
+} // namespace my
@@ -2,9 +2,10 @@
 #define LLGL_ENABLE_UTILITY
 #include <LLGL/Utility.h>
 
-#include <util/codecvt.h>
-
 #include <boost/format.hpp>
+
+#include <core/profiler.hpp>
+
 namespace my {
 
 // Rect Rect::cut(const Rect &rect) const {
@@ -22,25 +23,6 @@ namespace my {
 //     return cut;
 // }
 
-DrawPath::DrawPath(const glm::vec2 begin) { this->_points.push_back(begin); }
-
-DrawPath &DrawPath::line_to(const glm::vec2 &pos) {
-    this->_points.push_back(pos);
-    return *this;
-}
-DrawPath &DrawPath::rect(const glm::vec2 &a, const glm::vec2 &c) {
-    if (this->_points.size() == 1) {
-        this->_points[0] = a;
-    } else {
-        this->line_to(a);
-    }
-
-    this->line_to({c.x, a.y});
-    this->line_to(c);
-    this->line_to({a.x, c.y});
-    return *this;
-}
-
 Canvas::Canvas(RenderSystem *renderer, Window *win, EventBus *bus,
                ResourceMgr *resource_mgr, FontMgr *font_mgr)
     : _renderer(renderer), _window(win) {
@@ -237,7 +219,8 @@ void Canvas::_make_context_resource() {
             pipeline_desc.shaderProgram = this->_shader;
             pipeline_desc.renderPass = this->_render_target->GetRenderPass();
             pipeline_desc.pipelineLayout = this->_pipeline_layout;
-            pipeline_desc.rasterizer.cullMode = LLGL::CullMode::Back;
+            // tessellated paths do not guarantee a consistent winding
+            pipeline_desc.rasterizer.cullMode = LLGL::CullMode::Disabled;
             LLGL::BlendTargetDescriptor blend0;
             {
                 blend0.blendEnabled = true;
@@ -277,18 +260,36 @@ void Canvas::_resize_handle() {
     this->_make_context_resource();
 }
 
-Canvas &Canvas::draw_image(std::shared_ptr<Image> image, const glm::vec2 &p_min,
-                           const glm::vec2 &p_max, const glm::vec2 &uv_min,
-                           const glm::vec2 &uv_max, uint8_t alpha) {
-    std::unique_lock<std::shared_mutex> l_lock(this->_lock);
-    if (alpha == 0) {
-        return *this;
+ISize2D Canvas::_target_size() {
+    auto [w, h] = this->_canvas_tex->get_size();
+    return ISize2D::Make(w, h);
+}
+
+void Canvas::_read_pixels(const IRect &rect, const RGBAImage::view_t &dst) {
+    this->_canvas_tex->read(rect.x(), rect.y(), dst);
+}
+
+void Canvas::_write_pixels(const RGBAImage::const_view_t &src,
+                           const IPoint2D &pos) {
+    if (src.is_1d_traversable()) {
+        this->_canvas_tex->write(src, pos.x(), pos.y());
+        return;
+    }
+    if (this->_upload_staging.dimensions() != src.dimensions()) {
+        this->_upload_staging.recreate(src.dimensions());
     }
+    boost::gil::copy_pixels(src, boost::gil::view(this->_upload_staging));
+    this->_canvas_tex->write(boost::gil::const_view(this->_upload_staging),
+                             pos.x(), pos.y());
+}
 
-    this->_save();
-    this->_get_state().image = image;
+void Canvas::_upload_textures() {
+    for (const auto &cmd : this->_draw_data.cmd_list) {
+        const auto &image = cmd.state.image;
+        if (!image || this->_textures.count(image)) {
+            continue;
+        }
 
-    {
         LLGL::SrcImageDescriptor src_image_desc{
             LLGL::ImageFormat::RGBA, LLGL::DataType::UInt8, image->raw_data(),
             image->width() * image->height() * 4};
@@ -308,228 +309,34 @@ Canvas &Canvas::draw_image(std::shared_ptr<Image> image, const glm::vec2 &p_min,
         auto resource = this->_renderer->CreateResourceHeap(resource_heap_desc);
         this->_textures.insert({image, {texture, resource, this->_renderer}});
     }
-
-    this->_prim_rect_uv(p_min, p_max, uv_min, uv_max, {255, 255, 255, alpha});
-
-    this->_restore();
-    return *this;
 }
 
-Canvas &Canvas::fill_text(const std::string &text, const glm::vec2 &p,
-                          my::Font *font, float font_size,
-                          const ColorRGBAub &color) {
+void Canvas::clear() {
+    BasicCanvas::clear();
     std::unique_lock<std::shared_mutex> l_lock(this->_lock);
-    std::wstring wtext = codecvt::utf_to_utf<wchar_t>(text);
-    this->_save();
-    this->_get_state().image = nullptr;
-    if (font == nullptr) {
-        font = this->_default_font;
-    }
-
-    float scale = font_size / font->font_size();
-
-    glm::vec2 pos = p;
-    pos.y += font_size;
-    glm::vec2 p_min;
-    glm::vec2 p_max;
-    for (auto ch : wtext) {
-        const auto &glyph = font->get_glyph(ch);
-        const auto w = glyph.w * scale;
-        const auto h = glyph.h * scale;
-        p_min.x = pos.x + glyph.bearing.x;
-        p_min.y = pos.y - (h - glyph.h * scale) - h;
-        p_max.x = p_min.x + w;
-        p_max.y = p_min.y + h;
-        this->_prim_rect_uv(p_min, p_max, glyph.uv0, glyph.uv1, color);
-        pos.x += glyph.advance_x * scale;
-    }
-    this->_restore();
-    return *this;
-}
-
-std::shared_ptr<RGBAImage> Canvas::get_image_data(const IPoint2D &offset,
-                                                  const ISize2D &size) {
-    std::unique_lock<std::shared_mutex> l_lock(this->_lock);
-
-    Rect src_rect{offset, size};
-
-    auto [canvas_w, canvas_h] = this->_canvas_tex->get_size();
-    Rect canvas_rect{{0, 0}, {canvas_w, canvas_h}};
-
-    Rect rect{};
-    try {
-        rect = canvas_rect.cut(src_rect);
-    } catch (RectOutRangeError &) {
-        return std::make_shared<RGBAImage>();
-    }
-
-    return this->_canvas_tex->get_image_data(rect.left, rect.top, rect.w(),
-                                             rect.h());
+    this->_release_textures();
 }
 
-void Canvas::put_image_data(std::shared_ptr<RGBAImage> data,
-                            const PixelPos &offset) {
-    std::unique_lock<std::shared_mutex> l_lock(this->_lock);
-    uint32_t src_w = data->width();
-    uint32_t src_h = data->height();
-    Rect src_rect{offset, {src_w, src_h}};
-
-    auto [canvas_w, canvas_h] = this->_canvas_tex->get_size();
-    Rect canvas_rect{{0, 0}, {canvas_w, canvas_h}};
-
-    Rect rect{};
-    try {
-        rect = canvas_rect.cut(src_rect);
-    } catch (RectOutRangeError &) {
-        return;
-    }
-
-    RGBAImage::const_view_t image_view{};
-
-    PixelPos off{rect.pos() - src_rect.pos()};
-    image_view = boost::gil::subimage_view(
-        boost::gil::view(*data), {off.x, off.y}, {rect.w(), rect.h()});
-
-    this->_canvas_tex->put_image_data(image_view, rect.left, rect.top);
-}
-
-const std::vector<DrawCmd> &Canvas::_get_draw_cmd() {
-    this->_add_cmd();
-    return this->_cmd_list;
-}
-
-void Canvas::_add_cmd() {
-    auto idx_count = this->_idx_list.size();
-    uint32_t elem_count;
-    if (this->_cmd_list.empty()) {
-        elem_count = idx_count;
-    } else {
-        auto &prev_cmd = this->_cmd_list.back();
-        auto prev_idx_offset = prev_cmd.idx_offset;
-        auto prev_elem_count = prev_cmd.elem_count;
-        elem_count = idx_count - (prev_idx_offset + prev_elem_count);
-    }
-
-    if (elem_count == 0) {
-        return;
-    }
-
-    this->_current_cmd.elem_count = elem_count;
-    this->_cmd_list.push_back(this->_current_cmd);
-    this->_current_cmd.idx_offset = idx_count;
-    this->_current_cmd.vtx_offset = this->_vtx_list.size();
-}
-
-void Canvas::_save() {
-    auto &current_state = this->_get_state();
-    this->_state_stack.push(current_state);
-    this->_add_cmd();
-}
-void Canvas::_restore() {
-    this->_add_cmd();
-    this->_set_state(this->_state_stack.top());
-    this->_state_stack.pop();
-}
-
-void Canvas::_prim_rect(const glm::vec2 &a, const glm::vec2 &c,
-                        const ColorRGBAub &col) {
-    this->_prim_rect_uv(a, c, {0, 0}, {0, 0}, col);
-}
-
-void Canvas::_prim_rect_uv(const glm::vec2 &a, const glm::vec2 &c,
-                           const glm::vec2 &uv_a, const glm::vec2 &uv_c,
-                           const ColorRGBAub &col) {
-    glm::vec2 b(c.x, a.y), d(a.x, c.y), uv_b(uv_c.x, uv_a.y),
-        uv_d(uv_a.x, uv_c.y);
-    auto idx = this->_vtx_list.size();
-    this->_vtx_list.push_back({a, uv_a, col});
-    this->_vtx_list.push_back({b, uv_b, col});
-    this->_vtx_list.push_back({c, uv_c, col});
-    this->_vtx_list.push_back({d, uv_d, col});
-    this->_idx_list.push_back(idx);
-    this->_idx_list.push_back(idx + 1);
-    this->_idx_list.push_back(idx + 2);
-    this->_idx_list.push_back(idx);
-    this->_idx_list.push_back(idx + 2);
-    this->_idx_list.push_back(idx + 3);
-}
-
-void Canvas::_add_poly_line(const DrawPath &path, const ColorRGBAub &col,
-                            float line_width) {
-    const size_t point_count = path._points.size();
-
-    if (point_count < 2) {
-        return;
-    }
-
-    glm::vec2 uv = this->_default_font->white_pixels_uv();
-
-    size_t count = point_count - 1;
-
-    for (size_t i = 0; i < count; ++i) {
-        const auto i2 = i + 1;
-        assert(i2 < point_count);
-        size_t current_idx = this->_vtx_list.size();
-
-        const glm::vec2 &p1 = path._points[i];
-        const glm::vec2 &p2 = path._points[i2];
-
-        float dx = p2.x - p1.x;
-        float dy = p2.y - p1.y;
-
-        float d2 = dx * dx + dy * dy;
-        if (d2 > 0.0f) {
-            float inv_len = 1.0f / std::sqrt(d2);
-            dx *= inv_len;
-            dy *= inv_len;
-        }
-
-        dx *= (line_width * 0.5f);
-        dy *= (line_width * 0.5f);
-
-        this->_vtx_list.push_back({{p1.x + dy, p1.y - dx}, uv, col});
-        this->_vtx_list.push_back({{p2.x + dy, p2.y - dx}, uv, col});
-        this->_vtx_list.push_back({{p2.x - dy, p2.y + dx}, uv, col});
-        this->_vtx_list.push_back({{p1.x - dy, p1.y + dx}, uv, col});
-
-        this->_idx_list.push_back(current_idx);
-        this->_idx_list.push_back(current_idx + 1);
-        this->_idx_list.push_back(current_idx + 2);
-        this->_idx_list.push_back(current_idx);
-        this->_idx_list.push_back(current_idx + 2);
-        this->_idx_list.push_back(current_idx + 3);
-    }
-}
-
-void Canvas::_add_convex_poly_fill(const DrawPath &path,
-                                   const ColorRGBAub &col) {
-    const size_t point_count = path._points.size();
-
-    glm::vec2 uv = this->_default_font->white_pixels_uv();
-
-    // const size_t idx_count = (point_count - 2) * 3;
-    const size_t vtx_count = point_count;
-
-    size_t current_idx = this->_vtx_list.size();
-
-    for (size_t i = 0; i < vtx_count; ++i) {
-        this->_vtx_list.push_back({path._points[i], uv, col});
-    }
-
-    for (size_t i = 2; i < point_count; i++) {
-        this->_idx_list.push_back(current_idx);
-        this->_idx_list.push_back(current_idx + i - 1);
-        this->_idx_list.push_back(current_idx + i);
+void Canvas::_release_textures() {
+    for (auto &tex : this->_textures) {
+        tex.second.release();
     }
+    this->_textures.clear();
 }
 
 void Canvas::render() {
+    MY_PROFILE_ZONE_C("render", "Canvas::render");
+    HistogramTimer l_render_time(this->_render_us);
     {
         std::unique_lock<std::shared_mutex> l_lock(this->_lock);
         this->_resize_handle();
-        if (this->_vtx_list.empty() && this->_idx_list.empty()) {
+        this->_flush_uploads();
+        this->_merge_recorders();
+        if (this->_draw_data.empty()) {
+            this->_flush_readbacks();
             return;
         }
+        this->_upload_textures();
         {
             if (this->_vtx_buf) {
                 this->_renderer->Release(*this->_vtx_buf);
@@ -541,14 +348,15 @@ void Canvas::render() {
             }
 
             this->_vtx_buf = this->_renderer->CreateBuffer(
-                LLGL::VertexBufferDesc(this->_vtx_list.size() *
+                LLGL::VertexBufferDesc(this->_draw_data.vtx_list.size() *
                                            sizeof(DrawVert),
                                        this->_vertex_format),
-                this->_vtx_list.data());
+                this->_draw_data.vtx_list.data());
             this->_idx_buf = this->_renderer->CreateBuffer(
-                LLGL::IndexBufferDesc(this->_idx_list.size() * sizeof(uint32_t),
+                LLGL::IndexBufferDesc(this->_draw_data.idx_list.size() *
+                                          sizeof(uint32_t),
                                       LLGL ::Format::R32UInt),
-                this->_idx_list.data());
+                this->_draw_data.idx_list.data());
 
             this->_commands->Begin();
             {
@@ -568,7 +376,7 @@ void Canvas::render() {
                     this->_commands->SetPipelineState(*this->_pipeline[0]);
                     this->_commands->SetVertexBuffer(*this->_vtx_buf);
                     this->_commands->SetIndexBuffer(*this->_idx_buf);
-                    for (const auto &cmd : this->_get_draw_cmd()) {
+                    for (const auto &cmd : this->_draw_data.cmd_list) {
                         if (cmd.state.image) {
                             auto texture =
                                 this->_textures.at(cmd.state.image).resource;
@@ -579,8 +387,10 @@ void Canvas::render() {
                                 *this->_default_resource);
                         }
 
-                        this->_commands->DrawIndexed(cmd.elem_count, 0,
-                                                     cmd.vtx_offset);
+                        // merged indices are absolute, only the first index
+                        // of the command is needed
+                        this->_commands->DrawIndexed(cmd.elem_count,
+                                                     cmd.idx_offset);
                     }
                 }
                 this->_commands->EndRenderPass();
@@ -608,16 +418,19 @@ void Canvas::render() {
                 this->_context->Present();
             } catch (std::exception &e) {
                 GLOG_D(e.what());
+                this->_flush_readbacks();
                 this->_resize_handle();
                 return;
             }
             this->_queue->Submit(*this->_fence);
             this->_queue->WaitFence(*this->_fence,
                                     std::numeric_limits<std::uint64_t>::max());
+            // the frame is complete, copy it out before the next one starts
+            this->_flush_readbacks();
         }
+        this->_draw_data.clear();
+        this->_release_textures();
     }
-
-    this->clear();
 }
 
 } // namespace my
@@ -0,0 +1,171 @@
+#include "draw_list.hpp"
+
+#include <storage/font_mgr.h>
+
+#include <algorithm>
+
+namespace my {
+
+void DrawList::default_font(Font *font) {
+    this->_default_font = font;
+    if (font) {
+        this->_tessellator.uv(font->white_pixels_uv());
+    }
+}
+
+DrawList &DrawList::fill(const ColorRGBAub &col, FillRule rule) {
+    _CHECK_CURRENT_PATH;
+    this->_tessellator.fill(*this->_current_path, col, rule, this->_vtx_list,
+                            this->_idx_list);
+    this->_spare_path = std::move(this->_current_path);
+    return *this;
+}
+
+DrawList &DrawList::stroke(const ColorRGBAub &col, float line_width) {
+    _CHECK_CURRENT_PATH;
+    auto style = this->_stroke_style;
+    style.width = line_width;
+    this->_tessellator.stroke(*this->_current_path, col, style,
+                              this->_vtx_list, this->_idx_list);
+    this->_spare_path = std::move(this->_current_path);
+    return *this;
+}
+
+DrawList &DrawList::draw_image(std::shared_ptr<Image> image,
+                               const glm::vec2 &p_min, const glm::vec2 &p_max,
+                               const glm::vec2 &uv_min, const glm::vec2 &uv_max,
+                               uint8_t alpha) {
+    if (alpha == 0) {
+        return *this;
+    }
+
+    // the texture itself is created by the canvas when the frame is rendered
+    this->_save();
+    this->_get_state().image = image;
+    this->_prim_rect_uv(p_min, p_max, uv_min, uv_max, {255, 255, 255, alpha});
+    this->_restore();
+    return *this;
+}
+
+DrawList &DrawList::fill_text(const std::string &text, const glm::vec2 &p,
+                              my::Font *font, float font_size,
+                              const ColorRGBAub &color) {
+    if (font == nullptr) {
+        font = this->_default_font;
+    }
+    if (font == nullptr) {
+        GLOG_W("no font for fill_text");
+        return *this;
+    }
+
+    std::wstring wtext = codecvt::utf_to_utf<wchar_t>(text);
+    this->_save();
+    this->_get_state().image = nullptr;
+
+    float scale = font_size / font->font_size();
+
+    glm::vec2 pos = p;
+    pos.y += font_size;
+    glm::vec2 p_min;
+    glm::vec2 p_max;
+    for (auto ch : wtext) {
+        const auto &glyph = font->get_glyph(ch);
+        const auto w = glyph.w * scale;
+        const auto h = glyph.h * scale;
+        p_min.x = pos.x + glyph.bearing.x;
+        p_min.y = pos.y - (h - glyph.h * scale) - h;
+        p_max.x = p_min.x + w;
+        p_max.y = p_min.y + h;
+        this->_prim_rect_uv(p_min, p_max, glyph.uv0, glyph.uv1, color);
+        pos.x += glyph.advance_x * scale;
+    }
+    this->_restore();
+    return *this;
+}
+
+const std::vector<DrawCmd> &DrawList::cmd_list() {
+    this->_add_cmd();
+    return this->_cmd_list;
+}
+
+void DrawList::clear() {
+    this->_vtx_list.clear();
+    this->_idx_list.clear();
+    this->_cmd_list.clear();
+    if (this->_current_path) {
+        this->_spare_path = std::move(this->_current_path);
+    }
+    this->_current_cmd = {};
+    this->_state_stack = {};
+}
+
+void DrawList::_add_cmd() {
+    auto idx_count = static_cast<uint32_t>(this->_idx_list.size());
+    uint32_t elem_count = idx_count - this->_current_cmd.idx_offset;
+    if (elem_count == 0) {
+        return;
+    }
+
+    this->_current_cmd.elem_count = elem_count;
+    this->_cmd_list.push_back(this->_current_cmd);
+    this->_current_cmd.idx_offset = idx_count;
+    this->_current_cmd.vtx_offset = this->_vtx_list.size();
+}
+
+void DrawList::_save() {
+    auto &current_state = this->_get_state();
+    this->_state_stack.push(current_state);
+    this->_add_cmd();
+}
+
+void DrawList::_restore() {
+    this->_add_cmd();
+    this->_set_state(this->_state_stack.top());
+    this->_state_stack.pop();
+}
+
+void DrawList::_prim_rect_uv(const glm::vec2 &a, const glm::vec2 &c,
+                             const glm::vec2 &uv_a, const glm::vec2 &uv_c,
+                             const ColorRGBAub &col) {
+    glm::vec2 b(c.x, a.y), d(a.x, c.y), uv_b(uv_c.x, uv_a.y),
+        uv_d(uv_a.x, uv_c.y);
+    auto idx = static_cast<uint32_t>(this->_vtx_list.size());
+    this->_vtx_list.push_back({a, uv_a, col});
+    this->_vtx_list.push_back({b, uv_b, col});
+    this->_vtx_list.push_back({c, uv_c, col});
+    this->_vtx_list.push_back({d, uv_d, col});
+    this->_idx_list.insert(this->_idx_list.end(),
+                           {idx, idx + 1, idx + 2, idx, idx + 2, idx + 3});
+}
+
+void DrawData::merge(const std::vector<DrawList *> &lists) {
+    size_t vtx_count = this->vtx_list.size();
+    size_t idx_count = this->idx_list.size();
+    for (auto list : lists) {
+        vtx_count += list->vtx_list().size();
+        idx_count += list->idx_list().size();
+    }
+    this->vtx_list.reserve(vtx_count);
+    this->idx_list.reserve(idx_count);
+
+    for (auto list : lists) {
+        const auto vtx_base = static_cast<uint32_t>(this->vtx_list.size());
+        const auto idx_base = static_cast<uint32_t>(this->idx_list.size());
+
+        for (auto cmd : list->cmd_list()) {
+            cmd.idx_offset += idx_base;
+            cmd.vtx_offset += vtx_base;
+            this->cmd_list.push_back(std::move(cmd));
+        }
+
+        const auto &vtx = list->vtx_list();
+        this->vtx_list.insert(this->vtx_list.end(), vtx.begin(), vtx.end());
+        const auto &idx = list->idx_list();
+        this->idx_list.resize(idx_base + idx.size());
+        std::transform(idx.begin(), idx.end(),
+                       this->idx_list.begin() + idx_base,
+                       [vtx_base](uint32_t i) { return i + vtx_base; });
+    }
+}
+
+} // namespace my
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <memory>
+#include <stack>
+#include <vector>
+
+#include <render/back/back2/draw_path.hpp>
+#include <render/back/back2/path_tessellator.hpp>
+
+namespace my {
+
+class Image;
+class Font;
+
+#define _CHECK_CURRENT_PATH                                                    \
+    if (!this->_current_path) {                                                \
+        GLOG_W("current path is reset");                                       \
+        return *this;                                                          \
+    }
+
+struct DrawState {
+    std::shared_ptr<Image> image;
+};
+
+struct DrawCmd {
+    DrawState state;
+    uint32_t elem_count;
+    uint32_t idx_offset = 0;
+    uint32_t vtx_offset = 0;
+};
+
+/**
+ * @brief      records draw calls into its own vertex/index/command chunks
+ *
+ * A DrawList is not synchronized: it must only be used by one thread at a
+ * time, which is what lets several threads record for the same Canvas
+ * without contending on a lock.
+ */
+class DrawList {
+  public:
+    explicit DrawList(int order = 0) : _order(order) {}
+
+    /**
+     * @brief      merge key, lists with a lower order are drawn first
+     */
+    int order() const { return this->_order; }
+
+    void default_font(Font *font);
+
+    DrawList &fill_rect(const glm::vec2 &a, const glm::vec2 &c,
+                        const ColorRGBAub &col) {
+        return this->begin_path(a).rect(a, c).fill(col);
+    }
+
+    DrawList &stroke_rect(const glm::vec2 &a, const glm::vec2 &c,
+                          const ColorRGBAub &col, float line_width) {
+        return this->begin_path(a).rect(a, c).stroke(col, line_width);
+    }
+
+    DrawList &begin_path(const glm::vec2 &pos) {
+        if (this->_spare_path) {
+            this->_current_path = std::move(this->_spare_path);
+            *this->_current_path = DrawPath(pos);
+        } else {
+            this->_current_path.reset(new DrawPath(pos));
+        }
+        return *this;
+    }
+
+    DrawList &move_to(const glm::vec2 &pos) {
+        _CHECK_CURRENT_PATH;
+        this->_current_path->move_to(pos);
+        return *this;
+    }
+
+    DrawList &line_to(const glm::vec2 &pos) {
+        _CHECK_CURRENT_PATH;
+        this->_current_path->line_to(pos);
+        return *this;
+    }
+
+    DrawList &quad_to(const glm::vec2 &c, const glm::vec2 &pos) {
+        _CHECK_CURRENT_PATH;
+        this->_current_path->quad_to(c, pos);
+        return *this;
+    }
+
+    DrawList &bezier_to(const glm::vec2 &c1, const glm::vec2 &c2,
+                        const glm::vec2 &pos) {
+        _CHECK_CURRENT_PATH;
+        this->_current_path->cubic_to(c1, c2, pos);
+        return *this;
+    }
+
+    DrawList &arc(const glm::vec2 &center, float radius, float start_angle,
+                  float end_angle, bool anticlockwise = false) {
+        _CHECK_CURRENT_PATH;
+        this->_current_path->arc(center, radius, start_angle, end_angle,
+                                 anticlockwise);
+        return *this;
+    }
+
+    DrawList &arc_to(const glm::vec2 &p1, const glm::vec2 &p2, float radius) {
+        _CHECK_CURRENT_PATH;
+        this->_current_path->arc_to(p1, p2, radius);
+        return *this;
+    }
+
+    DrawList &ellipse(const glm::vec2 &center, const glm::vec2 &radii,
+                      float rotation, float start_angle, float end_angle,
+                      bool anticlockwise = false) {
+        _CHECK_CURRENT_PATH;
+        this->_current_path->ellipse(center, radii, rotation, start_angle,
+                                     end_angle, anticlockwise);
+        return *this;
+    }
+
+    DrawList &rect(const glm::vec2 &a, const glm::vec2 &c) {
+        _CHECK_CURRENT_PATH;
+        this->_current_path->rect(a, c);
+        return *this;
+    }
+
+    DrawList &close_path() {
+        _CHECK_CURRENT_PATH;
+        this->_current_path->close();
+        return *this;
+    }
+
+    DrawList &line_join(LineJoin join) {
+        this->_stroke_style.join = join;
+        return *this;
+    }
+
+    DrawList &line_cap(LineCap cap) {
+        this->_stroke_style.cap = cap;
+        return *this;
+    }
+
+    DrawList &miter_limit(float limit) {
+        this->_stroke_style.miter_limit = limit;
+        return *this;
+    }
+
+    DrawList &fill(const ColorRGBAub &col,
+                   FillRule rule = FillRule::kNonZero);
+
+    DrawList &stroke(const ColorRGBAub &col, float line_width);
+
+    DrawList &draw_image(std::shared_ptr<Image> image, const glm::vec2 &p_min,
+                         const glm::vec2 &p_max,
+                         const glm::vec2 &uv_min = {0, 0},
+                         const glm::vec2 &uv_max = {1, 1},
+                         uint8_t alpha = 255);
+
+    DrawList &fill_text(const std::string &text, const glm::vec2 &pos,
+                        my::Font *font = nullptr, float font_size = 16,
+                        const ColorRGBAub &color = {255, 255, 255, 255});
+
+    const std::vector<DrawVert> &vtx_list() const { return this->_vtx_list; }
+    const std::vector<uint32_t> &idx_list() const { return this->_idx_list; }
+
+    /**
+     * @brief      commands recorded so far, the pending command is closed
+     */
+    const std::vector<DrawCmd> &cmd_list();
+
+    bool empty() const { return this->_idx_list.empty(); }
+
+    /**
+     * @brief      drop recorded geometry, buffer capacity is kept
+     */
+    void clear();
+
+  private:
+    int _order;
+
+    std::vector<DrawVert> _vtx_list;
+    std::vector<uint32_t> _idx_list;
+    std::vector<DrawCmd> _cmd_list;
+
+    std::unique_ptr<DrawPath> _current_path;
+    // finished path kept around so begin_path does not allocate
+    std::unique_ptr<DrawPath> _spare_path;
+    PathTessellator _tessellator;
+    StrokeStyle _stroke_style;
+
+    DrawCmd _current_cmd{};
+    std::stack<DrawState> _state_stack;
+
+    my::Font *_default_font{};
+
+    DrawState &_get_state() { return this->_current_cmd.state; }
+    void _set_state(const DrawState &state) {
+        this->_current_cmd.state = state;
+    }
+
+    void _add_cmd();
+
+    void _save();
+    void _restore();
+
+    void _prim_rect_uv(const glm::vec2 &a, const glm::vec2 &c,
+                       const glm::vec2 &uv_a, const glm::vec2 &uv_c,
+                       const ColorRGBAub &col = {0, 0, 0, 0});
+};
+
+/**
+ * @brief      one frame of geometry merged from several DrawLists
+ */
+struct DrawData {
+    std::vector<DrawVert> vtx_list;
+    std::vector<uint32_t> idx_list;
+    std::vector<DrawCmd> cmd_list;
+
+    bool empty() const { return this->idx_list.empty(); }
+
+    void clear() {
+        this->vtx_list.clear();
+        this->idx_list.clear();
+        this->cmd_list.clear();
+    }
+
+    /**
+     * @brief      append lists in the given order, indices are rebased so
+     *             every command addresses the merged buffers
+     */
+    void merge(const std::vector<DrawList *> &lists);
+};
+
+} // namespace my
@@ -0,0 +1,179 @@
+#include "draw_path.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace my {
+
+namespace {
+constexpr float kPI = 3.14159265358979323846f;
+constexpr float kTwoPI = kPI * 2.0f;
+} // namespace
+
+DrawPath::DrawPath(const glm::vec2 begin) { this->move_to(begin); }
+
+const glm::vec2 &DrawPath::current_point() const {
+    if (this->_verbs.back() == Verb::kClose) {
+        return this->sub_path_start();
+    }
+    return this->_points.back();
+}
+
+void DrawPath::_ensure_sub_path() {
+    // drawing after close continues from the closed sub path start
+    if (this->_verbs.back() == Verb::kClose) {
+        this->move_to(this->sub_path_start());
+    }
+}
+
+DrawPath &DrawPath::move_to(const glm::vec2 &pos) {
+    if (!this->_verbs.empty() && this->_verbs.back() == Verb::kMove) {
+        this->_points.back() = pos;
+        return *this;
+    }
+    this->_verbs.push_back(Verb::kMove);
+    this->_sub_path_start = this->_points.size();
+    this->_points.push_back(pos);
+    return *this;
+}
+
+DrawPath &DrawPath::line_to(const glm::vec2 &pos) {
+    this->_ensure_sub_path();
+    this->_verbs.push_back(Verb::kLine);
+    this->_points.push_back(pos);
+    return *this;
+}
+
+DrawPath &DrawPath::quad_to(const glm::vec2 &c, const glm::vec2 &pos) {
+    this->_ensure_sub_path();
+    this->_verbs.push_back(Verb::kQuad);
+    this->_points.push_back(c);
+    this->_points.push_back(pos);
+    return *this;
+}
+
+DrawPath &DrawPath::cubic_to(const glm::vec2 &c1, const glm::vec2 &c2,
+                             const glm::vec2 &pos) {
+    this->_ensure_sub_path();
+    this->_verbs.push_back(Verb::kCubic);
+    this->_points.push_back(c1);
+    this->_points.push_back(c2);
+    this->_points.push_back(pos);
+    return *this;
+}
+
+DrawPath &DrawPath::arc(const glm::vec2 &center, float radius,
+                        float start_angle, float end_angle,
+                        bool anticlockwise) {
+    return this->ellipse(center, {radius, radius}, 0.0f, start_angle,
+                         end_angle, anticlockwise);
+}
+
+DrawPath &DrawPath::arc_to(const glm::vec2 &p1, const glm::vec2 &p2,
+                           float radius) {
+    this->_ensure_sub_path();
+    const glm::vec2 p0 = this->current_point();
+
+    auto d0 = p0 - p1;
+    auto d1 = p2 - p1;
+    float l0 = glm::length(d0);
+    float l1 = glm::length(d1);
+    if (radius <= 0.0f || l0 < 1e-6f || l1 < 1e-6f) {
+        return this->line_to(p1);
+    }
+    d0 /= l0;
+    d1 /= l1;
+
+    float cross = d0.x * d1.y - d0.y * d1.x;
+    if (std::abs(cross) < 1e-6f) {
+        return this->line_to(p1);
+    }
+
+    float half = std::acos(glm::clamp(glm::dot(d0, d1), -1.0f, 1.0f)) * 0.5f;
+    float dist = radius / std::tan(half);
+    auto t0 = p1 + d0 * dist;
+    auto t1 = p1 + d1 * dist;
+    auto center = p1 + glm::normalize(d0 + d1) * (radius / std::sin(half));
+
+    float a0 = std::atan2(t0.y - center.y, t0.x - center.x);
+    float a1 = std::atan2(t1.y - center.y, t1.x - center.x);
+
+    // turning right in screen space sweeps with increasing angle
+    auto turn = (p1 - p0);
+    bool anticlockwise = turn.x * (p2 - p1).y - turn.y * (p2 - p1).x < 0.0f;
+    return this->arc(center, radius, a0, a1, anticlockwise);
+}
+
+DrawPath &DrawPath::ellipse(const glm::vec2 &center, const glm::vec2 &radii,
+                            float rotation, float start_angle, float end_angle,
+                            bool anticlockwise) {
+    float sweep = end_angle - start_angle;
+    if (!anticlockwise) {
+        if (sweep >= kTwoPI) {
+            sweep = kTwoPI;
+        } else {
+            sweep = std::fmod(sweep, kTwoPI);
+            if (sweep < 0.0f)
+                sweep += kTwoPI;
+        }
+    } else {
+        if (sweep <= -kTwoPI) {
+            sweep = -kTwoPI;
+        } else {
+            sweep = std::fmod(sweep, kTwoPI);
+            if (sweep > 0.0f)
+                sweep -= kTwoPI;
+        }
+    }
+
+    const float cos_r = std::cos(rotation);
+    const float sin_r = std::sin(rotation);
+    auto map = [&](const glm::vec2 &unit) {
+        glm::vec2 p{unit.x * radii.x, unit.y * radii.y};
+        return center +
+               glm::vec2{p.x * cos_r - p.y * sin_r, p.x * sin_r + p.y * cos_r};
+    };
+
+    glm::vec2 start = map({std::cos(start_angle), std::sin(start_angle)});
+    if (this->_verbs.back() == Verb::kMove) {
+        this->move_to(start);
+    } else {
+        this->line_to(start);
+    }
+
+    // split into segments of at most 90 degree, each approximated by a cubic
+    int segments = std::max(
+        1, static_cast<int>(std::ceil(std::abs(sweep) / (kPI * 0.5f) - 1e-4f)));
+    float step = sweep / segments;
+    float k = 4.0f / 3.0f * std::tan(step * 0.25f);
+
+    float a = start_angle;
+    for (int i = 0; i < segments; ++i) {
+        float b = a + step;
+        glm::vec2 u0{std::cos(a), std::sin(a)};
+        glm::vec2 u1{std::cos(b), std::sin(b)};
+        glm::vec2 c1 = u0 + glm::vec2{-u0.y, u0.x} * k;
+        glm::vec2 c2 = u1 - glm::vec2{-u1.y, u1.x} * k;
+        this->cubic_to(map(c1), map(c2), map(u1));
+        a = b;
+    }
+    return *this;
+}
+
+DrawPath &DrawPath::rect(const glm::vec2 &a, const glm::vec2 &c) {
+    this->move_to(a);
+    this->line_to({c.x, a.y});
+    this->line_to(c);
+    this->line_to({a.x, c.y});
+    return this->close();
+}
+
+DrawPath &DrawPath::close() {
+    auto last = this->_verbs.back();
+    if (last != Verb::kClose && last != Verb::kMove) {
+        this->_verbs.push_back(Verb::kClose);
+    }
+    return *this;
+}
+
+} // namespace my
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <my_gui.hpp>
+
+namespace my {
+
+using ColorRGBAub = glm::u8vec4;
+
+struct DrawVert {
+    glm::vec2 pos;
+    glm::vec2 uv;
+    ColorRGBAub col{255, 255, 255, 255};
+};
+
+enum class FillRule { kNonZero, kEvenOdd };
+enum class LineJoin { kMiter, kRound, kBevel };
+enum class LineCap { kButt, kRound, kSquare };
+
+struct StrokeStyle {
+    float width{1.0f};
+    LineJoin join{LineJoin::kMiter};
+    LineCap cap{LineCap::kButt};
+    float miter_limit{4.0f};
+};
+
+/**
+ * @brief      path geometry recorded as verbs + control points,
+ *             arcs and ellipses are stored as cubic segments
+ */
+class DrawPath {
+  public:
+    friend class PathTessellator;
+
+    enum class Verb : uint8_t { kMove, kLine, kQuad, kCubic, kClose };
+
+    DrawPath() : DrawPath({0.0f, 0.0f}) {}
+    DrawPath(const glm::vec2 begin);
+
+    DrawPath &move_to(const glm::vec2 &pos);
+
+    DrawPath &line_to(const glm::vec2 &pos);
+
+    DrawPath &quad_to(const glm::vec2 &c, const glm::vec2 &pos);
+
+    DrawPath &cubic_to(const glm::vec2 &c1, const glm::vec2 &c2,
+                       const glm::vec2 &pos);
+
+    /**
+     * @brief      angles in radians, clockwise in screen space
+     */
+    DrawPath &arc(const glm::vec2 &center, float radius, float start_angle,
+                  float end_angle, bool anticlockwise = false);
+
+    DrawPath &arc_to(const glm::vec2 &p1, const glm::vec2 &p2, float radius);
+
+    DrawPath &ellipse(const glm::vec2 &center, const glm::vec2 &radii,
+                      float rotation, float start_angle, float end_angle,
+                      bool anticlockwise = false);
+
+    DrawPath &rect(const glm::vec2 &a, const glm::vec2 &c);
+
+    DrawPath &close();
+
+    bool empty() const { return this->_verbs.size() <= 1; }
+
+    const glm::vec2 &current_point() const;
+
+    /**
+     * @brief      start point of the current sub path
+     */
+    const glm::vec2 &sub_path_start() const {
+        return this->_points[this->_sub_path_start];
+    }
+
+    const std::vector<Verb> &verbs() const { return this->_verbs; }
+    const std::vector<glm::vec2> &points() const { return this->_points; }
+
+  private:
+    std::vector<Verb> _verbs;
+    std::vector<glm::vec2> _points;
+    size_t _sub_path_start{0};
+
+    void _ensure_sub_path();
+};
+
+} // namespace my
@@ -0,0 +1,692 @@
+#include "image_effects.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <boost/functional/hash.hpp>
+
+#include <core/profiler.hpp>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace my {
+
+namespace {
+
+// rows per job of row passes
+constexpr uint32_t kBandRows = 16;
+// pixels per job of column passes, the running sums stay in L1
+constexpr uint32_t kStripWidth = 64;
+// scratch buffers kept between blurs
+constexpr size_t kScratchBuffers = 2;
+
+// RGBA8 pixels, src planes are only read
+struct Plane {
+    uint8_t *pixels;
+    uint32_t width;
+    uint32_t height;
+    size_t row_bytes;
+
+    uint8_t *row(int64_t y) const {
+        y = std::clamp<int64_t>(y, 0, int64_t(this->height) - 1);
+        return this->pixels + size_t(y) * this->row_bytes;
+    }
+};
+
+Plane plane(const RGBAImage::const_view_t &view) {
+    return {const_cast<uint8_t *>(reinterpret_cast<const uint8_t *>(
+                boost::gil::interleaved_view_get_raw_data(view))),
+            uint32_t(view.width()), uint32_t(view.height()),
+            size_t(view.pixels().row_size())};
+}
+
+Plane plane(const RGBAImage::view_t &view) {
+    return {reinterpret_cast<uint8_t *>(
+                boost::gil::interleaved_view_get_raw_data(view)),
+            uint32_t(view.width()), uint32_t(view.height()),
+            size_t(view.pixels().row_size())};
+}
+
+inline int64_t clamp_x(int64_t x, uint32_t width) {
+    return std::clamp<int64_t>(x, 0, int64_t(width) - 1);
+}
+
+#if defined(__SSE2__)
+
+// one RGBA pixel in float lanes, 0..255
+struct Px {
+    __m128 v;
+
+    static Px zero() { return {_mm_setzero_ps()}; }
+
+    static Px set(float r, float g, float b, float a) {
+        return {_mm_setr_ps(r, g, b, a)};
+    }
+
+    static Px load(const uint8_t *p) {
+        int32_t raw;
+        std::memcpy(&raw, p, sizeof(raw));
+        const __m128i zero = _mm_setzero_si128();
+        __m128i i = _mm_cvtsi32_si128(raw);
+        i = _mm_unpacklo_epi8(i, zero);
+        i = _mm_unpacklo_epi16(i, zero);
+        return {_mm_cvtepi32_ps(i)};
+    }
+
+    // rounded to nearest even and saturated
+    void store(uint8_t *p) const {
+        __m128i i = _mm_cvtps_epi32(this->v);
+        i = _mm_packs_epi32(i, i);
+        i = _mm_packus_epi16(i, i);
+        int32_t raw = _mm_cvtsi128_si32(i);
+        std::memcpy(p, &raw, sizeof(raw));
+    }
+
+    static Px get(const float *p) { return {_mm_loadu_ps(p)}; }
+
+    void put(float *p) const { _mm_storeu_ps(p, this->v); }
+
+    template <int i> Px lane() const {
+        return {_mm_shuffle_ps(this->v, this->v, _MM_SHUFFLE(i, i, i, i))};
+    }
+
+    Px operator+(const Px &o) const { return {_mm_add_ps(v, o.v)}; }
+    Px operator*(const Px &o) const { return {_mm_mul_ps(v, o.v)}; }
+    Px operator*(float s) const { return {_mm_mul_ps(v, _mm_set1_ps(s))}; }
+};
+
+// one RGBA pixel in 32 bit integer lanes, for running sums
+struct Sum {
+    __m128i v;
+
+    static Sum zero() { return {_mm_setzero_si128()}; }
+
+    static Sum load(const uint8_t *p) {
+        int32_t raw;
+        std::memcpy(&raw, p, sizeof(raw));
+        const __m128i zero = _mm_setzero_si128();
+        __m128i i = _mm_cvtsi32_si128(raw);
+        i = _mm_unpacklo_epi8(i, zero);
+        return {_mm_unpacklo_epi16(i, zero)};
+    }
+
+    static Sum get(const uint32_t *lanes) {
+        return {_mm_loadu_si128(reinterpret_cast<const __m128i *>(lanes))};
+    }
+
+    void put(uint32_t *lanes) const {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), this->v);
+    }
+
+    Px px() const { return {_mm_cvtepi32_ps(this->v)}; }
+
+    Sum operator+(const Sum &o) const { return {_mm_add_epi32(v, o.v)}; }
+    Sum operator-(const Sum &o) const { return {_mm_sub_epi32(v, o.v)}; }
+};
+
+#else
+
+struct Px {
+    float v[4];
+
+    static Px zero() { return {{0, 0, 0, 0}}; }
+
+    static Px set(float r, float g, float b, float a) { return {{r, g, b, a}}; }
+
+    static Px load(const uint8_t *p) {
+        return {{float(p[0]), float(p[1]), float(p[2]), float(p[3])}};
+    }
+
+    void store(uint8_t *p) const {
+        for (int i = 0; i < 4; ++i) {
+            p[i] = static_cast<uint8_t>(
+                std::clamp<long>(std::lrint(this->v[i]), 0, 255));
+        }
+    }
+
+    static Px get(const float *p) { return {{p[0], p[1], p[2], p[3]}}; }
+
+    void put(float *p) const { std::copy(this->v, this->v + 4, p); }
+
+    template <int i> Px lane() const {
+        return {{this->v[i], this->v[i], this->v[i], this->v[i]}};
+    }
+
+    Px operator+(const Px &o) const {
+        return {{v[0] + o.v[0], v[1] + o.v[1], v[2] + o.v[2], v[3] + o.v[3]}};
+    }
+    Px operator*(const Px &o) const {
+        return {{v[0] * o.v[0], v[1] * o.v[1], v[2] * o.v[2], v[3] * o.v[3]}};
+    }
+    Px operator*(float s) const {
+        return {{v[0] * s, v[1] * s, v[2] * s, v[3] * s}};
+    }
+};
+
+struct Sum {
+    uint32_t v[4];
+
+    static Sum zero() { return {{0, 0, 0, 0}}; }
+
+    static Sum load(const uint8_t *p) { return {{p[0], p[1], p[2], p[3]}}; }
+
+    static Sum get(const uint32_t *lanes) {
+        return {{lanes[0], lanes[1], lanes[2], lanes[3]}};
+    }
+
+    void put(uint32_t *lanes) const { std::copy(this->v, this->v + 4, lanes); }
+
+    Px px() const {
+        return {{float(v[0]), float(v[1]), float(v[2]), float(v[3])}};
+    }
+
+    Sum operator+(const Sum &o) const {
+        return {{v[0] + o.v[0], v[1] + o.v[1], v[2] + o.v[2], v[3] + o.v[3]}};
+    }
+    Sum operator-(const Sum &o) const {
+        return {{v[0] - o.v[0], v[1] - o.v[1], v[2] - o.v[2], v[3] - o.v[3]}};
+    }
+};
+
+#endif
+
+// (x + 128) / 255 rounded, exact for the products of two bytes
+inline uint32_t div255(uint32_t x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+void premultiply_row(const uint8_t *src, uint8_t *dst, uint32_t n) {
+    uint32_t i = 0;
+#if defined(__SSE2__)
+    // two pixels per register in 16 bit lanes, alpha multiplied by 255
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i color = _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+    const __m128i opaque = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+    const __m128i round = _mm_set1_epi16(128);
+    auto mul = [&](__m128i x) {
+        __m128i a = _mm_shufflehi_epi16(
+            _mm_shufflelo_epi16(x, _MM_SHUFFLE(3, 3, 3, 3)),
+            _MM_SHUFFLE(3, 3, 3, 3));
+        a = _mm_or_si128(_mm_and_si128(a, color), opaque);
+        x = _mm_add_epi16(_mm_mullo_epi16(x, a), round);
+        return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+    };
+    for (; i + 4 <= n; i += 4, src += 16, dst += 16) {
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+        __m128i lo = mul(_mm_unpacklo_epi8(p, zero));
+        __m128i hi = mul(_mm_unpackhi_epi8(p, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst),
+                         _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; i < n; ++i, src += 4, dst += 4) {
+        const uint32_t a = src[3];
+        for (int ch = 0; ch < 3; ++ch) {
+            dst[ch] = uint8_t(div255(src[ch] * a));
+        }
+        dst[3] = uint8_t(a);
+    }
+}
+
+void unpremultiply_row(const uint8_t *src, uint8_t *dst, uint32_t n) {
+    static const auto scale = []() {
+        std::array<float, 256> scale{};
+        for (uint32_t a = 1; a < 256; ++a) {
+            scale[a] = 255.0f / float(a);
+        }
+        return scale;
+    }();
+    for (uint32_t i = 0; i < n; ++i, src += 4, dst += 4) {
+        const uint8_t a = src[3];
+        if (a == 255) {
+            std::memmove(dst, src, 4);
+        } else if (a == 0) {
+            std::memset(dst, 0, 4);
+        } else {
+            auto k = scale[a];
+            (Px::load(src) * Px::set(k, k, k, 1)).store(dst);
+        }
+    }
+}
+
+void color_matrix_row(const uint8_t *src, uint8_t *dst, uint32_t n,
+                      const Px (&column)[5]) {
+    for (uint32_t i = 0; i < n; ++i, src += 4, dst += 4) {
+        auto p = Px::load(src);
+        (column[0] * p.lane<0>() + column[1] * p.lane<1>() +
+         column[2] * p.lane<2>() + column[3] * p.lane<3>() + column[4])
+            .store(dst);
+    }
+}
+
+// sliding window of 2 * radius + 1 pixels, edges repeated
+void box_row(const uint8_t *src, uint8_t *dst, uint32_t width,
+             uint32_t radius) {
+    const float inv = 1.0f / float(2 * radius + 1);
+    auto px = [src, width](int64_t x) {
+        return Sum::load(src + 4 * clamp_x(x, width));
+    };
+    auto sum = Sum::zero();
+    for (int64_t k = -int64_t(radius); k <= int64_t(radius); ++k) {
+        sum = sum + px(k);
+    }
+    for (uint32_t x = 0; x < width; ++x, dst += 4) {
+        (sum.px() * inv).store(dst);
+        sum = sum + px(int64_t(x) + radius + 1) - px(int64_t(x) - radius);
+    }
+}
+
+// columns [x0, x1) of box_row turned vertical, one running sum per pixel
+void box_columns(const Plane &src, const Plane &dst, uint32_t x0, uint32_t x1,
+                 uint32_t radius) {
+    const float inv = 1.0f / float(2 * radius + 1);
+    const uint32_t n = x1 - x0;
+    std::vector<uint32_t> sums(size_t(n) * 4, 0);
+    for (int64_t k = -int64_t(radius); k <= int64_t(radius); ++k) {
+        auto row = src.row(k) + size_t(x0) * 4;
+        for (uint32_t x = 0; x < n; ++x) {
+            (Sum::get(&sums[x * 4]) + Sum::load(row + x * 4)).put(&sums[x * 4]);
+        }
+    }
+    for (uint32_t y = 0; y < dst.height; ++y) {
+        auto out = dst.row(y) + size_t(x0) * 4;
+        auto in = src.row(int64_t(y) + radius + 1) + size_t(x0) * 4;
+        auto off = src.row(int64_t(y) - radius) + size_t(x0) * 4;
+        for (uint32_t x = 0; x < n; ++x) {
+            auto sum = Sum::get(&sums[x * 4]);
+            (sum.px() * inv).store(out + x * 4);
+            (sum + Sum::load(in + x * 4) - Sum::load(off + x * 4))
+                .put(&sums[x * 4]);
+        }
+    }
+}
+
+// kernel holds the weights of offsets 0..radius, the same both ways
+void gaussian_row(const uint8_t *src, float *dst, uint32_t width,
+                  const std::vector<float> &kernel) {
+    const auto radius = int64_t(kernel.size()) - 1;
+    // the row in floats with its edges repeated, so no tap is clamped
+    thread_local std::vector<float> padded;
+    padded.resize(size_t(width + 2 * radius) * 4);
+    for (int64_t x = -radius; x < int64_t(width) + radius; ++x) {
+        Px::load(src + 4 * clamp_x(x, width))
+            .put(&padded[size_t(x + radius) * 4]);
+    }
+    for (uint32_t x = 0; x < width; ++x, dst += 4) {
+        auto center = &padded[size_t(x + radius) * 4];
+        auto acc = Px::get(center) * kernel[0];
+        for (int64_t k = 1; k <= radius; ++k) {
+            acc = acc + (Px::get(center - 4 * k) + Px::get(center + 4 * k)) *
+                            kernel[size_t(k)];
+        }
+        acc.put(dst);
+    }
+}
+
+void gaussian_columns(const float *src, uint32_t height, size_t stride,
+                      const Plane &dst, uint32_t x0, uint32_t x1,
+                      const std::vector<float> &kernel) {
+    const auto radius = int64_t(kernel.size()) - 1;
+    auto row = [src, height, stride, x0](int64_t y) {
+        y = std::clamp<int64_t>(y, 0, int64_t(height) - 1);
+        return src + size_t(y) * stride + size_t(x0) * 4;
+    };
+    const uint32_t n = x1 - x0;
+    // the strip of the output row, tap by tap
+    std::vector<float> acc(size_t(n) * 4);
+    for (uint32_t y = 0; y < height; ++y) {
+        auto center = row(y);
+        for (uint32_t x = 0; x < n; ++x) {
+            (Px::get(center + x * 4) * kernel[0]).put(&acc[x * 4]);
+        }
+        for (int64_t k = 1; k <= radius; ++k) {
+            auto up = row(int64_t(y) - k);
+            auto down = row(int64_t(y) + k);
+            const float w = kernel[size_t(k)];
+            for (uint32_t x = 0; x < n; ++x) {
+                (Px::get(&acc[x * 4]) +
+                 (Px::get(up + x * 4) + Px::get(down + x * 4)) * w)
+                    .put(&acc[x * 4]);
+            }
+        }
+        auto out = dst.row(y) + size_t(x0) * 4;
+        for (uint32_t x = 0; x < n; ++x) {
+            Px::get(&acc[x * 4]).store(out + x * 4);
+        }
+    }
+}
+
+// weights of offsets 0..ceil(3 sigma), summing to 1 over both sides
+std::vector<float> gaussian_kernel(float sigma) {
+    auto radius = int64_t(std::ceil(3 * sigma));
+    std::vector<float> kernel(size_t(radius + 1));
+    float total = 0;
+    for (int64_t k = 0; k <= radius; ++k) {
+        auto w = std::exp(-float(k * k) / (2 * sigma * sigma));
+        kernel[size_t(k)] = w;
+        total += k ? 2 * w : w;
+    }
+    for (auto &w : kernel) {
+        w /= total;
+    }
+    return kernel;
+}
+
+/**
+ * @brief      radii of three box blurs approximating a gaussian of sigma
+ *
+ * Box widths are the odd integers around the ideal one, mixed so that the
+ * variances add up to sigma^2.
+ */
+std::array<uint32_t, 3> box_radii(float sigma) {
+    constexpr int n = 3;
+    const double variance = 12.0 * double(sigma) * double(sigma);
+    auto lower = int(std::floor(std::sqrt(variance / n + 1)));
+    if (lower % 2 == 0) {
+        --lower;
+    }
+    auto m = int(std::lround((variance - n * lower * lower - 4 * n * lower -
+                              3 * n) /
+                             (-4.0 * lower - 4)));
+    std::array<uint32_t, 3> radii{};
+    for (int i = 0; i < n; ++i) {
+        auto width = i < m ? lower : lower + 2;
+        radii[size_t(i)] = uint32_t(std::max(0, (width - 1) / 2));
+    }
+    return radii;
+}
+
+void copy(const Plane &src, const Plane &dst) {
+    if (src.pixels == dst.pixels) {
+        return;
+    }
+    for (uint32_t y = 0; y < src.height; ++y) {
+        std::memcpy(dst.row(y), src.row(y), size_t(src.width) * 4);
+    }
+}
+
+} // namespace
+
+ColorMatrix ColorMatrix::saturation(float s) {
+    // Rec. 709 luma
+    const float r = 0.2126f * (1 - s);
+    const float g = 0.7152f * (1 - s);
+    const float b = 0.0722f * (1 - s);
+    return {{r + s, g, b, 0, 0, //
+             r, g + s, b, 0, 0, //
+             r, g, b + s, 0, 0, //
+             0, 0, 0, 1, 0}};
+}
+
+ColorMatrix ColorMatrix::tint(const ColorRGBAub &col, float amount) {
+    const float k = 1 - amount;
+    return {{k, 0, 0, 0, col.r / 255.0f * amount, //
+             0, k, 0, 0, col.g / 255.0f * amount, //
+             0, 0, k, 0, col.b / 255.0f * amount, //
+             0, 0, 0, 1, 0}};
+}
+
+ColorMatrix ColorMatrix::operator*(const ColorMatrix &other) const {
+    ColorMatrix result;
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 5; ++j) {
+            float v = j == 4 ? this->m[i * 5 + 4] : 0;
+            for (int k = 0; k < 4; ++k) {
+                v += this->m[i * 5 + k] * other.m[k * 5 + j];
+            }
+            result.m[i * 5 + j] = v;
+        }
+    }
+    return result;
+}
+
+size_t ImageEffects::KeyHash::operator()(const Key &key) const {
+    size_t seed = boost::hash<uuid>()(key.id);
+    for (const auto &effect : key.effects) {
+        boost::hash_combine(seed, int(effect.kind));
+        boost::hash_combine(seed, effect.radius);
+        if (effect.kind == ImageEffect::kColorMatrix) {
+            boost::hash_range(seed, effect.matrix.m.begin(),
+                              effect.matrix.m.end());
+        }
+    }
+    return seed;
+}
+
+ImageEffects::ImageEffects(const Options &options, Executor &executor)
+    : _options(options), _executor(executor),
+      _threads(std::max<uint32_t>(
+          1, options.threads ? options.threads
+                             : uint32_t(executor.concurrency()))) {}
+
+ImageEffects::~ImageEffects() {
+    this->_bytes_metric.add(-int64_t(this->_published_bytes));
+}
+
+void ImageEffects::_parallel_for(uint32_t count,
+                                 const std::function<void(uint32_t)> &job) {
+    parallel_for(this->_executor, count, this->_threads,
+                 [&job](size_t i) { job(uint32_t(i)); });
+}
+
+void ImageEffects::apply(const ImageEffect &effect,
+                         const RGBAImage::const_view_t &src,
+                         const RGBAImage::view_t &dst) {
+    MY_PROFILE_ZONE_C("render", "ImageEffects::apply");
+    if (src.dimensions() != dst.dimensions()) {
+        throw std::invalid_argument("effect source and target sizes differ");
+    }
+    auto in = plane(src);
+    auto out = plane(dst);
+    if (in.width == 0 || in.height == 0) {
+        return;
+    }
+
+    const uint32_t bands = (in.height + kBandRows - 1) / kBandRows;
+    auto rows = [&](auto &&kernel) {
+        this->_parallel_for(bands, [&](uint32_t band) {
+            auto end = std::min(in.height, (band + 1) * kBandRows);
+            for (auto y = band * kBandRows; y < end; ++y) {
+                kernel(in.row(y), out.row(y), in.width);
+            }
+        });
+    };
+
+    switch (effect.kind) {
+    case ImageEffect::kPremultiply:
+        rows(premultiply_row);
+        break;
+    case ImageEffect::kUnpremultiply:
+        rows(unpremultiply_row);
+        break;
+    case ImageEffect::kColorMatrix: {
+        const auto &m = effect.matrix.m;
+        Px column[5];
+        for (int j = 0; j < 4; ++j) {
+            column[j] = Px::set(m[j], m[5 + j], m[10 + j], m[15 + j]);
+        }
+        column[4] = Px::set(m[4], m[9], m[14], m[19]) * 255.0f;
+        rows([&column](const uint8_t *s, uint8_t *d, uint32_t n) {
+            color_matrix_row(s, d, n, column);
+        });
+        break;
+    }
+    case ImageEffect::kGaussianBlur:
+    case ImageEffect::kBoxBlur:
+        this->_blur(effect, src, dst);
+        break;
+    }
+}
+
+void ImageEffects::_blur(const ImageEffect &effect,
+                         const RGBAImage::const_view_t &src,
+                         const RGBAImage::view_t &dst) {
+    auto in = plane(src);
+    auto out = plane(dst);
+    if (effect.radius <= 0) {
+        copy(in, out);
+        return;
+    }
+    // one float per pixel holds the four bytes of the box passes, four the
+    // floats of the exact gaussian
+    const bool exact = effect.kind == ImageEffect::kGaussianBlur &&
+                       effect.radius <= kExactSigma;
+    auto buffer = this->_take_scratch(size_t(in.width) * in.height *
+                                      (exact ? 4 : 1));
+    Plane tmp{reinterpret_cast<uint8_t *>(buffer.data()), in.width,
+              in.height, size_t(in.width) * 4};
+
+    const uint32_t bands = (in.height + kBandRows - 1) / kBandRows;
+    const uint32_t strips = (in.width + kStripWidth - 1) / kStripWidth;
+    // rows of from into tmp, then columns of tmp into out
+    auto pass = [&](const Plane &from, auto &&row, auto &&columns) {
+        this->_parallel_for(bands, [&](uint32_t band) {
+            auto end = std::min(from.height, (band + 1) * kBandRows);
+            for (auto y = band * kBandRows; y < end; ++y) {
+                row(from.row(y), tmp.row(y), from.width);
+            }
+        });
+        this->_parallel_for(strips, [&](uint32_t strip) {
+            columns(tmp, out, strip * kStripWidth,
+                    std::min(out.width, (strip + 1) * kStripWidth));
+        });
+    };
+    auto box = [&](const Plane &from, uint32_t radius) {
+        pass(
+            from,
+            [radius](const uint8_t *s, uint8_t *d, uint32_t n) {
+                box_row(s, d, n, radius);
+            },
+            [radius](const Plane &s, const Plane &d, uint32_t x0,
+                     uint32_t x1) { box_columns(s, d, x0, x1, radius); });
+    };
+
+    if (effect.kind == ImageEffect::kBoxBlur) {
+        box(in, uint32_t(effect.radius));
+    } else if (exact) {
+        // float in between, rounding once keeps faint tails
+        auto kernel = gaussian_kernel(effect.radius);
+        const size_t stride = size_t(in.width) * 4;
+        auto rows = buffer.data();
+        this->_parallel_for(bands, [&](uint32_t band) {
+            auto end = std::min(in.height, (band + 1) * kBandRows);
+            for (auto y = band * kBandRows; y < end; ++y) {
+                gaussian_row(in.row(y), &rows[y * stride], in.width, kernel);
+            }
+        });
+        this->_parallel_for(strips, [&](uint32_t strip) {
+            gaussian_columns(rows, in.height, stride, out,
+                             strip * kStripWidth,
+                             std::min(out.width, (strip + 1) * kStripWidth),
+                             kernel);
+        });
+    } else {
+        auto radii = box_radii(effect.radius);
+        box(in, radii[0]);
+        box(out, radii[1]);
+        box(out, radii[2]);
+    }
+    this->_give_scratch(std::move(buffer));
+}
+
+std::vector<float> ImageEffects::_take_scratch(size_t size) {
+    std::vector<float> buffer;
+    {
+        std::unique_lock<std::mutex> l_lock(this->_lock);
+        if (!this->_scratch.empty()) {
+            buffer = std::move(this->_scratch.back());
+            this->_scratch.pop_back();
+        }
+    }
+    buffer.resize(size);
+    return buffer;
+}
+
+void ImageEffects::_give_scratch(std::vector<float> buffer) {
+    std::unique_lock<std::mutex> l_lock(this->_lock);
+    if (this->_scratch.size() < kScratchBuffers) {
+        this->_scratch.push_back(std::move(buffer));
+    }
+}
+
+std::shared_ptr<const RGBAImage>
+ImageEffects::apply(const uuid &id, const RGBAImage::const_view_t &src,
+                    const std::vector<ImageEffect> &effects) {
+    Key key{id, effects};
+    {
+        std::unique_lock<std::mutex> l_lock(this->_lock);
+        auto it = this->_index.find(key);
+        if (it != this->_index.end()) {
+            this->_entries.splice(this->_entries.begin(), this->_entries,
+                                  it->second);
+            ++this->_hits;
+            this->_hits_metric.add();
+            return it->second->image;
+        }
+        ++this->_misses;
+        this->_misses_metric.add();
+    }
+
+    auto image = std::make_shared<RGBAImage>(src.width(), src.height());
+    auto view = boost::gil::view(*image);
+    boost::gil::copy_pixels(src, view);
+    for (const auto &effect : effects) {
+        this->apply(effect, boost::gil::const_view(*image), view);
+    }
+
+    const size_t bytes = size_t(src.width()) * size_t(src.height()) * 4;
+    std::unique_lock<std::mutex> l_lock(this->_lock);
+    auto it = this->_index.find(key);
+    if (it != this->_index.end()) {
+        // computed meanwhile by another thread
+        return it->second->image;
+    }
+    if (bytes > this->_options.cache_bytes) {
+        return image;
+    }
+    this->_evict(bytes);
+    this->_entries.push_front({key, image, bytes});
+    this->_index.emplace(std::move(key), this->_entries.begin());
+    this->_bytes += bytes;
+    this->_publish_bytes();
+    return image;
+}
+
+void ImageEffects::_evict(size_t bytes) {
+    while (!this->_entries.empty() &&
+           this->_bytes + bytes > this->_options.cache_bytes) {
+        auto &last = this->_entries.back();
+        this->_bytes -= last.bytes;
+        this->_index.erase(last.key);
+        this->_entries.pop_back();
+        ++this->_evictions;
+        this->_evictions_metric.add();
+    }
+}
+
+void ImageEffects::clear() {
+    std::unique_lock<std::mutex> l_lock(this->_lock);
+    this->_index.clear();
+    this->_entries.clear();
+    this->_scratch.clear();
+    this->_bytes = 0;
+    this->_publish_bytes();
+}
+
+void ImageEffects::_publish_bytes() {
+    this->_bytes_metric.add(int64_t(this->_bytes) -
+                            int64_t(this->_published_bytes));
+    this->_published_bytes = this->_bytes;
+}
+
+ImageEffects::Stats ImageEffects::stats() const {
+    std::unique_lock<std::mutex> l_lock(this->_lock);
+    return {this->_hits, this->_misses, this->_evictions,
+            this->_entries.size(), this->_bytes};
+}
+
+} // namespace my
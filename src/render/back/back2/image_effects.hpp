@@ -0,0 +1,212 @@
+#pragma once
+
+#include <array>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include <core/executor.hpp>
+#include <core/metrics.hpp>
+#include <render/back/back2/basic_canvas.hpp>
+#include <util/uuid.hpp>
+
+namespace my {
+
+/**
+ * @brief      4x5 matrix mapping straight alpha RGBA to RGBA
+ *
+ * Row major like Skia's: row i computes channel i from (r, g, b, a, 1),
+ * colors in 0..1, so the fifth column is a translation in 0..1.
+ */
+struct ColorMatrix {
+    std::array<float, 20> m{1, 0, 0, 0, 0, //
+                            0, 1, 0, 0, 0, //
+                            0, 0, 1, 0, 0, //
+                            0, 0, 0, 1, 0};
+
+    /**
+     * @brief      0 is grayscale, 1 the identity, above 1 oversaturates
+     */
+    static ColorMatrix saturation(float s);
+
+    /**
+     * @brief      blend the color channels towards col by amount in 0..1,
+     *             alpha is kept
+     */
+    static ColorMatrix tint(const ColorRGBAub &col, float amount);
+
+    /**
+     * @brief      this applied after other
+     */
+    ColorMatrix operator*(const ColorMatrix &other) const;
+
+    bool operator==(const ColorMatrix &other) const {
+        return this->m == other.m;
+    }
+};
+
+/**
+ * @brief      one step of ImageEffects, built by the factories
+ */
+struct ImageEffect {
+    enum Kind : uint8_t {
+        kGaussianBlur,
+        kBoxBlur,
+        kColorMatrix,
+        kPremultiply,
+        kUnpremultiply,
+    };
+
+    Kind kind{kPremultiply};
+    // gaussian: the standard deviation, box: the radius in pixels
+    float radius{0};
+    ColorMatrix matrix;
+
+    /**
+     * @brief      blur premultiplied pixels, or colors bleed from
+     *             transparent ones
+     */
+    static ImageEffect gaussian_blur(float sigma) {
+        return {kGaussianBlur, sigma, {}};
+    }
+    static ImageEffect box_blur(uint32_t radius) {
+        return {kBoxBlur, float(radius), {}};
+    }
+    static ImageEffect color_matrix(const ColorMatrix &matrix) {
+        return {kColorMatrix, 0, matrix};
+    }
+    static ImageEffect premultiply() { return {kPremultiply, 0, {}}; }
+    static ImageEffect unpremultiply() { return {kUnpremultiply, 0, {}}; }
+
+    bool operator==(const ImageEffect &other) const {
+        return this->kind == other.kind && this->radius == other.radius &&
+               this->matrix == other.matrix;
+    }
+};
+
+/**
+ * @brief      blur and color effects on RGBA8 images on the CPU
+ *
+ * Blurs are separable: a horizontal pass over row bands, then a vertical
+ * pass over column strips, each band or strip one job on the executor
+ * with the caller taking part. Small gaussians use an exact kernel, wider
+ * ones three box blurs of matching variance, whose cost does not grow
+ * with the radius. Kernels process a pixel per SSE register when
+ * available. Results of apply() with an image id are kept in a cache
+ * bounded in bytes, least recently used first out. Thread-safe.
+ */
+class ImageEffects {
+  public:
+    // above this sigma gaussians are approximated by box blurs, as Skia does
+    static constexpr float kExactSigma = 2.0f;
+
+    struct Options {
+        // jobs run at once including the caller, 0 uses the executor's
+        // concurrency
+        uint32_t threads{0};
+        // results kept by apply() with an id
+        size_t cache_bytes{64 << 20};
+    };
+
+    struct Stats {
+        uint64_t hits{};
+        uint64_t misses{};
+        uint64_t evictions{};
+        size_t entries{};
+        size_t bytes{};
+    };
+
+    ImageEffects() : ImageEffects(Options{}) {}
+    explicit ImageEffects(const Options &options,
+                          Executor &executor = *Executor::shared());
+    ~ImageEffects();
+
+    ImageEffects(const ImageEffects &) = delete;
+    ImageEffects &operator=(const ImageEffects &) = delete;
+
+    const Options &options() const { return this->_options; }
+
+    /**
+     * @brief      run effect from src into dst of the same size, src and dst
+     *             may be the same pixels
+     */
+    void apply(const ImageEffect &effect, const RGBAImage::const_view_t &src,
+               const RGBAImage::view_t &dst);
+
+    /**
+     * @brief      effects in order on a copy of src, cached by id and effects
+     *
+     * @param      id    names the pixels of src, e.g. Resource::id(); a new
+     *                   content needs a new id
+     */
+    std::shared_ptr<const RGBAImage>
+    apply(const uuid &id, const RGBAImage::const_view_t &src,
+          const std::vector<ImageEffect> &effects);
+
+    void clear();
+
+    Stats stats() const;
+
+  private:
+    struct Key {
+        uuid id;
+        std::vector<ImageEffect> effects;
+
+        bool operator==(const Key &other) const {
+            return this->id == other.id && this->effects == other.effects;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key &key) const;
+    };
+
+    struct Entry {
+        Key key;
+        std::shared_ptr<const RGBAImage> image;
+        size_t bytes;
+    };
+
+    Options _options;
+    Executor &_executor;
+    uint32_t _threads;
+
+    mutable std::mutex _lock;
+    // most recently used first
+    std::list<Entry> _entries;
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> _index;
+    size_t _bytes{0};
+    uint64_t _hits{0};
+    uint64_t _misses{0};
+    uint64_t _evictions{0};
+    // buffers of finished blurs, a fresh one would fault in every page
+    std::vector<std::vector<float>> _scratch;
+
+    Counter &_hits_metric{Metrics::get()->counter("render.effect_hits")};
+    Counter &_misses_metric{Metrics::get()->counter("render.effect_misses")};
+    Counter &_evictions_metric{
+        Metrics::get()->counter("render.effect_evictions")};
+    // instances add up, each publishes the change of its own bytes
+    Gauge &_bytes_metric{Metrics::get()->gauge("render.effect_bytes")};
+    size_t _published_bytes{0};
+
+    /**
+     * @brief      job(i) for i in [0, count), on up to _threads threads
+     */
+    void _parallel_for(uint32_t count,
+                       const std::function<void(uint32_t)> &job);
+
+    // call with _lock held
+    void _publish_bytes();
+
+    void _blur(const ImageEffect &effect, const RGBAImage::const_view_t &src,
+               const RGBAImage::view_t &dst);
+
+    std::vector<float> _take_scratch(size_t size);
+    void _give_scratch(std::vector<float> buffer);
+
+    // under _lock
+    void _evict(size_t bytes);
+};
+
+} // namespace my
@@ -0,0 +1,759 @@
+#include "path_tessellator.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace my {
+
+namespace {
+constexpr float kPI = 3.14159265358979323846f;
+constexpr float kEpsilon = 1e-4f;
+constexpr int kMaxCurveSegments = 256;
+
+inline glm::vec2 normal_of(const glm::vec2 &d) { return {-d.y, d.x}; }
+
+inline float cross_of(const glm::vec2 &a, const glm::vec2 &b) {
+    return a.x * b.y - a.y * b.x;
+}
+
+inline glm::vec2 direction(const glm::vec2 &a, const glm::vec2 &b) {
+    auto d = b - a;
+    float len = glm::length(d);
+    return len > 0.0f ? d / len : glm::vec2{1.0f, 0.0f};
+}
+
+inline ColorRGBAub transparent(ColorRGBAub col) {
+    col.a = 0;
+    return col;
+}
+
+inline void push_quad(std::vector<uint32_t> &idx, uint32_t a, uint32_t b,
+                      uint32_t c, uint32_t d) {
+    idx.insert(idx.end(), {a, b, c, a, c, d});
+}
+} // namespace
+
+//
+// flatten
+//
+
+void PathTessellator::_add_point(const glm::vec2 &p) {
+    auto &contour = this->_contours.back();
+    if (contour.size() != 0) {
+        auto d = p - this->_pts.back();
+        if (std::abs(d.x) < kEpsilon && std::abs(d.y) < kEpsilon) {
+            return;
+        }
+    }
+    this->_pts.push_back(p);
+    ++contour.end;
+}
+
+void PathTessellator::_end_contour(bool closed) {
+    if (this->_contours.empty()) {
+        return;
+    }
+    auto &contour = this->_contours.back();
+    if (closed && contour.size() > 1) {
+        auto d = this->_pts[contour.begin] - this->_pts.back();
+        if (std::abs(d.x) < kEpsilon && std::abs(d.y) < kEpsilon) {
+            this->_pts.pop_back();
+            --contour.end;
+        }
+    }
+    contour.closed = closed;
+    if (contour.size() < 2) {
+        this->_pts.resize(contour.begin);
+        this->_contours.pop_back();
+    }
+}
+
+void PathTessellator::_flatten(const DrawPath &path) {
+    this->_pts.clear();
+    this->_contours.clear();
+
+    const float tol = std::max(this->_options.tolerance, 1e-3f);
+    const auto &points = path._points;
+    size_t pi = 0;
+    bool open = false;
+
+    auto subdivisions = [tol](float dd, float factor) {
+        int n = static_cast<int>(std::ceil(std::sqrt(factor * dd / tol)));
+        return std::clamp(n, 1, kMaxCurveSegments);
+    };
+
+    for (auto verb : path._verbs) {
+        switch (verb) {
+        case DrawPath::Verb::kMove: {
+            if (open) {
+                this->_end_contour(false);
+            }
+            auto begin = static_cast<uint32_t>(this->_pts.size());
+            this->_contours.push_back({begin, begin, false});
+            open = true;
+            this->_add_point(points[pi++]);
+            break;
+        }
+        case DrawPath::Verb::kLine:
+            this->_add_point(points[pi++]);
+            break;
+        case DrawPath::Verb::kQuad: {
+            const auto p0 = points[pi - 1];
+            const auto p1 = points[pi];
+            const auto p2 = points[pi + 1];
+            pi += 2;
+            // Wang's formula: n = sqrt(d(d-1)/8 * |max 2nd difference| / tol)
+            int n = subdivisions(glm::length(p0 - 2.0f * p1 + p2), 0.25f);
+            for (int i = 1; i <= n; ++i) {
+                float t = static_cast<float>(i) / n;
+                float mt = 1.0f - t;
+                this->_add_point(mt * mt * p0 + 2.0f * mt * t * p1 +
+                                 t * t * p2);
+            }
+            break;
+        }
+        case DrawPath::Verb::kCubic: {
+            const auto p0 = points[pi - 1];
+            const auto p1 = points[pi];
+            const auto p2 = points[pi + 1];
+            const auto p3 = points[pi + 2];
+            pi += 3;
+            float dd = std::max(glm::length(p0 - 2.0f * p1 + p2),
+                                glm::length(p1 - 2.0f * p2 + p3));
+            int n = subdivisions(dd, 0.75f);
+            for (int i = 1; i <= n; ++i) {
+                float t = static_cast<float>(i) / n;
+                float mt = 1.0f - t;
+                this->_add_point(mt * mt * mt * p0 + 3.0f * mt * mt * t * p1 +
+                                 3.0f * mt * t * t * p2 + t * t * t * p3);
+            }
+            break;
+        }
+        case DrawPath::Verb::kClose:
+            this->_end_contour(true);
+            open = false;
+            break;
+        }
+    }
+    if (open) {
+        this->_end_contour(false);
+    }
+}
+
+int PathTessellator::_arc_segments(float radius, float angle) const {
+    float tol = std::max(this->_options.tolerance, 1e-3f);
+    if (radius <= tol) {
+        return 1;
+    }
+    float step = 2.0f * std::acos(1.0f - tol / radius);
+    return std::clamp(static_cast<int>(std::ceil(std::abs(angle) / step)), 1,
+                      kMaxCurveSegments);
+}
+
+//
+// stroke
+//
+
+void PathTessellator::stroke(const DrawPath &path, const ColorRGBAub &col,
+                             const StrokeStyle &style,
+                             std::vector<DrawVert> &vtx,
+                             std::vector<uint32_t> &idx) {
+    this->_flatten(path);
+
+    float hw = style.width * 0.5f;
+    ColorRGBAub color = col;
+    const float aa = this->_options.aa_width;
+    if (aa > 0.0f && style.width < aa) {
+        // hairline: keep the geometry one feather wide and fade the coverage
+        color.a = static_cast<uint8_t>(color.a * (style.width / aa));
+        hw = aa * 0.5f;
+    }
+    if (hw <= 0.0f) {
+        return;
+    }
+
+    for (const auto &contour : this->_contours) {
+        this->_ribs.clear();
+        this->_stroke_contour(contour, hw, style);
+        this->_emit_ribs(contour.closed && contour.size() > 2, hw, color, vtx,
+                         idx);
+    }
+}
+
+void PathTessellator::_add_cap(const glm::vec2 &p, const glm::vec2 &d,
+                               float hw, LineCap cap, bool start) {
+    const auto n = normal_of(d);
+    const float aa = this->_options.aa_width;
+    // caps point backwards at the start of a contour and forwards at the end
+    const glm::vec2 out = start ? -d : d;
+
+    switch (cap) {
+    case LineCap::kRound: {
+        int segments = this->_arc_segments(hw, kPI * 0.5f);
+        for (int i = 0; i <= segments; ++i) {
+            float t = static_cast<float>(i) / segments;
+            float phi = (start ? t : 1.0f - t) * kPI * 0.5f;
+            auto along = out * (std::cos(phi) * hw);
+            auto side = n * (std::sin(phi) * hw);
+            this->_ribs.push_back({p, along + side, along - side});
+        }
+        return;
+    }
+    case LineCap::kButt:
+    case LineCap::kSquare: {
+        auto center = cap == LineCap::kSquare ? p + out * hw : p;
+        Rib rib{center, n * hw, -n * hw};
+        Rib fade{center + out * aa, n * hw, -n * hw, true};
+        if (start) {
+            if (aa > 0.0f)
+                this->_ribs.push_back(fade);
+            this->_ribs.push_back(rib);
+        } else {
+            this->_ribs.push_back(rib);
+            if (aa > 0.0f)
+                this->_ribs.push_back(fade);
+        }
+        return;
+    }
+    }
+}
+
+void PathTessellator::_add_join(const glm::vec2 &p, const glm::vec2 &d0,
+                                const glm::vec2 &d1, float hw, float max_inner,
+                                const StrokeStyle &style) {
+    const auto n0 = normal_of(d0);
+    const auto n1 = normal_of(d1);
+    const float cross = cross_of(d0, d1);
+    const float denom = 1.0f + glm::dot(n0, n1);
+
+    if (std::abs(cross) < kEpsilon && glm::dot(d0, d1) > 0.0f) {
+        this->_ribs.push_back({p, n0 * hw, -n0 * hw});
+        return;
+    }
+
+    // miter vector, scaled so that dot(miter, n0) == 1
+    glm::vec2 miter = denom > 1e-3f ? (n0 + n1) / denom : glm::vec2{0.0f};
+    float miter_len = glm::length(miter);
+
+    // inner corner: shared by both segments, clamped for short segments
+    glm::vec2 inner = miter * hw;
+    if (miter_len * hw > max_inner) {
+        inner = miter_len > 0.0f ? miter * (max_inner / miter_len)
+                                 : glm::vec2{0.0f};
+    }
+
+    // turning towards the normal side makes the opposite side the outer one
+    const bool outer_right = cross > 0.0f;
+    auto push = [this, &p, outer_right](const glm::vec2 &in,
+                                        const glm::vec2 &out) {
+        if (outer_right) {
+            this->_ribs.push_back({p, in, out});
+        } else {
+            this->_ribs.push_back({p, out, in});
+        }
+    };
+    const float side = outer_right ? -1.0f : 1.0f;
+    inner *= outer_right ? 1.0f : -1.0f;
+
+    switch (style.join) {
+    case LineJoin::kMiter:
+        if (denom > 1e-3f && miter_len <= style.miter_limit) {
+            push(inner, miter * (side * hw));
+            return;
+        }
+        [[fallthrough]];
+    case LineJoin::kBevel:
+        push(inner, n0 * (side * hw));
+        push(inner, n1 * (side * hw));
+        return;
+    case LineJoin::kRound: {
+        float a0 = std::atan2(side * n0.y, side * n0.x);
+        float a1 = std::atan2(side * n1.y, side * n1.x);
+        float sweep = a1 - a0;
+        if (sweep > kPI)
+            sweep -= 2.0f * kPI;
+        if (sweep < -kPI)
+            sweep += 2.0f * kPI;
+        int segments = this->_arc_segments(hw, sweep);
+        for (int i = 0; i <= segments; ++i) {
+            float a = a0 + sweep * i / segments;
+            push(inner, glm::vec2{std::cos(a), std::sin(a)} * hw);
+        }
+        return;
+    }
+    }
+}
+
+void PathTessellator::_stroke_contour(const Contour &contour, float hw,
+                                      const StrokeStyle &style) {
+    const auto *pts = this->_pts.data() + contour.begin;
+    const uint32_t n = contour.size();
+    const bool closed = contour.closed && n > 2;
+
+    auto seg_len = [pts, n](uint32_t i) {
+        return glm::length(pts[(i + 1) % n] - pts[i]);
+    };
+
+    if (!closed) {
+        this->_add_cap(pts[0], direction(pts[0], pts[1]), hw, style.cap, true);
+    }
+
+    uint32_t first = closed ? 0 : 1;
+    uint32_t last = closed ? n : n - 1;
+    for (uint32_t i = first; i < last; ++i) {
+        uint32_t prev = (i + n - 1) % n;
+        uint32_t next = (i + 1) % n;
+        float max_inner = std::min(seg_len(prev), seg_len(i));
+        this->_add_join(pts[i], direction(pts[prev], pts[i]),
+                        direction(pts[i], pts[next]), hw,
+                        std::max(max_inner, hw), style);
+    }
+
+    if (!closed) {
+        this->_add_cap(pts[n - 1], direction(pts[n - 2], pts[n - 1]), hw,
+                       style.cap, false);
+    }
+}
+
+void PathTessellator::_emit_ribs(bool closed, float hw,
+                                 const ColorRGBAub &col,
+                                 std::vector<DrawVert> &vtx,
+                                 std::vector<uint32_t> &idx) {
+    const auto &ribs = this->_ribs;
+    if (ribs.size() < 2) {
+        return;
+    }
+
+    const float aa = this->_options.aa_width;
+    const auto clear = transparent(col);
+    const auto base = static_cast<uint32_t>(vtx.size());
+
+    if (aa <= 0.0f) {
+        for (const auto &rib : ribs) {
+            auto c = rib.faded ? clear : col;
+            vtx.push_back({rib.center + rib.left, this->_uv, c});
+            vtx.push_back({rib.center + rib.right, this->_uv, c});
+        }
+        auto count = static_cast<uint32_t>(ribs.size());
+        uint32_t segments = closed ? count : count - 1;
+        for (uint32_t i = 0; i < segments; ++i) {
+            uint32_t a = base + i * 2;
+            uint32_t b = base + ((i + 1) % count) * 2;
+            push_quad(idx, a, a + 1, b + 1, b);
+        }
+        return;
+    }
+
+    // [outer left fringe, left, right, outer right fringe] per rib
+    const float core = std::max(hw - aa * 0.5f, 0.0f) / hw;
+    const float fringe = (hw + aa * 0.5f) / hw;
+    for (const auto &rib : ribs) {
+        auto c = rib.faded ? clear : col;
+        vtx.push_back({rib.center + rib.left * fringe, this->_uv, clear});
+        vtx.push_back({rib.center + rib.left * core, this->_uv, c});
+        vtx.push_back({rib.center + rib.right * core, this->_uv, c});
+        vtx.push_back({rib.center + rib.right * fringe, this->_uv, clear});
+    }
+    auto count = static_cast<uint32_t>(ribs.size());
+    uint32_t segments = closed ? count : count - 1;
+    for (uint32_t i = 0; i < segments; ++i) {
+        uint32_t a = base + i * 4;
+        uint32_t b = base + ((i + 1) % count) * 4;
+        push_quad(idx, a, a + 1, b + 1, b);
+        push_quad(idx, a + 1, a + 2, b + 2, b + 1);
+        push_quad(idx, a + 2, a + 3, b + 3, b + 2);
+    }
+}
+
+//
+// fill
+//
+
+void PathTessellator::fill(const DrawPath &path, const ColorRGBAub &col,
+                           FillRule rule, std::vector<DrawVert> &vtx,
+                           std::vector<uint32_t> &idx) {
+    this->_flatten(path);
+
+    // a fill implicitly closes every contour
+    this->_contours.erase(
+        std::remove_if(this->_contours.begin(), this->_contours.end(),
+                       [](const Contour &c) { return c.size() < 3; }),
+        this->_contours.end());
+    if (this->_contours.empty()) {
+        return;
+    }
+
+    const bool aa = this->_options.aa_width > 0.0f;
+    const bool convex =
+        this->_contours.size() == 1 && this->_is_convex(this->_contours[0]);
+    if (aa) {
+        // the fringe fades out from aa/2 inside the outline to aa/2 outside
+        // it, the solid core is inset to meet it
+        this->_build_edges();
+        this->_fringe_outline(rule);
+        for (size_t i = 0; i < this->_pts.size(); ++i) {
+            this->_pts[i] -= this->_outsets[i];
+        }
+    }
+    if (convex) {
+        this->_fill_convex(this->_contours[0], col, vtx, idx);
+    } else {
+        this->_build_edges();
+        this->_fill_slabs(rule, col, vtx, idx);
+    }
+    if (aa) {
+        this->_fill_fringe(col, vtx, idx);
+    }
+}
+
+void PathTessellator::_build_edges() {
+    auto &edges = this->_edges;
+    auto &ys = this->_ys;
+    edges.clear();
+    ys.clear();
+
+    for (const auto &contour : this->_contours) {
+        const auto *pts = this->_pts.data() + contour.begin;
+        const uint32_t n = contour.size();
+        for (uint32_t i = 0; i < n; ++i) {
+            auto a = pts[i];
+            auto b = pts[(i + 1) % n];
+            ys.push_back(a.y);
+            if (std::abs(b.y - a.y) < kEpsilon) {
+                continue;
+            }
+            int winding = 1;
+            if (a.y > b.y) {
+                std::swap(a, b);
+                winding = -1;
+            }
+            edges.push_back({a, b, winding, (b.x - a.x) / (b.y - a.y)});
+        }
+    }
+}
+
+bool PathTessellator::_is_convex(const Contour &contour) const {
+    const auto *pts = this->_pts.data() + contour.begin;
+    const uint32_t n = contour.size();
+
+    int sign = 0;
+    int x_flips = 0;
+    float prev_dx = 0.0f;
+    for (uint32_t i = 0; i < n; ++i) {
+        auto d0 = pts[(i + 1) % n] - pts[i];
+        auto d1 = pts[(i + 2) % n] - pts[(i + 1) % n];
+        float c = cross_of(d0, d1);
+        if (std::abs(c) > kEpsilon) {
+            int s = c > 0.0f ? 1 : -1;
+            if (sign != 0 && s != sign) {
+                return false;
+            }
+            sign = s;
+        }
+        // a simple convex polygon changes horizontal direction at most twice
+        if (std::abs(d0.x) > kEpsilon) {
+            if (prev_dx != 0.0f && (d0.x > 0.0f) != (prev_dx > 0.0f)) {
+                ++x_flips;
+            }
+            prev_dx = d0.x;
+        }
+    }
+    return x_flips <= 2;
+}
+
+void PathTessellator::_fill_convex(const Contour &contour,
+                                   const ColorRGBAub &col,
+                                   std::vector<DrawVert> &vtx,
+                                   std::vector<uint32_t> &idx) {
+    const auto base = static_cast<uint32_t>(vtx.size());
+    uint32_t top = 0;
+    for (uint32_t i = contour.begin; i < contour.end; ++i) {
+        vtx.push_back({this->_pts[i], this->_uv, col});
+        if (this->_pts[i].y < this->_pts[contour.begin + top].y) {
+            top = i - contour.begin;
+        }
+    }
+
+    // zig-zag down both sides from the topmost vertex instead of a fan:
+    // the triangles become short horizontal bands, which keeps the span
+    // count of scanline rasterizers proportional to the shape height
+    const uint32_t n = contour.size();
+    uint32_t left = 0;
+    uint32_t right = n - 1;
+    for (bool step_left = true; right - left > 1; step_left = !step_left) {
+        auto a = base + (top + left) % n;
+        auto b = base + (top + right) % n;
+        if (step_left) {
+            idx.insert(idx.end(), {a, base + (top + left + 1) % n, b});
+            ++left;
+        } else {
+            idx.insert(idx.end(), {a, base + (top + right - 1) % n, b});
+            --right;
+        }
+    }
+}
+
+void PathTessellator::_fill_slabs(FillRule rule, const ColorRGBAub &col,
+                                  std::vector<DrawVert> &vtx,
+                                  std::vector<uint32_t> &idx) {
+    auto &edges = this->_edges;
+    auto &ys = this->_ys;
+
+    std::sort(edges.begin(), edges.end(), [](const Edge &a, const Edge &b) {
+        return a.top.y < b.top.y;
+    });
+
+    // every crossing becomes a slab boundary, so edges never cross
+    // inside a slab and can be ordered by x once per slab
+    for (size_t i = 0; i < edges.size(); ++i) {
+        const auto &e0 = edges[i];
+        for (size_t j = i + 1;
+             j < edges.size() && edges[j].top.y < e0.bottom.y; ++j) {
+            const auto &e1 = edges[j];
+            float y0 = std::max(e0.top.y, e1.top.y);
+            float y1 = std::min(e0.bottom.y, e1.bottom.y);
+            if (y1 - y0 < kEpsilon) {
+                continue;
+            }
+            float d0 = e0.x_at(y0) - e1.x_at(y0);
+            float d1 = e0.x_at(y1) - e1.x_at(y1);
+            if ((d0 < 0.0f) != (d1 < 0.0f) && std::abs(d0 - d1) > 0.0f) {
+                ys.push_back(y0 + (y1 - y0) * (d0 / (d0 - d1)));
+            }
+        }
+    }
+
+    std::sort(ys.begin(), ys.end());
+    ys.erase(std::unique(ys.begin(), ys.end(),
+                         [](float a, float b) { return b - a < kEpsilon; }),
+             ys.end());
+
+    auto inside = [rule](int winding) {
+        return rule == FillRule::kNonZero ? winding != 0 : (winding & 1) != 0;
+    };
+
+    auto emit = [this, &col, &vtx, &idx](const Span &span, float bottom) {
+        const auto &l = this->_edges[span.left];
+        const auto &r = this->_edges[span.right];
+        const auto base = static_cast<uint32_t>(vtx.size());
+        vtx.push_back({{l.x_at(span.top), span.top}, this->_uv, col});
+        vtx.push_back({{r.x_at(span.top), span.top}, this->_uv, col});
+        vtx.push_back({{r.x_at(bottom), bottom}, this->_uv, col});
+        vtx.push_back({{l.x_at(bottom), bottom}, this->_uv, col});
+        push_quad(idx, base, base + 1, base + 2, base + 3);
+    };
+
+    auto &active = this->_active;
+    auto &spans = this->_spans;
+    auto &next_spans = this->_next_spans;
+    active.clear();
+    spans.clear();
+
+    size_t next_edge = 0;
+    for (size_t k = 0; k + 1 < ys.size(); ++k) {
+        const float top = ys[k];
+        const float bottom = ys[k + 1];
+        const float mid = (top + bottom) * 0.5f;
+
+        while (next_edge < edges.size() && edges[next_edge].top.y <= mid) {
+            active.push_back(static_cast<uint32_t>(next_edge++));
+        }
+        active.erase(std::remove_if(active.begin(), active.end(),
+                                    [&edges, mid](uint32_t e) {
+                                        return edges[e].bottom.y <= mid;
+                                    }),
+                     active.end());
+        std::sort(active.begin(), active.end(),
+                  [&edges, mid](uint32_t a, uint32_t b) {
+                      return edges[a].x_at(mid) < edges[b].x_at(mid);
+                  });
+
+        // trapezoids bounded by the same edge pair are merged vertically
+        next_spans.clear();
+        int winding = 0;
+        uint32_t left = 0;
+        for (auto e : active) {
+            bool was_inside = inside(winding);
+            winding += edges[e].winding;
+            bool is_inside = inside(winding);
+            if (!was_inside && is_inside) {
+                left = e;
+            } else if (was_inside && !is_inside) {
+                float span_top = top;
+                for (auto &span : spans) {
+                    if (span.alive && span.left == left && span.right == e) {
+                        span.alive = false;
+                        span_top = span.top;
+                        break;
+                    }
+                }
+                next_spans.push_back({left, e, span_top, true});
+            }
+        }
+        for (const auto &span : spans) {
+            if (span.alive) {
+                emit(span, top);
+            }
+        }
+        std::swap(spans, next_spans);
+    }
+    if (!ys.empty()) {
+        for (const auto &span : spans) {
+            emit(span, ys.back());
+        }
+    }
+}
+
+int PathTessellator::_winding_at(const glm::vec2 &p) const {
+    int winding = 0;
+    for (const auto &e : this->_edges) {
+        if (p.y < e.top.y || p.y >= e.bottom.y) {
+            continue;
+        }
+        if (e.x_at(p.y) > p.x) {
+            winding += e.winding;
+        }
+    }
+    return winding;
+}
+
+void PathTessellator::_fringe_outline(FillRule rule) {
+    const float half = this->_options.aa_width * 0.5f;
+    this->_outsets.resize(this->_pts.size());
+    this->_fringe.clear();
+
+    auto inside = [this, rule](const glm::vec2 &p) {
+        int w = this->_winding_at(p);
+        return rule == FillRule::kNonZero ? w != 0 : (w & 1) != 0;
+    };
+
+    for (const auto &contour : this->_contours) {
+        const auto *pts = this->_pts.data() + contour.begin;
+        const uint32_t n = contour.size();
+
+        // probe both sides of the longest edge to learn which side is filled
+        uint32_t longest = 0;
+        float longest_len = 0.0f;
+        float area = 0.0f;
+        for (uint32_t i = 0; i < n; ++i) {
+            const auto &a = pts[i];
+            const auto &b = pts[(i + 1) % n];
+            area += cross_of(a, b);
+            float len = glm::length(b - a);
+            if (len > longest_len) {
+                longest_len = len;
+                longest = i;
+            }
+        }
+        auto d = direction(pts[longest], pts[(longest + 1) % n]);
+        auto m = (pts[longest] + pts[(longest + 1) % n]) * 0.5f;
+        auto probe = normal_of(d) * 0.01f;
+        bool filled_normal = inside(m + probe);
+        bool filled_other = inside(m - probe);
+        float outward;
+        if (filled_normal != filled_other) {
+            outward = filled_normal ? -1.0f : 1.0f;
+        } else {
+            outward = area > 0.0f ? -1.0f : 1.0f;
+        }
+
+        for (uint32_t i = 0; i < n; ++i) {
+            auto n0 = normal_of(direction(pts[(i + n - 1) % n], pts[i]));
+            auto n1 = normal_of(direction(pts[i], pts[(i + 1) % n]));
+            float denom = 1.0f + glm::dot(n0, n1);
+            glm::vec2 miter = denom > 1e-3f ? (n0 + n1) / denom : n0;
+            float len = glm::length(miter);
+            if (len > 4.0f) {
+                miter *= 4.0f / len;
+            }
+            this->_outsets[contour.begin + i] = miter * (outward * half);
+        }
+
+        // the parts of an edge inside the fill, e.g. where contours overlap,
+        // get no fringe or translucent fills would blend twice there
+        for (uint32_t i = 0; i < n; ++i) {
+            const auto &a = pts[i];
+            const auto &b = pts[(i + 1) % n];
+            auto out = normal_of(direction(a, b)) * outward;
+            auto &cuts = this->_cuts;
+            cuts.clear();
+            cuts.push_back({0.0f, {}});
+            cuts.push_back({1.0f, {}});
+            this->_crossings(a, b, cuts);
+            std::sort(cuts.begin(), cuts.end(),
+                      [](const Cut &x, const Cut &y) { return x.t < y.t; });
+
+            // where the outline turns onto the crossing edge, the fringe
+            // is mitered with it as at a corner
+            auto outset = [&](const Cut &cut, const glm::vec2 &toward) {
+                auto n1 = cut.normal;
+                if (glm::dot(n1, toward) < 0.0f) {
+                    n1 = -n1;
+                }
+                float denom = 1.0f + glm::dot(out, n1);
+                glm::vec2 miter = denom > 1e-3f ? (out + n1) / denom : out;
+                float len = glm::length(miter);
+                if (len > 4.0f) {
+                    miter *= 4.0f / len;
+                }
+                return miter * half;
+            };
+            for (size_t k = 0; k + 1 < cuts.size(); ++k) {
+                float t0 = cuts[k].t;
+                float t1 = cuts[k + 1].t;
+                if (t1 - t0 < kEpsilon) {
+                    continue;
+                }
+                auto p0 = a + (b - a) * t0;
+                auto p1 = a + (b - a) * t1;
+                if (inside((p0 + p1) * 0.5f + out * 0.01f)) {
+                    continue;
+                }
+                auto o0 = k == 0 ? this->_outsets[contour.begin + i]
+                                 : outset(cuts[k], p1 - p0);
+                auto o1 = k + 2 == cuts.size()
+                              ? this->_outsets[contour.begin + (i + 1) % n]
+                              : outset(cuts[k + 1], p0 - p1);
+                this->_fringe.push_back({p0, p1, o0, o1});
+            }
+        }
+    }
+}
+
+void PathTessellator::_crossings(const glm::vec2 &a, const glm::vec2 &b,
+                                 std::vector<Cut> &cuts) const {
+    auto d = b - a;
+    for (const auto &contour : this->_contours) {
+        const auto *pts = this->_pts.data() + contour.begin;
+        const uint32_t n = contour.size();
+        for (uint32_t i = 0; i < n; ++i) {
+            const auto &c = pts[i];
+            auto e = pts[(i + 1) % n] - c;
+            float denom = cross_of(d, e);
+            if (std::abs(denom) < kEpsilon) {
+                continue;
+            }
+            float t = cross_of(c - a, e) / denom;
+            float u = cross_of(c - a, d) / denom;
+            if (t > 0.0f && t < 1.0f && u >= 0.0f && u <= 1.0f) {
+                cuts.push_back({t, normal_of(glm::normalize(e))});
+            }
+        }
+    }
+}
+
+void PathTessellator::_fill_fringe(const ColorRGBAub &col,
+                                   std::vector<DrawVert> &vtx,
+                                   std::vector<uint32_t> &idx) {
+    const auto clear = transparent(col);
+    for (const auto &piece : this->_fringe) {
+        const auto base = static_cast<uint32_t>(vtx.size());
+        vtx.push_back({piece.a - piece.out_a, this->_uv, col});
+        vtx.push_back({piece.a + piece.out_a, this->_uv, clear});
+        vtx.push_back({piece.b + piece.out_b, this->_uv, clear});
+        vtx.push_back({piece.b - piece.out_b, this->_uv, col});
+        push_quad(idx, base, base + 1, base + 2, base + 3);
+    }
+}
+
+} // namespace my
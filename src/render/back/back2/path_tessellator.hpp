@@ -0,0 +1,143 @@
+#pragma once
+
+#include <render/back/back2/draw_path.hpp>
+
+namespace my {
+
+/**
+ * @brief      converts DrawPath into indexed triangles
+ *
+ * Curves are flattened with a per segment subdivision count derived from
+ * the requested tolerance, strokes are emitted as one continuous strip per
+ * contour (joins and caps included) and fills are split into horizontal
+ * slabs so concave and self-intersecting paths honour the fill rule.
+ * When aa_width > 0 every outline gets a feathered fringe fading to
+ * transparent, centered on the outline as the solid part of a fill is
+ * inset by half the fringe.
+ * Scratch buffers are kept between calls, so a long lived tessellator does
+ * not allocate in the steady state.
+ */
+class PathTessellator {
+  public:
+    struct Options {
+        // max distance in pixels between a curve and its polyline
+        float tolerance{0.25f};
+        // width of the feathered edge in pixels, 0 disables anti-aliasing
+        float aa_width{1.0f};
+    };
+
+    PathTessellator() = default;
+    explicit PathTessellator(const Options &options) : _options(options) {}
+
+    Options &options() { return this->_options; }
+
+    /**
+     * @brief      texture coordinate used by every emitted vertex
+     */
+    void uv(const glm::vec2 &uv) { this->_uv = uv; }
+
+    void fill(const DrawPath &path, const ColorRGBAub &col, FillRule rule,
+              std::vector<DrawVert> &vtx, std::vector<uint32_t> &idx);
+
+    void stroke(const DrawPath &path, const ColorRGBAub &col,
+                const StrokeStyle &style, std::vector<DrawVert> &vtx,
+                std::vector<uint32_t> &idx);
+
+  private:
+    struct Contour {
+        uint32_t begin;
+        uint32_t end;
+        bool closed;
+
+        uint32_t size() const { return this->end - this->begin; }
+    };
+
+    struct Rib {
+        glm::vec2 center;
+        glm::vec2 left;
+        glm::vec2 right;
+        bool faded{false};
+    };
+
+    struct Edge {
+        glm::vec2 top;
+        glm::vec2 bottom;
+        int winding;
+        float dxdy;
+
+        float x_at(float y) const {
+            return this->top.x + (y - this->top.y) * this->dxdy;
+        }
+    };
+
+    // a fringed part of a fill edge, out_* point half the fringe away from
+    // the fill
+    struct FringePiece {
+        glm::vec2 a;
+        glm::vec2 b;
+        glm::vec2 out_a;
+        glm::vec2 out_b;
+    };
+
+    // where a fill edge crosses another one, normal is the other's
+    struct Cut {
+        float t;
+        glm::vec2 normal;
+    };
+
+    struct Span {
+        uint32_t left;
+        uint32_t right;
+        float top;
+        bool alive;
+    };
+
+    Options _options;
+    glm::vec2 _uv{0.0f, 0.0f};
+
+    // scratch
+    std::vector<glm::vec2> _pts;
+    std::vector<Contour> _contours;
+    std::vector<Rib> _ribs;
+    std::vector<Edge> _edges;
+    std::vector<float> _ys;
+    std::vector<uint32_t> _active;
+    std::vector<Span> _spans;
+    std::vector<Span> _next_spans;
+    // per fill point, half the fringe away from the fill
+    std::vector<glm::vec2> _outsets;
+    std::vector<FringePiece> _fringe;
+    std::vector<Cut> _cuts;
+
+    void _flatten(const DrawPath &path);
+    void _add_point(const glm::vec2 &p);
+    void _end_contour(bool closed);
+
+    bool _is_convex(const Contour &contour) const;
+    void _fill_convex(const Contour &contour, const ColorRGBAub &col,
+                      std::vector<DrawVert> &vtx, std::vector<uint32_t> &idx);
+    void _build_edges();
+    void _fill_slabs(FillRule rule, const ColorRGBAub &col,
+                     std::vector<DrawVert> &vtx, std::vector<uint32_t> &idx);
+    void _fringe_outline(FillRule rule);
+    // parameters in (0, 1) where a-b crosses a fill edge
+    void _crossings(const glm::vec2 &a, const glm::vec2 &b,
+                    std::vector<Cut> &cuts) const;
+    void _fill_fringe(const ColorRGBAub &col, std::vector<DrawVert> &vtx,
+                      std::vector<uint32_t> &idx);
+    int _winding_at(const glm::vec2 &p) const;
+
+    void _stroke_contour(const Contour &contour, float hw,
+                         const StrokeStyle &style);
+    void _add_cap(const glm::vec2 &p, const glm::vec2 &d, float hw,
+                  LineCap cap, bool start);
+    void _add_join(const glm::vec2 &p, const glm::vec2 &d0,
+                   const glm::vec2 &d1, float hw, float max_inner,
+                   const StrokeStyle &style);
+    void _emit_ribs(bool closed, float hw, const ColorRGBAub &col,
+                    std::vector<DrawVert> &vtx, std::vector<uint32_t> &idx);
+
+    int _arc_segments(float radius, float angle) const;
+};
+
+} // namespace my
@@ -0,0 +1,93 @@
+#include "raster_canvas.hpp"
+
+#include <core/profiler.hpp>
+#include <storage/font_mgr.h>
+#include <storage/image.hpp>
+
+namespace my {
+
+RasterCanvas::RasterCanvas(uint32_t width, uint32_t height, my::Font *font,
+                           const Rasterizer::Options &options)
+    : _image(width, height), _rasterizer(options) {
+    this->_default_font = font;
+    if (font) {
+        int w, h;
+        auto pixels = font->get_tex_as_rgb32(&w, &h);
+        this->_font_atlas = {pixels, static_cast<uint32_t>(w),
+                             static_cast<uint32_t>(h),
+                             static_cast<size_t>(w) * 4};
+    }
+    this->erase({0, 0, 0, 0});
+}
+
+void RasterCanvas::erase(const ColorRGBAub &col) {
+    std::unique_lock<std::shared_mutex> l_lock(this->_lock);
+    boost::gil::fill_pixels(boost::gil::view(this->_image),
+                            boost::gil::rgba8_pixel_t(col.r, col.g, col.b,
+                                                      col.a));
+}
+
+void RasterCanvas::resize(uint32_t width, uint32_t height) {
+    std::unique_lock<std::shared_mutex> l_lock(this->_lock);
+    this->_image.recreate(width, height);
+    boost::gil::fill_pixels(boost::gil::view(this->_image),
+                            boost::gil::rgba8_pixel_t(0, 0, 0, 0));
+}
+
+void RasterCanvas::_read_pixels(const IRect &rect,
+                                const RGBAImage::view_t &dst) {
+    boost::gil::copy_pixels(
+        boost::gil::subimage_view(boost::gil::const_view(this->_image),
+                                  rect.x(), rect.y(), rect.width(),
+                                  rect.height()),
+        dst);
+}
+
+void RasterCanvas::_write_pixels(const RGBAImage::const_view_t &src,
+                                 const IPoint2D &pos) {
+    boost::gil::copy_pixels(
+        src, boost::gil::subimage_view(boost::gil::view(this->_image),
+                                       pos.x(), pos.y(), src.width(),
+                                       src.height()));
+}
+
+void RasterCanvas::render() {
+    MY_PROFILE_ZONE_C("render", "RasterCanvas::render");
+    HistogramTimer l_render_time(this->_render_us);
+    std::unique_lock<std::shared_mutex> l_lock(this->_lock);
+    this->_flush_uploads();
+    this->_merge_recorders();
+    if (this->_draw_data.empty()) {
+        // nothing to draw, readbacks see the pixels as they are
+        this->_flush_readbacks();
+        return;
+    }
+
+    this->_rasterizer.unbind_all();
+    if (this->_font_atlas.pixels) {
+        this->_rasterizer.bind(nullptr, this->_font_atlas);
+    }
+    for (const auto &cmd : this->_draw_data.cmd_list) {
+        const auto &image = cmd.state.image;
+        if (image) {
+            this->_rasterizer.bind(
+                image.get(),
+                {static_cast<const uint8_t *>(image->data()),
+                 static_cast<uint32_t>(image->width()),
+                 static_cast<uint32_t>(image->height()), image->row_bytes()});
+        }
+    }
+
+    auto view = boost::gil::view(this->_image);
+    this->_rasterizer.draw(
+        this->_draw_data,
+        {reinterpret_cast<uint8_t *>(
+             boost::gil::interleaved_view_get_raw_data(view)),
+         static_cast<uint32_t>(view.width()),
+         static_cast<uint32_t>(view.height()),
+         static_cast<size_t>(view.pixels().row_size())});
+    this->_draw_data.clear();
+    this->_flush_readbacks();
+}
+
+} // namespace my
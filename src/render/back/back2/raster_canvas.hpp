@@ -0,0 +1,64 @@
+#pragma once
+
+#include <render/back/back2/basic_canvas.hpp>
+#include <render/back/back2/rasterizer.hpp>
+
+namespace my {
+
+/**
+ * @brief      BasicCanvas drawn on the CPU into an RGBAImage
+ *
+ * Needs neither a window nor a GPU, which makes it usable for headless
+ * rendering, tests and benchmarks. Frames accumulate into the image like
+ * they do into the render target of Canvas, erase() resets it.
+ */
+class RasterCanvas : public BasicCanvas {
+  public:
+    RasterCanvas(uint32_t width, uint32_t height, my::Font *font = nullptr,
+                 const Rasterizer::Options &options = {});
+
+    static std::shared_ptr<RasterCanvas>
+    make(uint32_t width, uint32_t height, my::Font *font = nullptr,
+         const Rasterizer::Options &options = {}) {
+        return std::make_shared<RasterCanvas>(width, height, font, options);
+    }
+
+    void render() override;
+
+    /**
+     * @brief      fill the whole image with col
+     */
+    void erase(const ColorRGBAub &col);
+
+    /**
+     * @brief      resize the image, the content is discarded
+     */
+    void resize(uint32_t width, uint32_t height);
+
+    /**
+     * @brief      rendered pixels, only valid between render() calls
+     */
+    const RGBAImage &image() const { return this->_image; }
+
+    const Rasterizer::Stats &stats() const {
+        return this->_rasterizer.stats();
+    }
+
+  protected:
+    ISize2D _target_size() override {
+        return ISize2D::Make(this->_image.width(), this->_image.height());
+    }
+
+    void _read_pixels(const IRect &rect,
+                      const RGBAImage::view_t &dst) override;
+
+    void _write_pixels(const RGBAImage::const_view_t &src,
+                       const IPoint2D &pos) override;
+
+  private:
+    RGBAImage _image;
+    Rasterizer _rasterizer;
+    Rasterizer::TextureView _font_atlas{};
+};
+
+} // namespace my
@@ -0,0 +1,498 @@
+#include "rasterizer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace my {
+
+namespace {
+
+// triangles below this count are set up by a single job
+constexpr uint32_t kMinSetupJob = 4096;
+
+double elapsed_ms(std::chrono::steady_clock::time_point begin) {
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - begin)
+        .count();
+}
+
+#if defined(__SSE2__)
+
+// one RGBA pixel in float lanes, 0..255
+struct Pixel {
+    __m128 v;
+
+    static Pixel set(const float *c) { return {_mm_loadu_ps(c)}; }
+
+    static Pixel load(const uint8_t *p) {
+        int32_t raw;
+        std::memcpy(&raw, p, sizeof(raw));
+        const __m128i zero = _mm_setzero_si128();
+        __m128i i = _mm_cvtsi32_si128(raw);
+        i = _mm_unpacklo_epi8(i, zero);
+        i = _mm_unpacklo_epi16(i, zero);
+        return {_mm_cvtepi32_ps(i)};
+    }
+
+    void get(float *c) const { _mm_storeu_ps(c, this->v); }
+
+    void store(uint8_t *p) const {
+        __m128i i = _mm_cvtps_epi32(this->v);
+        i = _mm_packs_epi32(i, i);
+        i = _mm_packus_epi16(i, i);
+        int32_t raw = _mm_cvtsi128_si32(i);
+        std::memcpy(p, &raw, sizeof(raw));
+    }
+
+    Pixel operator+(const Pixel &o) const { return {_mm_add_ps(v, o.v)}; }
+    Pixel operator-(const Pixel &o) const { return {_mm_sub_ps(v, o.v)}; }
+    Pixel operator*(const Pixel &o) const { return {_mm_mul_ps(v, o.v)}; }
+    Pixel operator*(float s) const { return {_mm_mul_ps(v, _mm_set1_ps(s))}; }
+
+    Pixel clamp() const {
+        return {_mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()),
+                           _mm_set1_ps(255.0f))};
+    }
+
+    // src alpha / inv src alpha over dst
+    Pixel over(const Pixel &dst) const {
+        __m128 a = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+        a = _mm_mul_ps(a, _mm_set1_ps(1.0f / 255.0f));
+        return {_mm_add_ps(dst.v, _mm_mul_ps(_mm_sub_ps(v, dst.v), a))};
+    }
+};
+
+#else
+
+struct Pixel {
+    float v[4];
+
+    static Pixel set(const float *c) { return {{c[0], c[1], c[2], c[3]}}; }
+
+    static Pixel load(const uint8_t *p) {
+        return {{float(p[0]), float(p[1]), float(p[2]), float(p[3])}};
+    }
+
+    void get(float *c) const { std::copy(this->v, this->v + 4, c); }
+
+    void store(uint8_t *p) const {
+        for (int i = 0; i < 4; ++i) {
+            p[i] = static_cast<uint8_t>(std::lrint(this->v[i]));
+        }
+    }
+
+    template <typename Op> Pixel map(const Pixel &o, Op op) const {
+        Pixel r;
+        for (int i = 0; i < 4; ++i) {
+            r.v[i] = op(this->v[i], o.v[i]);
+        }
+        return r;
+    }
+
+    Pixel operator+(const Pixel &o) const {
+        return this->map(o, [](float a, float b) { return a + b; });
+    }
+    Pixel operator-(const Pixel &o) const {
+        return this->map(o, [](float a, float b) { return a - b; });
+    }
+    Pixel operator*(const Pixel &o) const {
+        return this->map(o, [](float a, float b) { return a * b; });
+    }
+    Pixel operator*(float s) const {
+        return this->map(*this, [s](float a, float) { return a * s; });
+    }
+
+    Pixel clamp() const {
+        return this->map(*this, [](float a, float) {
+            return std::min(std::max(a, 0.0f), 255.0f);
+        });
+    }
+
+    Pixel over(const Pixel &dst) const {
+        float a = this->v[3] / 255.0f;
+        return this->map(dst, [a](float s, float d) { return d + (s - d) * a; });
+    }
+};
+
+#endif
+
+// (x + 128) / 255 rounded, exact for the products of two bytes
+inline uint32_t div255(uint32_t x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+// constant colour over a span, four pixels per iteration in 16 bit lanes
+void blend_flat(uint8_t *row, int n, const uint8_t *c) {
+    const uint32_t a = c[3];
+    const uint32_t inv = 255 - a;
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i src =
+        _mm_set_epi16(a * a, c[2] * a, c[1] * a, c[0] * a, a * a, c[2] * a,
+                      c[1] * a, c[0] * a);
+    const __m128i inv16 = _mm_set1_epi16(static_cast<int16_t>(inv));
+    const __m128i round = _mm_set1_epi16(128);
+    auto blend = [&](__m128i d) {
+        __m128i x = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(d, inv16), src),
+                                  round);
+        return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+    };
+    for (; i + 4 <= n; i += 4, row += 16) {
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row));
+        __m128i lo = blend(_mm_unpacklo_epi8(d, zero));
+        __m128i hi = blend(_mm_unpackhi_epi8(d, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(row),
+                         _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; i < n; ++i, row += 4) {
+        for (int ch = 0; ch < 3; ++ch) {
+            row[ch] = div255(c[ch] * a + row[ch] * inv);
+        }
+        row[3] = div255(a * a + row[3] * inv);
+    }
+}
+
+bool same_color(const ColorRGBAub &a, const ColorRGBAub &b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+// std::ceil is a libm call without SSE4.1, this is on every scanline
+inline int ceil_int(float x) {
+    int i = static_cast<int>(x);
+    return i + (x > static_cast<float>(i));
+}
+
+int wrap(int i, int n) {
+    i %= n;
+    return i < 0 ? i + n : i;
+}
+
+// bilinear with repeat addressing, like the default GPU sampler
+Pixel sample(const Rasterizer::TextureView &tex, float u, float v) {
+    float fx = u * tex.width - 0.5f;
+    float fy = v * tex.height - 0.5f;
+    float x_floor = std::floor(fx);
+    float y_floor = std::floor(fy);
+    float ax = fx - x_floor;
+    float ay = fy - y_floor;
+    int x0 = wrap(static_cast<int>(x_floor), tex.width);
+    int y0 = wrap(static_cast<int>(y_floor), tex.height);
+    int x1 = x0 + 1 == static_cast<int>(tex.width) ? 0 : x0 + 1;
+    int y1 = y0 + 1 == static_cast<int>(tex.height) ? 0 : y0 + 1;
+
+    const uint8_t *row0 = tex.pixels + y0 * tex.row_bytes;
+    const uint8_t *row1 = tex.pixels + y1 * tex.row_bytes;
+    Pixel t00 = Pixel::load(row0 + x0 * 4);
+    Pixel t10 = Pixel::load(row0 + x1 * 4);
+    Pixel t01 = Pixel::load(row1 + x0 * 4);
+    Pixel t11 = Pixel::load(row1 + x1 * 4);
+    Pixel top = t00 + (t10 - t00) * ax;
+    Pixel bottom = t01 + (t11 - t01) * ax;
+    return top + (bottom - top) * ay;
+}
+
+// value of the plane through (p[i], v[i]) as base + dx * x + dy * y
+void plane(const glm::vec2 *p, const float *v, float inv_det, float &base,
+           float &dx, float &dy) {
+    float e1x = p[1].x - p[0].x, e1y = p[1].y - p[0].y;
+    float e2x = p[2].x - p[0].x, e2y = p[2].y - p[0].y;
+    float d1 = v[1] - v[0];
+    float d2 = v[2] - v[0];
+    dx = (d1 * e2y - d2 * e1y) * inv_det;
+    dy = (d2 * e1x - d1 * e2x) * inv_det;
+    base = v[0] - dx * p[0].x - dy * p[0].y;
+}
+
+} // namespace
+
+Rasterizer::Rasterizer(const Options &options, Executor &executor)
+    : _options(options), _executor(executor) {
+    if (this->_options.tile_size == 0) {
+        this->_options.tile_size = 64;
+    }
+    if (this->_options.threads == 0) {
+        this->_options.threads = uint32_t(executor.concurrency());
+    }
+    this->_options.threads = std::max(1u, this->_options.threads);
+}
+
+void Rasterizer::_parallel_for(uint32_t count,
+                               const std::function<void(uint32_t)> &job) {
+    parallel_for(this->_executor, count, this->_options.threads,
+                 [&job](size_t i) { job(uint32_t(i)); });
+}
+
+void Rasterizer::draw(const DrawData &data, const TargetView &target) {
+    this->_stats = {};
+    if (data.empty() || !target.pixels || target.width == 0 ||
+        target.height == 0) {
+        return;
+    }
+
+    this->_cmd_tri.clear();
+    uint32_t tri_count = 0;
+    for (const auto &cmd : data.cmd_list) {
+        this->_cmd_tri.push_back(tri_count);
+        tri_count += cmd.elem_count / 3;
+    }
+    this->_cmd_tri.push_back(tri_count);
+    this->_setups.resize(tri_count);
+
+    const auto ts = this->_options.tile_size;
+    this->_tiles_x = (target.width + ts - 1) / ts;
+    this->_tiles_y = (target.height + ts - 1) / ts;
+    const uint32_t tile_count = this->_tiles_x * this->_tiles_y;
+
+    this->_bin_jobs = std::max(
+        1u, std::min(this->_options.threads,
+                     (tri_count + kMinSetupJob - 1) / kMinSetupJob));
+    this->_bins.resize(this->_bin_jobs * tile_count);
+    for (auto &bin : this->_bins) {
+        bin.clear();
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    const uint32_t jobs = this->_bin_jobs;
+    std::function<void(uint32_t)> setup = [&](uint32_t job) {
+        uint64_t first = uint64_t(tri_count) * job / jobs;
+        uint64_t last = uint64_t(tri_count) * (job + 1) / jobs;
+        this->_setup(data, target, first, last, job);
+    };
+    this->_parallel_for(jobs, setup);
+    this->_stats.setup_ms = elapsed_ms(begin);
+
+    begin = std::chrono::steady_clock::now();
+    std::atomic<size_t> tiles{0};
+    std::function<void(uint32_t)> raster = [&](uint32_t tile) {
+        bool touched = false;
+        for (uint32_t job = 0; job < jobs && !touched; ++job) {
+            touched = !this->_bins[job * tile_count + tile].empty();
+        }
+        if (touched) {
+            tiles.fetch_add(1, std::memory_order_relaxed);
+            this->_raster_tile(target, tile);
+        }
+    };
+    this->_parallel_for(tile_count, raster);
+    this->_stats.raster_ms = elapsed_ms(begin);
+
+    this->_stats.triangles = tri_count;
+    this->_stats.tiles = tiles;
+    for (const auto &bin : this->_bins) {
+        this->_stats.bin_entries += bin.size();
+    }
+}
+
+void Rasterizer::_setup(const DrawData &data, const TargetView &target,
+                        uint32_t begin, uint32_t end, uint32_t job) {
+    if (begin >= end) {
+        return;
+    }
+    const auto ts = this->_options.tile_size;
+    const uint32_t tile_count = this->_tiles_x * this->_tiles_y;
+    auto bins = this->_bins.begin() + job * tile_count;
+
+    size_t ci = std::upper_bound(this->_cmd_tri.begin(), this->_cmd_tri.end(),
+                                 begin) -
+                this->_cmd_tri.begin() - 1;
+    const TextureView *texture = nullptr;
+    size_t texture_ci = SIZE_MAX;
+
+    for (uint32_t t = begin; t < end; ++t) {
+        while (t >= this->_cmd_tri[ci + 1]) {
+            ++ci;
+        }
+        const auto &cmd = data.cmd_list[ci];
+        if (texture_ci != ci) {
+            auto it = this->_textures.find(cmd.state.image.get());
+            texture = it == this->_textures.end() ? nullptr : &it->second;
+            texture_ci = ci;
+        }
+
+        auto &s = this->_setups[t];
+        s.visible = false;
+
+        const uint32_t *idx =
+            data.idx_list.data() + cmd.idx_offset + (t - this->_cmd_tri[ci]) * 3;
+        const DrawVert *v[3] = {&data.vtx_list[idx[0]], &data.vtx_list[idx[1]],
+                                &data.vtx_list[idx[2]]};
+        // (y, x) order makes a shared edge walk the same direction in both
+        // of its triangles, so neighbours agree on every pixel center
+        std::sort(std::begin(v), std::end(v),
+                  [](const DrawVert *a, const DrawVert *b) {
+                      return a->pos.y < b->pos.y ||
+                             (a->pos.y == b->pos.y && a->pos.x < b->pos.x);
+                  });
+        for (int k = 0; k < 3; ++k) {
+            s.p[k] = v[k]->pos;
+        }
+        if (v[0]->col.a == 0 && v[1]->col.a == 0 && v[2]->col.a == 0) {
+            continue;
+        }
+
+        float det = (s.p[1].x - s.p[0].x) * (s.p[2].y - s.p[0].y) -
+                    (s.p[2].x - s.p[0].x) * (s.p[1].y - s.p[0].y);
+        if (std::fabs(det) < 1e-6f) {
+            continue;
+        }
+
+        float min_x = std::min({s.p[0].x, s.p[1].x, s.p[2].x});
+        float max_x = std::max({s.p[0].x, s.p[1].x, s.p[2].x});
+        int px0 = std::max(0, static_cast<int>(std::floor(min_x)));
+        int px1 = std::min(static_cast<int>(target.width),
+                           static_cast<int>(std::ceil(max_x)));
+        int py0 = std::max(0, static_cast<int>(std::floor(s.p[0].y)));
+        int py1 = std::min(static_cast<int>(target.height),
+                           static_cast<int>(std::ceil(s.p[2].y)));
+        if (px0 >= px1 || py0 >= py1) {
+            continue;
+        }
+
+        const int edges[3][2] = {{0, 1}, {1, 2}, {0, 2}};
+        for (int e = 0; e < 3; ++e) {
+            const auto &a = s.p[edges[e][0]];
+            const auto &b = s.p[edges[e][1]];
+            float dy = b.y - a.y;
+            s.slope[e] = dy > 0 ? (b.x - a.x) / dy : 0.0f;
+        }
+
+        // a texture sampled at a single uv (the white pixel of the font
+        // atlas for tessellated paths) folds into the vertex colours
+        glm::vec2 uv[3] = {v[0]->uv, v[1]->uv, v[2]->uv};
+        s.texture = texture;
+        float texel[4] = {255.0f, 255.0f, 255.0f, 255.0f};
+        if (texture && uv[0] == uv[1] && uv[0] == uv[2]) {
+            sample(*texture, uv[0].x, uv[0].y).get(texel);
+            s.texture = nullptr;
+        }
+
+        float col[4][3];
+        for (int k = 0; k < 3; ++k) {
+            const auto &c = v[k]->col;
+            col[0][k] = c.r * texel[0] / 255.0f;
+            col[1][k] = c.g * texel[1] / 255.0f;
+            col[2][k] = c.b * texel[2] / 255.0f;
+            col[3][k] = c.a * texel[3] / 255.0f;
+        }
+
+        float inv_det = 1.0f / det;
+        for (int ch = 0; ch < 4; ++ch) {
+            plane(s.p, col[ch], inv_det, s.c_base[ch], s.c_dx[ch],
+                  s.c_dy[ch]);
+        }
+        if (s.texture) {
+            float u[3] = {uv[0].x, uv[1].x, uv[2].x};
+            float w[3] = {uv[0].y, uv[1].y, uv[2].y};
+            plane(s.p, u, inv_det, s.uv_base[0], s.uv_dx[0], s.uv_dy[0]);
+            plane(s.p, w, inv_det, s.uv_base[1], s.uv_dx[1], s.uv_dy[1]);
+        }
+
+        s.flat = !s.texture && same_color(v[0]->col, v[1]->col) &&
+                 same_color(v[0]->col, v[2]->col);
+        s.opaque = s.flat && col[3][0] >= 254.5f;
+        s.visible = true;
+
+        for (int ty = py0 / ts; ty <= (py1 - 1) / int(ts); ++ty) {
+            for (int tx = px0 / ts; tx <= (px1 - 1) / int(ts); ++tx) {
+                bins[ty * this->_tiles_x + tx].push_back(t);
+            }
+        }
+    }
+}
+
+void Rasterizer::_raster_tile(const TargetView &target, uint32_t tile) {
+    const int ts = this->_options.tile_size;
+    int x0 = (tile % this->_tiles_x) * ts;
+    int y0 = (tile / this->_tiles_x) * ts;
+    int x1 = std::min(x0 + ts, static_cast<int>(target.width));
+    int y1 = std::min(y0 + ts, static_cast<int>(target.height));
+
+    const uint32_t tile_count = this->_tiles_x * this->_tiles_y;
+    for (uint32_t job = 0; job < this->_bin_jobs; ++job) {
+        for (auto t : this->_bins[job * tile_count + tile]) {
+            this->_raster_triangle(this->_setups[t], target, x0, y0, x1, y1);
+        }
+    }
+}
+
+void Rasterizer::_raster_triangle(const Setup &s, const TargetView &target,
+                                  int x0, int y0, int x1, int y1) {
+    const auto *p = s.p;
+    // pixel centers inside [top, bottom)
+    int ya = std::max(y0, ceil_int(p[0].y - 0.5f));
+    int yb = std::min(y1, ceil_int(p[2].y - 0.5f));
+
+    uint8_t flat[4];
+    uint32_t packed = 0;
+    if (s.flat) {
+        for (int ch = 0; ch < 4; ++ch) {
+            flat[ch] = static_cast<uint8_t>(
+                std::lrint(std::min(std::max(s.c_base[ch], 0.0f), 255.0f)));
+        }
+        std::memcpy(&packed, flat, sizeof(packed));
+    }
+
+    const Pixel dc = Pixel::set(s.c_dx);
+    for (int y = ya; y < yb; ++y) {
+        float yc = y + 0.5f;
+        float xl = p[0].x + (yc - p[0].y) * s.slope[2];
+        float xs = yc < p[1].y ? p[0].x + (yc - p[0].y) * s.slope[0]
+                               : p[1].x + (yc - p[1].y) * s.slope[1];
+        if (xl > xs) {
+            std::swap(xl, xs);
+        }
+        int xa = std::max(x0, ceil_int(xl - 0.5f));
+        int xb = std::min(x1, ceil_int(xs - 0.5f));
+        if (xa >= xb) {
+            continue;
+        }
+
+        uint8_t *row = target.pixels + y * target.row_bytes + xa * 4;
+        const int n = xb - xa;
+        if (s.opaque) {
+            auto out = reinterpret_cast<uint32_t *>(row);
+            std::fill(out, out + n, packed);
+            continue;
+        }
+        if (s.flat) {
+            blend_flat(row, n, flat);
+            continue;
+        }
+
+        float xc = xa + 0.5f;
+        float c0[4];
+        for (int ch = 0; ch < 4; ++ch) {
+            c0[ch] = s.c_base[ch] + s.c_dx[ch] * xc + s.c_dy[ch] * yc;
+        }
+        Pixel c = Pixel::set(c0);
+
+        if (!s.texture) {
+            for (int i = 0; i < n; ++i, row += 4, c = c + dc) {
+                c.clamp().over(Pixel::load(row)).store(row);
+            }
+            continue;
+        }
+
+        float u = s.uv_base[0] + s.uv_dx[0] * xc + s.uv_dy[0] * yc;
+        float v = s.uv_base[1] + s.uv_dx[1] * xc + s.uv_dy[1] * yc;
+        for (int i = 0; i < n; ++i, row += 4, c = c + dc) {
+            Pixel texel = sample(*s.texture, u, v);
+            Pixel src = (c.clamp() * texel) * (1.0f / 255.0f);
+            src.over(Pixel::load(row)).store(row);
+            u += s.uv_dx[0];
+            v += s.uv_dx[1];
+        }
+    }
+}
+
+} // namespace my
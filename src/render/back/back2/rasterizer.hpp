@@ -0,0 +1,134 @@
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include <core/executor.hpp>
+#include <render/back/back2/draw_list.hpp>
+
+namespace my {
+
+/**
+ * @brief      software rasterizer for DrawData
+ *
+ * The target is split into square tiles. Triangles are set up and binned
+ * to the tiles they touch in parallel (one contiguous triangle range per
+ * job, so the submission order survives), then every tile is rasterized
+ * by a single job which walks its bins scanline by scanline. Jobs run on
+ * the executor, the caller takes part. Pixels are
+ * blended with the same src-alpha / inv-src-alpha equation as the GPU
+ * pipeline, one pixel per SSE register when available.
+ */
+class Rasterizer {
+  public:
+    struct Options {
+        uint32_t tile_size{64};
+        // jobs run at once including the caller, 0 uses the executor's
+        // concurrency
+        uint32_t threads{0};
+    };
+
+    /**
+     * @brief      RGBA8 pixels sampled by commands drawing an image
+     */
+    struct TextureView {
+        const uint8_t *pixels{};
+        uint32_t width{};
+        uint32_t height{};
+        size_t row_bytes{};
+    };
+
+    /**
+     * @brief      RGBA8 pixels written by draw()
+     */
+    struct TargetView {
+        uint8_t *pixels{};
+        uint32_t width{};
+        uint32_t height{};
+        size_t row_bytes{};
+    };
+
+    struct Stats {
+        size_t triangles{};
+        // sum over tiles of the triangles binned to them
+        size_t bin_entries{};
+        size_t tiles{};
+        double setup_ms{};
+        double raster_ms{};
+    };
+
+    Rasterizer() : Rasterizer(Options{}) {}
+    explicit Rasterizer(const Options &options,
+                        Executor &executor = *Executor::shared());
+
+    Rasterizer(const Rasterizer &) = delete;
+    Rasterizer &operator=(const Rasterizer &) = delete;
+
+    const Options &options() const { return this->_options; }
+
+    /**
+     * @brief      texture sampled by commands whose state image is image
+     *
+     * nullptr binds the texture of commands without an image (the font
+     * atlas). Commands with an unbound image sample opaque white.
+     */
+    void bind(const Image *image, const TextureView &view) {
+        this->_textures[image] = view;
+    }
+
+    void unbind_all() { this->_textures.clear(); }
+
+    void draw(const DrawData &data, const TargetView &target);
+
+    const Stats &stats() const { return this->_stats; }
+
+  private:
+    struct Setup {
+        // vertices sorted by y
+        glm::vec2 p[3];
+        float slope[3];
+        // colour planes, value at (x, y) is base + dx * x + dy * y
+        float c_base[4];
+        float c_dx[4];
+        float c_dy[4];
+        float uv_base[2];
+        float uv_dx[2];
+        float uv_dy[2];
+        const TextureView *texture;
+        bool visible;
+        // constant colour and no texture
+        bool flat;
+        // flat and opaque, spans are plain stores
+        bool opaque;
+    };
+
+    Options _options;
+    std::unordered_map<const Image *, TextureView> _textures;
+    Stats _stats;
+
+    std::vector<Setup> _setups;
+    // first triangle of each command
+    std::vector<uint32_t> _cmd_tri;
+    // bins[job * tile_count + tile] holds triangle ids in submission order
+    std::vector<std::vector<uint32_t>> _bins;
+    uint32_t _bin_jobs{};
+    uint32_t _tiles_x{};
+    uint32_t _tiles_y{};
+
+    Executor &_executor;
+
+    /**
+     * @brief      job(i) for i in [0, count), on up to threads threads
+     */
+    void _parallel_for(uint32_t count,
+                       const std::function<void(uint32_t)> &job);
+
+    void _setup(const DrawData &data, const TargetView &target,
+                uint32_t begin, uint32_t end, uint32_t job);
+    void _raster_tile(const TargetView &target, uint32_t tile);
+    void _raster_triangle(const Setup &setup, const TargetView &target,
+                          int x0, int y0, int x1, int y1);
+};
+
+} // namespace my
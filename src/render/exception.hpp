@@ -1,5 +1,8 @@
 #pragma once
 
+#include <stdexcept>
+#include <string>
+
 #include <core/config.hpp>
 
 namespace my {
@@ -13,4 +16,14 @@ class RenderServiceError : public std::runtime_error {
   private:
     std::string _msg;
 };
+
+class NodeError : public std::runtime_error {
+  public:
+    NodeError(const std::string &msg) : std::runtime_error(msg), _msg(msg) {}
+
+    const char *what() const noexcept override { return this->_msg.c_str(); }
+
+  private:
+    std::string _msg;
+};
 } // namespace my
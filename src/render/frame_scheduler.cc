@@ -0,0 +1,82 @@
+#include "frame_scheduler.hpp"
+
+#include <algorithm>
+
+namespace my {
+
+namespace {
+
+uint64_t to_us(FrameScheduler::clock::duration d) {
+  return uint64_t(std::max<int64_t>(
+      0, std::chrono::duration_cast<std::chrono::microseconds>(d).count()));
+}
+
+} // namespace
+
+void FrameScheduler::refresh_rate(int hz) {
+  if (hz == kUncapped) {
+    this->_refresh_rate = kUncapped;
+    this->_period = clock::duration::zero();
+    return;
+  }
+  this->_refresh_rate = hz > 0 ? hz : kDefaultRefreshRate;
+  this->_period = std::chrono::duration_cast<clock::duration>(
+      std::chrono::duration<double>(1.0 / this->_refresh_rate));
+}
+
+bool FrameScheduler::request() {
+  ++this->_requests;
+  if (this->_pending) {
+    return false;
+  }
+  this->_pending = true;
+  return !this->_drawing;
+}
+
+FrameScheduler::clock::time_point
+FrameScheduler::deadline(clock::time_point now) const {
+  if (this->_frames == 0) {
+    return now;
+  }
+  return std::max(now, this->_begin + this->_period);
+}
+
+void FrameScheduler::begin_frame(clock::time_point now) {
+  this->_pending = false;
+  this->_drawing = true;
+  // a frame right after the previous one continues an animation
+  this->_continued =
+      this->_frames != 0 && now - this->_presented < this->_period;
+  this->_begin = now;
+}
+
+bool FrameScheduler::end_frame(clock::time_point presented) {
+  this->_drawing = false;
+  ++this->_frames;
+  this->_frames_metric.add();
+
+  auto frame_time = presented - this->_begin;
+  this->_frame_time.record(to_us(frame_time));
+  this->_frame_time_metric.record(to_us(frame_time));
+  if (this->_refresh_rate != kUncapped &&
+      frame_time > this->_period + this->_period / 8) {
+    ++this->_missed;
+    this->_missed_metric.add();
+  }
+
+  if (this->_continued) {
+    auto off = (presented - this->_presented) % this->_period;
+    auto jitter = to_us(std::min(off, this->_period - off));
+    this->_jitter.record(jitter);
+    this->_jitter_metric.record(jitter);
+  }
+  this->_presented = presented;
+  return this->_pending;
+}
+
+FrameStats FrameScheduler::stats() const {
+  return {this->_frames, this->_missed, this->_requests,
+          this->_frame_time.summary(), this->_jitter.summary()};
+}
+
+} // namespace my
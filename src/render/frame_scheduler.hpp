@@ -0,0 +1,111 @@
+#pragma once
+
+#include <chrono>
+
+#include <core/metrics.hpp>
+
+namespace my {
+
+struct FrameStats {
+  // frames rendered
+  uint64_t frames{};
+  // frames that took longer than a refresh period and skipped a vsync
+  uint64_t missed{};
+  // invalidations, those arriving while a frame is pending share it
+  uint64_t requests{};
+  // from the start of a frame to its present, in microseconds
+  HistogramSummary frame_time_us;
+  // how far back to back presents are off the vsync grid, in microseconds
+  HistogramSummary jitter_us;
+};
+
+/**
+ * @brief      decides when the render thread draws a frame
+ *
+ * A frame is drawn only after request(), so an unchanged scene costs
+ * nothing. Frames start at most once per refresh period, after an idle
+ * period the first one starts right away; with a swap that waits for
+ * vsync the starts settle right after the vsyncs. Requests while a frame
+ * is pending are folded into it, those while a frame is drawn schedule
+ * the next one when it ends. Presents are measured against the vsync grid
+ * for jitter, a frame missed its vsync if it took noticeably longer than
+ * a period. Not thread-safe, used on the render thread.
+ */
+class FrameScheduler {
+public:
+  using clock = std::chrono::steady_clock;
+
+  static constexpr int kDefaultRefreshRate = 60;
+  // frames start as soon as requested, nothing is missed nor jitters
+  static constexpr int kUncapped = -1;
+
+  explicit FrameScheduler(int refresh_rate = kDefaultRefreshRate) {
+    this->refresh_rate(refresh_rate);
+  }
+
+  /**
+   * @brief      the display's refresh rate in Hz or kUncapped, unknown
+   *             rates (0) fall back to kDefaultRefreshRate
+   */
+  void refresh_rate(int hz);
+  int refresh_rate() const { return this->_refresh_rate; }
+
+  clock::duration period() const { return this->_period; }
+
+  /**
+   * @brief      the scene changed and needs a frame
+   *
+   * @return     true if no frame was pending or being drawn, the caller
+   *             schedules one at deadline()
+   */
+  bool request();
+
+  bool pending() const { return this->_pending; }
+
+  /**
+   * @brief      when the pending frame should start
+   */
+  clock::time_point deadline(clock::time_point now) const;
+
+  /**
+   * @brief      the pending frame starts drawing
+   */
+  void begin_frame(clock::time_point now);
+
+  /**
+   * @brief      the frame begun last was presented
+   *
+   * @return     true if it was requested again meanwhile, the caller
+   *             schedules a frame at deadline()
+   */
+  bool end_frame(clock::time_point presented);
+
+  FrameStats stats() const;
+
+private:
+  int _refresh_rate{kDefaultRefreshRate};
+  clock::duration _period;
+
+  bool _pending{false};
+  bool _drawing{false};
+  // whether the frame being drawn directly follows the previous one
+  bool _continued{false};
+  clock::time_point _begin;
+  // the last present, taken as a vsync
+  clock::time_point _presented;
+
+  uint64_t _frames{0};
+  uint64_t _missed{0};
+  uint64_t _requests{0};
+  Histogram _frame_time;
+  Histogram _jitter;
+
+  Counter &_frames_metric{Metrics::get()->counter("render.frames")};
+  Counter &_missed_metric{Metrics::get()->counter("render.frames_missed")};
+  Histogram &_frame_time_metric{
+      Metrics::get()->histogram("render.frame_time_us")};
+  Histogram &_jitter_metric{
+      Metrics::get()->histogram("render.frame_jitter_us")};
+};
+
+} // namespace my
@@ -0,0 +1,164 @@
+#include "layer_cache.hpp"
+
+#include <core/profiler.hpp>
+
+namespace my {
+
+void LayerCache::draw(SkCanvas &canvas, Node &root) {
+  MY_PROFILE_ZONE_C("render", "LayerCache::draw");
+  ++this->_frame;
+  this->_stats = {};
+
+  this->_draw_node(canvas, root);
+
+  for (auto it = this->_layers.begin(); it != this->_layers.end();) {
+    auto next = std::next(it);
+    if (this->_frame - it->second.last_frame > kIdleFrames) {
+      this->_erase(it);
+      ++this->_stats.evictions;
+    }
+    it = next;
+  }
+
+  this->_stats.layers = this->_layers.size();
+  this->_stats.bytes = this->_bytes;
+  this->_hits.add(this->_stats.hits);
+  this->_misses.add(this->_stats.misses);
+  this->_evictions.add(this->_stats.evictions);
+  this->_publish_bytes();
+}
+
+void LayerCache::budget(size_t bytes) {
+  this->_budget = bytes;
+  // no layer is in use between frames
+  this->_make_room(0, 0);
+  this->_publish_bytes();
+}
+
+void LayerCache::clear() {
+  this->_layers.clear();
+  this->_bytes = 0;
+  this->_publish_bytes();
+}
+
+void LayerCache::_publish_bytes() {
+  this->_layer_bytes.add(int64_t(this->_bytes) -
+                         int64_t(this->_published_bytes));
+  this->_published_bytes = this->_bytes;
+}
+
+void LayerCache::_draw_node(SkCanvas &canvas, Node &node) {
+  auto const &rect = node.rect();
+  canvas.save();
+  canvas.translate(float(rect.left()), float(rect.top()));
+  canvas.concat(node.transform());
+  // grouping nodes without a size do not clip
+  if (!rect.isEmpty()) {
+    canvas.clipRect(Rect::MakeWH(float(rect.width()), float(rect.height())));
+  }
+
+  auto view = dynamic_cast<NodeView *>(&node);
+  sk_sp<SkImage> image;
+  if (view && view->cached()) {
+    image = this->_layer(*view);
+  }
+  if (image) {
+    canvas.drawImage(image, 0, 0);
+  } else {
+    this->_draw_content(canvas, node);
+  }
+  canvas.restore();
+}
+
+void LayerCache::_draw_content(SkCanvas &canvas, Node &node) {
+  if (auto view = dynamic_cast<NodeView *>(&node)) {
+    view->paint(canvas);
+  }
+  auto store = node.store();
+  if (!store) {
+    return;
+  }
+  for (auto child = store->first_child(node.handle()); child;
+       child = store->next_sibling(child)) {
+    this->_draw_node(canvas, *Node::from(*store, child));
+  }
+}
+
+sk_sp<SkImage> LayerCache::_layer(NodeView &view) {
+  auto size = view.size();
+  if (size.isEmpty()) {
+    return nullptr;
+  }
+  auto version = view.version();
+  auto it = this->_layers.find(view.id());
+  if (it != this->_layers.end()) {
+    auto &layer = it->second;
+    if (layer.version == version && layer.surface->width() == size.width() &&
+        layer.surface->height() == size.height()) {
+      layer.last_frame = this->_frame;
+      ++this->_stats.hits;
+      return layer.image;
+    }
+    if (layer.surface->width() != size.width() ||
+        layer.surface->height() != size.height()) {
+      this->_erase(it);
+      it = this->_layers.end();
+    }
+  }
+
+  if (it == this->_layers.end()) {
+    auto bytes = size_t(size.width()) * size_t(size.height()) * 4;
+    if (!this->_make_room(bytes, this->_frame)) {
+      ++this->_stats.uncached;
+      return nullptr;
+    }
+    auto surface =
+        SkSurface::MakeRasterN32Premul(size.width(), size.height());
+    if (!surface) {
+      throw RenderServiceError("create layer surface failure");
+    }
+    this->_bytes += bytes;
+    it = this->_layers.emplace(view.id(), Layer{}).first;
+    it->second.surface = std::move(surface);
+  }
+
+  // in use from here on, nested layers drawn into it must not evict it
+  auto &layer = it->second;
+  layer.last_frame = this->_frame;
+  auto layer_canvas = layer.surface->getCanvas();
+  layer_canvas->clear(SK_ColorTRANSPARENT);
+  this->_draw_content(*layer_canvas, view);
+  layer.image = layer.surface->makeImageSnapshot();
+  layer.version = version;
+  ++this->_stats.misses;
+  return layer.image;
+}
+
+bool LayerCache::_make_room(size_t bytes, uint64_t in_use) {
+  if (bytes > this->_budget) {
+    return false;
+  }
+  while (this->_bytes + bytes > this->_budget) {
+    auto lru = this->_layers.end();
+    for (auto it = this->_layers.begin(); it != this->_layers.end(); ++it) {
+      if (it->second.last_frame != in_use &&
+          (lru == this->_layers.end() ||
+           it->second.last_frame < lru->second.last_frame)) {
+        lru = it;
+      }
+    }
+    if (lru == this->_layers.end()) {
+      return false;
+    }
+    this->_erase(lru);
+    ++this->_stats.evictions;
+  }
+  return true;
+}
+
+void LayerCache::_erase(decltype(_layers)::iterator it) {
+  this->_bytes -= _bytes_of(*it->second.surface);
+  this->_layers.erase(it);
+}
+
+} // namespace my
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+#include <boost/functional/hash.hpp>
+
+#include <core/metrics.hpp>
+
+#include <render/node_view.hpp>
+#include <render/type.hpp>
+
+#include <skia/include/core/SkImage.h>
+
+namespace my {
+
+struct LayerStats {
+  // layers drawn from the cache
+  uint64_t hits{};
+  // layers (re)drawn into their surface
+  uint64_t misses{};
+  // layers dropped to stay in budget or after idling
+  uint64_t evictions{};
+  // cached nodes drawn directly as their layer did not fit the budget
+  uint64_t uncached{};
+  size_t layers{};
+  size_t bytes{};
+};
+
+/**
+ * @brief      draws a NodeView tree, keeping cached() nodes in raster layers
+ *
+ * A cached node and its subtree are drawn once into a surface of the
+ * node's size, later frames composite the snapshot with the node's
+ * transform and clip as long as the node's version and size are unchanged.
+ * Layers not used by a frame are evicted least recently used first when a
+ * new layer would exceed the budget, and dropped after kIdleFrames.
+ * Nested cached nodes get layers of their own, redrawing an inner layer
+ * redraws the outer one as well. Not thread-safe, draw() runs on the
+ * render thread.
+ *
+ * Each cache publishes <metrics>_hits, _misses, _evictions and _bytes,
+ * caches sharing a prefix add up in the same metrics.
+ */
+class LayerCache {
+public:
+  static constexpr uint64_t kIdleFrames = 120;
+
+  explicit LayerCache(size_t budget_bytes = 64 << 20,
+                      std::string const &metrics = "render.layer")
+      : _budget(budget_bytes),
+        _hits(Metrics::get()->counter(metrics + "_hits")),
+        _misses(Metrics::get()->counter(metrics + "_misses")),
+        _evictions(Metrics::get()->counter(metrics + "_evictions")),
+        _layer_bytes(Metrics::get()->gauge(metrics + "_bytes")) {}
+
+  LayerCache(LayerCache const &) = delete;
+  LayerCache &operator=(LayerCache const &) = delete;
+
+  ~LayerCache() { this->_layer_bytes.add(-int64_t(this->_published_bytes)); }
+
+  /**
+   * @brief      draw root and its subtree as one frame
+   */
+  void draw(SkCanvas &canvas, Node &root);
+
+  size_t budget() const { return this->_budget; }
+
+  /**
+   * @brief      change the memory budget, evicting layers above it
+   */
+  void budget(size_t bytes);
+
+  /**
+   * @brief      stats of the last frame, layers and bytes as of its end
+   */
+  LayerStats const &frame_stats() const { return this->_stats; }
+
+  size_t size() const { return this->_layers.size(); }
+
+  size_t bytes() const { return this->_bytes; }
+
+  void clear();
+
+private:
+  struct Layer {
+    sk_sp<SkSurface> surface;
+    sk_sp<SkImage> image;
+    uint64_t version{};
+    uint64_t last_frame{};
+  };
+
+  size_t _budget;
+  size_t _bytes{0};
+  uint64_t _frame{0};
+  std::unordered_map<uuid, Layer, boost::hash<uuid>> _layers;
+  LayerStats _stats;
+
+  Counter &_hits;
+  Counter &_misses;
+  Counter &_evictions;
+  Gauge &_layer_bytes;
+  // this cache's share of _layer_bytes
+  size_t _published_bytes{0};
+
+  void _publish_bytes();
+  void _draw_node(SkCanvas &canvas, Node &node);
+  void _draw_content(SkCanvas &canvas, Node &node);
+
+  /**
+   * @brief      up to date snapshot of view's layer, null if it does not fit
+   */
+  sk_sp<SkImage> _layer(NodeView &view);
+
+  /**
+   * @brief      evict layers not used by frame in_use until bytes more fit
+   *             the budget
+   */
+  bool _make_room(size_t bytes, uint64_t in_use);
+
+  void _erase(decltype(_layers)::iterator it);
+
+  static size_t _bytes_of(SkSurface const &surface) {
+    return size_t(surface.width()) * size_t(surface.height()) * 4;
+  }
+};
+
+} // namespace my
@@ -0,0 +1,397 @@
+#include "layout.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <core/profiler.hpp>
+#include <render/node_view.hpp>
+
+namespace my {
+
+namespace {
+
+constexpr auto kAuto = LayoutStyle::kAuto;
+constexpr auto kUnbounded = LayoutStyle::kUnbounded;
+
+int32_t clamp_size(int32_t v, int32_t min, int32_t max) {
+  // min wins over max, as in CSS
+  return std::max(min, std::min(v, max));
+}
+
+// room left inside a box of size known, or of at most avail and max
+int32_t inner_size(int32_t known, int32_t avail, int32_t max, int32_t pad) {
+  if (known != kAuto) {
+    return std::max(0, known - pad);
+  }
+  auto bound = std::min(avail, max);
+  return bound >= kUnbounded ? kUnbounded : std::max(0, bound - pad);
+}
+
+// whether a size measured along an axis holds for another limit: content
+// that fit with room to spare, or fits a stricter limit, does not change,
+// nor does it when asked to be exactly the size it took
+bool reusable(int32_t old_avail, bool old_exact, int32_t avail, bool exact,
+              int32_t size) {
+  if (old_avail == avail && old_exact == exact) {
+    return true;
+  }
+  if (old_exact) {
+    return false;
+  }
+  if (exact) {
+    return size == avail;
+  }
+  return size <= avail && (size < old_avail || avail <= old_avail);
+}
+
+bool reusable(FlexLayout::Constraint const &old, FlexLayout::Constraint const &c,
+              ISize2D size) {
+  return reusable(old.width, old.exact_width, c.width, c.exact_width,
+                  size.width()) &&
+         reusable(old.height, old.exact_height, c.height, c.exact_height,
+                  size.height());
+}
+
+struct Axes {
+  bool row;
+
+  int32_t main(int32_t w, int32_t h) const { return this->row ? w : h; }
+  int32_t cross(int32_t w, int32_t h) const { return this->row ? h : w; }
+
+  int32_t main(ISize2D s) const { return this->main(s.width(), s.height()); }
+  int32_t cross(ISize2D s) const { return this->cross(s.width(), s.height()); }
+
+  int32_t main_start(Edges const &e) const {
+    return this->row ? e.left : e.top;
+  }
+  int32_t cross_start(Edges const &e) const {
+    return this->row ? e.top : e.left;
+  }
+  int32_t main_sum(Edges const &e) const {
+    return this->row ? e.left + e.right : e.top + e.bottom;
+  }
+  int32_t cross_sum(Edges const &e) const {
+    return this->row ? e.top + e.bottom : e.left + e.right;
+  }
+};
+
+} // namespace
+
+void FlexLayout::compute(Node &root, ISize2D size) {
+  MY_PROFILE_ZONE_C("render", "FlexLayout::compute");
+  auto rect = root.rect();
+  root.rect(IRect::MakeXYWH(rect.x(), rect.y(), size.width(), size.height()));
+  if (root.store() != this->_store) {
+    this->clear();
+    this->_store = root.store();
+  }
+  this->_stats = {};
+  this->_layout(root.handle(),
+                {size.width(), size.height(), true, true}, true);
+}
+
+void FlexLayout::clear() {
+  this->_store = nullptr;
+  this->_entries.clear();
+}
+
+ISize2D FlexLayout::_layout(NodeHandle node, Constraint const &c, bool place) {
+  auto &store = *this->_store;
+  auto version = store.version(node);
+  {
+    auto &entry = this->_entry(node);
+    auto const &laid_out = entry.laid_out;
+    if (laid_out.valid && laid_out.constraint == c &&
+        laid_out.version == version) {
+      ++this->_stats.cache_hits;
+      return laid_out.size;
+    }
+    if (!place) {
+      for (auto const &measured : entry.measured) {
+        if (measured.valid && measured.version == version &&
+            reusable(measured.constraint, c, measured.size)) {
+          ++this->_stats.cache_hits;
+          return measured.size;
+        }
+      }
+    }
+  }
+
+  auto const &style = this->_style(node);
+  // what the parent settled on wins over the node's own size
+  auto known_width =
+      c.exact_width ? c.width
+      : style.width != kAuto
+          ? clamp_size(style.width, style.min_width, style.max_width)
+          : kAuto;
+  auto known_height =
+      c.exact_height ? c.height
+      : style.height != kAuto
+          ? clamp_size(style.height, style.min_height, style.max_height)
+          : kAuto;
+
+  ISize2D size;
+  if (store.first_child(node)) {
+    size = this->_layout_children(node, style, c,
+                                  ISize2D::Make(known_width, known_height),
+                                  place);
+  } else {
+    auto pad_width = style.padding.left + style.padding.right;
+    auto pad_height = style.padding.top + style.padding.bottom;
+    ISize2D content = ISize2D::Make(0, 0);
+    auto view = known_width == kAuto || known_height == kAuto
+                    ? dynamic_cast<NodeView *>(Node::from(store, node))
+                    : nullptr;
+    if (view) {
+      content = view->measure(
+          inner_size(known_width, c.width, style.max_width, pad_width),
+          inner_size(known_height, c.height, style.max_height, pad_height));
+    }
+    size = ISize2D::Make(
+        known_width != kAuto
+            ? known_width
+            : clamp_size(std::min(content.width() + pad_width, c.width),
+                         style.min_width, style.max_width),
+        known_height != kAuto
+            ? known_height
+            : clamp_size(std::min(content.height() + pad_height, c.height),
+                         style.min_height, style.max_height));
+  }
+
+  auto &entry = this->_entry(node);
+  if (place) {
+    ++this->_stats.laid_out;
+    // placing the children changed the version, not the sizes
+    auto placed_version = store.version(node);
+    for (auto &measured : entry.measured) {
+      if (measured.version == version) {
+        measured.version = placed_version;
+      }
+    }
+    entry.laid_out = {true, c, size, placed_version};
+  } else {
+    ++this->_stats.measured;
+    // outdated sizes go first, then the oldest
+    auto slot = std::find_if(
+        std::begin(entry.measured), std::end(entry.measured),
+        [version](Cached const &m) { return m.version != version; });
+    if (slot == std::end(entry.measured)) {
+      slot = &entry.measured[entry.next_measured];
+      entry.next_measured = (entry.next_measured + 1) % kMeasureSlots;
+    }
+    *slot = {true, c, size, version};
+  }
+  return size;
+}
+
+ISize2D FlexLayout::_layout_children(NodeHandle node, LayoutStyle const &style,
+                                     Constraint const &c, ISize2D known,
+                                     bool place) {
+  auto &store = *this->_store;
+  Axes axes{style.direction == FlexDirection::kRow};
+  auto &items = this->_items;
+  auto begin = items.size();
+  for (auto child = store.first_child(node); child;
+       child = store.next_sibling(child)) {
+    items.push_back({child, &this->_style(child), 0, 0, 0});
+  }
+  auto end = items.size();
+  auto count = int32_t(end - begin);
+
+  auto pad_main = axes.main_sum(style.padding);
+  auto pad_cross = axes.cross_sum(style.padding);
+  auto known_main = axes.main(known);
+  auto known_cross = axes.cross(known);
+  auto avail_main = axes.main(c.width, c.height);
+  auto avail_cross = axes.cross(c.width, c.height);
+  auto min_main = axes.main(style.min_width, style.min_height);
+  auto max_main = axes.main(style.max_width, style.max_height);
+  auto min_cross = axes.cross(style.min_width, style.min_height);
+  auto max_cross = axes.cross(style.max_width, style.max_height);
+  auto inner_main = inner_size(known_main, avail_main, max_main, pad_main);
+  auto inner_cross = inner_size(known_cross, avail_cross, max_cross, pad_cross);
+
+  // a child's size along an axis, given the room of the container
+  auto constraint = [&axes](int32_t main, bool exact_main, int32_t cross,
+                            bool exact_cross) {
+    return axes.row ? Constraint{main, cross, exact_main, exact_cross}
+                    : Constraint{cross, main, exact_cross, exact_main};
+  };
+  auto room = [](int32_t inner, int32_t margins) {
+    return inner >= kUnbounded ? kUnbounded : std::max(0, inner - margins);
+  };
+
+  // flex bases
+  int64_t used = int64_t(style.gap) * std::max(0, count - 1);
+  for (auto i = begin; i < end; ++i) {
+    auto const &cs = *items[i].style;
+    auto fixed = axes.main(cs.width, cs.height);
+    int32_t basis;
+    if (fixed != kAuto) {
+      basis = fixed;
+    } else {
+      auto stretched = style.align == FlexAlign::kStretch &&
+                       known_cross != kAuto &&
+                       axes.cross(cs.width, cs.height) == kAuto;
+      auto size = this->_layout(
+          items[i].node,
+          constraint(room(inner_main, axes.main_sum(cs.margin)), false,
+                     room(inner_cross, axes.cross_sum(cs.margin)), stretched),
+          false);
+      basis = axes.main(size);
+    }
+    basis = clamp_size(basis, axes.main(cs.min_width, cs.min_height),
+                       axes.main(cs.max_width, cs.max_height));
+    items[i].basis = basis;
+    used += basis + axes.main_sum(cs.margin);
+  }
+
+  auto main_size =
+      known_main != kAuto
+          ? known_main
+          : clamp_size(int32_t(std::min<int64_t>(used + pad_main, avail_main)),
+                       min_main, max_main);
+  auto free = int64_t(std::max(0, main_size - pad_main)) - used;
+
+  // grow or shrink, rounding the running total so the sizes add up
+  float grow = 0, shrink = 0;
+  for (auto i = begin; i < end; ++i) {
+    grow += items[i].style->grow;
+    shrink += items[i].style->shrink * float(items[i].basis);
+  }
+  float total = 0;
+  int32_t rounded = 0;
+  for (auto i = begin; i < end; ++i) {
+    auto const &cs = *items[i].style;
+    float share = 0;
+    if (free > 0 && grow > 0) {
+      share = float(free) * cs.grow / grow;
+    } else if (free < 0 && shrink > 0) {
+      share = float(free) * cs.shrink * float(items[i].basis) / shrink;
+    }
+    total += share;
+    auto delta = int32_t(std::lround(total)) - rounded;
+    rounded += delta;
+    items[i].main = clamp_size(items[i].basis + delta,
+                               axes.main(cs.min_width, cs.min_height),
+                               axes.main(cs.max_width, cs.max_height));
+  }
+
+  // cross sizes, auto sized children are stretched once the container's
+  // cross size is known
+  int32_t content_cross = 0;
+  for (auto i = begin; i < end; ++i) {
+    auto const &cs = *items[i].style;
+    auto min_child = axes.cross(cs.min_width, cs.min_height);
+    auto max_child = axes.cross(cs.max_width, cs.max_height);
+    auto fixed = axes.cross(cs.width, cs.height);
+    int32_t cross;
+    if (fixed != kAuto) {
+      cross = clamp_size(fixed, min_child, max_child);
+    } else if (style.align == FlexAlign::kStretch && known_cross != kAuto) {
+      cross = clamp_size(room(inner_cross, axes.cross_sum(cs.margin)),
+                         min_child, max_child);
+    } else {
+      auto size = this->_layout(
+          items[i].node,
+          constraint(items[i].main, true,
+                     room(inner_cross, axes.cross_sum(cs.margin)), false),
+          false);
+      cross = axes.cross(size);
+    }
+    items[i].cross = cross;
+    content_cross =
+        std::max(content_cross, cross + axes.cross_sum(cs.margin));
+  }
+  auto cross_size =
+      known_cross != kAuto
+          ? known_cross
+          : clamp_size(std::min(content_cross + pad_cross, avail_cross),
+                       min_cross, max_cross);
+  auto final_inner_cross = std::max(0, cross_size - pad_cross);
+  if (style.align == FlexAlign::kStretch && known_cross == kAuto) {
+    for (auto i = begin; i < end; ++i) {
+      auto const &cs = *items[i].style;
+      if (axes.cross(cs.width, cs.height) == kAuto) {
+        items[i].cross = clamp_size(
+            std::max(0, final_inner_cross - axes.cross_sum(cs.margin)),
+            axes.cross(cs.min_width, cs.min_height),
+            axes.cross(cs.max_width, cs.max_height));
+      }
+    }
+  }
+
+  if (place) {
+    int64_t taken = int64_t(style.gap) * std::max(0, count - 1);
+    for (auto i = begin; i < end; ++i) {
+      taken += items[i].main + axes.main_sum(items[i].style->margin);
+    }
+    auto leftover = int32_t(int64_t(std::max(0, main_size - pad_main)) - taken);
+    int32_t pos = axes.main_start(style.padding);
+    int32_t spacing = style.gap;
+    switch (style.justify) {
+    case FlexJustify::kStart:
+      break;
+    case FlexJustify::kCenter:
+      pos += leftover / 2;
+      break;
+    case FlexJustify::kEnd:
+      pos += leftover;
+      break;
+    case FlexJustify::kSpaceBetween:
+      if (count > 1 && leftover > 0) {
+        spacing += leftover / (count - 1);
+      }
+      break;
+    }
+
+    for (auto i = begin; i < end; ++i) {
+      auto item = items[i];
+      auto const &cs = *item.style;
+      pos += axes.main_start(cs.margin);
+      auto cross_pos = axes.cross_start(style.padding) +
+                       axes.cross_start(cs.margin);
+      auto cross_left =
+          final_inner_cross - item.cross - axes.cross_sum(cs.margin);
+      if (style.align == FlexAlign::kCenter) {
+        cross_pos += cross_left / 2;
+      } else if (style.align == FlexAlign::kEnd) {
+        cross_pos += cross_left;
+      }
+
+      this->_layout(item.node, constraint(item.main, true, item.cross, true),
+                    true);
+      store.rect(item.node,
+                 axes.row ? IRect::MakeXYWH(pos, cross_pos, item.main,
+                                            item.cross)
+                          : IRect::MakeXYWH(cross_pos, pos, item.cross,
+                                            item.main));
+      pos += item.main + axes.main_sum(cs.margin) - axes.main_start(cs.margin) +
+             spacing;
+    }
+  }
+  items.resize(begin);
+
+  return axes.row ? ISize2D::Make(main_size, cross_size)
+                  : ISize2D::Make(cross_size, main_size);
+}
+
+FlexLayout::Entry &FlexLayout::_entry(NodeHandle node) {
+  if (this->_entries.size() <= node.index) {
+    this->_entries.resize(node.index + 1);
+  }
+  auto &entry = this->_entries[node.index];
+  if (entry.generation != node.generation) {
+    entry = Entry{};
+    entry.generation = node.generation;
+  }
+  return entry;
+}
+
+LayoutStyle const &FlexLayout::_style(NodeHandle node) const {
+  static const LayoutStyle container;
+  auto view = dynamic_cast<NodeView const *>(Node::from(*this->_store, node));
+  return view ? view->layout_style() : container;
+}
+
+} // namespace my
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <limits>
+#include <vector>
+
+#include <render/node.hpp>
+
+namespace my {
+
+enum class FlexDirection { kRow, kColumn };
+
+enum class FlexJustify { kStart, kCenter, kEnd, kSpaceBetween };
+
+enum class FlexAlign { kStart, kCenter, kEnd, kStretch };
+
+struct Edges {
+  int32_t left{0};
+  int32_t top{0};
+  int32_t right{0};
+  int32_t bottom{0};
+
+  static Edges all(int32_t v) { return {v, v, v, v}; }
+
+  bool operator==(Edges const &o) const {
+    return this->left == o.left && this->top == o.top &&
+           this->right == o.right && this->bottom == o.bottom;
+  }
+};
+
+/**
+ * @brief      how a node sizes itself and places its children, a subset of
+ *             CSS flexbox
+ *
+ * Sizes are border-box, margins are outside of them.
+ */
+struct LayoutStyle {
+  static constexpr int32_t kAuto = -1;
+  static constexpr int32_t kUnbounded = std::numeric_limits<int32_t>::max() / 4;
+
+  FlexDirection direction{FlexDirection::kColumn};
+  FlexJustify justify{FlexJustify::kStart};
+  FlexAlign align{FlexAlign::kStretch};
+  float grow{0};
+  float shrink{1};
+
+  int32_t width{kAuto};
+  int32_t height{kAuto};
+  int32_t min_width{0};
+  int32_t min_height{0};
+  int32_t max_width{kUnbounded};
+  int32_t max_height{kUnbounded};
+
+  Edges padding;
+  Edges margin;
+  // between children along the main axis
+  int32_t gap{0};
+};
+
+struct LayoutStats {
+  // nodes whose children were placed
+  uint64_t laid_out{};
+  // sizes computed without placing
+  uint64_t measured{};
+  // subtrees and sizes taken from the cache
+  uint64_t cache_hits{};
+};
+
+/**
+ * @brief      flexbox layout of a node tree, writing the rects of the nodes
+ *
+ * NodeViews are styled by their layout_style() and measure their content
+ * with measure(), other nodes are containers with the default style.
+ * Results are cached per node together with the constraints and the
+ * node's NodeStore version. A node is measured or laid out again only if
+ * its constraints changed or something in its subtree did, including a
+ * style change or invalidate(). Rects are written only when they change,
+ * so unchanged parts keep their versions for the layer cache and the hit
+ * index. Not thread-safe.
+ */
+class FlexLayout {
+public:
+  /**
+   * @brief      lay root and its subtree out into size
+   */
+  void compute(Node &root, ISize2D size);
+
+  /**
+   * @brief      stats of the last compute()
+   */
+  LayoutStats const &stats() const { return this->_stats; }
+
+  void clear();
+
+  struct Constraint {
+    int32_t width{0};
+    int32_t height{0};
+    bool exact_width{false};
+    bool exact_height{false};
+
+    bool operator==(Constraint const &o) const {
+      return this->width == o.width && this->height == o.height &&
+             this->exact_width == o.exact_width &&
+             this->exact_height == o.exact_height;
+    }
+  };
+
+private:
+  struct Cached {
+    bool valid{false};
+    Constraint constraint;
+    ISize2D size{0, 0};
+    uint64_t version{0};
+  };
+
+  // a child is measured for its basis and its cross size, under the
+  // constraints of its container being measured and being placed, which
+  // deep trees repeat in turns
+  static constexpr size_t kMeasureSlots = 8;
+
+  struct Entry {
+    uint32_t generation{};
+    Cached measured[kMeasureSlots];
+    uint8_t next_measured{0};
+    Cached laid_out;
+  };
+
+  struct Item {
+    NodeHandle node;
+    LayoutStyle const *style;
+    int32_t basis;
+    int32_t main;
+    int32_t cross;
+  };
+
+  NodeStore *_store{};
+  std::vector<Entry> _entries;
+  LayoutStats _stats;
+  // children of the containers being laid out, nested containers push
+  // theirs on top
+  std::vector<Item> _items;
+
+  ISize2D _layout(NodeHandle node, Constraint const &c, bool place);
+
+  /**
+   * @brief      size node from its children and place them if place is set,
+   *             known holds the sizes fixed by the style or the parent
+   */
+  ISize2D _layout_children(NodeHandle node, LayoutStyle const &style,
+                           Constraint const &c, ISize2D known, bool place);
+
+  Entry &_entry(NodeHandle node);
+  LayoutStyle const &_style(NodeHandle node) const;
+};
+
+} // namespace my
@@ -0,0 +1,128 @@
+#include "node.hpp"
+
+#include <unordered_map>
+
+namespace my {
+
+Node::Tree::~Tree() {
+  // nodes referenced elsewhere outlive the tree as single nodes
+  if (this->root && this->root->_tree == this) {
+    this->store.pre_order(this->root->_handle, [this](NodeHandle handle) {
+      auto node = Node::from(this->store, handle);
+      node->_tree = nullptr;
+      node->_handle = {};
+    });
+  }
+}
+
+void Node::append_child(ptr_type child) {
+  if (!child || child.get() == this) {
+    throw NodeError("node can not become its own descendant");
+  }
+  this->_ensure_tree();
+  auto &tree = *this->_tree;
+
+  if (child->_tree == &tree) {
+    tree.store.append_child(this->_handle, child->_handle);
+    return;
+  }
+
+  if (!child->_tree) {
+    auto handle = tree.store.create();
+    tree.store.user(handle, child.get());
+    tree.store.append_child(this->_handle, handle);
+    if (tree.owned.size() <= handle.index) {
+      tree.owned.resize(handle.index + 1);
+    }
+    child->_tree = &tree;
+    child->_handle = handle;
+    tree.owned[handle.index] = std::move(child);
+    return;
+  }
+
+  // keeps the old tree alive while its root moves out of it
+  auto old_tree = std::move(child->_own_tree);
+  child->_move_to(tree, this->_handle, child);
+}
+
+void Node::detach() {
+  if (!this->_tree || this->_tree->root == this) {
+    return;
+  }
+  auto self = this->shared_from_this();
+  auto tree = std::make_unique<Tree>();
+  tree->root = this;
+  this->_move_to(*tree, {}, self);
+  this->_own_tree = std::move(tree);
+}
+
+Node::ptr_type Node::parent() const {
+  if (!this->_tree) {
+    return nullptr;
+  }
+  auto &tree = *this->_tree;
+  auto parent = tree.store.parent(this->_handle);
+  if (!parent) {
+    return nullptr;
+  }
+  if (parent.index < tree.owned.size() && tree.owned[parent.index]) {
+    return tree.owned[parent.index];
+  }
+  return tree.root->shared_from_this();
+}
+
+Node::ptr_type Node::root() const {
+  if (!this->_tree) {
+    return const_cast<Node *>(this)->shared_from_this();
+  }
+  return this->_tree->root->shared_from_this();
+}
+
+void Node::_ensure_tree() {
+  if (this->_tree) {
+    return;
+  }
+  this->_own_tree = std::make_unique<Tree>();
+  this->_tree = this->_own_tree.get();
+  this->_tree->root = this;
+  this->_handle = this->_tree->store.create();
+  this->_tree->store.user(this->_handle, this);
+}
+
+void Node::_move_to(Tree &dst, NodeHandle dst_parent, ptr_type const &self) {
+  auto &src = *this->_tree;
+  std::unordered_map<uint32_t, NodeHandle> moved_to;
+  std::vector<std::pair<Node *, NodeHandle>> moved;
+
+  src.store.pre_order(this->_handle, [&](NodeHandle handle) {
+    auto node = Node::from(src.store, handle);
+    auto to = dst.store.create();
+    dst.store.user(to, node);
+    dst.store.rect(to, src.store.rect(handle));
+    dst.store.transform(to, src.store.transform(handle));
+
+    auto parent = node == this ? dst_parent
+                               : moved_to.at(src.store.parent(handle).index);
+    if (parent) {
+      dst.store.append_child(parent, to);
+    }
+    moved_to.emplace(handle.index, to);
+    moved.emplace_back(node, to);
+
+    if (dst.owned.size() <= to.index) {
+      dst.owned.resize(to.index + 1);
+    }
+    if (handle.index < src.owned.size()) {
+      dst.owned[to.index] = std::move(src.owned[handle.index]);
+    }
+  });
+  src.store.destroy(this->_handle);
+
+  for (auto [node, handle] : moved) {
+    node->_tree = &dst;
+    node->_handle = handle;
+  }
+  dst.owned[moved.front().second.index] = dst_parent ? self : nullptr;
+}
+
+} // namespace my
@@ -1,95 +1,117 @@
 #pragma once
 
-#include <core/core.hpp>
+#include <core/type.hpp>
 
 #include <render/exception.hpp>
+#include <render/node_store.hpp>
 #include <render/type.hpp>
 #include <util/uuid.hpp>
 
-#include <tree.hh>
-
 namespace my {
 
-// class Node:
-//   修改操作(针对子树)
-//   只读操作
-//   保存 RootNode 实例(用于只读操作整个树)
-//   保存 node pos (nodeTreeIter)
-// class RootNode
-//   读写操作树
-
-template <typename T> class TreeNode {
-  using data_type = T;
-  using self_type = TreeNode<data_type>;
-  using ptr_type = shared_ptr<self_type>;
-  using tree_type = tree<data_type>;
-  using tree_iter_type = typename tree_type::iterator;
-  using tree_ptr_type = shared_ptr<tree_type>;
+/**
+ * @brief      scene tree node
+ *
+ * The hierarchy, rect and transform of every node of a tree live in the
+ * NodeStore of the tree's root, a Node is a handle into it plus the cold
+ * data (id and name). A node made with make() is a tree of its own once it
+ * needs storage; appending it to another tree moves its subtree into that
+ * tree's store. The tree keeps its nodes alive, dropping the root detaches
+ * every node still referenced elsewhere into a single node.
+ */
+class Node : public std::enable_shared_from_this<Node> {
+  using self_type = Node;
+  using ptr_type = shared_ptr<Node>;
 
 public:
-  TreeNode() {}
-
-  // TreeNode(tree_ptr_type tree, tree_iter_type pos) : _tree(tree), _pos(pos)
-  // {}
+  virtual ~Node() = default;
 
-  data_type const &parent() const {
-    return *this->_tree->parent(this->_pos);
+  static ptr_type make(std::string const &name = {}) {
+    return shared_ptr<Node>(new Node(name));
   }
-  
-  void append_child(data_type child) {
-    auto child_pos = this->_tree->append_child(this->_pos, child);
-    child->set_tree_node(this->_tree, child_pos);
+
+  static ptr_type make_root(std::string const &name = {}) {
+    auto root = Node::make(name);
+    root->_ensure_tree();
+    return root;
   }
 
-  void set_tree_node(tree_ptr_type tree, tree_iter_type pos) {
-    BOOST_ASSERT_MSG(!this->_tree, "node cannot have multiple parent nodes");
+  /**
+   * @brief      append child as last child, taking it out of its old tree
+   *
+   * @throw      NodeError if child is this node or one of its ancestors
+   */
+  void append_child(ptr_type child);
 
-    this->_tree = tree;
-    this->_pos = pos;
-  }
+  /**
+   * @brief      take this node and its subtree out of its tree, it becomes
+   *             the root of a tree of its own
+   */
+  void detach();
 
-  void as_root(data_type head) {
-    auto tree = std::make_shared<tree_type>();
-    auto pos = tree->set_head(head);
-    this->set_tree_node(tree, pos);
-  }
+  ptr_type parent() const;
 
-  template <typename Callback> void post_order(Callback &&cb) {
-    auto const &tree = this->_tree;
-    tree_iter_type it = tree->begin();
-    while (it != tree->end())
-      cb(*it++);
+  ptr_type root() const;
+
+  bool is_root() const {
+    return !this->_tree || this->_tree->root == this;
   }
 
-  bool is_root() const { return this->_tree->is_head(this->iter); }
+  int depth() const {
+    return this->_tree ? this->_tree->store.depth(this->_handle) : 0;
+  }
 
-  T const &root() const { return this->_tree->head->data; };
+  /**
+   * @brief      cb(ptr_type const &) for this node and its descendants,
+   *             parents before children
+   */
+  template <typename Callback> void pre_order(Callback &&cb) {
+    this->_visit<true>(std::forward<Callback>(cb));
+  }
 
-  int depth() const { return this->_tree->depth(this->_pos); }
+  /**
+   * @brief      cb(ptr_type const &) for this node and its descendants,
+   *             children before parents
+   */
+  template <typename Callback> void post_order(Callback &&cb) {
+    this->_visit<false>(std::forward<Callback>(cb));
+  }
 
-private:
-  tree_ptr_type _tree;
-  tree_iter_type _pos;
-};
+  IRect const &rect() const {
+    static const IRect empty = IRect::MakeEmpty();
+    return this->_tree ? this->_tree->store.rect(this->_handle) : empty;
+  }
 
-class Node : public std::enable_shared_from_this<Node>,
-             public TreeNode<shared_ptr<Node>> {
-  using self_type = Node;
-  using ptr_type = shared_ptr<Node>;
-  using tree_node_type = TreeNode<shared_ptr<Node>>;
+  void rect(IRect const &rect) {
+    this->_ensure_tree();
+    this->_tree->store.rect(this->_handle, rect);
+  }
 
-public:
-  virtual ~Node() = default;
+  Matrix const &transform() const {
+    return this->_tree ? this->_tree->store.transform(this->_handle)
+                       : Matrix::I();
+  }
 
-  static ptr_type make() { return shared_ptr<Node>(new Node()); }
+  void transform(Matrix const &m) {
+    this->_ensure_tree();
+    this->_tree->store.transform(this->_handle, m);
+  }
 
-  static ptr_type make_root() {
-    auto root = Node::make();
-    root->as_root(root);
-    return root;
+  /**
+   * @brief      mark the content of this node as changed, e.g. to redraw
+   *             layers holding it
+   */
+  void invalidate() {
+    this->_ensure_tree();
+    this->_tree->store.touch(this->_handle);
   }
 
-  void append_child(ptr_type child) { tree_node_type::append_child(child); }
+  /**
+   * @brief      see NodeStore::version()
+   */
+  uint64_t version() const {
+    return this->_tree ? this->_tree->store.version(this->_handle) : 0;
+  }
 
   std::string const &name() const { return this->_name; }
 
@@ -97,16 +119,76 @@ public:
 
   uuid const &id() const { return this->_id; }
 
+  /**
+   * @brief      store of the tree and this node's slot in it, for passes
+   *             over the whole tree without the Node objects
+   *
+   * The store pointer is null until the node needs storage, handles change
+   * when a node moves to another tree.
+   */
+  NodeStore *store() const {
+    return this->_tree ? &this->_tree->store : nullptr;
+  }
+
+  NodeHandle handle() const { return this->_handle; }
+
+  /**
+   * @brief      the node a store slot belongs to
+   */
+  static Node *from(NodeStore const &store, NodeHandle handle) {
+    return static_cast<Node *>(store.user(handle));
+  }
+
 protected:
-  Node() : _id{uuid_gen()} {}
+  explicit Node(std::string const &name = {})
+      : _id{uuid_gen()}, _name(name) {}
 
 private:
-  using tree_node_type::append_child;
+  struct Tree {
+    NodeStore store;
+    Node *root{};
+    // owners of the members by slot, empty for the root which owns the tree
+    std::vector<ptr_type> owned;
+
+    ~Tree();
+  };
 
-  // void id(std::string const &id) { this->_id = id; }
+  Tree *_tree{};
+  unique_ptr<Tree> _own_tree;
+  NodeHandle _handle;
 
   uuid _id;
   std::string _name;
+
+  void _ensure_tree();
+
+  /**
+   * @brief      move this node's subtree to dst below dst_parent, or as its
+   *             root if dst_parent is null
+   */
+  void _move_to(Tree &dst, NodeHandle dst_parent, ptr_type const &self);
+
+  template <bool kPreOrder, typename Callback> void _visit(Callback &&cb) {
+    if (!this->_tree) {
+      cb(this->shared_from_this());
+      return;
+    }
+    auto &tree = *this->_tree;
+    auto root = tree.root->shared_from_this();
+    auto visit = [&tree, &root, &cb](NodeHandle node) {
+      auto &owned = tree.owned;
+      if (node.index < owned.size() && owned[node.index]) {
+        cb(owned[node.index]);
+      } else {
+        cb(root);
+      }
+    };
+    if constexpr (kPreOrder) {
+      tree.store.pre_order(this->_handle, visit);
+    } else {
+      tree.store.post_order(this->_handle, visit);
+    }
+  }
 };
 
 } // namespace my
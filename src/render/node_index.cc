@@ -0,0 +1,291 @@
+#include "node_index.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace my {
+
+void NodeIndex::sync(NodeStore const &store, NodeHandle root) {
+  if (!store.valid(root)) {
+    this->clear();
+    return;
+  }
+  auto const &rect = store.rect(root);
+  auto grid = rect.isEmpty()
+                  ? IRect::MakeEmpty()
+                  : store.local_transform(root)
+                        .mapRect(Rect::MakeWH(float(rect.width()),
+                                              float(rect.height())))
+                        .roundOut();
+  if (&store != this->_store || root != this->_root || grid != this->_grid) {
+    this->_reset(grid);
+    this->_store = &store;
+    this->_root = root;
+  }
+
+  ++this->_epoch;
+  this->_orphans.clear();
+  this->_stack.push_back({root, NodeHandle::kNil, 0});
+  while (!this->_stack.empty()) {
+    auto visit = this->_stack.back();
+    this->_stack.pop_back();
+    this->_visit(visit);
+  }
+
+  // children that were not found again were detached or destroyed
+  for (auto index : this->_orphans) {
+    this->_remove_subtree(index);
+  }
+}
+
+std::optional<NodeHit> NodeIndex::hit_test(Point2D pos) const {
+  auto x = int32_t(std::floor(pos.x()));
+  auto y = int32_t(std::floor(pos.y()));
+  if (!this->_grid.contains(x, y)) {
+    return std::nullopt;
+  }
+  auto const &cell =
+      this->_cells[size_t((y - this->_grid.top()) / this->_cell_size) *
+                       size_t(this->_columns) +
+                   size_t((x - this->_grid.left()) / this->_cell_size)];
+
+  auto best = NodeHandle::kNil;
+  Point2D best_local{};
+  for (auto index : cell) {
+    auto const &e = this->_entries[index];
+    if (!e.bounds.contains(x, y) ||
+        !this->_store->valid({index, e.generation})) {
+      continue;
+    }
+    auto local = e.inverse.mapXY(pos.x(), pos.y());
+    if (local.x() < 0 || local.y() < 0 || local.x() >= e.size.width() ||
+        local.y() >= e.size.height()) {
+      continue;
+    }
+    if (best == NodeHandle::kNil || this->_below(best, index)) {
+      best = index;
+      best_local = local;
+    }
+  }
+  if (best == NodeHandle::kNil) {
+    return std::nullopt;
+  }
+  return NodeHit{{best, this->_entries[best].generation}, best_local};
+}
+
+bool NodeIndex::hover(Point2D pos) {
+  auto hit = this->hit_test(pos);
+  auto node = hit ? hit->node : NodeHandle{};
+  if (node == this->_hovered) {
+    return false;
+  }
+  this->_hovered = node;
+  return true;
+}
+
+IRect NodeIndex::bounds(NodeHandle node) const {
+  if (node.index >= this->_entries.size()) {
+    return IRect::MakeEmpty();
+  }
+  auto const &e = this->_entries[node.index];
+  if (!e.present || e.generation != node.generation) {
+    return IRect::MakeEmpty();
+  }
+  return e.bounds;
+}
+
+void NodeIndex::clear() {
+  this->_reset(IRect::MakeEmpty());
+  this->_store = nullptr;
+  this->_root = {};
+}
+
+void NodeIndex::_reset(IRect const &grid) {
+  this->_grid = grid;
+  this->_columns = (grid.width() + this->_cell_size - 1) / this->_cell_size;
+  auto rows = (grid.height() + this->_cell_size - 1) / this->_cell_size;
+  this->_cells.clear();
+  this->_cells.resize(size_t(this->_columns) * size_t(rows));
+  this->_entries.clear();
+  this->_size = 0;
+  this->_hovered = {};
+}
+
+void NodeIndex::_visit(Visit const &visit) {
+  auto &store = *this->_store;
+  auto index = visit.node.index;
+  if (this->_entries.size() <= index) {
+    this->_entries.resize(index + 1);
+  }
+
+  auto *e = &this->_entries[index];
+  if (e->present && e->generation != visit.node.generation) {
+    // the slot was reused by another node
+    this->_file(index, e->bounds, IRect::MakeEmpty());
+    this->_push_children(index, this->_orphans);
+    this->_reset_entry(index);
+  }
+
+  auto world = store.local_transform(visit.node);
+  auto clip = this->_grid;
+  uint32_t depth = 0;
+  if (visit.parent != NodeHandle::kNil) {
+    auto const &parent = this->_entries[visit.parent];
+    world = Matrix::Concat(parent.world, world);
+    clip = parent.clip;
+    depth = parent.depth + 1;
+  }
+  auto const &rect = store.rect(visit.node);
+  auto bounds = IRect::MakeEmpty();
+  if (!rect.isEmpty()) {
+    bounds = world
+                 .mapRect(Rect::MakeWH(float(rect.width()),
+                                       float(rect.height())))
+                 .roundOut();
+    if (!bounds.intersect(clip)) {
+      bounds = IRect::MakeEmpty();
+    }
+  }
+  Matrix inverse;
+  if (!world.invert(&inverse)) {
+    bounds = IRect::MakeEmpty();
+  }
+  auto child_clip = rect.isEmpty() ? clip : bounds;
+
+  bool placed = e->present && e->world == world &&
+                e->size.width() == rect.width() &&
+                e->size.height() == rect.height() && e->bounds == bounds &&
+                e->clip == child_clip && e->depth == depth;
+  if (!placed) {
+    this->_file(index, e->present ? e->bounds : IRect::MakeEmpty(), bounds);
+    e->world = world;
+    e->inverse = inverse;
+    e->size = rect.size();
+    e->bounds = bounds;
+    e->clip = child_clip;
+    e->depth = depth;
+  }
+  e->parent = visit.parent;
+  e->order = visit.order;
+  e->present = true;
+  e->generation = visit.node.generation;
+  e->epoch = this->_epoch;
+
+  // nothing below moved or changed
+  auto version = store.version(visit.node);
+  if (placed && e->version == version) {
+    return;
+  }
+  e->version = version;
+
+  this->_push_children(index, this->_orphans);
+
+  uint32_t order = 0;
+  auto prev = NodeHandle::kNil;
+  this->_entries[index].first_child = NodeHandle::kNil;
+  for (auto child = store.first_child(visit.node); child;
+       child = store.next_sibling(child)) {
+    if (this->_entries.size() <= child.index) {
+      this->_entries.resize(child.index + 1);
+    }
+    if (prev == NodeHandle::kNil) {
+      this->_entries[index].first_child = child.index;
+    } else {
+      this->_link(prev, child.index);
+    }
+    this->_link(child.index, NodeHandle::kNil);
+    prev = child.index;
+    this->_stack.push_back({child, index, order++});
+  }
+}
+
+void NodeIndex::_push_children(uint32_t index, std::vector<uint32_t> &out) {
+  for (auto c = this->_entries[index].first_child; c != NodeHandle::kNil;
+       c = this->_old_next(c)) {
+    out.push_back(c);
+  }
+}
+
+uint32_t NodeIndex::_old_next(uint32_t index) const {
+  auto const &e = this->_entries[index];
+  return e.link_epoch == this->_epoch ? e.old_next_sibling : e.next_sibling;
+}
+
+void NodeIndex::_link(uint32_t index, uint32_t next) {
+  auto &e = this->_entries[index];
+  if (e.link_epoch != this->_epoch) {
+    e.old_next_sibling = e.next_sibling;
+    e.link_epoch = this->_epoch;
+  }
+  e.next_sibling = next;
+}
+
+void NodeIndex::_reset_entry(uint32_t index) {
+  auto next = this->_old_next(index);
+  auto &e = this->_entries[index];
+  e = Entry{};
+  e.old_next_sibling = next;
+  e.link_epoch = this->_epoch;
+}
+
+void NodeIndex::_remove_subtree(uint32_t index) {
+  std::vector<uint32_t> pending{index};
+  while (!pending.empty()) {
+    auto i = pending.back();
+    pending.pop_back();
+    auto &e = this->_entries[i];
+    // not present any more, or found elsewhere in the tree
+    if (!e.present || e.epoch == this->_epoch) {
+      continue;
+    }
+    this->_file(i, e.bounds, IRect::MakeEmpty());
+    this->_push_children(i, pending);
+    if (this->_hovered.index == i) {
+      this->_hovered = {};
+    }
+    this->_reset_entry(i);
+  }
+}
+
+void NodeIndex::_file(uint32_t index, IRect const &from, IRect const &to) {
+  if (from == to) {
+    return;
+  }
+  this->_for_cells(from, [index](std::vector<uint32_t> &cell) {
+    auto it = std::find(cell.begin(), cell.end(), index);
+    if (it != cell.end()) {
+      *it = cell.back();
+      cell.pop_back();
+    }
+  });
+  this->_for_cells(to, [index](std::vector<uint32_t> &cell) {
+    cell.push_back(index);
+  });
+  if (from.isEmpty() != to.isEmpty()) {
+    this->_size += to.isEmpty() ? -1 : 1;
+  }
+}
+
+bool NodeIndex::_below(uint32_t a, uint32_t b) const {
+  auto const &entries = this->_entries;
+  // ancestors are drawn before their descendants
+  while (entries[a].depth > entries[b].depth) {
+    a = entries[a].parent;
+    if (a == b) {
+      return false;
+    }
+  }
+  while (entries[b].depth > entries[a].depth) {
+    b = entries[b].parent;
+    if (a == b) {
+      return true;
+    }
+  }
+  while (entries[a].parent != entries[b].parent) {
+    a = entries[a].parent;
+    b = entries[b].parent;
+  }
+  return entries[a].order < entries[b].order;
+}
+
+} // namespace my
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include <render/node_store.hpp>
+#include <render/type.hpp>
+
+namespace my {
+
+struct NodeHit {
+  NodeHandle node;
+  // the point in the node's local space
+  Point2D local;
+};
+
+/**
+ * @brief      uniform grid over the window-space bounds of a node tree
+ *
+ * Every node with a non-empty rect is filed under the grid cells its
+ * bounds cover, the bounds being clipped by the ancestors' rects and the
+ * root's rect, which is the window. sync() only walks the subtrees whose
+ * NodeStore version changed since the last sync, so moving a node refiles
+ * it and its descendants and nothing else. A hit test looks at the entries
+ * of one cell and maps the point into each candidate's local space, so
+ * rotated and scaled nodes hit exactly; clipping by ancestors uses their
+ * bounding boxes. Queries reflect the tree as of the last sync, except that
+ * destroyed nodes never hit. Not thread-safe.
+ */
+class NodeIndex {
+public:
+  static constexpr int32_t kDefaultCellSize = 64;
+
+  explicit NodeIndex(int32_t cell_size = kDefaultCellSize)
+      : _cell_size(cell_size) {
+    if (cell_size <= 0) {
+      throw NodeError("cell size must be positive");
+    }
+  }
+
+  /**
+   * @brief      bring the index up to date with root's subtree, a different
+   *             store or root rebuilds it
+   */
+  void sync(NodeStore const &store, NodeHandle root);
+
+  /**
+   * @brief      topmost node at pos, children above their parent and later
+   *             siblings above earlier ones
+   */
+  std::optional<NodeHit> hit_test(Point2D pos) const;
+
+  /**
+   * @brief      move the pointer to pos
+   *
+   * @return     true if the hovered node changed
+   */
+  bool hover(Point2D pos);
+
+  NodeHandle hovered() const { return this->_hovered; }
+
+  /**
+   * @brief      window-space bounds of node as of the last sync, empty if it
+   *             is not visible
+   */
+  IRect bounds(NodeHandle node) const;
+
+  /**
+   * @brief      nodes with non-empty bounds
+   */
+  size_t size() const { return this->_size; }
+
+  void clear();
+
+private:
+  struct Entry {
+    uint32_t generation{};
+    bool present{false};
+    uint64_t epoch{0};
+    uint64_t version{0};
+
+    Matrix world;
+    Matrix inverse;
+    ISize2D size{0, 0};
+    IRect bounds{IRect::MakeEmpty()};
+    // what the children are clipped by
+    IRect clip{IRect::MakeEmpty()};
+
+    // hierarchy as of the last sync, for ordering hits and for finding
+    // removed subtrees
+    uint32_t parent{NodeHandle::kNil};
+    uint32_t depth{0};
+    uint32_t order{0};
+    uint32_t first_child{NodeHandle::kNil};
+    uint32_t next_sibling{NodeHandle::kNil};
+    // next_sibling before the running sync relinked it, the old sibling
+    // lists are walked for removed children until the sync ends
+    uint32_t old_next_sibling{NodeHandle::kNil};
+    uint64_t link_epoch{0};
+  };
+
+  struct Visit {
+    NodeHandle node;
+    uint32_t parent;
+    uint32_t order;
+  };
+
+  int32_t _cell_size;
+  NodeStore const *_store{};
+  NodeHandle _root;
+  IRect _grid{IRect::MakeEmpty()};
+  int32_t _columns{0};
+  std::vector<std::vector<uint32_t>> _cells;
+  std::vector<Entry> _entries;
+  size_t _size{0};
+  uint64_t _epoch{0};
+  NodeHandle _hovered;
+
+  std::vector<Visit> _stack;
+  std::vector<uint32_t> _orphans;
+
+  void _reset(IRect const &grid);
+  void _visit(Visit const &visit);
+  void _remove_subtree(uint32_t index);
+  void _file(uint32_t index, IRect const &from, IRect const &to);
+
+  void _push_children(uint32_t index, std::vector<uint32_t> &out);
+  uint32_t _old_next(uint32_t index) const;
+  void _link(uint32_t index, uint32_t next);
+  void _reset_entry(uint32_t index);
+
+  /**
+   * @brief      whether the node at index a is drawn before the one at b
+   */
+  bool _below(uint32_t a, uint32_t b) const;
+
+  template <typename Func> void _for_cells(IRect const &bounds, Func &&func) {
+    if (bounds.isEmpty()) {
+      return;
+    }
+    auto x0 = (bounds.left() - this->_grid.left()) / this->_cell_size;
+    auto y0 = (bounds.top() - this->_grid.top()) / this->_cell_size;
+    auto x1 = (bounds.right() - 1 - this->_grid.left()) / this->_cell_size;
+    auto y1 = (bounds.bottom() - 1 - this->_grid.top()) / this->_cell_size;
+    for (auto y = y0; y <= y1; ++y) {
+      for (auto x = x0; x <= x1; ++x) {
+        func(this->_cells[size_t(y) * size_t(this->_columns) + size_t(x)]);
+      }
+    }
+  }
+};
+
+} // namespace my
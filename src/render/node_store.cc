@@ -0,0 +1,158 @@
+#include "node_store.hpp"
+
+#include <atomic>
+
+namespace my {
+
+namespace {
+// shared by all stores, a node moved to another store never gets a version
+// it had before
+uint64_t next_stamp() {
+  static std::atomic<uint64_t> stamp{0};
+  return stamp.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+} // namespace
+
+NodeHandle NodeStore::create() {
+  uint32_t index;
+  if (this->_free_head != NodeHandle::kNil) {
+    index = this->_free_head;
+    this->_free_head = this->_links[index].next_sibling;
+    this->_links[index] = Links{};
+  } else {
+    index = uint32_t(this->_links.size());
+    this->_links.emplace_back();
+    this->_generation.push_back(0);
+    this->_alive.push_back(0);
+    this->_transform.push_back(Matrix::I());
+    this->_world.push_back(Matrix::I());
+    this->_rect.push_back(IRect::MakeEmpty());
+    this->_user.push_back(nullptr);
+    this->_version.push_back(0);
+  }
+  this->_touch(index);
+  this->_alive[index] = 1;
+  ++this->_size;
+  return {index, this->_generation[index]};
+}
+
+void NodeStore::destroy(NodeHandle node) {
+  this->detach(node);
+  this->_scratch.clear();
+  this->pre_order(node,
+                  [this](NodeHandle n) { this->_scratch.push_back(n.index); });
+  for (auto index : this->_scratch) {
+    ++this->_generation[index];
+    this->_alive[index] = 0;
+    this->_transform[index] = Matrix::I();
+    this->_world[index] = Matrix::I();
+    this->_rect[index] = IRect::MakeEmpty();
+    this->_user[index] = nullptr;
+    this->_links[index] = Links{};
+    this->_links[index].next_sibling = this->_free_head;
+    this->_free_head = index;
+  }
+  this->_size -= this->_scratch.size();
+}
+
+void NodeStore::append_child(NodeHandle parent, NodeHandle child) {
+  auto p = this->_check(parent);
+  auto c = this->_check(child);
+  if (p == c || this->is_ancestor(child, parent)) {
+    throw NodeError("node can not become its own descendant");
+  }
+  this->_unlink(c);
+
+  auto &links = this->_links;
+  links[c].parent = p;
+  links[c].prev_sibling = links[p].last_child;
+  if (links[p].last_child != NodeHandle::kNil) {
+    links[links[p].last_child].next_sibling = c;
+  } else {
+    links[p].first_child = c;
+  }
+  links[p].last_child = c;
+  this->_touch(p);
+}
+
+void NodeStore::detach(NodeHandle node) { this->_unlink(this->_check(node)); }
+
+bool NodeStore::is_ancestor(NodeHandle ancestor, NodeHandle node) const {
+  auto a = this->_check(ancestor);
+  for (auto index = this->_links[this->_check(node)].parent;
+       index != NodeHandle::kNil; index = this->_links[index].parent) {
+    if (index == a) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int NodeStore::depth(NodeHandle node) const {
+  int depth = 0;
+  for (auto index = this->_links[this->_check(node)].parent;
+       index != NodeHandle::kNil; index = this->_links[index].parent) {
+    ++depth;
+  }
+  return depth;
+}
+
+void NodeStore::reserve(size_t n) {
+  this->_links.reserve(n);
+  this->_generation.reserve(n);
+  this->_alive.reserve(n);
+  this->_transform.reserve(n);
+  this->_world.reserve(n);
+  this->_rect.reserve(n);
+  this->_user.reserve(n);
+  this->_version.reserve(n);
+}
+
+void NodeStore::update_world_transforms(NodeHandle root) {
+  // the world transform of root's parent is taken as current
+  this->pre_order(root, [this](NodeHandle node) {
+    auto index = node.index;
+    auto parent = this->_links[index].parent;
+    auto local = this->local_transform(node);
+    this->_world[index] = parent == NodeHandle::kNil
+                              ? local
+                              : Matrix::Concat(this->_world[parent], local);
+  });
+}
+
+void NodeStore::_unlink(uint32_t index) {
+  auto &links = this->_links;
+  auto parent = links[index].parent;
+  if (parent == NodeHandle::kNil) {
+    return;
+  }
+  auto prev = links[index].prev_sibling;
+  auto next = links[index].next_sibling;
+  if (prev != NodeHandle::kNil) {
+    links[prev].next_sibling = next;
+  } else {
+    links[parent].first_child = next;
+  }
+  if (next != NodeHandle::kNil) {
+    links[next].prev_sibling = prev;
+  } else {
+    links[parent].last_child = prev;
+  }
+  links[index].parent = NodeHandle::kNil;
+  links[index].prev_sibling = NodeHandle::kNil;
+  links[index].next_sibling = NodeHandle::kNil;
+  this->_touch(parent);
+}
+
+void NodeStore::_touch(uint32_t index) {
+  if (this->_stamp_read) {
+    this->_stamp = next_stamp();
+    this->_stamp_read = false;
+  }
+  while (index != NodeHandle::kNil && this->_version[index] != this->_stamp) {
+    this->_version[index] = this->_stamp;
+    index = this->_links[index].parent;
+  }
+}
+
+} // namespace my
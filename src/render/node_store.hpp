@@ -0,0 +1,268 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <render/exception.hpp>
+#include <render/type.hpp>
+
+namespace my {
+
+/**
+ * @brief      slot of a NodeStore, stale once the node is destroyed
+ */
+struct NodeHandle {
+  static constexpr uint32_t kNil = ~uint32_t(0);
+
+  uint32_t index{kNil};
+  uint32_t generation{0};
+
+  explicit operator bool() const { return this->index != kNil; }
+
+  bool operator==(NodeHandle const &other) const {
+    return this->index == other.index && this->generation == other.generation;
+  }
+  bool operator!=(NodeHandle const &other) const { return !(*this == other); }
+};
+
+/**
+ * @brief      scene nodes as structure of arrays
+ *
+ * Hierarchy links, local and world transforms, rects and a user pointer
+ * live in parallel arrays indexed by slot, so a traversal walks a few dense
+ * arrays instead of chasing heap nodes. Children form a doubly linked
+ * sibling list, which makes appending and reparenting O(1) besides the
+ * cycle check. Destroyed slots are reused, a handle carries the slot's
+ * generation so stale handles are detected. Not thread-safe.
+ */
+class NodeStore {
+public:
+  NodeStore() = default;
+  NodeStore(NodeStore const &) = delete;
+  NodeStore &operator=(NodeStore const &) = delete;
+
+  /**
+   * @brief      new node without parent
+   */
+  NodeHandle create();
+
+  /**
+   * @brief      destroy node and its subtree
+   */
+  void destroy(NodeHandle node);
+
+  bool valid(NodeHandle node) const {
+    return node.index < this->_generation.size() &&
+           this->_alive[node.index] &&
+           this->_generation[node.index] == node.generation;
+  }
+
+  /**
+   * @brief      make child the last child of parent, detaching it first
+   *
+   * @throw      NodeError if a handle is stale or child is parent itself or
+   *             one of its ancestors
+   */
+  void append_child(NodeHandle parent, NodeHandle child);
+
+  /**
+   * @brief      unlink node from its parent, its subtree stays intact
+   */
+  void detach(NodeHandle node);
+
+  NodeHandle parent(NodeHandle node) const {
+    return this->_handle(this->_links[this->_check(node)].parent);
+  }
+  NodeHandle first_child(NodeHandle node) const {
+    return this->_handle(this->_links[this->_check(node)].first_child);
+  }
+  NodeHandle last_child(NodeHandle node) const {
+    return this->_handle(this->_links[this->_check(node)].last_child);
+  }
+  NodeHandle next_sibling(NodeHandle node) const {
+    return this->_handle(this->_links[this->_check(node)].next_sibling);
+  }
+  NodeHandle prev_sibling(NodeHandle node) const {
+    return this->_handle(this->_links[this->_check(node)].prev_sibling);
+  }
+
+  bool is_ancestor(NodeHandle ancestor, NodeHandle node) const;
+
+  int depth(NodeHandle node) const;
+
+  /**
+   * @brief      live nodes
+   */
+  size_t size() const { return this->_size; }
+
+  void reserve(size_t n);
+
+  Matrix const &transform(NodeHandle node) const {
+    return this->_transform[this->_check(node)];
+  }
+  void transform(NodeHandle node, Matrix const &m) {
+    auto index = this->_check(node);
+    if (this->_transform[index] != m) {
+      this->_transform[index] = m;
+      this->_touch(this->_links[index].parent);
+    }
+  }
+
+  /**
+   * @brief      node's local space to its parent's: the node's transform,
+   *             then the offset of its rect
+   *
+   * The origin of a node's local space is the top left of its rect.
+   */
+  Matrix local_transform(NodeHandle node) const {
+    auto index = this->_check(node);
+    return Matrix::Concat(Matrix::Translate(float(this->_rect[index].left()),
+                                            float(this->_rect[index].top())),
+                          this->_transform[index]);
+  }
+
+  /**
+   * @brief      transform to root space, as of the last
+   *             update_world_transforms() covering node
+   */
+  Matrix const &world_transform(NodeHandle node) const {
+    return this->_world[this->_check(node)];
+  }
+
+  /**
+   * @brief      recompute world transforms of root's subtree
+   */
+  void update_world_transforms(NodeHandle root);
+
+  IRect const &rect(NodeHandle node) const {
+    return this->_rect[this->_check(node)];
+  }
+  void rect(NodeHandle node, IRect const &rect) {
+    auto index = this->_check(node);
+    if (this->_rect[index] != rect) {
+      this->_rect[index] = rect;
+      this->_touch(this->_links[index].parent);
+    }
+  }
+
+  /**
+   * @brief      changes whenever node's content or subtree changes
+   *
+   * Changing a node's rect or transform changes the version of its parent,
+   * not its own: the node looks the same, only placed elsewhere.
+   */
+  uint64_t version(NodeHandle node) const {
+    auto index = this->_check(node);
+    this->_stamp_read = true;
+    return this->_version[index];
+  }
+
+  /**
+   * @brief      mark node's content as changed
+   */
+  void touch(NodeHandle node) { this->_touch(this->_check(node)); }
+
+  void *user(NodeHandle node) const { return this->_user[this->_check(node)]; }
+  void user(NodeHandle node, void *user) {
+    this->_user[this->_check(node)] = user;
+  }
+
+  /**
+   * @brief      call func(NodeHandle) for root and its descendants, parents
+   *             before children
+   *
+   * func may change node data but not the hierarchy.
+   */
+  template <typename Func> void pre_order(NodeHandle root, Func &&func) const {
+    auto const top = this->_check(root);
+    auto index = top;
+    while (true) {
+      func(this->_handle(index));
+      if (this->_links[index].first_child != NodeHandle::kNil) {
+        index = this->_links[index].first_child;
+        continue;
+      }
+      while (index != top &&
+             this->_links[index].next_sibling == NodeHandle::kNil) {
+        index = this->_links[index].parent;
+      }
+      if (index == top) {
+        return;
+      }
+      index = this->_links[index].next_sibling;
+    }
+  }
+
+  /**
+   * @brief      call func(NodeHandle) for root and its descendants, children
+   *             before parents
+   */
+  template <typename Func> void post_order(NodeHandle root, Func &&func) const {
+    auto const top = this->_check(root);
+    auto index = this->_leftmost_leaf(top);
+    while (true) {
+      func(this->_handle(index));
+      if (index == top) {
+        return;
+      }
+      auto next = this->_links[index].next_sibling;
+      index = next != NodeHandle::kNil ? this->_leftmost_leaf(next)
+                                       : this->_links[index].parent;
+    }
+  }
+
+private:
+  // every traversal step reads several links, so they stay together
+  struct Links {
+    uint32_t parent{NodeHandle::kNil};
+    uint32_t first_child{NodeHandle::kNil};
+    uint32_t last_child{NodeHandle::kNil};
+    uint32_t next_sibling{NodeHandle::kNil};
+    uint32_t prev_sibling{NodeHandle::kNil};
+  };
+
+  std::vector<Links> _links;
+  std::vector<uint32_t> _generation;
+  std::vector<uint8_t> _alive;
+  std::vector<Matrix> _transform;
+  std::vector<Matrix> _world;
+  std::vector<IRect> _rect;
+  std::vector<void *> _user;
+  std::vector<uint64_t> _version;
+
+  // every touch until the next version() read shares a stamp, so touching
+  // stops at the first ancestor already carrying it
+  uint64_t _stamp{0};
+  mutable bool _stamp_read{true};
+
+  // free slots are chained through next_sibling
+  uint32_t _free_head{NodeHandle::kNil};
+  size_t _size{0};
+  std::vector<uint32_t> _scratch;
+
+  uint32_t _check(NodeHandle node) const {
+    if (!this->valid(node)) {
+      throw NodeError("stale node handle");
+    }
+    return node.index;
+  }
+
+  NodeHandle _handle(uint32_t index) const {
+    if (index == NodeHandle::kNil) {
+      return {};
+    }
+    return {index, this->_generation[index]};
+  }
+
+  uint32_t _leftmost_leaf(uint32_t index) const {
+    while (this->_links[index].first_child != NodeHandle::kNil) {
+      index = this->_links[index].first_child;
+    }
+    return index;
+  }
+
+  void _unlink(uint32_t index);
+  void _touch(uint32_t index);
+};
+
+} // namespace my
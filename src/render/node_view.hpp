@@ -1,9 +1,7 @@
 #pragma once
 
-#include <core/core.hpp>
-#include <window/window.hpp>
-
 #include <render/exception.hpp>
+#include <render/layout.hpp>
 #include <render/node.hpp>
 #include <render/type.hpp>
 // #include <render/render_service.hpp>
@@ -11,12 +9,45 @@
 namespace my {
 class RenderService;
 
-class NodeView : public std::enable_shared_from_this<NodeView>, public Node {
+/**
+ * @brief      node that draws itself
+ *
+ * Content is drawn by paint() in local coordinates, (0, 0) being the top
+ * left of irect(). Children are drawn on top, clipped to irect().
+ */
+class NodeView : public Node {
 
   using ptr_type = shared_ptr<NodeView>;
 
 public:
-  static ptr_type make() { return shared_ptr<NodeView>(new NodeView()); }
+  static ptr_type make(std::string const &name = {}) {
+    return shared_ptr<NodeView>(new NodeView(name));
+  }
+
+  virtual void paint(SkCanvas &) {}
+
+  /**
+   * @brief      size of the content, within max_width and max_height which
+   *             are LayoutStyle::kUnbounded if unconstrained
+   */
+  virtual ISize2D measure(int32_t /*max_width*/, int32_t /*max_height*/) {
+    return ISize2D::Make(0, 0);
+  }
+
+  LayoutStyle const &layout_style() const { return this->_layout_style; }
+
+  void layout_style(LayoutStyle const &style) {
+    this->_layout_style = style;
+    this->invalidate();
+  }
+
+  /**
+   * @brief      draw this node and its subtree through a LayerCache layer,
+   *             redrawn only once the node's version changes
+   */
+  void cached(bool v) { this->_cached = v; }
+
+  bool cached() const { return this->_cached; }
 
   IPoint2D pos() const { return this->irect().topLeft(); }
 
@@ -30,14 +61,14 @@ public:
 
   int32_t left() const { return this->irect().left(); }
 
-  IRect const &irect() const { return this->_irect; }
+  IRect const &irect() const { return this->rect(); }
 
-private:
-  NodeView() : Node{} {}
+protected:
+  explicit NodeView(std::string const &name = {}) : Node{name} {}
 
-  IRect &irect() { return this->_irect; }
-
-  IRect _irect;
+private:
+  bool _cached{false};
+  LayoutStyle _layout_style;
 };
 
 // class NodeView : public std::enable_shared_from_this<NodeView> {
@@ -1,24 +1,29 @@
 #include "render_service.hpp"
 
+#include <algorithm>
 #include <stack>
 
 #include <GL/gl.h>
 #include <SDL2/SDL.h>
 
+#include <skia/include/core/SkPictureRecorder.h>
 #include <skia/include/core/SkSurface.h>
 #include <skia/include/gpu/GrBackendSurface.h>
 #include <skia/include/gpu/GrContext.h>
+#include <skia/include/gpu/GrContextOptions.h>
 #include <skia/include/gpu/gl/GrGLInterface.h>
 
 #include <render/exception.hpp>
+#include <render/tiled_rasterizer.hpp>
 
 namespace {
 using namespace my;
 
 class SDLRenderService : public RenderService {
 public:
-  SDLRenderService(shared_ptr<Window> win)
-      : _win(win), _surface(this->create_sk_surface().get()) {
+  SDLRenderService(shared_ptr<Window> win, RenderOptions const &options)
+      : _win(win), _surface(this->create_sk_surface(options.caches).get()) {
+    this->frame_scheduler().refresh_rate(options.refresh_rate);
     this->run();
   }
 
@@ -52,25 +57,28 @@ public:
   //   }
   // }
 
-  void run() {
-    rx::observable<>::interval(std::chrono::milliseconds(1000 / 60),
-                               this->coordination().get())
-        .subscribe([this](auto) {
-          this->canvas()->clear(SK_ColorWHITE);
-
-          // this->draw_root();
-
-          this->canvas()->flush();
-          SDL_GL_SwapWindow(this->native_instance());
-        });
+  // the first frame, later ones follow requests
+  void run() { this->request_frame(); }
+
+  void draw_frame() {
+    MY_PROFILE_ZONE_C("render", "SDLRenderService::draw_frame");
+    this->_begin_frame();
+    this->canvas()->clear(SK_ColorWHITE);
+    this->_draw_scene(*this->_surface->getCanvas());
+    this->canvas()->flush();
+    // waits for vsync
+    SDL_GL_SwapWindow(this->native_instance());
+    this->_end_frame();
   }
 
   CanvasPtr canvas() override {
     return CanvasPtr{this->_surface->getCanvas(), this};
   }
 
-  future<sk_sp<SkSurface>> create_sk_surface() {
-    return this->schedule<sk_sp<SkSurface>>([this]() {
+  future<sk_sp<SkSurface>> create_sk_surface(SkiaCacheOptions const &caches) {
+    return this->schedule<sk_sp<SkSurface>>([this, caches]() {
+      this->skia_caches().configure(caches);
+
       static const int stencil_bits = 8;
       static const int msaa_sample_count = 0;
 
@@ -97,6 +105,12 @@ public:
         throw RenderServiceError("gl make current failure");
       }
 
+      // adaptive vsync if available, a late frame tears instead of waiting
+      // for one more vsync
+      if (SDL_GL_SetSwapInterval(-1) != 0) {
+        SDL_GL_SetSwapInterval(1);
+      }
+
       int w, h;
       SDL_GL_GetDrawableSize(this->native_instance(), &w, &h);
 
@@ -108,7 +122,13 @@ public:
       auto interface = GrGLMakeNativeInterface();
 
       // setup contexts
-      sk_sp<GrContext> gr_ctx(GrContext::MakeGL(interface));
+      GrContextOptions context_options;
+      this->skia_caches().context_options(context_options);
+      this->_gr_ctx = GrContext::MakeGL(interface, context_options);
+      if (!this->_gr_ctx) {
+        throw RenderServiceError("create gr context failure");
+      }
+      this->skia_caches().attach(this->_gr_ctx.get());
 
       GrGLFramebufferInfo info{};
       {
@@ -128,25 +148,318 @@ public:
       SkSurfaceProps props(SkSurfaceProps::kLegacyFontHost_InitType);
 
       return SkSurface::MakeFromBackendRenderTarget(
-          gr_ctx.get(), target, kBottomLeft_GrSurfaceOrigin, color_type,
+          this->_gr_ctx.get(), target, kBottomLeft_GrSurfaceOrigin, color_type,
           nullptr, &props);
     });
   }
 
+protected:
+  void _schedule_frame(FrameScheduler::clock::time_point deadline) override {
+    this->coordination().coordinator().get_worker().schedule(
+        deadline, [this](auto) { this->draw_frame(); });
+  }
+
 private:
   shared_ptr<Window> _win;
   SDL_GLContext _glctx;
+  // set up with _surface, outlives it
+  sk_sp<GrContext> _gr_ctx;
+  sk_sp<SkSurface> _surface;
+
+  SDL_Window *native_instance() {
+    return ::SDL_GetWindowFromID(this->_win->window_id());
+  }
+};
+
+/**
+ * @brief      draw a frame into the pixels behind surface, through a picture
+ *             played in bands if tiler has more than one
+ */
+template <typename Draw>
+void draw_raster(TiledRasterizer &tiler, SkSurface &surface,
+                 SkImageInfo const &info, void *pixels, size_t row_bytes,
+                 Draw &&draw) {
+  if (tiler.bands() > 1) {
+    SkPictureRecorder recorder;
+    auto canvas = recorder.beginRecording(
+        SkRect::MakeWH(float(info.width()), float(info.height())));
+    canvas->clear(SK_ColorWHITE);
+    draw(*canvas);
+    tiler.draw(*recorder.finishRecordingAsPicture(), info, pixels, row_bytes);
+  } else {
+    auto canvas = surface.getCanvas();
+    canvas->clear(SK_ColorWHITE);
+    draw(*canvas);
+  }
+}
+
+/**
+ * @brief      Skia raster rendering copied to the SDL window surface
+ *
+ * Works without a GPU and with the offscreen SDL video driver. Frames are
+ * drawn straight into the window surface if it is 32-bit BGRA, Skia's
+ * native order here, and into an own buffer blitted to it otherwise. With
+ * more than one raster thread the frame is recorded into a picture and
+ * played in bands on the shared Executor.
+ */
+class SDLRasterRenderService : public RenderService {
+public:
+  SDLRasterRenderService(shared_ptr<Window> win, RenderOptions const &options)
+      : _win(win), _tiler(options.raster_threads) {
+    this->frame_scheduler().refresh_rate(options.refresh_rate);
+    this->schedule<void>([this, caches = options.caches]() {
+      this->skia_caches().configure(caches);
+      auto window_surface = this->_window_surface();
+      this->_fit(window_surface);
+      this->_unlock(window_surface);
+    }).get();
+    this->run();
+  }
+
+  ~SDLRasterRenderService() { this->exit().get(); }
+
+  // the first frame, later ones follow requests
+  void run() { this->request_frame(); }
+
+  void draw_frame() {
+    MY_PROFILE_ZONE_C("render", "SDLRasterRenderService::draw_frame");
+    this->_begin_frame();
+    auto window_surface = this->_window_surface();
+    this->_fit(window_surface);
+
+    draw_raster(this->_tiler, *this->_surface, this->_info, this->_pixels,
+                this->_row_bytes,
+                [this](SkCanvas &canvas) { this->_draw_scene(canvas); });
+
+    this->_unlock(window_surface);
+    if (!this->_direct) {
+      this->_blit(window_surface);
+    }
+    if (SDL_UpdateWindowSurface(this->native_instance()) != 0) {
+      throw RenderServiceError(SDL_GetError());
+    }
+    this->_end_frame();
+  }
+
+  CanvasPtr canvas() override {
+    return CanvasPtr{this->_surface->getCanvas(), this};
+  }
+
+protected:
+  void _schedule_frame(FrameScheduler::clock::time_point deadline) override {
+    this->coordination().coordinator().get_worker().schedule(
+        deadline, [this](auto) { this->draw_frame(); });
+  }
+
+private:
+  shared_ptr<Window> _win;
+  TiledRasterizer _tiler;
   sk_sp<SkSurface> _surface;
+  SkImageInfo _info;
+  void *_pixels{nullptr};
+  size_t _row_bytes{0};
+  // whether _surface draws into the window surface
+  bool _direct{false};
+  // pixels of an own surface, when the window's format differs
+  std::vector<uint32_t> _buffer;
 
   SDL_Window *native_instance() {
     return ::SDL_GetWindowFromID(this->_win->window_id());
   }
+
+  // changes with the window size, locked until the frame is drawn
+  SDL_Surface *_window_surface() {
+    auto surface = SDL_GetWindowSurface(this->native_instance());
+    if (!surface) {
+      throw RenderServiceError(SDL_GetError());
+    }
+    if (SDL_MUSTLOCK(surface) && SDL_LockSurface(surface) != 0) {
+      throw RenderServiceError(SDL_GetError());
+    }
+    return surface;
+  }
+
+  static void _unlock(SDL_Surface *surface) {
+    if (SDL_MUSTLOCK(surface)) {
+      SDL_UnlockSurface(surface);
+    }
+  }
+
+  /**
+   * @brief      point _surface at the window surface, or at a buffer of its
+   *             size
+   */
+  void _fit(SDL_Surface *window) {
+    auto format = window->format->format;
+    auto direct = kN32_SkColorType == kBGRA_8888_SkColorType &&
+                  (format == SDL_PIXELFORMAT_ARGB8888 ||
+                   format == SDL_PIXELFORMAT_RGB888);
+    if (direct) {
+      if (this->_direct && this->_pixels == window->pixels &&
+          this->_info.width() == window->w &&
+          this->_info.height() == window->h) {
+        return;
+      }
+      this->_buffer = {};
+      this->_info = SkImageInfo::Make(window->w, window->h,
+                                      kBGRA_8888_SkColorType,
+                                      format == SDL_PIXELFORMAT_RGB888
+                                          ? kOpaque_SkAlphaType
+                                          : kPremul_SkAlphaType);
+      this->_pixels = window->pixels;
+      this->_row_bytes = size_t(window->pitch);
+    } else {
+      if (!this->_direct && this->_info.width() == window->w &&
+          this->_info.height() == window->h && this->_surface) {
+        return;
+      }
+      this->_info = SkImageInfo::MakeN32Premul(window->w, window->h);
+      this->_buffer.assign(size_t(window->w) * size_t(window->h), 0);
+      this->_pixels = this->_buffer.data();
+      this->_row_bytes = this->_info.minRowBytes();
+    }
+    this->_direct = direct;
+    this->_surface =
+        SkSurface::MakeRasterDirect(this->_info, this->_pixels,
+                                    this->_row_bytes);
+    if (!this->_surface) {
+      throw RenderServiceError("create raster surface failure");
+    }
+  }
+
+  void _blit(SDL_Surface *window) {
+    auto source = SDL_CreateRGBSurfaceWithFormatFrom(
+        this->_pixels, this->_info.width(), this->_info.height(), 32,
+        int(this->_row_bytes),
+        kN32_SkColorType == kBGRA_8888_SkColorType ? SDL_PIXELFORMAT_ARGB8888
+                                                   : SDL_PIXELFORMAT_ABGR8888);
+    if (!source) {
+      throw RenderServiceError(SDL_GetError());
+    }
+    // a copy, blending the premultiplied pixels would darken the window
+    SDL_SetSurfaceBlendMode(source, SDL_BLENDMODE_NONE);
+    auto result = SDL_BlitSurface(source, nullptr, window, nullptr);
+    SDL_FreeSurface(source);
+    if (result != 0) {
+      throw RenderServiceError(SDL_GetError());
+    }
+  }
+};
+
+/**
+ * @brief      Skia raster rendering into a HeadlessWindow's frame buffer
+ *
+ * Frames are uncapped, drawn as soon as requested, so benchmarks measure
+ * rendering alone. A frame is drawn into a buffer of the service and copied
+ * into the frame buffer under its lock, a resize may reallocate the frame
+ * buffer at any time and requests a frame at the new size.
+ */
+class HeadlessRenderService : public RenderService {
+public:
+  HeadlessRenderService(shared_ptr<HeadlessWindow> win,
+                        RenderOptions const &options)
+      : _win(win), _tiler(options.raster_threads) {
+    this->frame_scheduler().refresh_rate(FrameScheduler::kUncapped);
+    this->schedule<void>([this, caches = options.caches]() {
+      this->skia_caches().configure(caches);
+      this->_fit(this->_frame_buffer_size());
+    }).get();
+    this->_win->on_resize([this]() { this->request_frame(); });
+    this->run();
+  }
+
+  ~HeadlessRenderService() {
+    this->_win->on_resize(nullptr);
+    this->exit().get();
+  }
+
+  // the first frame, later ones follow requests
+  void run() { this->request_frame(); }
+
+  void draw_frame() {
+    MY_PROFILE_ZONE_C("render", "HeadlessRenderService::draw_frame");
+    this->_begin_frame();
+    this->_fit(this->_frame_buffer_size());
+    draw_raster(this->_tiler, *this->_surface, this->_info,
+                this->_pixels.data(), this->_info.minRowBytes(),
+                [this](SkCanvas &canvas) { this->_draw_scene(canvas); });
+    auto copied = this->_win->with_frame_buffer(
+        [this](HeadlessWindow::FrameBuffer &fb) {
+          if (fb.size.width() != this->_info.width() ||
+              fb.size.height() != this->_info.height()) {
+            return false;
+          }
+          std::copy(this->_pixels.begin(), this->_pixels.end(),
+                    fb.pixels.begin());
+          return true;
+        });
+    if (copied) {
+      this->_win->present();
+    } else {
+      // resized while drawing, draw again at the new size
+      this->_request_frame();
+    }
+    this->_end_frame();
+  }
+
+  /**
+   * @brief      canvas over the service's own pixels, valid on the render
+   *             thread until the next frame
+   */
+  CanvasPtr canvas() override {
+    return CanvasPtr{this->_surface->getCanvas(), this};
+  }
+
+protected:
+  void _schedule_frame(FrameScheduler::clock::time_point deadline) override {
+    this->coordination().coordinator().get_worker().schedule(
+        deadline, [this](auto) { this->draw_frame(); });
+  }
+
+private:
+  shared_ptr<HeadlessWindow> _win;
+  TiledRasterizer _tiler;
+  sk_sp<SkSurface> _surface;
+  SkImageInfo _info;
+  std::vector<uint32_t> _pixels;
+
+  ISize2D _frame_buffer_size() {
+    return this->_win->with_frame_buffer(
+        [](HeadlessWindow::FrameBuffer &fb) { return fb.size; });
+  }
+
+  void _fit(ISize2D size) {
+    if (this->_surface && this->_info.width() == size.width() &&
+        this->_info.height() == size.height()) {
+      return;
+    }
+    this->_info = SkImageInfo::MakeN32Premul(size.width(), size.height());
+    this->_pixels.assign(size_t(std::max(0, size.width())) *
+                             size_t(std::max(0, size.height())),
+                         0);
+    this->_surface = SkSurface::MakeRasterDirect(this->_info,
+                                                 this->_pixels.data(),
+                                                 this->_info.minRowBytes());
+    if (!this->_surface) {
+      throw RenderServiceError("create raster surface failure");
+    }
+  }
 };
 
 } // namespace
 
 namespace my {
-unique_ptr<RenderService> RenderService::make(shared_ptr<Window> win) {
-  return std::make_unique<SDLRenderService>(win);
+unique_ptr<RenderService> RenderService::make(shared_ptr<Window> win,
+                                              RenderOptions const &options) {
+  if (auto headless = std::dynamic_pointer_cast<HeadlessWindow>(win)) {
+    return std::make_unique<HeadlessRenderService>(headless, options);
+  }
+  switch (options.backend) {
+  case RenderBackend::kRaster:
+    return std::make_unique<SDLRasterRenderService>(win, options);
+  case RenderBackend::kGL:
+  default:
+    return std::make_unique<SDLRenderService>(win, options);
+  }
 }
 } // namespace my
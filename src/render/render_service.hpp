@@ -1,13 +1,51 @@
 #pragma once
 
 #include <core/core.hpp>
+#include <render/exception.hpp>
+#include <render/frame_scheduler.hpp>
+#include <render/layer_cache.hpp>
+#include <render/node_index.hpp>
 #include <render/node2d.hpp>
+#include <render/scene_recorder.hpp>
+#include <render/skia_cache.hpp>
+#include <util/triple_buffer.hpp>
 #include <window/window.hpp>
 
 namespace my {
 
 class RenderService;
 
+enum class RenderBackend {
+  // Skia on an OpenGL context
+  kGL,
+  // Skia raster surface copied to the window surface, needs no GPU
+  kRaster,
+};
+
+struct RenderOptions {
+  RenderBackend backend{RenderBackend::kGL};
+  // the display's, see WindowService::display_mode()
+  int refresh_rate{FrameScheduler::kDefaultRefreshRate};
+  // raster only: horizontal bands drawn in parallel, 1 draws on the render
+  // thread alone
+  size_t raster_threads{1};
+  // Skia's glyph, path and resource caches
+  SkiaCacheOptions caches;
+
+  /**
+   * @brief      backend named "gl" or "raster", e.g. from a program option
+   */
+  static RenderBackend backend_from(std::string const &name) {
+    if (name == "gl") {
+      return RenderBackend::kGL;
+    }
+    if (name == "raster") {
+      return RenderBackend::kRaster;
+    }
+    throw RenderServiceError("unknown render backend: " + name);
+  }
+};
+
 class CanvasPtr {
 public:
   CanvasPtr(SkCanvas *ptr, RenderService *renderer)
@@ -27,15 +65,156 @@ class RenderService : public BasicService // , public Bindable
 public:
   RenderService() {}
 
-  static unique_ptr<RenderService> make(shared_ptr<Window>);
+  /**
+   * @brief      render into win with the backend of options, a
+   *             HeadlessWindow always renders raster and uncapped
+   */
+  static unique_ptr<RenderService> make(shared_ptr<Window>,
+                                        RenderOptions const &options = {});
+
+  /**
+   * @brief      the frame's canvas on the render thread, other threads
+   *             record a SceneSnapshot and submit() it
+   */
   virtual CanvasPtr canvas() = 0;
 
+  /**
+   * @brief      run func on the render thread, a frame follows if it
+   *             changed the scene
+   */
   template <typename Func> void run_at(Func &&func) {
-    this->schedule<void>(
-        [this, func = std::forward<Func>(func)]() { func(this); });
+    this->schedule<void>([this, func = std::forward<Func>(func)]() {
+      func(this);
+      this->_damage();
+    });
+  }
+
+  /**
+   * @brief      draw a frame soon, for changes not in the scene's NodeStore,
+   *             from any thread
+   */
+  void request_frame() {
+    this->schedule<void>([this]() { this->_request_frame(); });
   }
 
+  /**
+   * @brief      change the pacing to the display's refresh rate, from any
+   *             thread
+   */
+  void refresh_rate(int hz) {
+    this->schedule<void>([this, hz]() { this->_frames.refresh_rate(hz); });
+  }
+
+  /**
+   * @brief      tree drawn on changes, call on the render thread
+   */
+  void scene(shared_ptr<Node> root) {
+    this->_scene = std::move(root);
+    this->_request_frame();
+  }
+
+  /**
+   * @brief      replace the recorded scene, from one thread at a time
+   *
+   * The snapshot is handed over without locking and drawn below scene()
+   * from the next frame on. Snapshots submitted before that frame are
+   * dropped but the newest, older pictures are released on the submitting
+   * thread.
+   */
+  void submit(SceneSnapshot snapshot) {
+    this->_snapshots.back() = std::move(snapshot);
+    this->_snapshots.publish();
+    // one pending request covers any number of submits
+    if (!this->_submitted.exchange(true, std::memory_order_acq_rel)) {
+      this->request_frame();
+    }
+  }
+
+  /**
+   * @brief      frame pacing and stats, call on the render thread
+   */
+  FrameScheduler &frame_scheduler() { return this->_frames; }
+
+  LayerCache &layer_cache() { return this->_layer_cache; }
+
+  /**
+   * @brief      Skia's cache limits and usage, sampled every frame, call on
+   *             the render thread
+   */
+  SkiaCaches &skia_caches() { return this->_skia_caches; }
+
+  /**
+   * @brief      the scene in window space as of the last frame, for hit
+   *             testing on the render thread
+   */
+  NodeIndex &node_index() { return this->_node_index; }
+
 protected:
+  shared_ptr<Node> const &scene() const { return this->_scene; }
+
+  /**
+   * @brief      draw a frame at deadline on the render thread, the frame
+   *             is bracketed by _begin_frame() and _end_frame()
+   */
+  virtual void _schedule_frame(FrameScheduler::clock::time_point deadline) = 0;
+
+  void _request_frame() {
+    if (this->_frames.request()) {
+      this->_schedule_frame(
+          this->_frames.deadline(FrameScheduler::clock::now()));
+    }
+  }
+
+  void _begin_frame() {
+    this->_frames.begin_frame(FrameScheduler::clock::now());
+  }
+
+  /**
+   * @brief      the submitted snapshot, then scene()
+   */
+  void _draw_scene(SkCanvas &canvas) {
+    this->_submitted.store(false, std::memory_order_release);
+    this->_snapshots.acquire();
+    if (auto const &picture = this->_snapshots.front().picture) {
+      canvas.drawPicture(picture);
+    }
+    if (this->_scene) {
+      this->_layer_cache.draw(canvas, *this->_scene);
+      if (auto store = this->_scene->store()) {
+        this->_node_index.sync(*store, this->_scene->handle());
+      }
+    }
+  }
+
+  void _end_frame() {
+    this->_drawn_version = this->_scene_version();
+    this->_skia_caches.sample();
+    if (this->_frames.end_frame(FrameScheduler::clock::now())) {
+      this->_schedule_frame(
+          this->_frames.deadline(FrameScheduler::clock::now()));
+    }
+  }
+
+private:
+  shared_ptr<Node> _scene;
+  LayerCache _layer_cache;
+  SkiaCaches _skia_caches;
+  NodeIndex _node_index;
+  FrameScheduler _frames;
+  // scene version of the last frame
+  uint64_t _drawn_version{0};
+  TripleBuffer<SceneSnapshot> _snapshots;
+  std::atomic<bool> _submitted{false};
+
+  uint64_t _scene_version() const {
+    return this->_scene ? this->_scene->version() : 0;
+  }
+
+  void _damage() {
+    if (this->_scene_version() != this->_drawn_version) {
+      this->_request_frame();
+    }
+  }
 //   shared_ptr<NodeViewTree> node2dtree() { return this->_node2dtree; }
 
 // private:
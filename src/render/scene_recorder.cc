@@ -0,0 +1,31 @@
+#include "scene_recorder.hpp"
+
+#include <core/profiler.hpp>
+
+#include <skia/include/core/SkPictureRecorder.h>
+
+namespace my {
+
+SceneSnapshot const &SceneRecorder::record(Node &root) {
+  auto version = root.version();
+  // the root's own rect and transform are not in its version
+  if (this->_last.picture && this->_last.version == version &&
+      this->_rect == root.rect() && this->_transform == root.transform()) {
+    return this->_last;
+  }
+
+  MY_PROFILE_ZONE_C("render", "SceneRecorder::record");
+  auto const &rect = root.rect();
+  SkPictureRecorder recorder;
+  auto canvas = recorder.beginRecording(
+      SkRect::MakeWH(float(rect.right()), float(rect.bottom())));
+  this->_layers.draw(*canvas, root);
+
+  this->_last = {recorder.finishRecordingAsPicture(), version,
+                 this->_last.sequence + 1};
+  this->_rect = rect;
+  this->_transform = root.transform();
+  return this->_last;
+}
+
+} // namespace my
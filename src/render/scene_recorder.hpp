@@ -0,0 +1,52 @@
+#pragma once
+
+#include <render/layer_cache.hpp>
+
+#include <skia/include/core/SkPicture.h>
+
+namespace my {
+
+/**
+ * @brief      an immutable frame of a scene, replayed on any thread
+ */
+struct SceneSnapshot {
+  sk_sp<SkPicture> picture;
+  // the root's NodeStore version when it was recorded
+  uint64_t version{0};
+  // counts the snapshots of a recorder from 1, 0 for none
+  uint64_t sequence{0};
+};
+
+/**
+ * @brief      records a node tree into SceneSnapshots on the thread that
+ *             owns the tree
+ *
+ * UI code keeps its tree off the render thread, records it when it changed
+ * and hands the snapshot to RenderService::submit(), the render thread only
+ * replays it. Cached NodeViews are rasterized into the recorder's own
+ * LayerCache and recorded as images, so an unchanged layer costs one image
+ * draw per snapshot, its metrics are render.recorder_layer_*. An unchanged
+ * tree returns the last snapshot. Not thread-safe, one recorder per tree.
+ */
+class SceneRecorder {
+public:
+  explicit SceneRecorder(size_t layer_budget_bytes = 64 << 20)
+      : _layers(layer_budget_bytes, "render.recorder_layer") {}
+
+  /**
+   * @brief      snapshot of root and its subtree
+   */
+  SceneSnapshot const &record(Node &root);
+
+  LayerCache &layer_cache() { return this->_layers; }
+
+  SceneSnapshot const &last() const { return this->_last; }
+
+private:
+  LayerCache _layers;
+  SceneSnapshot _last;
+  IRect _rect{IRect::MakeEmpty()};
+  Matrix _transform;
+};
+
+} // namespace my
@@ -0,0 +1,90 @@
+#include "skia_cache.hpp"
+
+#include <skia/include/core/SkGraphics.h>
+#include <skia/include/gpu/GrContext.h>
+#include <skia/include/gpu/GrContextOptions.h>
+
+namespace my {
+
+void SkiaCaches::configure(SkiaCacheOptions const &options) {
+  this->_options = options;
+  if (options.font_cache_bytes) {
+    SkGraphics::SetFontCacheLimit(options.font_cache_bytes);
+  }
+  if (options.font_cache_glyphs) {
+    SkGraphics::SetFontCacheCountLimit(options.font_cache_glyphs);
+  }
+  if (options.font_point_size_limit) {
+    SkGraphics::SetFontCachePointSizeLimit(options.font_point_size_limit);
+  }
+  if (options.resource_cache_bytes) {
+    SkGraphics::SetResourceCacheTotalByteLimit(options.resource_cache_bytes);
+  }
+  if (options.resource_cache_single_bytes) {
+    SkGraphics::SetResourceCacheSingleAllocationByteLimit(
+        options.resource_cache_single_bytes);
+  }
+  this->attach(this->_context);
+}
+
+void SkiaCaches::context_options(GrContextOptions &context_options) const {
+  context_options.fAllowPathMaskCaching = this->_options.gpu_path_masks;
+  if (this->_options.gpu_glyph_atlas_bytes) {
+    context_options.fGlyphCacheTextureMaximumBytes =
+        this->_options.gpu_glyph_atlas_bytes;
+  }
+}
+
+void SkiaCaches::attach(GrContext *context) {
+  this->_context = context;
+  auto const &options = this->_options;
+  if (!context || (!options.gpu_cache_bytes && !options.gpu_cache_resources)) {
+    return;
+  }
+  int resources;
+  size_t bytes;
+  context->getResourceCacheLimits(&resources, &bytes);
+  context->setResourceCacheLimits(
+      options.gpu_cache_resources ? options.gpu_cache_resources : resources,
+      options.gpu_cache_bytes ? options.gpu_cache_bytes : bytes);
+}
+
+SkiaCacheStats SkiaCaches::sample() {
+  SkiaCacheStats stats;
+  stats.font_bytes = SkGraphics::GetFontCacheUsed();
+  stats.font_bytes_limit = SkGraphics::GetFontCacheLimit();
+  stats.font_glyphs = SkGraphics::GetFontCacheCountUsed();
+  stats.font_glyphs_limit = SkGraphics::GetFontCacheCountLimit();
+  stats.resource_bytes = SkGraphics::GetResourceCacheTotalBytesUsed();
+  stats.resource_bytes_limit = SkGraphics::GetResourceCacheTotalByteLimit();
+  if (this->_context) {
+    int limit_resources;
+    this->_context->getResourceCacheLimits(&limit_resources,
+                                           &stats.gpu_bytes_limit);
+    this->_context->getResourceCacheUsage(&stats.gpu_resources,
+                                          &stats.gpu_bytes);
+    stats.gpu_purgeable_bytes =
+        this->_context->getResourceCachePurgeableBytes();
+  }
+
+  this->_font_bytes.set(int64_t(stats.font_bytes));
+  this->_font_bytes_limit.set(int64_t(stats.font_bytes_limit));
+  this->_font_glyphs.set(stats.font_glyphs);
+  this->_resource_bytes.set(int64_t(stats.resource_bytes));
+  this->_resource_bytes_limit.set(int64_t(stats.resource_bytes_limit));
+  this->_gpu_bytes.set(int64_t(stats.gpu_bytes));
+  this->_gpu_bytes_limit.set(int64_t(stats.gpu_bytes_limit));
+  this->_gpu_purgeable_bytes.set(int64_t(stats.gpu_purgeable_bytes));
+  return stats;
+}
+
+void SkiaCaches::purge() {
+  SkGraphics::PurgeFontCache();
+  SkGraphics::PurgeResourceCache();
+  if (this->_context) {
+    this->_context->freeGpuResources();
+  }
+  this->_purges.add();
+}
+
+} // namespace my
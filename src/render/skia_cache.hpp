@@ -0,0 +1,108 @@
+#pragma once
+
+#include <core/metrics.hpp>
+
+class GrContext;
+struct GrContextOptions;
+
+namespace my {
+
+/**
+ * @brief      limits of Skia's caches, 0 keeps Skia's default
+ */
+struct SkiaCacheOptions {
+  // glyph images and paths of all typefaces and sizes, in bytes
+  size_t font_cache_bytes{0};
+  // glyphs kept in all
+  int font_cache_glyphs{0};
+  // text larger than this many points is drawn from paths, its glyphs are
+  // not cached as images
+  int font_point_size_limit{0};
+  // raster caches: blur masks, decoded and scaled images, in bytes
+  size_t resource_cache_bytes{0};
+  // allocations above this are not cached at all, in bytes
+  size_t resource_cache_single_bytes{0};
+  // GPU only: textures and buffers kept by the context
+  size_t gpu_cache_bytes{0};
+  int gpu_cache_resources{0};
+  // GPU only: size of the glyph atlas textures, in bytes
+  size_t gpu_glyph_atlas_bytes{0};
+  // GPU only: keep paths drawn in software as mask textures
+  bool gpu_path_masks{true};
+};
+
+struct SkiaCacheStats {
+  size_t font_bytes{};
+  size_t font_bytes_limit{};
+  int font_glyphs{};
+  int font_glyphs_limit{};
+  size_t resource_bytes{};
+  size_t resource_bytes_limit{};
+  // zero without a GPU context
+  size_t gpu_bytes{};
+  size_t gpu_bytes_limit{};
+  int gpu_resources{};
+  // held by the context but unused, freed first when over the limit
+  size_t gpu_purgeable_bytes{};
+};
+
+/**
+ * @brief      applies SkiaCacheOptions and samples the caches' usage
+ *
+ * The font and resource caches are process-wide in Skia, the last
+ * configure() wins; the GPU limits apply to the attached context. Skia
+ * does not count cache hits in release builds, so usage against the limit
+ * is what is published: a cache that stays at its limit frame after frame
+ * is evicting and needs more room. Not thread-safe, used on the render
+ * thread.
+ */
+class SkiaCaches {
+public:
+  explicit SkiaCaches(SkiaCacheOptions const &options = {}) {
+    this->configure(options);
+  }
+
+  void configure(SkiaCacheOptions const &options);
+  SkiaCacheOptions const &options() const { return this->_options; }
+
+  /**
+   * @brief      the options of a GPU context to create
+   */
+  void context_options(GrContextOptions &context_options) const;
+
+  /**
+   * @brief      apply the GPU limits to context and sample it, null detaches
+   */
+  void attach(GrContext *context);
+
+  /**
+   * @brief      read the caches' usage and publish it as render.skia.*
+   *             gauges, once per frame
+   */
+  SkiaCacheStats sample();
+
+  /**
+   * @brief      free everything unused, e.g. after a long session
+   */
+  void purge();
+
+private:
+  SkiaCacheOptions _options;
+  GrContext *_context{nullptr};
+
+  Gauge &_font_bytes{Metrics::get()->gauge("render.skia.font_bytes")};
+  Gauge &_font_bytes_limit{
+      Metrics::get()->gauge("render.skia.font_bytes_limit")};
+  Gauge &_font_glyphs{Metrics::get()->gauge("render.skia.font_glyphs")};
+  Gauge &_resource_bytes{Metrics::get()->gauge("render.skia.resource_bytes")};
+  Gauge &_resource_bytes_limit{
+      Metrics::get()->gauge("render.skia.resource_bytes_limit")};
+  Gauge &_gpu_bytes{Metrics::get()->gauge("render.skia.gpu_bytes")};
+  Gauge &_gpu_bytes_limit{
+      Metrics::get()->gauge("render.skia.gpu_bytes_limit")};
+  Gauge &_gpu_purgeable_bytes{
+      Metrics::get()->gauge("render.skia.gpu_purgeable_bytes")};
+  Counter &_purges{Metrics::get()->counter("render.skia.purges")};
+};
+
+} // namespace my
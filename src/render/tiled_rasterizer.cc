@@ -0,0 +1,54 @@
+#include "tiled_rasterizer.hpp"
+
+#include <core/profiler.hpp>
+
+namespace my {
+
+namespace {
+
+void play(SkPicture const &picture, SkImageInfo const &info, void *pixels,
+          size_t row_bytes, IRect const &band) {
+  MY_PROFILE_ZONE_C("render", "TiledRasterizer::band");
+  auto surface = SkSurface::MakeRasterDirect(
+      info.makeWH(band.width(), band.height()),
+      static_cast<char *>(pixels) + size_t(band.top()) * row_bytes,
+      row_bytes);
+  auto canvas = surface->getCanvas();
+  canvas->translate(0, -float(band.top()));
+  picture.playback(canvas);
+}
+
+} // namespace
+
+void TiledRasterizer::draw(SkPicture const &picture, SkImageInfo const &info,
+                           void *pixels, size_t row_bytes) {
+  MY_PROFILE_ZONE_C("render", "TiledRasterizer::draw");
+  auto bands = split(ISize2D::Make(info.width(), info.height()), this->_bands);
+  if (bands.empty()) {
+    return;
+  }
+
+  parallel_for(this->_executor, bands.size(), bands.size(), [&](size_t i) {
+    play(picture, info, pixels, row_bytes, bands[i]);
+  });
+}
+
+std::vector<IRect> TiledRasterizer::split(ISize2D size, size_t count) {
+  std::vector<IRect> bands;
+  if (size.isEmpty() || count == 0) {
+    return bands;
+  }
+  count = std::min(count, size_t(size.height()));
+  auto height = int32_t(size_t(size.height()) / count);
+  auto rest = int32_t(size_t(size.height()) % count);
+  int32_t top = 0;
+  for (size_t i = 0; i < count; ++i) {
+    // the first bands take the rows left over
+    auto rows = height + (int32_t(i) < rest ? 1 : 0);
+    bands.push_back(IRect::MakeXYWH(0, top, size.width(), rows));
+    top += rows;
+  }
+  return bands;
+}
+
+} // namespace my
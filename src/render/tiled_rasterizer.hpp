@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+
+#include <core/executor.hpp>
+#include <render/type.hpp>
+
+#include <skia/include/core/SkImageInfo.h>
+#include <skia/include/core/SkPicture.h>
+
+namespace my {
+
+/**
+ * @brief      plays a picture into raster pixels in horizontal bands, the
+ *             bands in parallel on an Executor
+ *
+ * Playing an SkPicture is thread-safe, every band gets a surface of its own
+ * over its rows of the pixels, so nothing is shared but the picture. The
+ * calling thread plays the first band and draw() returns once all are
+ * done. With one band the picture plays on the calling thread alone.
+ */
+class TiledRasterizer {
+public:
+  explicit TiledRasterizer(size_t bands,
+                           Executor &executor = *Executor::shared())
+      : _bands(std::max<size_t>(1, bands)), _executor(executor) {}
+
+  size_t bands() const { return this->_bands; }
+
+  /**
+   * @brief      play picture into the pixels described by info and
+   *             row_bytes
+   */
+  void draw(SkPicture const &picture, SkImageInfo const &info, void *pixels,
+            size_t row_bytes);
+
+  /**
+   * @brief      rows of every band, at most count bands of equal height
+   *             covering size
+   */
+  static std::vector<IRect> split(ISize2D size, size_t count);
+
+private:
+  size_t _bands;
+  Executor &_executor;
+};
+
+} // namespace my
@@ -8,6 +8,7 @@
 #include <boost/iostreams/device/array.hpp>
 #include <boost/iostreams/stream.hpp>
 
+#include <core/profiler.hpp>
 #include <my_render.hpp>
 #include <storage/blob.hpp>
 #include <storage/resource.hpp>
@@ -40,6 +41,16 @@ class Image : public Resource {
 
     const void *data() { return this->_image_buf.localpixels(); }
 
+    /**
+     * @brief      the pixels as a view, e.g. for ImageEffects
+     */
+    boost::gil::rgba8c_view_t view() {
+        return boost::gil::interleaved_view(
+            this->width(), this->height(),
+            static_cast<const boost::gil::rgba8_pixel_t *>(this->data()),
+            this->row_bytes());
+    }
+
     size_t byte_size() { return this->_spec.image_bytes(); }
 
     sk_sp<SkImage> sk_image() {
@@ -64,6 +75,7 @@ class Image : public Resource {
     }
 
     Image(const std::shared_ptr<Blob> &blob) {
+        MY_PROFILE_ZONE_C("resource", "Image::decode");
         OIIO::Filesystem::IOMemReader mr(const_cast<void *>(blob->data()),
                                          blob->size());
         auto in = OIIO::ImageInput::open(".exr", nullptr, &mr);
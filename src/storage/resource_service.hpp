@@ -8,6 +8,9 @@ namespace my {
 
 class ResourceService : public BasicService {
   public:
+    // loading has no thread affinity, share the executor's workers
+    ResourceService() : BasicService(*Executor::shared()) {}
+
     future<bool> exist(shared_ptr<ResourceLocator> locator) {
         return this->exist(locator->get_id());
     }
@@ -39,11 +42,36 @@ class ResourceService : public BasicService {
                 this->_resources.begin(), this->_resources.end(),
                 [&r](resource_map::value_type v) { return v.second == r; });
             if (it != this->_resources.end()) {
+                this->_cached.add(-1);
+                this->_cached_bytes.add(-int64_t(it->second->used_mem()));
                 this->_resources.erase(it);
             }
         });
     }
 
+    // await()-able variants of the calls above
+
+    Async<bool> async_exist(const std::string &uri) {
+        return this->async<bool>(
+            [this, uri]() { return this->search_cache(uri).has_value(); });
+    }
+
+    template <typename res,
+              typename = std::enable_if_t<std::is_base_of_v<Resource, res>>>
+    Async<shared_ptr<res>> async_load(shared_ptr<ResourceLocator> locator) {
+        return this->async<shared_ptr<res>>([this, locator]() {
+            auto resource = this->load_resource<res>(locator);
+            this->add_cache(locator->get_id(), resource);
+            return resource;
+        });
+    }
+
+    template <typename res,
+              typename = std::enable_if_t<std::is_base_of_v<Resource, res>>>
+    Async<shared_ptr<res>> async_load(const fs::path &path) {
+        return this->async_load<res>(FSResourceLocator::make(path));
+    }
+
     static unique_ptr<ResourceService> create() {
         return std::make_unique<ResourceService>();
     }
@@ -52,6 +80,13 @@ class ResourceService : public BasicService {
     typedef std::map<std::string, shared_ptr<Resource>> resource_map;
     resource_map _resources;
 
+    Counter &_cache_hits{Metrics::get()->counter("resource.cache_hits")};
+    Counter &_cache_misses{Metrics::get()->counter("resource.cache_misses")};
+    Counter &_failures{Metrics::get()->counter("resource.load_failures")};
+    Histogram &_load_us{Metrics::get()->histogram("resource.load_us")};
+    Gauge &_cached{Metrics::get()->gauge("resource.cached")};
+    Gauge &_cached_bytes{Metrics::get()->gauge("resource.cached_bytes")};
+
     template <typename res,
               typename = std::enable_if_t<std::is_base_of_v<Resource, res>>>
     shared_ptr<res> load_from_cache(const std::string &uri) {
@@ -64,7 +99,10 @@ class ResourceService : public BasicService {
     }
 
     void add_cache(const std::string &id, shared_ptr<Resource> resource) {
-        this->_resources.insert({id, resource});
+        if (this->_resources.insert({id, resource}).second) {
+            this->_cached.add(1);
+            this->_cached_bytes.add(int64_t(resource->used_mem()));
+        }
     }
 
     std::optional<resource_map::const_iterator>
@@ -79,15 +117,19 @@ class ResourceService : public BasicService {
     template <typename res,
               typename = std::enable_if_t<std::is_base_of_v<Resource, res>>>
     shared_ptr<res> load_resource(shared_ptr<ResourceLocator> locator) {
+        MY_PROFILE_ZONE_C("resource", "ResourceService::load");
         auto uri = locator->get_id();
         shared_ptr<res> resource{};
         {
             resource = this->load_from_cache<res>(uri);
 
             if (resource) {
+                this->_cache_hits.add();
                 return resource;
             }
         }
+        this->_cache_misses.add();
+        HistogramTimer l_load_time(this->_load_us);
 
         {
             auto file_provider = locator->make_file_provide_info();
@@ -111,6 +153,7 @@ class ResourceService : public BasicService {
                 return resource;
             }
         }
+        this->_failures.add();
         throw ResourceServiceError(
             (boost::format("load resource failure: %1%") % uri).str());
     }
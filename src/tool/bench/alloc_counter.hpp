@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Replaces the global allocation functions to count heap allocations.
+// Include from exactly one translation unit of a benchmark or test binary.
+
+namespace my::bench {
+
+inline std::atomic<size_t> alloc_count{0};
+inline std::atomic<size_t> alloc_bytes{0};
+
+/**
+ * @brief      heap allocations made by the process so far
+ */
+inline size_t allocations() {
+    return alloc_count.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief      bytes requested by those allocations
+ */
+inline size_t allocated_bytes() {
+    return alloc_bytes.load(std::memory_order_relaxed);
+}
+
+} // namespace my::bench
+
+void *operator new(size_t size) {
+    my::bench::alloc_count.fetch_add(1, std::memory_order_relaxed);
+    my::bench::alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (auto p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) { return ::operator new(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
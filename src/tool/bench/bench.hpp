@@ -0,0 +1,48 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace my::bench {
+
+using clock = std::chrono::steady_clock;
+
+inline double elapsed_ms(clock::time_point begin,
+                         clock::time_point end = clock::now()) {
+    return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+/**
+ * @brief      run func repeat times and return wall time per run in ms
+ */
+template <typename Func> double measure_ms(Func &&func, int repeat = 1) {
+    func(); // warm up
+    auto begin = clock::now();
+    for (int i = 0; i < repeat; ++i) {
+        func();
+    }
+    return elapsed_ms(begin) / repeat;
+}
+
+/**
+ * @brief      nearest rank percentile of samples, sorts in place
+ */
+inline double percentile(std::vector<double> &samples, double p) {
+    if (samples.empty()) {
+        return 0;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto rank = static_cast<size_t>(p / 100.0 * (samples.size() - 1) + 0.5);
+    return samples[std::min(rank, samples.size() - 1)];
+}
+
+inline void report(const std::string &name, const std::string &metric,
+                   double value, const std::string &unit) {
+    std::printf("%-40s %-24s %14.3f %s\n", name.c_str(), metric.c_str(), value,
+                unit.c_str());
+}
+
+} // namespace my::bench
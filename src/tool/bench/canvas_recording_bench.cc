@@ -0,0 +1,121 @@
+#include "bench.hpp"
+
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <render/back/back2/draw_list.hpp>
+
+using namespace my;
+
+namespace {
+
+// shapes recorded per frame, split evenly between the recording threads
+constexpr int kShapes = 1 << 15;
+
+const ColorRGBAub kFill{40, 90, 200, 255};
+const ColorRGBAub kStroke{20, 20, 20, 255};
+
+// a widget like mix: background rect, rounded outline and a check mark
+void record_shape(DrawList &list, int i) {
+    glm::vec2 o{float(i % 256) * 4, float(i / 256 % 256) * 4};
+    list.fill_rect(o, o + glm::vec2{24, 16}, kFill);
+    list.begin_path(o + glm::vec2{4, 0})
+        .arc_to(o + glm::vec2{24, 0}, o + glm::vec2{24, 16}, 4)
+        .arc_to(o + glm::vec2{24, 16}, o + glm::vec2{0, 16}, 4)
+        .arc_to(o + glm::vec2{0, 16}, o, 4)
+        .arc_to(o, o + glm::vec2{24, 0}, 4)
+        .close_path()
+        .stroke(kStroke, 1);
+    list.begin_path(o + glm::vec2{6, 8})
+        .line_to(o + glm::vec2{10, 12})
+        .line_to(o + glm::vec2{18, 4})
+        .stroke(kStroke, 2);
+}
+
+template <typename Func> void run_threads(int threads, Func &&func) {
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back(func, t);
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+// every thread shares one list guarded by a mutex, like the old Canvas
+double bench_locked(int threads, size_t &vertices) {
+    DrawList list;
+    std::mutex lock;
+    const int per_thread = kShapes / threads;
+    auto frame = [&]() {
+        list.clear();
+        run_threads(threads, [&](int t) {
+            for (int i = t * per_thread; i < (t + 1) * per_thread; ++i) {
+                std::lock_guard<std::mutex> l(lock);
+                record_shape(list, i);
+            }
+        });
+    };
+    double ms = bench::measure_ms(frame, 5);
+    vertices = list.vtx_list().size();
+    return ms;
+}
+
+// one list per thread, merged in order at the end of the frame
+double bench_per_thread(int threads, size_t &vertices, double &merge_ms) {
+    std::vector<std::unique_ptr<DrawList>> lists;
+    std::vector<DrawList *> order;
+    for (int t = 0; t < threads; ++t) {
+        lists.push_back(std::make_unique<DrawList>(t));
+        order.push_back(lists.back().get());
+    }
+    DrawData data;
+    const int per_thread = kShapes / threads;
+    auto frame = [&]() {
+        run_threads(threads, [&](int t) {
+            auto &list = *lists[t];
+            for (int i = t * per_thread; i < (t + 1) * per_thread; ++i) {
+                record_shape(list, i);
+            }
+        });
+        auto begin = bench::clock::now();
+        data.clear();
+        data.merge(order);
+        merge_ms = bench::elapsed_ms(begin);
+        for (auto &list : lists) {
+            list->clear();
+        }
+    };
+    double ms = bench::measure_ms(frame, 5);
+    vertices = data.vtx_list.size();
+    return ms;
+}
+
+} // namespace
+
+int main() {
+    double base_ms = 0;
+    for (int threads : {1, 2, 4, 8, 16}) {
+        auto name = std::to_string(threads) + " threads";
+        size_t locked_vtx = 0;
+        size_t merged_vtx = 0;
+        double merge_ms = 0;
+        double locked_ms = bench_locked(threads, locked_vtx);
+        double merged_ms = bench_per_thread(threads, merged_vtx, merge_ms);
+        if (threads == 1) {
+            base_ms = merged_ms;
+        }
+        bench::report(name, "mutex time", locked_ms, "ms");
+        bench::report(name, "per-thread time", merged_ms, "ms");
+        bench::report(name, "merge time", merge_ms, "ms");
+        bench::report(name, "per-thread speedup", base_ms / merged_ms, "x");
+        bench::report(name, "vertices", merged_vtx, "");
+        if (locked_vtx != merged_vtx) {
+            std::fprintf(stderr, "vertex count mismatch %zu != %zu\n",
+                         locked_vtx, merged_vtx);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include "alloc_counter.hpp"
+#include "bench.hpp"
+
+#include <core/event_bus.hpp>
+
+using namespace my;
+
+namespace {
+
+constexpr int kEvents = 1 << 18;
+constexpr int kOtherTypes = 16;
+
+struct MotionEvent {
+    int x, y;
+    int xrel, yrel;
+};
+
+// events of other types the bus carries subscribers for
+template <int N> struct OtherEvent {
+    int value;
+};
+
+template <int... N>
+void subscribe_others(EventBus &bus,
+                      std::vector<rx::composite_subscription> &subs,
+                      std::integer_sequence<int, N...>) {
+    (subs.push_back(on_event<OtherEvent<N>>(&bus).subscribe([](auto) {})),
+     ...);
+}
+
+template <int... N>
+void dispatch_others(EventBus &bus, std::integer_sequence<int, N...>) {
+    (bus.on_dispatch<OtherEvent<N>>([](const auto &) {}), ...);
+}
+
+struct Result {
+    double events_per_sec;
+    double allocs_per_event;
+};
+
+template <typename Post> Result run(Post &&post) {
+    for (int i = 0; i < 1024; ++i) {
+        post(i);
+    }
+    auto allocs = bench::allocations();
+    auto begin = bench::clock::now();
+    for (int i = 0; i < kEvents; ++i) {
+        post(i);
+    }
+    double ms = bench::elapsed_ms(begin);
+    return {kEvents / ms * 1000,
+            double(bench::allocations() - allocs) / kEvents};
+}
+
+void report(const std::string &name, const Result &result) {
+    bench::report(name, "events/sec", result.events_per_sec, "");
+    bench::report(name, "allocations/event", result.allocs_per_event, "");
+}
+
+} // namespace
+
+int main() {
+    for (int others : {0, kOtherTypes}) {
+        auto suffix = " (+" + std::to_string(others) + " other types)";
+        long sum = 0;
+
+        {
+            EventBus bus;
+            std::vector<rx::composite_subscription> subs;
+            subs.push_back(on_event<MotionEvent>(&bus).subscribe(
+                [&sum](const auto &e) { sum += (*e)->x; }));
+            if (others) {
+                subscribe_others(
+                    bus, subs, std::make_integer_sequence<int, kOtherTypes>{});
+            }
+            report("rx on_event" + suffix, run([&bus](int i) {
+                       bus.post<MotionEvent>(MotionEvent{i, i, 1, 1});
+                   }));
+            for (auto &sub : subs) {
+                sub.unsubscribe();
+            }
+        }
+
+        {
+            EventBus bus;
+            bus.on_dispatch<MotionEvent>(
+                [&sum](const TypedEvent<MotionEvent> &e) { sum += e->x; });
+            if (others) {
+                dispatch_others(
+                    bus, std::make_integer_sequence<int, kOtherTypes>{});
+            }
+            report("typed dispatch" + suffix, run([&bus](int i) {
+                       bus.dispatch<MotionEvent>(i, i, 1, 1);
+                   }));
+        }
+
+        bench::report("checksum", "sum", double(sum), "");
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include "alloc_counter.hpp"
+#include "bench.hpp"
+
+#include <core/basic_service.hpp>
+
+using namespace my;
+
+namespace {
+
+constexpr int kServices = 8;
+constexpr int kTasks = 1 << 15;
+constexpr int kLatencyRounds = 2000;
+
+class BenchService : public BasicService {
+  public:
+    BenchService() = default;
+    explicit BenchService(Executor &executor) : BasicService(executor) {}
+
+    template <typename T, typename Func> future<T> run(Func &&func) {
+        return this->schedule<T>(std::forward<Func>(func));
+    }
+};
+
+using services_type = std::vector<unique_ptr<BenchService>>;
+
+/**
+ * @brief      one task per service at a time, the task reports how long
+ *             after scheduling it started
+ */
+void latency(const std::string &name, services_type &services) {
+    std::vector<double> samples;
+    samples.reserve(kLatencyRounds * services.size());
+    std::vector<future<double>> futures;
+    for (int round = 0; round < kLatencyRounds; ++round) {
+        futures.clear();
+        for (auto &service : services) {
+            auto begin = bench::clock::now();
+            futures.push_back(service->run<double>([begin]() {
+                return std::chrono::duration<double, std::micro>(
+                           bench::clock::now() - begin)
+                    .count();
+            }));
+        }
+        for (auto &f : futures) {
+            samples.push_back(f.get());
+        }
+    }
+    bench::report(name, "schedule-to-run p50", bench::percentile(samples, 50),
+                  "us");
+    bench::report(name, "schedule-to-run p99", bench::percentile(samples, 99),
+                  "us");
+}
+
+/**
+ * @brief      kTasks per service posted back to back
+ */
+void throughput(const std::string &name, services_type &services) {
+    std::atomic<long> sum{0};
+    std::vector<future<void>> last;
+    auto allocs = bench::allocations();
+    auto begin = bench::clock::now();
+    for (int i = 0; i < kTasks; ++i) {
+        for (auto &service : services) {
+            auto f = service->run<void>([&sum, i]() {
+                sum.fetch_add(i, std::memory_order_relaxed);
+            });
+            if (i == kTasks - 1) {
+                last.push_back(std::move(f));
+            }
+        }
+    }
+    for (auto &f : last) {
+        f.get();
+    }
+    double ms = bench::elapsed_ms(begin);
+    double tasks = double(kTasks) * services.size();
+    bench::report(name, "tasks/sec", tasks / ms * 1000, "");
+    bench::report(name, "allocations/task",
+                  double(bench::allocations() - allocs) / tasks, "");
+}
+
+} // namespace
+
+int main() {
+    {
+        services_type services;
+        for (int i = 0; i < kServices; ++i) {
+            services.push_back(std::make_unique<BenchService>());
+        }
+        bench::report("thread per service", "threads", kServices, "");
+        latency("thread per service", services);
+        throughput("thread per service", services);
+    }
+
+    {
+        Executor executor;
+        services_type services;
+        for (int i = 0; i < kServices; ++i) {
+            services.push_back(std::make_unique<BenchService>(executor));
+        }
+        bench::report("strand per service", "threads",
+                      double(executor.concurrency()), "");
+        latency("strand per service", services);
+        throughput("strand per service", services);
+        bench::report("strand per service", "stolen tasks",
+                      double(executor.stats().stolen), "");
+    }
+    return 0;
+}
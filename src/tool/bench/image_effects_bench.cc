@@ -0,0 +1,82 @@
+#include "bench.hpp"
+
+#include <random>
+
+#include <render/back/back2/image_effects.hpp>
+
+using namespace my;
+
+namespace {
+
+constexpr uint32_t kWidth = 1920;
+constexpr uint32_t kHeight = 1080;
+
+} // namespace
+
+int main() {
+    RGBAImage source(kWidth, kHeight);
+    {
+        std::mt19937 rng(1234);
+        std::uniform_int_distribution<int> byte(0, 255);
+        for (auto &pixel : boost::gil::view(source)) {
+            pixel = boost::gil::rgba8_pixel_t(byte(rng), byte(rng), byte(rng),
+                                              byte(rng));
+        }
+    }
+    RGBAImage target(kWidth, kHeight);
+    const double mpx = kWidth * kHeight / 1e6;
+
+    struct Case {
+        std::string name;
+        ImageEffect effect;
+    };
+    std::vector<Case> cases{
+        {"premultiply", ImageEffect::premultiply()},
+        {"unpremultiply", ImageEffect::unpremultiply()},
+        {"color matrix", ImageEffect::color_matrix(
+                             ColorMatrix::saturation(0.5f) *
+                             ColorMatrix::tint({40, 90, 200, 255}, 0.3f))},
+        {"box blur r4", ImageEffect::box_blur(4)},
+        {"box blur r32", ImageEffect::box_blur(32)},
+        {"gaussian s2", ImageEffect::gaussian_blur(2)},
+        {"gaussian s4 (boxes)", ImageEffect::gaussian_blur(4)},
+        {"gaussian s20 (boxes)", ImageEffect::gaussian_blur(20)},
+    };
+
+    for (auto &c : cases) {
+        double base_ms = 0;
+        for (uint32_t threads : {1u, 2u, 4u, 8u}) {
+            ImageEffects effects({threads});
+            double ms = bench::measure_ms(
+                [&]() {
+                    effects.apply(c.effect, boost::gil::const_view(source),
+                                  boost::gil::view(target));
+                },
+                10);
+            if (threads == 1) {
+                base_ms = ms;
+            }
+            auto name = c.name + " " + std::to_string(threads) + "t";
+            bench::report(name, "time", ms, "ms");
+            bench::report(name, "throughput", mpx / ms * 1000, "Mpx/s");
+            bench::report(name, "speedup", base_ms / ms, "x");
+        }
+    }
+
+    // a blurred backdrop drawn every frame from the cache
+    ImageEffects effects;
+    auto id = uuid_gen();
+    std::vector<ImageEffect> backdrop{ImageEffect::premultiply(),
+                                      ImageEffect::gaussian_blur(20),
+                                      ImageEffect::unpremultiply()};
+    double miss_ms = bench::measure_ms([&]() {
+        effects.clear();
+        effects.apply(id, boost::gil::const_view(source), backdrop);
+    });
+    double hit_ms = bench::measure_ms(
+        [&]() { effects.apply(id, boost::gil::const_view(source), backdrop); },
+        1000);
+    bench::report("backdrop", "miss", miss_ms, "ms");
+    bench::report("backdrop", "hit", hit_ms * 1000, "us");
+    return 0;
+}
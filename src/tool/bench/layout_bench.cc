@@ -0,0 +1,94 @@
+#include "bench.hpp"
+
+#include <render/layout.hpp>
+#include <render/node_view.hpp>
+
+using namespace my;
+
+namespace {
+
+class Label : public NodeView {
+  public:
+    static shared_ptr<Label> make() {
+        return shared_ptr<Label>(new Label());
+    }
+
+    void text(int32_t width) {
+        this->_width = width;
+        this->invalidate();
+    }
+
+    ISize2D measure(int32_t max_width, int32_t) override {
+        return ISize2D::Make(std::min(this->_width, max_width), 12);
+    }
+
+  private:
+    int32_t _width{40};
+};
+
+// alternating rows and columns, labels at the leaves
+shared_ptr<NodeView> build(int depth, int fanout,
+                           std::vector<shared_ptr<Label>> &labels) {
+    if (depth == 0) {
+        labels.push_back(Label::make());
+        return labels.back();
+    }
+    LayoutStyle style;
+    style.direction = depth % 2 ? FlexDirection::kRow : FlexDirection::kColumn;
+    style.padding = Edges::all(1);
+    style.gap = 1;
+    style.grow = 1;
+    auto view = NodeView::make();
+    view->layout_style(style);
+    for (int i = 0; i < fanout; ++i) {
+        view->append_child(build(depth - 1, fanout, labels));
+    }
+    return view;
+}
+
+void run(int depth, int fanout) {
+    std::vector<shared_ptr<Label>> labels;
+    auto root = build(depth, fanout, labels);
+    auto label = "depth " + std::to_string(depth) + " fanout " +
+                 std::to_string(fanout) + " (" +
+                 std::to_string(root->store()->size()) + " nodes)";
+    auto size = ISize2D::Make(1920, 1080);
+
+    FlexLayout layout;
+    bench::report(label, "full layout ms", bench::measure_ms([&]() {
+                      layout.clear();
+                      layout.compute(*root, size);
+                  }),
+                  "");
+    bench::report(label, "laid out", double(layout.stats().laid_out), "");
+
+    bench::report(label, "unchanged ms",
+                  bench::measure_ms([&]() { layout.compute(*root, size); }),
+                  "");
+
+    int32_t width = 40;
+    bench::report(label, "one label ms", bench::measure_ms([&]() {
+                      width = width == 40 ? 60 : 40;
+                      labels[labels.size() / 2]->text(width);
+                      layout.compute(*root, size);
+                  }),
+                  "");
+    bench::report(label, "laid out", double(layout.stats().laid_out), "");
+
+    bench::report(label, "window resize ms", bench::measure_ms([&]() {
+                      size = ISize2D::Make(size.width() == 1920 ? 1600 : 1920,
+                                           1080);
+                      layout.compute(*root, size);
+                  }),
+                  "");
+    bench::report(label, "laid out", double(layout.stats().laid_out), "");
+}
+
+} // namespace
+
+int main() {
+    run(8, 4);
+    run(12, 2);
+    run(2, 300);
+    return 0;
+}
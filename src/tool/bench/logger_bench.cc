@@ -0,0 +1,84 @@
+#include "alloc_counter.hpp"
+#include "bench.hpp"
+
+#include <thread>
+
+#include <core/logger.hpp>
+
+using namespace my;
+
+namespace {
+
+constexpr int kCalls = 1 << 16;
+
+class NullOutput : public Logger::LoggerOutput {
+  public:
+    NullOutput() : Logger::LoggerOutput(Logger::kDebug) {}
+    void operator()(const Logger::LogMsg &msg) override {
+        this->bytes += msg.msg.size();
+    }
+    size_t bytes{0};
+};
+
+/**
+ * @brief      ns per call on the calling threads, the logger thread's
+ *             formatting is not included
+ */
+template <typename Call> void run(const std::string &name, int threads,
+                                  Logger &logger, Call &&call) {
+    auto allocs = bench::allocations();
+    auto begin = bench::clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&call]() {
+            for (int i = 0; i < kCalls; ++i) {
+                call(i);
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    double ms = bench::elapsed_ms(begin);
+    logger.flush();
+    double calls = double(kCalls) * threads;
+    bench::report(name, "ns/call", ms * 1e6 / calls, "");
+    bench::report(name, "allocations/call",
+                  double(bench::allocations() - allocs) / calls, "");
+}
+
+} // namespace
+
+int main() {
+    auto output = std::make_shared<NullOutput>();
+    Logger logger({output});
+    float elapsed = 1.5f;
+
+    // what every GLOG_D cost before: formatting on the calling thread
+    run("format on caller", 1, logger, [&](int i) {
+        auto msg = (boost::format("handle video frame: pts %d, next_pts %d, "
+                                  "elapsed %f") %
+                    i % (i + 1) % elapsed)
+                       .str();
+        output->bytes += msg.size();
+    });
+
+    logger.set_level(Logger::kInfo);
+    run("filtered debug", 1, logger, [&](int i) {
+        LOG_D(&logger, "handle video frame: pts %d, next_pts %d, elapsed %f",
+              i, i + 1, elapsed);
+    });
+
+    logger.set_level(Logger::kDebug);
+    for (int threads : {1, 4}) {
+        run("deferred debug x" + std::to_string(threads), threads, logger,
+            [&](int i) {
+                LOG_D(&logger,
+                      "handle video frame: pts %d, next_pts %d, elapsed %f",
+                      i, i + 1, elapsed);
+            });
+    }
+    bench::report("dropped records", "count", double(logger.dropped()), "");
+    bench::report("checksum", "bytes", double(output->bytes), "");
+    return 0;
+}
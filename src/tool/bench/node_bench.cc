@@ -0,0 +1,149 @@
+#include "bench.hpp"
+
+#include <random>
+
+#include <render/node.hpp>
+
+using namespace my;
+
+namespace {
+
+constexpr size_t kFanout = 8;
+constexpr size_t kReparents = 10000;
+
+// the layout the tree had before: heap nodes owning their children
+struct PointerNode {
+    PointerNode *parent{};
+    std::vector<std::shared_ptr<PointerNode>> children;
+    uuid id{uuid_gen()};
+    std::string name;
+    IRect rect{IRect::MakeEmpty()};
+};
+
+template <typename Func> void visit_pre(PointerNode &node, Func &func) {
+    func(node);
+    for (auto &child : node.children) {
+        visit_pre(*child, func);
+    }
+}
+
+template <typename Func> void visit_post(PointerNode &node, Func &func) {
+    for (auto &child : node.children) {
+        visit_post(*child, func);
+    }
+    func(node);
+}
+
+void pointer_tree(size_t n) {
+    auto label = "pointer tree " + std::to_string(n);
+    std::vector<PointerNode *> nodes;
+    std::shared_ptr<PointerNode> root;
+    bench::report(label, "build ms", bench::measure_ms([&]() {
+                      nodes.clear();
+                      root = std::make_shared<PointerNode>();
+                      nodes.push_back(root.get());
+                      for (size_t i = 1; i < n; ++i) {
+                          auto parent = nodes[(i - 1) / kFanout];
+                          auto node = std::make_shared<PointerNode>();
+                          node->parent = parent;
+                          nodes.push_back(node.get());
+                          parent->children.push_back(std::move(node));
+                      }
+                  }),
+                  "");
+    int64_t sum = 0;
+    auto add = [&sum](PointerNode &node) { sum += node.rect.width(); };
+    bench::report(label, "pre-order ms",
+                  bench::measure_ms([&]() { visit_pre(*root, add); }, 5), "");
+    bench::report(label, "post-order ms",
+                  bench::measure_ms([&]() { visit_post(*root, add); }, 5), "");
+    bench::report(label, "checksum", double(sum), "");
+}
+
+void node_store(size_t n) {
+    auto label = "node store " + std::to_string(n);
+    NodeStore store;
+    std::vector<NodeHandle> nodes;
+    bench::report(label, "build ms", bench::measure_ms([&]() {
+                      if (!nodes.empty()) {
+                          store.destroy(nodes.front());
+                      }
+                      nodes.clear();
+                      store.reserve(n);
+                      nodes.push_back(store.create());
+                      for (size_t i = 1; i < n; ++i) {
+                          auto node = store.create();
+                          store.append_child(nodes[(i - 1) / kFanout], node);
+                          nodes.push_back(node);
+                      }
+                  }),
+                  "");
+    auto root = nodes.front();
+    int64_t sum = 0;
+    auto add = [&store, &sum](NodeHandle node) {
+        sum += store.rect(node).width();
+    };
+    bench::report(label, "pre-order ms", bench::measure_ms([&]() {
+                      store.pre_order(root, add);
+                  }, 5),
+                  "");
+    bench::report(label, "post-order ms", bench::measure_ms([&]() {
+                      store.post_order(root, add);
+                  }, 5),
+                  "");
+    bench::report(label, "world transforms ms", bench::measure_ms([&]() {
+                      store.update_world_transforms(root);
+                  }, 5),
+                  "");
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> pick(1, n - 1);
+    size_t moved = 0;
+    double ms = bench::measure_ms([&]() {
+        for (size_t i = 0; i < kReparents; ++i) {
+            auto child = nodes[pick(rng)];
+            auto parent = nodes[pick(rng)];
+            if (child != parent && !store.is_ancestor(child, parent)) {
+                store.append_child(parent, child);
+                ++moved;
+            }
+        }
+    });
+    bench::report(label, "reparent ns/op", ms * 1e6 / kReparents, "");
+    bench::report(label, "checksum", double(sum + int64_t(moved)), "");
+}
+
+void node_facade(size_t n) {
+    auto label = "Node " + std::to_string(n);
+    shared_ptr<Node> root;
+    bench::report(label, "build ms", bench::measure_ms([&]() {
+                      std::vector<Node *> nodes;
+                      root = Node::make_root();
+                      nodes.push_back(root.get());
+                      for (size_t i = 1; i < n; ++i) {
+                          auto node = Node::make();
+                          nodes.push_back(node.get());
+                          nodes[(i - 1) / kFanout]->append_child(node);
+                      }
+                  }),
+                  "");
+    int64_t sum = 0;
+    bench::report(label, "pre-order ms", bench::measure_ms([&]() {
+                      root->pre_order([&sum](shared_ptr<Node> const &node) {
+                          sum += node->rect().width();
+                      });
+                  }, 5),
+                  "");
+    bench::report(label, "checksum", double(sum), "");
+}
+
+} // namespace
+
+int main() {
+    for (size_t n : {size_t(10000), size_t(100000), size_t(1000000)}) {
+        pointer_tree(n);
+        node_store(n);
+        node_facade(n);
+    }
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include "bench.hpp"
+
+#include <random>
+
+#include <render/node_index.hpp>
+
+using namespace my;
+
+namespace {
+
+constexpr int kWindow = 4096;
+constexpr int kPanels = 16;
+constexpr int kPanelSize = kWindow / kPanels;
+constexpr int kButtons = 20;
+constexpr int kButtonStride = 12;
+constexpr int kButtonSize = 10;
+
+// what the planned dispatch does: descend into every child containing the
+// point, allocating a translated point per level like the translated event
+NodeHandle walk(NodeStore const &store, NodeHandle node,
+                shared_ptr<Point2D> const &pos) {
+    auto const &rect = store.rect(node);
+    if (!rect.contains(int32_t(pos->x()), int32_t(pos->y()))) {
+        return {};
+    }
+    auto translated = std::make_shared<Point2D>(
+        Point2D::Make(pos->x() - rect.left(), pos->y() - rect.top()));
+    NodeHandle hit;
+    for (auto child = store.first_child(node); child;
+         child = store.next_sibling(child)) {
+        if (auto h = walk(store, child, translated)) {
+            hit = h;
+        }
+    }
+    return hit ? hit : node;
+}
+
+} // namespace
+
+int main() {
+    NodeStore store;
+    auto root = store.create();
+    store.rect(root, IRect::MakeWH(kWindow, kWindow));
+    std::vector<NodeHandle> buttons;
+    for (int py = 0; py < kPanels; ++py) {
+        for (int px = 0; px < kPanels; ++px) {
+            auto panel = store.create();
+            store.rect(panel, IRect::MakeXYWH(px * kPanelSize, py * kPanelSize,
+                                              kPanelSize, kPanelSize));
+            store.append_child(root, panel);
+            for (int by = 0; by < kButtons; ++by) {
+                for (int bx = 0; bx < kButtons; ++bx) {
+                    auto button = store.create();
+                    store.rect(button,
+                               IRect::MakeXYWH(bx * kButtonStride + 4,
+                                               by * kButtonStride + 4,
+                                               kButtonSize, kButtonSize));
+                    store.append_child(panel, button);
+                    buttons.push_back(button);
+                }
+            }
+        }
+    }
+    auto label = "nodes " + std::to_string(store.size());
+
+    NodeIndex index;
+    bench::report(label, "full sync ms",
+                  bench::measure_ms([&]() {
+                      index.clear();
+                      index.sync(store, root);
+                  }),
+                  "");
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> coord(0, kWindow);
+    std::vector<Point2D> points;
+    for (int i = 0; i < (1 << 20); ++i) {
+        points.push_back(Point2D::Make(coord(rng), coord(rng)));
+    }
+
+    uint64_t checksum = 0;
+    auto ms = bench::measure_ms([&]() {
+        for (auto &p : points) {
+            if (auto hit = index.hit_test(p)) {
+                checksum += hit->node.index;
+            }
+        }
+    });
+    bench::report(label, "index hit tests/s", points.size() / ms * 1e3, "");
+
+    size_t walked = points.size() / 16;
+    ms = bench::measure_ms([&]() {
+        for (size_t i = 0; i < walked; ++i) {
+            checksum +=
+                walk(store, root, std::make_shared<Point2D>(points[i])).index;
+        }
+    });
+    bench::report(label, "tree walk hit tests/s", walked / ms * 1e3, "");
+
+    std::uniform_int_distribution<size_t> pick(0, buttons.size() - 1);
+    ms = bench::measure_ms([&]() {
+        for (int i = 0; i < 100; ++i) {
+            auto button = buttons[pick(rng)];
+            auto rect = store.rect(button);
+            store.rect(button, rect.makeOffset(rect.left() % 2 ? -1 : 1, 0));
+        }
+        index.sync(store, root);
+    });
+    bench::report(label, "sync after 100 moves ms", ms, "");
+
+    ms = bench::measure_ms([&]() {
+        for (auto &p : points) {
+            checksum += index.hover(p);
+        }
+    });
+    bench::report(label, "hover updates/s", points.size() / ms * 1e3, "");
+    bench::report(label, "checksum", double(checksum % 1000), "");
+    return 0;
+}
@@ -0,0 +1,145 @@
+#include "bench.hpp"
+
+#include <cmath>
+#include <functional>
+#include <random>
+
+#include <render/back/back2/path_tessellator.hpp>
+
+using namespace my;
+
+namespace {
+
+struct Scene {
+    std::string name;
+    std::vector<DrawPath> paths;
+    std::function<void(PathTessellator &, const DrawPath &,
+                       std::vector<DrawVert> &, std::vector<uint32_t> &)>
+        draw;
+};
+
+const ColorRGBAub kColor{40, 90, 200, 255};
+
+// glyph like outlines: quadratic contours with a counter
+std::vector<DrawPath> make_glyphs(std::mt19937 &rng, int count) {
+    std::uniform_real_distribution<float> pos(0, 1024);
+    std::vector<DrawPath> paths;
+    for (int i = 0; i < count; ++i) {
+        glm::vec2 o{pos(rng), pos(rng)};
+        DrawPath p(o);
+        p.quad_to(o + glm::vec2{8, -20}, o + glm::vec2{16, 0})
+            .quad_to(o + glm::vec2{24, 20}, o + glm::vec2{8, 24})
+            .quad_to(o + glm::vec2{-8, 20}, o)
+            .close()
+            .move_to(o + glm::vec2{8, 6})
+            .quad_to(o + glm::vec2{4, 12}, o + glm::vec2{8, 16})
+            .quad_to(o + glm::vec2{12, 12}, o + glm::vec2{8, 6})
+            .close();
+        paths.push_back(std::move(p));
+    }
+    return paths;
+}
+
+// line chart with thousands of samples, stroked with round joins
+std::vector<DrawPath> make_chart(std::mt19937 &rng, int samples) {
+    std::normal_distribution<float> noise(0, 6);
+    DrawPath p({0, 300});
+    float y = 300;
+    for (int i = 1; i < samples; ++i) {
+        y = std::clamp(y + noise(rng), 0.0f, 600.0f);
+        p.line_to({i * 1024.0f / samples, y});
+    }
+    return {p};
+}
+
+// self intersecting random polygons filled with the even-odd rule
+std::vector<DrawPath> make_scribbles(std::mt19937 &rng, int count,
+                                     int points) {
+    std::uniform_real_distribution<float> pos(0, 256);
+    std::vector<DrawPath> paths;
+    for (int i = 0; i < count; ++i) {
+        DrawPath p({pos(rng), pos(rng)});
+        for (int k = 1; k < points; ++k) {
+            p.line_to({pos(rng), pos(rng)});
+        }
+        paths.push_back(p.close());
+    }
+    return paths;
+}
+
+// svg like blobs made of cubics and arcs
+std::vector<DrawPath> make_blobs(std::mt19937 &rng, int count) {
+    std::uniform_real_distribution<float> pos(64, 960);
+    std::uniform_real_distribution<float> radius(8, 96);
+    std::vector<DrawPath> paths;
+    for (int i = 0; i < count; ++i) {
+        glm::vec2 c{pos(rng), pos(rng)};
+        float r = radius(rng);
+        DrawPath p(c + glm::vec2{r, 0});
+        p.cubic_to(c + glm::vec2{r, r * 1.3f}, c + glm::vec2{-r, r * 0.6f},
+                   c + glm::vec2{-r, 0})
+            .arc_to(c + glm::vec2{-r, -r}, c + glm::vec2{0, -r}, r * 0.4f)
+            .ellipse(c, {r, r * 0.5f}, 0.3f, -1.5f, 0.0f)
+            .close();
+        paths.push_back(std::move(p));
+    }
+    return paths;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(1234);
+
+    auto filler = [](FillRule rule) {
+        return [rule](PathTessellator &t, const DrawPath &p,
+                      std::vector<DrawVert> &vtx, std::vector<uint32_t> &idx) {
+            t.fill(p, kColor, rule, vtx, idx);
+        };
+    };
+    auto stroker = [](StrokeStyle style) {
+        return [style](PathTessellator &t, const DrawPath &p,
+                       std::vector<DrawVert> &vtx,
+                       std::vector<uint32_t> &idx) {
+            t.stroke(p, kColor, style, vtx, idx);
+        };
+    };
+
+    std::vector<Scene> scenes{
+        {"glyphs fill nonzero", make_glyphs(rng, 2000),
+         filler(FillRule::kNonZero)},
+        {"chart stroke round", make_chart(rng, 20000),
+         stroker({2.0f, LineJoin::kRound, LineCap::kRound})},
+        {"chart stroke miter", make_chart(rng, 20000),
+         stroker({2.0f, LineJoin::kMiter, LineCap::kButt})},
+        {"scribbles fill evenodd", make_scribbles(rng, 200, 32),
+         filler(FillRule::kEvenOdd)},
+        {"blobs fill nonzero", make_blobs(rng, 1000),
+         filler(FillRule::kNonZero)},
+        {"blobs stroke bevel", make_blobs(rng, 1000),
+         stroker({3.0f, LineJoin::kBevel, LineCap::kSquare})},
+    };
+
+    for (float aa : {0.0f, 1.0f}) {
+        PathTessellator tessellator;
+        tessellator.options().aa_width = aa;
+
+        std::vector<DrawVert> vtx;
+        std::vector<uint32_t> idx;
+        for (auto &scene : scenes) {
+            auto run = [&]() {
+                vtx.clear();
+                idx.clear();
+                for (const auto &path : scene.paths) {
+                    scene.draw(tessellator, path, vtx, idx);
+                }
+            };
+            double ms = bench::measure_ms(run, 10);
+            auto name = scene.name + (aa > 0 ? " aa" : "");
+            bench::report(name, "time", ms, "ms");
+            bench::report(name, "vertices", vtx.size(), "");
+            bench::report(name, "throughput", vtx.size() / ms, "vertices/ms");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,37 @@
+#include "bench.hpp"
+
+#include <core/profiler.hpp>
+
+using namespace my;
+
+namespace {
+
+constexpr int kZones = 1 << 20;
+
+// collects every few thousand zones, like a per frame collect() would
+void run(const std::string &name) {
+    auto profiler = Profiler::get();
+    double ms = bench::measure_ms([profiler]() {
+        for (int i = 0; i < kZones; ++i) {
+            MY_PROFILE_ZONE("bench zone");
+            if ((i & 4095) == 0) {
+                profiler->collect();
+            }
+        }
+    });
+    bench::report(name, "ns/zone", ms * 1e6 / kZones, "");
+}
+
+} // namespace
+
+int main() {
+    run("not capturing");
+
+    auto profiler = Profiler::get();
+    profiler->start();
+    run("capturing");
+    profiler->stop();
+    bench::report("capturing", "events", double(profiler->size()), "");
+    bench::report("capturing", "dropped", double(profiler->dropped()), "");
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include "bench.hpp"
+
+#include <condition_variable>
+#include <queue>
+#include <shared_mutex>
+#include <thread>
+
+#include <util/queue.hpp>
+
+using namespace my;
+
+namespace {
+
+constexpr int kItems = 1 << 20;
+constexpr int kLatencyItems = 1 << 16;
+constexpr size_t kCapacity = 1024;
+
+/**
+ * @brief      the previous util::Queue, a std::queue behind one lock
+ */
+template <class T, size_t max_size> class LockedQueue {
+  public:
+    void push(T &&v) {
+        std::unique_lock<std::shared_mutex> l_lock(this->_lock);
+        this->_cv.wait(l_lock,
+                       [this]() { return this->_queue.size() < max_size; });
+        this->_queue.push(std::move(v));
+        this->_cv.notify_one();
+    }
+
+    T pop() {
+        std::unique_lock<std::shared_mutex> l_lock(this->_lock);
+        this->_cv.wait(l_lock, [this]() { return !this->_queue.empty(); });
+        auto v = std::move(this->_queue.front());
+        this->_queue.pop();
+        this->_cv.notify_one();
+        return v;
+    }
+
+  private:
+    std::queue<T> _queue;
+    std::condition_variable_any _cv;
+    std::shared_mutex _lock;
+};
+
+/**
+ * @brief      producers push kItems values in total, consumers pop them
+ *
+ * @return     ops/sec
+ */
+template <typename Q> double throughput(int producers, int consumers) {
+    Q queue;
+    std::vector<std::thread> threads;
+    std::atomic<long> sum{0};
+    auto begin = bench::clock::now();
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&queue, producers]() {
+            for (int i = 0; i < kItems / producers; ++i) {
+                queue.push(long(i));
+            }
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&queue, &sum, consumers]() {
+            long local = 0;
+            for (int i = 0; i < kItems / consumers; ++i) {
+                local += queue.pop();
+            }
+            sum += local;
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    return kItems / bench::elapsed_ms(begin) * 1000;
+}
+
+/**
+ * @brief      push timestamps at a steady pace, the consumer records how
+ *             long each one waited in the queue
+ */
+template <typename Q> void latency(const std::string &name) {
+    Q queue;
+    std::vector<double> samples;
+    samples.reserve(kLatencyItems);
+    std::thread consumer([&queue, &samples]() {
+        for (int i = 0; i < kLatencyItems; ++i) {
+            auto sent = queue.pop();
+            samples.push_back(std::chrono::duration<double, std::micro>(
+                                  bench::clock::now() - sent)
+                                  .count());
+        }
+    });
+    for (int i = 0; i < kLatencyItems; ++i) {
+        queue.push(bench::clock::now());
+        // leave the consumer time to drain, so the queue stays short
+        auto until = bench::clock::now() + std::chrono::microseconds(2);
+        while (bench::clock::now() < until) {
+        }
+    }
+    consumer.join();
+
+    bench::report(name, "p50", bench::percentile(samples, 50), "us");
+    bench::report(name, "p99", bench::percentile(samples, 99), "us");
+    bench::report(name, "p99.9", bench::percentile(samples, 99.9), "us");
+}
+
+} // namespace
+
+int main() {
+    using Locked = LockedQueue<long, kCapacity>;
+    using MPMC = Queue<long, kCapacity>;
+    using SPSC = Queue<long, kCapacity, QueueKind::kSPSC>;
+
+    bench::report("locked 1P1C", "ops/sec", throughput<Locked>(1, 1), "");
+    bench::report("mpmc 1P1C", "ops/sec", throughput<MPMC>(1, 1), "");
+    bench::report("spsc 1P1C", "ops/sec", throughput<SPSC>(1, 1), "");
+    for (int n : {2, 4}) {
+        auto threads = std::to_string(n) + "P" + std::to_string(n) + "C";
+        bench::report("locked " + threads, "ops/sec",
+                      throughput<Locked>(n, n), "");
+        bench::report("mpmc " + threads, "ops/sec", throughput<MPMC>(n, n),
+                      "");
+    }
+
+    using time_point = bench::clock::time_point;
+    latency<LockedQueue<time_point, kCapacity>>("locked latency");
+    latency<Queue<time_point, kCapacity>>("mpmc latency");
+    latency<Queue<time_point, kCapacity, QueueKind::kSPSC>>("spsc latency");
+    return 0;
+}
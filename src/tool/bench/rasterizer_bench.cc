@@ -0,0 +1,112 @@
+#include "bench.hpp"
+
+#include <cmath>
+#include <random>
+
+#include <render/back/back2/rasterizer.hpp>
+
+using namespace my;
+
+namespace {
+
+constexpr uint32_t kWidth = 1920;
+constexpr uint32_t kHeight = 1080;
+
+// widgets: opaque backgrounds, rounded outlines and translucent overlays
+void record_widgets(DrawList &list, std::mt19937 &rng) {
+    std::uniform_real_distribution<float> x(0, kWidth - 120);
+    std::uniform_real_distribution<float> y(0, kHeight - 40);
+    for (int i = 0; i < 4000; ++i) {
+        glm::vec2 o{x(rng), y(rng)};
+        list.fill_rect(o, o + glm::vec2{120, 32}, {230, 230, 235, 255});
+        list.begin_path(o + glm::vec2{6, 0})
+            .arc_to(o + glm::vec2{120, 0}, o + glm::vec2{120, 32}, 6)
+            .arc_to(o + glm::vec2{120, 32}, o + glm::vec2{0, 32}, 6)
+            .arc_to(o + glm::vec2{0, 32}, o, 6)
+            .arc_to(o, o + glm::vec2{120, 0}, 6)
+            .close_path()
+            .stroke({60, 60, 70, 255}, 1);
+        list.fill_rect(o + glm::vec2{4, 4}, o + glm::vec2{60, 28},
+                       {40, 120, 220, 96});
+    }
+}
+
+// full screen line chart with an area fill under the curve
+void record_chart(DrawList &list, std::mt19937 &rng) {
+    std::normal_distribution<float> noise(0, 4);
+    float v = kHeight / 2.0f;
+    list.begin_path({0, float(kHeight)});
+    for (uint32_t i = 0; i <= kWidth; i += 2) {
+        v = std::clamp(v + noise(rng), 100.0f, kHeight - 100.0f);
+        list.line_to({float(i), v});
+    }
+    list.line_to({float(kWidth), float(kHeight)})
+        .close_path()
+        .fill({40, 160, 90, 80});
+    list.begin_path({0, kHeight / 2.0f});
+    for (uint32_t i = 0; i <= kWidth; i += 2) {
+        v = std::clamp(v + noise(rng), 100.0f, kHeight - 100.0f);
+        list.line_to({float(i), v});
+    }
+    list.line_join(LineJoin::kRound).stroke({20, 80, 40, 255}, 2);
+}
+
+// overlapping translucent circles, mostly blending work
+void record_circles(DrawList &list, std::mt19937 &rng) {
+    std::uniform_real_distribution<float> x(0, kWidth);
+    std::uniform_real_distribution<float> y(0, kHeight);
+    std::uniform_real_distribution<float> r(20, 160);
+    for (int i = 0; i < 600; ++i) {
+        glm::vec2 c{x(rng), y(rng)};
+        list.begin_path(c)
+            .arc(c, r(rng), 0, 2 * float(M_PI))
+            .close_path()
+            .fill({uint8_t(i * 7), uint8_t(i * 13), uint8_t(i * 29), 64});
+    }
+}
+
+} // namespace
+
+int main() {
+    std::vector<uint8_t> pixels(size_t(kWidth) * kHeight * 4);
+    Rasterizer::TargetView target{pixels.data(), kWidth, kHeight,
+                                  size_t(kWidth) * 4};
+
+    struct Scene {
+        std::string name;
+        void (*record)(DrawList &, std::mt19937 &);
+    };
+    std::vector<Scene> scenes{{"widgets", record_widgets},
+                              {"chart", record_chart},
+                              {"circles", record_circles}};
+
+    for (auto &scene : scenes) {
+        std::mt19937 rng(1234);
+        DrawList list;
+        scene.record(list, rng);
+        DrawData data;
+        data.merge({&list});
+
+        double base_ms = 0;
+        for (uint32_t threads : {1u, 2u, 4u, 8u, 16u}) {
+            Rasterizer rasterizer({64, threads});
+            double ms = bench::measure_ms(
+                [&]() { rasterizer.draw(data, target); }, 10);
+            if (threads == 1) {
+                base_ms = ms;
+            }
+            const auto &stats = rasterizer.stats();
+            auto name = scene.name + " " + std::to_string(threads) + "t";
+            bench::report(name, "frame", ms, "ms");
+            bench::report(name, "setup", stats.setup_ms, "ms");
+            bench::report(name, "raster", stats.raster_ms, "ms");
+            bench::report(name, "speedup", base_ms / ms, "x");
+            bench::report(name, "bins/triangle",
+                          double(stats.bin_entries) / stats.triangles, "");
+            bench::report(name, "fill rate", kWidth * kHeight / ms / 1000,
+                          "Mpx/s");
+        }
+        bench::report(scene.name, "triangles", data.idx_list.size() / 3, "");
+    }
+    return 0;
+}
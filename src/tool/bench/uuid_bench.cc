@@ -0,0 +1,55 @@
+#include "bench.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <util/uuid.hpp>
+
+using namespace my;
+
+namespace {
+
+constexpr int kIds = 1 << 18;
+
+// what uuid_gen() did before: one generator behind a global lock
+uuid locked_uuid_gen() {
+    static std::mutex lock;
+    std::unique_lock<std::mutex> l_lock(lock);
+    static uuids::random_generator gen;
+    return gen();
+}
+
+template <typename Gen> void run(const std::string &name, int threads,
+                                 Gen gen) {
+    std::atomic<uint64_t> checksum{0};
+    auto begin = bench::clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&checksum, gen]() {
+            uint64_t sum = 0;
+            for (int i = 0; i < kIds; ++i) {
+                sum += gen().data[0];
+            }
+            checksum += sum;
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    double ms = bench::elapsed_ms(begin);
+    auto label = name + " x" + std::to_string(threads);
+    bench::report(label, "ids/s", double(kIds) * threads / ms * 1e3, "");
+    bench::report(label, "checksum", double(checksum.load()), "");
+}
+
+} // namespace
+
+int main() {
+    for (int threads : {1, 4}) {
+        run("locked boost generator", threads, locked_uuid_gen);
+        run("uuid_gen", threads, uuid_gen);
+    }
+    return 0;
+}
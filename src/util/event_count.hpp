@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <thread>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace my {
+
+/**
+ * @brief      lets threads sleep until a lock-free condition may have changed
+ *
+ * Waiters announce themselves with prepare_wait(), re-check their condition
+ * and then either cancel_wait() or wait(). notify() wakes every announced
+ * waiter and forgets them, so it is a fence and an atomic load until
+ * somebody announces again, also while the woken threads are not yet
+ * scheduled. Sleeping uses a futex on Linux.
+ */
+class EventCount {
+  public:
+    using key_type = uint32_t;
+
+    key_type prepare_wait() {
+        return _epoch(this->_state.fetch_add(1, std::memory_order_seq_cst));
+    }
+
+    void cancel_wait(key_type key) {
+        // once the epoch moved on, notify() already forgot this waiter
+        auto state = this->_state.load(std::memory_order_relaxed);
+        while (_epoch(state) == key &&
+               !this->_state.compare_exchange_weak(
+                   state, state - 1, std::memory_order_seq_cst)) {
+        }
+    }
+
+    void wait(key_type key) {
+        while (_epoch(this->_state.load(std::memory_order_acquire)) == key) {
+#ifdef __linux__
+            ::syscall(SYS_futex, this->_epoch_word(), FUTEX_WAIT_PRIVATE, key,
+                      nullptr, nullptr, 0);
+#else
+            std::this_thread::yield();
+#endif
+        }
+    }
+
+    /**
+     * @brief      wait() with a deadline
+     *
+     * @return     false when the deadline passed without a notify()
+     */
+    template <typename Clock, typename Duration>
+    bool wait_until(key_type key,
+                    const std::chrono::time_point<Clock, Duration> &deadline) {
+        while (_epoch(this->_state.load(std::memory_order_acquire)) == key) {
+            auto left = deadline - Clock::now();
+            if (left <= left.zero()) {
+                this->cancel_wait(key);
+                return false;
+            }
+#ifdef __linux__
+            auto ns =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(left);
+            timespec timeout{time_t(ns.count() / 1000000000),
+                             long(ns.count() % 1000000000)};
+            ::syscall(SYS_futex, this->_epoch_word(), FUTEX_WAIT_PRIVATE, key,
+                      &timeout, nullptr, 0);
+#else
+            std::this_thread::yield();
+#endif
+        }
+        return true;
+    }
+
+    void notify() {
+        // orders the caller's publishing store before the load of the
+        // waiters, a seq_cst load alone may be satisfied before that store
+        // is visible and miss a waiter that just saw the old condition
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto state = this->_state.load(std::memory_order_relaxed);
+        do {
+            if (_waiters(state) == 0) {
+                return;
+            }
+        } while (!this->_state.compare_exchange_weak(
+            state, (state & kEpochMask) + kEpochStep,
+            std::memory_order_seq_cst));
+#ifdef __linux__
+        ::syscall(SYS_futex, this->_epoch_word(), FUTEX_WAKE_PRIVATE, INT_MAX,
+                  nullptr, nullptr, 0);
+#endif
+    }
+
+  private:
+    static constexpr uint64_t kEpochStep = uint64_t(1) << 32;
+    static constexpr uint64_t kEpochMask = ~(kEpochStep - 1);
+
+    // epoch in the high half, number of announced waiters in the low half
+    std::atomic<uint64_t> _state{0};
+
+    static key_type _epoch(uint64_t state) { return key_type(state >> 32); }
+    static uint32_t _waiters(uint64_t state) { return uint32_t(state); }
+
+    uint32_t *_epoch_word() {
+        static_assert(sizeof(this->_state) == sizeof(uint64_t));
+        auto words = reinterpret_cast<uint32_t *>(&this->_state);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        return words + 1;
+#else
+        return words;
+#endif
+    }
+};
+
+} // namespace my
@@ -1,67 +1,318 @@
-#include <condition_variable>
-#include <queue>
-#include <shared_mutex>
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <util/event_count.hpp>
 
 namespace my {
-template <class T,
-          auto max_size =
-              std::numeric_limits<typename std::queue<T>::size_type>::max()>
-class Queue {
+
+enum class QueueKind {
+    // any number of producer and consumer threads
+    kMPMC,
+    // one producer thread and one consumer thread
+    kSPSC,
+};
+
+namespace detail {
+
+// keeps producer and consumer indices off each other's cache line
+constexpr size_t kQueueAlign = 64;
+
+template <typename T> struct QueueSlot {
+    alignas(T) unsigned char storage[sizeof(T)];
+
+    T *data() { return std::launder(reinterpret_cast<T *>(this->storage)); }
+
+    template <typename... Args> void construct(Args &&...args) {
+        new (this->storage) T(std::forward<Args>(args)...);
+    }
+
+    T take() {
+        T v(std::move(*this->data()));
+        this->data()->~T();
+        return v;
+    }
+};
+
+/**
+ * @brief      Vyukov's bounded MPMC ring, one sequence number per cell
+ */
+template <typename T, size_t capacity> class MPMCRing {
   public:
-    T &front() {
-        std::unique_lock<std::shared_mutex> l_lock(this->_lock);
-        this->_cv.wait(l_lock, [this]() { return !this->_queue.empty(); });
-        return this->_queue.front();
+    MPMCRing() {
+        for (size_t i = 0; i < capacity; ++i) {
+            this->_cells[i].seq.store(i, std::memory_order_relaxed);
+        }
     }
 
-    T &back() {
-        std::unique_lock<std::shared_mutex> l_lock(this->_lock);
-        this->_cv.wait(l_lock, [this]() { return !this->_queue.empty(); });
-        return this->_queue.back();
+    ~MPMCRing() {
+        auto head = this->_head.load(std::memory_order_relaxed);
+        for (auto pos = this->_tail.load(std::memory_order_relaxed);
+             pos != head; ++pos) {
+            this->_cells[pos % capacity].slot.take();
+        }
     }
 
-    bool empty() {
-        std::shared_lock<std::shared_mutex> l_lock(this->_lock);
-        return this->_queue.empty();
+    template <typename... Args> bool try_emplace(Args &&...args) {
+        if constexpr (std::is_nothrow_constructible_v<T, Args...>) {
+            return this->_try_construct(std::forward<Args>(args)...);
+        } else {
+            // a claimed cell must be published or consumers stop at it, so
+            // a constructor which may throw runs before the claim
+            static_assert(std::is_nothrow_move_constructible_v<T>,
+                          "queue elements must be nothrow movable");
+            return this->_try_construct(T(std::forward<Args>(args)...));
+        }
     }
 
-    void push(const T &v) {
-        std::unique_lock<std::shared_mutex> l_lock(this->_lock);
-        this->_cv.wait(l_lock,
-                       [this]() { return this->_queue.size() < max_size; });
+    bool try_pop(T &out) {
+        auto pos = this->_tail.load(std::memory_order_relaxed);
+        Cell *cell;
+        while (true) {
+            cell = &this->_cells[pos % capacity];
+            auto seq = cell->seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+            if (diff == 0) {
+                if (this->_tail.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = this->_tail.load(std::memory_order_relaxed);
+            }
+        }
+        out = cell->slot.take();
+        cell->seq.store(pos + capacity, std::memory_order_release);
+        return true;
+    }
 
-        this->_queue.push(v);
-        this->_cv.notify_one();
+    size_t size() const {
+        auto head = this->_head.load(std::memory_order_acquire);
+        auto tail = this->_tail.load(std::memory_order_acquire);
+        return head > tail ? head - tail : 0;
     }
 
-    void push(T &&v) {
-        std::unique_lock<std::shared_mutex> l_lock(this->_lock);
-        this->_cv.wait(l_lock,
-                       [this]() { return this->_queue.size() < max_size; });
+  private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        QueueSlot<T> slot;
+    };
 
-        this->_queue.push(std::move(v));
-        this->_cv.notify_one();
+    Cell _cells[capacity];
+    alignas(kQueueAlign) std::atomic<size_t> _head{0};
+    alignas(kQueueAlign) std::atomic<size_t> _tail{0};
+
+    template <typename... Args> bool _try_construct(Args &&...args) {
+        auto pos = this->_head.load(std::memory_order_relaxed);
+        Cell *cell;
+        while (true) {
+            cell = &this->_cells[pos % capacity];
+            auto seq = cell->seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+            if (diff == 0) {
+                if (this->_head.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = this->_head.load(std::memory_order_relaxed);
+            }
+        }
+        cell->slot.construct(std::forward<Args>(args)...);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
     }
+};
 
-    T pop() {
-        std::unique_lock<std::shared_mutex> l_lock(this->_lock);
-        this->_cv.wait(l_lock, [this]() { return !this->_queue.empty(); });
+/**
+ * @brief      bounded SPSC ring, each side caches the other side's index
+ */
+template <typename T, size_t capacity> class SPSCRing {
+  public:
+    ~SPSCRing() {
+        auto head = this->_head.load(std::memory_order_relaxed);
+        for (auto tail = this->_tail.load(std::memory_order_relaxed);
+             tail != head; ++tail) {
+            this->_slots[tail % capacity].take();
+        }
+    }
+
+    template <typename... Args> bool try_emplace(Args &&...args) {
+        auto head = this->_head.load(std::memory_order_relaxed);
+        if (head - this->_tail_cache == capacity) {
+            this->_tail_cache = this->_tail.load(std::memory_order_acquire);
+            if (head - this->_tail_cache == capacity) {
+                return false;
+            }
+        }
+        this->_slots[head % capacity].construct(std::forward<Args>(args)...);
+        this->_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
 
-        auto v = this->_queue.front();
-        this->_queue.pop();
-        this->_cv.notify_one();
+    bool try_pop(T &out) {
+        auto slot = this->front();
+        if (!slot) {
+            return false;
+        }
+        out = std::move(*slot);
+        slot->~T();
+        this->_tail.store(this->_tail.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief      oldest element or nullptr, consumer side only
+     */
+    T *front() {
+        auto tail = this->_tail.load(std::memory_order_relaxed);
+        if (tail == this->_head_cache) {
+            this->_head_cache = this->_head.load(std::memory_order_acquire);
+            if (tail == this->_head_cache) {
+                return nullptr;
+            }
+        }
+        return this->_slots[tail % capacity].data();
+    }
+
+    size_t size() const {
+        auto head = this->_head.load(std::memory_order_acquire);
+        auto tail = this->_tail.load(std::memory_order_acquire);
+        return head > tail ? head - tail : 0;
+    }
+
+  private:
+    QueueSlot<T> _slots[capacity];
+    // written by the producer
+    alignas(kQueueAlign) std::atomic<size_t> _head{0};
+    size_t _tail_cache{0};
+    // written by the consumer
+    alignas(kQueueAlign) std::atomic<size_t> _tail{0};
+    size_t _head_cache{0};
+};
+
+} // namespace detail
+
+/**
+ * @brief      bounded lock-free queue
+ *
+ * try_push / try_pop never block. push / pop spin briefly and then sleep
+ * on an EventCount until the other side made progress, the fast path does
+ * not touch a lock or make a syscall. Elements are moved in and out, so
+ * move-only types work. kSPSC selects a cheaper ring which additionally
+ * allows the consumer to peek with front().
+ */
+template <typename T, size_t capacity, QueueKind kind = QueueKind::kMPMC>
+class Queue {
+    static_assert(capacity > 0, "queue capacity must not be zero");
+    static_assert(std::is_default_constructible_v<T> &&
+                      std::is_move_assignable_v<T>,
+                  "queue elements are popped by move assignment");
+
+  public:
+    Queue() = default;
+    Queue(const Queue &) = delete;
+    Queue &operator=(const Queue &) = delete;
+
+    template <typename... Args> bool try_emplace(Args &&...args) {
+        if (!this->_ring.try_emplace(std::forward<Args>(args)...)) {
+            return false;
+        }
+        this->_not_empty.notify();
+        return true;
+    }
+
+    bool try_push(const T &v) { return this->try_emplace(v); }
+    bool try_push(T &&v) { return this->try_emplace(std::move(v)); }
+
+    bool try_pop(T &out) {
+        if (!this->_ring.try_pop(out)) {
+            return false;
+        }
+        this->_not_full.notify();
+        return true;
+    }
+
+    template <typename... Args> void emplace(Args &&...args) {
+        this->_wait(this->_not_full, [&]() {
+            return this->try_emplace(std::forward<Args>(args)...);
+        });
+    }
+
+    void push(const T &v) { this->emplace(v); }
+    void push(T &&v) { this->emplace(std::move(v)); }
+
+    T pop() {
+        T v;
+        this->_wait(this->_not_empty, [&]() { return this->try_pop(v); });
         return v;
     }
 
-    auto size() {
-        std::shared_lock<std::shared_mutex> l_lock(this->_lock);
-        return this->_queue.size();
+    /**
+     * @brief      oldest element, waits for one, consumer side only
+     */
+    template <QueueKind k = kind,
+              typename = std::enable_if_t<k == QueueKind::kSPSC>>
+    T &front() {
+        T *v = nullptr;
+        this->_wait(this->_not_empty,
+                    [&]() { return (v = this->_ring.front()) != nullptr; });
+        return *v;
     }
 
-  protected:
-    std::queue<T> _queue;
-    std::condition_variable_any _cv;
-    std::shared_mutex _lock;
+    /**
+     * @brief      oldest element or nullptr, consumer side only
+     */
+    template <QueueKind k = kind,
+              typename = std::enable_if_t<k == QueueKind::kSPSC>>
+    T *try_front() {
+        return this->_ring.front();
+    }
+
+    // a snapshot, other threads may change it right away
+    size_t size() const { return this->_ring.size(); }
+    bool empty() const { return this->size() == 0; }
+
+    static constexpr size_t max_size() { return capacity; }
+
+  private:
+    static constexpr int kSpin = 64;
+
+    std::conditional_t<kind == QueueKind::kSPSC,
+                       detail::SPSCRing<T, capacity>,
+                       detail::MPMCRing<T, capacity>>
+        _ring;
+    EventCount _not_empty;
+    EventCount _not_full;
+
+    template <typename Func> static void _wait(EventCount &ec, Func &&done) {
+        // spinning only helps when the other side runs on another core
+        static const int spin =
+            std::thread::hardware_concurrency() > 1 ? kSpin : 1;
+        for (int i = 0; i < spin; ++i) {
+            if (done()) {
+                return;
+            }
+        }
+        while (true) {
+            auto key = ec.prepare_wait();
+            if (done()) {
+                ec.cancel_wait(key);
+                return;
+            }
+            ec.wait(key);
+        }
+    }
 };
 
 } // namespace my
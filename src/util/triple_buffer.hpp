@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace my {
+
+/**
+ * @brief      lock-free hand-off of the latest value from one writer thread
+ *             to one reader thread
+ *
+ * The writer fills back() and publishes it, the reader acquires the latest
+ * published value into front(). The two never wait for each other: a slot
+ * in the middle is swapped with an atomic exchange, values published
+ * between two acquires are dropped but the newest one. A slot goes back to
+ * the writer only after the reader moved past it, so whatever the writer
+ * overwrites in back() is released on the writer thread.
+ */
+template <typename T> class TripleBuffer {
+  public:
+    /**
+     * @brief      the writer's slot, holds an older value until overwritten
+     */
+    T &back() { return this->_slots[this->_back]; }
+
+    /**
+     * @brief      make back() the latest value, the writer gets another slot
+     */
+    void publish() {
+        auto old = this->_middle.exchange(uint8_t(this->_back | kFresh),
+                                          std::memory_order_acq_rel);
+        this->_back = old & kIndex;
+    }
+
+    /**
+     * @brief      move front() to the latest published value
+     *
+     * @return     true if a value was published since the last acquire
+     */
+    bool acquire() {
+        if (!(this->_middle.load(std::memory_order_relaxed) & kFresh)) {
+            return false;
+        }
+        auto old = this->_middle.exchange(this->_front,
+                                          std::memory_order_acq_rel);
+        this->_front = old & kIndex;
+        return true;
+    }
+
+    /**
+     * @brief      the reader's slot, the value acquired last
+     */
+    T &front() { return this->_slots[this->_front]; }
+
+  private:
+    static constexpr uint8_t kIndex = 0x3;
+    static constexpr uint8_t kFresh = 0x4;
+
+    std::array<T, 3> _slots{};
+    // index of the middle slot, kFresh if published and not yet acquired
+    alignas(64) std::atomic<uint8_t> _middle{1};
+    // owned by the writer
+    alignas(64) uint8_t _back{0};
+    // owned by the reader
+    alignas(64) uint8_t _front{2};
+};
+
+} // namespace my
@@ -3,7 +3,8 @@
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_generators.hpp>
 #include <boost/uuid/uuid_io.hpp>
-#include <mutex>
+#include <cstring>
+#include <random>
 
 namespace my {
 
@@ -13,11 +14,65 @@ namespace uuids {
 using namespace boost::uuids;
 }
 
+namespace detail {
+
+/**
+ * @brief      xoshiro256**, seeded with 256 bits of system entropy
+ */
+class UuidEngine {
+  public:
+    UuidEngine() {
+        std::random_device rd;
+        for (auto &s : this->_s) {
+            s = (uint64_t(rd()) << 32) | rd();
+        }
+        if (!(this->_s[0] | this->_s[1] | this->_s[2] | this->_s[3])) {
+            // the all zero state only ever yields zeros
+            this->_s[0] = 1;
+        }
+    }
+
+    uint64_t operator()() {
+        auto &s = this->_s;
+        auto result = rotl(s[1] * 5, 7) * 9;
+        auto t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+  private:
+    uint64_t _s[4];
+
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+};
+
+} // namespace detail
+
+/**
+ * @brief      random (version 4) uuid
+ *
+ * Every thread draws from an own generator, so creating ids never
+ * contends. Generators are seeded independently from the system entropy
+ * source, the chance of two threads colliding is that of two random
+ * uuids.
+ */
 inline uuid uuid_gen() {
-    static std::mutex lock;
-    std::unique_lock<std::mutex> l_lock(lock);
-    static uuids::random_generator gen;
-    return gen();
+    thread_local detail::UuidEngine engine;
+    uint64_t bits[2] = {engine(), engine()};
+    uuid id;
+    static_assert(sizeof(id.data) == sizeof(bits));
+    std::memcpy(id.data, bits, sizeof(bits));
+    // version 4, variant 1 as boost::uuids::random_generator sets them
+    id.data[6] = (id.data[6] & 0x0f) | 0x40;
+    id.data[8] = (id.data[8] & 0x3f) | 0x80;
+    return id;
 }
 
 } // namespace my
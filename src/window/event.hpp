@@ -17,15 +17,14 @@ namespace my {
 //     WindowEvent(WidnowPtr win) : win(win) {}
 // };
 
-// struct MouseMotionEvent : public WindowEvent {
-//     IPoint2D pos;
-//     ISize2D rel;
-//     uint32_t state;
+struct MouseMotionEvent : public GetWindowPtr {
+    IPoint2D pos;
+    ISize2D rel;
+    uint32_t state;
 
-//     MouseMotionEvent(WidnowPtr win, IPoint2D pos, ISize2D rel, uint32_t
-//     state)
-//         : WindowEvent(win), pos(pos), rel(rel), state(state) {}
-// };
+    MouseMotionEvent(WindowPtr win, IPoint2D pos, ISize2D rel, uint32_t state)
+        : GetWindowPtr(win), pos(pos), rel(rel), state(state) {}
+};
 
 // struct MoushWheelEvent : public WindowEvent {
 //     IPoint2D pos;
@@ -85,6 +84,13 @@ MouseButtonEvent::make_translate(IPoint2D translate) {
         this->shared_from_this(), translate);
 }
 
+/**
+ * @brief      the events of one window from one input poll, in order
+ */
+struct WindowEventBatch {
+    std::vector<shared_ptr<IEvent>> events;
+};
+
 // struct WindowStateEvent : public WindowEvent {
 
 //     enum event_type {
@@ -0,0 +1,417 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+
+#include <window/event.hpp>
+#include <window/headless/input_script.hpp>
+#include <window/window_service.hpp>
+
+namespace my {
+
+struct HeadlessMouseButtonEvent : public MouseButtonEvent {
+    HeadlessMouseButtonEvent(WindowPtr ptr, HeadlessInput const &input)
+        : MouseButtonEvent(ptr), _input(input) {}
+
+    ButtonType button_type() override {
+        switch (this->_input.button) {
+        case HeadlessInput::kLeft:
+            return MouseButtonEvent::kLeft;
+        case HeadlessInput::kMiddle:
+            return MouseButtonEvent::kMiddle;
+        case HeadlessInput::kRight:
+            return MouseButtonEvent::kRight;
+        }
+        throw WindowServiceError("unknown button type");
+    }
+    ButtonState button_state() override {
+        return this->_input.type == HeadlessInput::kMouseDown
+                   ? MouseButtonEvent::kPressed
+                   : MouseButtonEvent::kReleased;
+    }
+
+    uint8_t clicks() override { return 1; }
+    IPoint2D pos() override { return this->_input.pos; }
+
+  private:
+    HeadlessInput _input;
+};
+
+/**
+ * @brief      a window in memory, its frame buffer is a pixel array
+ *
+ * Sizes behave like a desktop window's, clamped to the min and max size,
+ * at a scale of 1. A render service draws into the frame buffer with
+ * with_frame_buffer() and calls present(), tests and benchmarks read the
+ * pixels the same way or wait for presents. A resize reallocates the frame
+ * buffer cleared and calls the on_resize() listener. Thread-safe.
+ */
+class HeadlessWindow : public Window,
+                       public std::enable_shared_from_this<HeadlessWindow> {
+  public:
+    /**
+     * @brief      32-bit pixels, in Skia's N32 order, rows without padding
+     */
+    struct FrameBuffer {
+        std::vector<uint32_t> pixels;
+        ISize2D size{0, 0};
+    };
+
+    HeadlessWindow(WindowID id, const ISize2D &size) : _win_id(id) {
+        this->size(size);
+    }
+
+    ISize2D frame_buffer_size() override { return this->size(); }
+    void frame_buffer_size(const ISize2D &size) override { this->size(size); }
+
+    ISize2D min_size() override {
+        std::unique_lock<std::mutex> l_lock(this->_lock);
+        return this->_min_size;
+    }
+    void min_size(const ISize2D &size) override {
+        bool resized;
+        {
+            std::unique_lock<std::mutex> l_lock(this->_lock);
+            this->_min_size = size;
+            resized = this->_resize(this->_size);
+        }
+        if (resized) {
+            this->_notify_resize();
+        }
+    }
+
+    ISize2D max_size() override {
+        std::unique_lock<std::mutex> l_lock(this->_lock);
+        return this->_max_size;
+    }
+    void max_size(const ISize2D &size) override {
+        bool resized;
+        {
+            std::unique_lock<std::mutex> l_lock(this->_lock);
+            this->_max_size = size;
+            resized = this->_resize(this->_size);
+        }
+        if (resized) {
+            this->_notify_resize();
+        }
+    }
+
+    ISize2D size() override {
+        std::unique_lock<std::mutex> l_lock(this->_lock);
+        return this->_size;
+    }
+    void size(const ISize2D &size) override {
+        bool resized;
+        {
+            std::unique_lock<std::mutex> l_lock(this->_lock);
+            resized = this->_resize(size);
+        }
+        if (resized) {
+            this->_notify_resize();
+        }
+    }
+
+    IPoint2D pos() override {
+        std::unique_lock<std::mutex> l_lock(this->_lock);
+        return this->_pos;
+    }
+    void pos(const IPoint2D &pos) override {
+        std::unique_lock<std::mutex> l_lock(this->_lock);
+        this->_pos = pos;
+    }
+
+    void full_screen(bool full_screen) override {
+        this->_full_screen = full_screen;
+    }
+
+    WindowID window_id() override { return this->_win_id; }
+
+    void hide() override { this->visible(false); };
+    void show() override { this->visible(true); }
+
+    void visible(bool visible) override { this->_is_visible = visible; }
+    bool visible() override { return this->_is_visible; }
+
+    void show_cursor() override {}
+    void hide_cursor() override {}
+
+    void mouse_pos(const IPoint2D &pos) override {
+        std::unique_lock<std::mutex> l_lock(this->_lock);
+        this->_mouse_pos = pos;
+    }
+
+    /**
+     * @brief      call func(FrameBuffer &) with the frame buffer locked, it
+     *             keeps its size meanwhile
+     */
+    template <typename Func> decltype(auto) with_frame_buffer(Func &&func) {
+        std::unique_lock<std::mutex> l_lock(this->_lock);
+        return func(this->_frame_buffer);
+    }
+
+    /**
+     * @brief      call func on the resizing thread after the frame buffer
+     *             changed its size, e.g. to draw a frame at the new size,
+     *             an empty func removes the listener
+     *
+     * Once this returns the previous listener is no longer running.
+     */
+    void on_resize(std::function<void()> func) {
+        std::unique_lock<std::mutex> l_lock(this->_listener_lock);
+        this->_on_resize = std::move(func);
+    }
+
+    /**
+     * @brief      a frame was drawn into the frame buffer
+     */
+    void present() {
+        {
+            std::unique_lock<std::mutex> l_lock(this->_lock);
+            ++this->_presents;
+        }
+        this->_presented.notify_all();
+    }
+
+    uint64_t presents() {
+        std::unique_lock<std::mutex> l_lock(this->_lock);
+        return this->_presents;
+    }
+
+    /**
+     * @brief      block until count frames were presented in all
+     */
+    void wait_presents(uint64_t count) {
+        std::unique_lock<std::mutex> l_lock(this->_lock);
+        this->_presented.wait(
+            l_lock, [this, count]() { return this->_presents >= count; });
+    }
+
+    Observable::observable_type event_source() override {
+        return this->_event_source;
+    }
+
+    void subscribe(Observable *o) override {
+        // the window owns the stream, holding itself there would leak it
+        std::weak_ptr<HeadlessWindow> weak = this->shared_from_this();
+        this->_event_source =
+            on_event<HeadlessInput>(o)
+                .filter([weak](auto e) {
+                    auto self = weak.lock();
+                    return self && (*e)->window == self->window_id();
+                })
+                .map([weak](auto e) {
+                    std::shared_ptr<IEvent> event =
+                        Event<HeadlessMouseButtonEvent>::make(weak.lock(),
+                                                              *e->data())
+                            ->template cast_to<MouseButtonEvent>();
+                    return event;
+                });
+    }
+
+  private:
+    WindowID _win_id{};
+    std::atomic<bool> _is_visible{true};
+    std::atomic<bool> _full_screen{false};
+
+    std::mutex _lock;
+    std::condition_variable _presented;
+    ISize2D _size{0, 0};
+    ISize2D _min_size{0, 0};
+    ISize2D _max_size{0, 0};
+    IPoint2D _pos{0, 0};
+    IPoint2D _mouse_pos{0, 0};
+    FrameBuffer _frame_buffer;
+    uint64_t _presents{0};
+
+    observable_type _event_source;
+
+    // held while calling _on_resize, not _lock as it may read the window
+    std::mutex _listener_lock;
+    std::function<void()> _on_resize;
+
+    void _notify_resize() {
+        std::unique_lock<std::mutex> l_lock(this->_listener_lock);
+        if (this->_on_resize) {
+            this->_on_resize();
+        }
+    }
+
+    // a max size of 0 is no limit, as in SDL, true if the frame buffer
+    // was reallocated
+    bool _resize(const ISize2D &size) {
+        auto clamp = [](int32_t v, int32_t min, int32_t max) {
+            v = std::max(v, min);
+            return max > 0 ? std::min(v, max) : v;
+        };
+        this->_size = ISize2D::Make(
+            clamp(size.width(), this->_min_size.width(),
+                  this->_max_size.width()),
+            clamp(size.height(), this->_min_size.height(),
+                  this->_max_size.height()));
+        if (this->_frame_buffer.size != this->_size) {
+            this->_frame_buffer.size = this->_size;
+            this->_frame_buffer.pixels.assign(
+                size_t(std::max(0, this->_size.width())) *
+                    size_t(std::max(0, this->_size.height())),
+                0);
+            return true;
+        }
+        return false;
+    }
+};
+
+/**
+ * @brief      windows in memory with input from scripts, for benchmarks and
+ *             soak tests without a display
+ *
+ * Injected mouse input reaches the bus like platform input, as
+ * MouseButtonEvents of the target window; resizes are applied to the
+ * window and quit posts a QuitEvent. Windows are drawn by the headless
+ * render backend, see RenderService::make().
+ */
+class HeadlessWindowService : public WindowService {
+  public:
+    explicit HeadlessWindowService(const DisplayMode &mode) : _mode(mode) {
+        pthread_setname_np(this->coordination().get_thread_info().handle,
+                           "window service");
+    }
+
+    observable_type event_source() override {
+        return this->_event_source.get_observable();
+    }
+
+    void subscribe(MY_UNUSED Observable *o) override {}
+
+    future<std::shared_ptr<Window>>
+    create_window(MY_UNUSED const std::string &title,
+                  const ISize2D &size) override {
+        return this->schedule<shared_ptr<Window>>([this, size]() {
+            auto win = std::make_shared<HeadlessWindow>(++this->_last_id, size);
+            win->subscribe(this);
+            this->_windows[win->window_id()] = win;
+            return win;
+        });
+    }
+
+    future<DisplayMode> display_mode() override {
+        return this->schedule<DisplayMode>([this]() { return this->_mode; });
+    }
+
+    // nothing to coalesce, input arrives as scripted
+    future<void> input_options(MY_UNUSED const InputOptions &options) override {
+        return this->schedule<void>([]() {});
+    }
+
+    InputStats input_stats() override {
+        auto injected = this->_injected.load();
+        return {injected, injected, 0};
+    }
+
+    /**
+     * @brief      inject input now, from any thread
+     */
+    future<void> inject(const HeadlessInput &input) {
+        return this->schedule<void>([this, input]() { this->_inject(input); });
+    }
+
+    /**
+     * @brief      inject the inputs of script after their delays, timed on
+     *             the service thread
+     *
+     * @return     ready once the last input was injected
+     */
+    future<void> play(InputScript script) {
+        auto done = std::make_shared<promise<void>>();
+        auto f = done->get_future();
+        this->schedule<void>(
+            [this, script = std::make_shared<InputScript>(std::move(script)),
+             done]() {
+                auto const &inputs = script->inputs;
+                if (inputs.empty()) {
+                    done->set_value();
+                } else if (inputs[0].delay.count() > 0) {
+                    this->_after(inputs[0].delay, [this, script, done]() {
+                        this->_play(script, 0, done);
+                    });
+                } else {
+                    this->_play(script, 0, done);
+                }
+            });
+        return f;
+    }
+
+  private:
+    DisplayMode _mode;
+    subject_dynamic_event_type _event_source;
+
+    // only touched on the service thread
+    WindowID _last_id{0};
+    std::map<WindowID, std::weak_ptr<HeadlessWindow>> _windows;
+
+    std::atomic<uint64_t> _injected{0};
+
+    template <typename Func>
+    void _after(std::chrono::milliseconds delay, Func &&func) {
+        auto worker = this->coordination().coordinator().get_worker();
+        worker.schedule(worker.now() + delay,
+                        [func = std::forward<Func>(func)](auto) { func(); });
+    }
+
+    void _play(shared_ptr<InputScript> const &script, size_t i,
+               shared_ptr<promise<void>> const &done) {
+        auto const &inputs = script->inputs;
+        try {
+            while (i < inputs.size()) {
+                this->_inject(inputs[i]);
+                ++i;
+                if (i < inputs.size() && inputs[i].delay.count() > 0) {
+                    this->_after(inputs[i].delay, [this, script, i, done]() {
+                        this->_play(script, i, done);
+                    });
+                    return;
+                }
+            }
+            done->set_value();
+        } catch (...) {
+            done->set_exception(std::current_exception());
+        }
+    }
+
+    void _inject(HeadlessInput input) {
+        MY_PROFILE_ZONE_C("window", "HeadlessWindowService::inject");
+        ++this->_injected;
+        if (input.type == HeadlessInput::kQuit) {
+            this->_emit(Event<QuitEvent>::make());
+            return;
+        }
+
+        auto it = input.window ? this->_windows.find(input.window)
+                               : this->_windows.begin();
+        auto win = it != this->_windows.end() ? it->second.lock() : nullptr;
+        if (!win) {
+            throw WindowServiceError("no headless window " +
+                                     std::to_string(input.window));
+        }
+        input.window = win->window_id();
+
+        if (input.type == HeadlessInput::kResize) {
+            win->size(input.size);
+        } else {
+            win->mouse_pos(input.pos);
+            this->_emit(Event<HeadlessInput>::make(input));
+        }
+    }
+
+    void _emit(shared_ptr<IEvent> e) {
+        this->_event_source.get_subscriber().on_next(e);
+    }
+};
+
+inline std::unique_ptr<WindowService>
+WindowService::create_headless(const DisplayMode &mode) {
+    return std::make_unique<HeadlessWindowService>(mode);
+}
+
+} // namespace my
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <chrono>
+#include <istream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <window/exception.hpp>
+#include <window/type.hpp>
+
+namespace my {
+
+/**
+ * @brief      one input injected into a headless window
+ */
+struct HeadlessInput {
+    enum Type { kMouseDown, kMouseUp, kResize, kQuit };
+    enum Button { kLeft, kMiddle, kRight };
+
+    Type type{kMouseDown};
+    // 0 for the first window created
+    uint32_t window{0};
+    IPoint2D pos{0, 0};
+    Button button{kLeft};
+    // kResize only
+    ISize2D size{0, 0};
+    // waited before the input
+    std::chrono::milliseconds delay{0};
+};
+
+/**
+ * @brief      inputs played in order by HeadlessWindowService::play()
+ *
+ * The text form has one command per line, # starts a comment:
+ *
+ *     wait <ms>                   delay the next input
+ *     down|up|click <x> <y> [left|middle|right]
+ *     resize <w> <h>
+ *     window <id>                 target of the following inputs
+ *     repeat <n>                  play the inputs so far n times in all
+ *     quit
+ */
+struct InputScript {
+    std::vector<HeadlessInput> inputs;
+
+    /**
+     * @throw      WindowServiceError naming the line that does not parse
+     */
+    static InputScript parse(std::istream &is) {
+        InputScript script;
+        HeadlessInput next;
+        std::string line;
+        for (int number = 1; std::getline(is, line); ++number) {
+            line = line.substr(0, line.find('#'));
+            std::istringstream words(line);
+            std::string command;
+            if (!(words >> command)) {
+                continue;
+            }
+
+            auto fail = [&]() {
+                return WindowServiceError("input script line " +
+                                          std::to_string(number) + ": " +
+                                          line);
+            };
+            auto done = [&words]() {
+                std::string rest;
+                return !(words >> rest);
+            };
+
+            if (command == "wait") {
+                int64_t ms;
+                if (!(words >> ms) || ms < 0 || !done()) {
+                    throw fail();
+                }
+                next.delay += std::chrono::milliseconds(ms);
+            } else if (command == "down" || command == "up" ||
+                       command == "click") {
+                int32_t x, y;
+                if (!(words >> x >> y)) {
+                    throw fail();
+                }
+                next.pos = IPoint2D::Make(x, y);
+                next.button = HeadlessInput::kLeft;
+                std::string button;
+                if (words >> button) {
+                    if (button == "left") {
+                        next.button = HeadlessInput::kLeft;
+                    } else if (button == "middle") {
+                        next.button = HeadlessInput::kMiddle;
+                    } else if (button == "right") {
+                        next.button = HeadlessInput::kRight;
+                    } else {
+                        throw fail();
+                    }
+                }
+                if (!done()) {
+                    throw fail();
+                }
+                next.type = command == "up" ? HeadlessInput::kMouseUp
+                                            : HeadlessInput::kMouseDown;
+                script._push(next);
+                if (command == "click") {
+                    next.type = HeadlessInput::kMouseUp;
+                    script._push(next);
+                }
+            } else if (command == "resize") {
+                int32_t w, h;
+                if (!(words >> w >> h) || w <= 0 || h <= 0 || !done()) {
+                    throw fail();
+                }
+                next.type = HeadlessInput::kResize;
+                next.size = ISize2D::Make(w, h);
+                script._push(next);
+            } else if (command == "window") {
+                if (!(words >> next.window) || !done()) {
+                    throw fail();
+                }
+            } else if (command == "repeat") {
+                int n;
+                if (!(words >> n) || n < 1 || !done()) {
+                    throw fail();
+                }
+                auto once = script.inputs;
+                for (int i = 1; i < n; ++i) {
+                    script.inputs.insert(script.inputs.end(), once.begin(),
+                                         once.end());
+                }
+            } else if (command == "quit") {
+                if (!done()) {
+                    throw fail();
+                }
+                next.type = HeadlessInput::kQuit;
+                script._push(next);
+            } else {
+                throw fail();
+            }
+        }
+        return script;
+    }
+
+  private:
+    // the delay applies to one input only
+    void _push(HeadlessInput &input) {
+        this->inputs.push_back(input);
+        input.delay = std::chrono::milliseconds(0);
+    }
+};
+
+} // namespace my
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <vector>
+
+#include <SDL2/SDL.h>
+
+namespace my {
+
+/**
+ * @brief      merges high rate SDL input events of one poll
+ *
+ * Within a run of consecutive events of the same kind, motion events of
+ * the same window and mouse collapse into the latest position with the
+ * summed relative motion, and wheel events of the same window, mouse and
+ * direction into the summed delta. Any other event ends the run, so the
+ * order between different kinds of events is kept.
+ */
+class SDLEventCoalescer {
+  public:
+    struct Options {
+        bool motion{true};
+        bool wheel{true};
+    };
+
+    struct Stats {
+        // events pushed
+        uint64_t raw{};
+        // events handed out by flush()
+        uint64_t delivered{};
+    };
+
+    SDLEventCoalescer() : SDLEventCoalescer(Options{}) {}
+    explicit SDLEventCoalescer(const Options &options) : _options(options) {}
+
+    const Options &options() const { return this->_options; }
+    void options(const Options &options) { this->_options = options; }
+
+    const Stats &stats() const { return this->_stats; }
+
+    void push(const SDL_Event &e) {
+        ++this->_stats.raw;
+        if (e.type != this->_run_type) {
+            this->_run.clear();
+            this->_run_type = this->_coalesced(e.type) ? e.type : 0;
+        }
+        if (this->_run_type) {
+            for (auto i : this->_run) {
+                if (this->_merge(this->_events[i], e)) {
+                    return;
+                }
+            }
+            this->_run.push_back(this->_events.size());
+        }
+        this->_events.push_back(e);
+    }
+
+    /**
+     * @brief      move the coalesced events into out and start a new poll
+     */
+    void flush(std::vector<SDL_Event> &out) {
+        this->_stats.delivered += this->_events.size();
+        out.swap(this->_events);
+        this->_events.clear();
+        this->_run.clear();
+        this->_run_type = 0;
+    }
+
+    size_t size() const { return this->_events.size(); }
+
+  private:
+    Options _options;
+    Stats _stats;
+    std::vector<SDL_Event> _events;
+    // indices of the coalescable events of the current run
+    std::vector<size_t> _run;
+    Uint32 _run_type{0};
+
+    bool _coalesced(Uint32 type) const {
+        return (type == SDL_MOUSEMOTION && this->_options.motion) ||
+               (type == SDL_MOUSEWHEEL && this->_options.wheel);
+    }
+
+    static bool _merge(SDL_Event &dst, const SDL_Event &src) {
+        if (src.type == SDL_MOUSEMOTION) {
+            auto &d = dst.motion;
+            const auto &s = src.motion;
+            if (d.windowID != s.windowID || d.which != s.which) {
+                return false;
+            }
+            d.timestamp = s.timestamp;
+            d.state = s.state;
+            d.x = s.x;
+            d.y = s.y;
+            d.xrel += s.xrel;
+            d.yrel += s.yrel;
+            return true;
+        }
+
+        auto &d = dst.wheel;
+        const auto &s = src.wheel;
+        if (d.windowID != s.windowID || d.which != s.which ||
+            d.direction != s.direction) {
+            return false;
+        }
+        d.timestamp = s.timestamp;
+        d.x += s.x;
+        d.y += s.y;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        d.preciseX += s.preciseX;
+        d.preciseY += s.preciseY;
+#endif
+        return true;
+    }
+};
+
+} // namespace my
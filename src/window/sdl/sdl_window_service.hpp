@@ -1,6 +1,8 @@
 #pragma once
 
+#include <core/profiler.hpp>
 #include <window/sdl/sdl_event.hpp>
+#include <window/sdl/sdl_event_coalescer.hpp>
 #include <window/window_service.hpp>
 
 namespace my {
@@ -9,6 +11,21 @@ struct SDLEvent {
     SDL_Event e;
 };
 
+/**
+ * @brief      every event of one poll, posted instead of single SDLEvents
+ *             when InputOptions::batch is set
+ */
+struct SDLEventBatch {
+    std::vector<SDL_Event> events;
+
+    std::vector<SDL_Event>::const_iterator begin() const {
+        return this->events.begin();
+    }
+    std::vector<SDL_Event>::const_iterator end() const {
+        return this->events.end();
+    }
+};
+
 class SDLWindow : public Window,
                   public std::enable_shared_from_this<SDLWindow> {
   public:
@@ -102,57 +119,31 @@ class SDLWindow : public Window,
     }
 
     void subscribe(Observable *o) override {
-        this->_event_source =
+        // the source is kept by this window, a strong self would leak it
+        std::weak_ptr<SDLWindow> weak = this->shared_from_this();
+        auto convert = [weak](const SDL_Event &sdl_event) {
+            auto self = weak.lock();
+            return self ? self->_convert(sdl_event) : nullptr;
+        };
+        auto single =
             on_event<SDLEvent>(o)
-                .map([self = this->shared_from_this()](auto e) {
-                    SDL_Event &sdl_event = (*e)->e;
-                    std::shared_ptr<IEvent> event;
-                    WindowID id;
-                    switch (sdl_event.type) {
-                    // case SDL_MOUSEMOTION:
-                    //     id = sdl_event.motion.windowID;
-                    //     event = Event<MouseMotionEvent>::make(
-                    //         self,
-                    //         IPoint2D::Make(sdl_event.motion.x,
-                    //                        sdl_event.motion.y),
-                    //         ISize2D::Make(sdl_event.motion.xrel,
-                    //                       sdl_event.motion.yrel),
-                    //         sdl_event.motion.state);
-                    //     break;
-                    // case SDL_MOUSEWHEEL:
-                    //     id = sdl_event.wheel.windowID;
-                    //     event = Event<MoushWheelEvent>::make(
-                    //         self,
-                    //         IPoint2D{sdl_event.wheel.x, sdl_event.wheel.y},
-                    //         sdl_event.wheel.which,
-                    //         sdl_event.wheel.direction);
-                    //     break;
-                    // case SDL_KEYUP:
-                    // case SDL_KEYDOWN:
-                    //     id = sdl_event.key.windowID;
-                    //     event = Event<KeyboardEvent>::make(
-                    //         self, sdl_event.key.state,
-                    //         sdl_event.key.repeat != 0, sdl_event.key.keysym);
-                    //     break;
-                    // case SDL_WINDOWEVENT:
-                    //     id = sdl_event.window.windowID;
-                    //     event = Event<WindowStateEvent>::make(
-                    //         self, sdl_event.window.event);
-                    //     break;
-                    case SDL_MOUSEBUTTONDOWN:
-                    case SDL_MOUSEBUTTONUP:
-                        id = sdl_event.button.windowID;
-                        event = Event<SDLMouseButtonEvent>::make(
-                                    self, sdl_event.button)
-                                    ->cast_to<MouseButtonEvent>();
-                        break;
+                .map([convert](auto e) { return convert((*e)->e); })
+                .filter([](const auto &event) { return event != nullptr; });
+        // one emission per poll, with the events of this window only
+        auto batched =
+            on_event<SDLEventBatch>(o)
+                .map([convert](auto batch) {
+                    auto window_batch = Event<WindowEventBatch>::make();
+                    for (const auto &sdl_event : (*batch)->events) {
+                        if (auto event = convert(sdl_event)) {
+                            (*window_batch)->events.push_back(event);
+                        }
                     }
-                    return std::make_pair(id, event);
-                })
-                .filter([self = this->shared_from_this()](auto event) {
-                    return event.first == self->window_id();
+                    return window_batch;
                 })
-                .map([](auto e) { return e.second; });
+                .filter([](auto batch) { return !(*batch)->events.empty(); })
+                .map([](auto batch) { return batch->as_dynamic(); });
+        this->_event_source = single.merge(batched);
     }
 
   private:
@@ -162,8 +153,67 @@ class SDLWindow : public Window,
     bool _is_visible{true};
 
     observable_type _event_source;
+
+    /**
+     * @brief      the window event of sdl_event, null when it is for
+     *             another window or not mapped
+     */
+    shared_ptr<IEvent> _convert(const SDL_Event &sdl_event) {
+        shared_ptr<IEvent> event;
+        WindowID id{};
+        switch (sdl_event.type) {
+        case SDL_MOUSEMOTION:
+            id = sdl_event.motion.windowID;
+            event = Event<MouseMotionEvent>::make(
+                this->shared_from_this(),
+                IPoint2D::Make(sdl_event.motion.x, sdl_event.motion.y),
+                ISize2D::Make(sdl_event.motion.xrel, sdl_event.motion.yrel),
+                sdl_event.motion.state);
+            break;
+        // case SDL_MOUSEWHEEL:
+        //     id = sdl_event.wheel.windowID;
+        //     event = Event<MoushWheelEvent>::make(
+        //         self,
+        //         IPoint2D{sdl_event.wheel.x, sdl_event.wheel.y},
+        //         sdl_event.wheel.which,
+        //         sdl_event.wheel.direction);
+        //     break;
+        // case SDL_KEYUP:
+        // case SDL_KEYDOWN:
+        //     id = sdl_event.key.windowID;
+        //     event = Event<KeyboardEvent>::make(
+        //         self, sdl_event.key.state,
+        //         sdl_event.key.repeat != 0, sdl_event.key.keysym);
+        //     break;
+        // case SDL_WINDOWEVENT:
+        //     id = sdl_event.window.windowID;
+        //     event = Event<WindowStateEvent>::make(
+        //         self, sdl_event.window.event);
+        //     break;
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+            id = sdl_event.button.windowID;
+            event = Event<SDLMouseButtonEvent>::make(this->shared_from_this(),
+                                                     sdl_event.button)
+                        ->cast_to<MouseButtonEvent>();
+            break;
+        }
+        if (id != this->_win_id) {
+            return nullptr;
+        }
+        return event;
+    }
 };
 
+/**
+ * @brief      SDL windows and input, polled once per frame
+ *
+ * Mouse motion, the highest rate input, goes through EventBus::dispatch
+ * once the service is subscribed to a bus: it never enters the rx event
+ * source, handlers registered with on_dispatch<MouseMotionEvent>() get it
+ * on the service thread without an allocation. Without a bus, and for all
+ * other input, windows post rx events as before.
+ */
 class SDLWindowService : public WindowService {
     using base_type = WindowService;
 
@@ -181,21 +231,34 @@ class SDLWindowService : public WindowService {
         return this->_event_source.get_observable();
     }
 
-    void subscribe(MY_UNUSED Observable *o) override {
-        // source->event_source();
+    /**
+     * @brief      o is the application's bus: mouse motion is dispatched
+     *             on its typed channel from now on
+     */
+    void subscribe(Observable *o) override {
+        this->_bus.store(dynamic_cast<EventBus *>(o),
+                         std::memory_order_release);
     }
 
     future<std::shared_ptr<Window>>
     create_window(const std::string &title, const ISize2D &size) override {
         return this->schedule<shared_ptr<Window>>([&]() {
             auto [w, h] = size;
+            Uint32 flags = SDL_WINDOW_UTILITY | SDL_WINDOW_ALLOW_HIGHDPI |
+                           SDL_WINDOW_RESIZABLE;
             SDL_Window *sdl_win =
                 SDL_CreateWindow(title.c_str(), SDL_WINDOWPOS_UNDEFINED,
                                  SDL_WINDOWPOS_UNDEFINED, w, h,
-                                 SDL_WINDOW_UTILITY | SDL_WINDOW_ALLOW_HIGHDPI |
-                                     SDL_WINDOW_RESIZABLE | SDL_WINDOW_OPENGL
+                                 flags | SDL_WINDOW_OPENGL
                                  // | SDL_WINDOW_VULKAN
                 );
+            // drivers without GL, e.g. offscreen, still get a window for
+            // raster rendering
+            if (sdl_win == nullptr) {
+                sdl_win = SDL_CreateWindow(title.c_str(),
+                                           SDL_WINDOWPOS_UNDEFINED,
+                                           SDL_WINDOWPOS_UNDEFINED, w, h, flags);
+            }
 
             if (sdl_win == nullptr) {
                 throw WindowServiceError(SDL_GetError());
@@ -203,6 +266,7 @@ class SDLWindowService : public WindowService {
 
             auto win = std::make_shared<SDLWindow>(sdl_win);
             win->subscribe(this);
+            this->_windows[win->window_id()] = win;
             return win;
         });
     }
@@ -218,6 +282,19 @@ class SDLWindowService : public WindowService {
         });
     }
 
+    future<void> input_options(const InputOptions &options) override {
+        return this->schedule<void>([this, options]() {
+            this->_coalescer.options(
+                {options.coalesce_motion, options.coalesce_wheel});
+            this->_batch = options.batch;
+        });
+    }
+
+    InputStats input_stats() override {
+        return {this->_raw_events.load(), this->_delivered_events.load(),
+                this->_batches.load()};
+    }
+
     // future<Keymod> key_mod() override {
     //     return this->schedule<Keymod>(
     //         []() { return static_cast<Keymod>(SDL_GetModState()); });
@@ -233,30 +310,91 @@ class SDLWindowService : public WindowService {
   private:
     subject_dynamic_event_type _event_source;
 
+    std::atomic<EventBus *> _bus{nullptr};
+
+    // only touched on the service thread
+    std::map<WindowID, std::weak_ptr<SDLWindow>> _windows;
+    SDLEventCoalescer _coalescer{SDLEventCoalescer::Options{false, false}};
+    bool _batch{false};
+    std::vector<SDL_Event> _polled;
+
+    std::atomic<uint64_t> _raw_events{0};
+    std::atomic<uint64_t> _delivered_events{0};
+    std::atomic<uint64_t> _batches{0};
+
+    /**
+     * @brief      one poll per frame of the desktop's refresh rate
+     */
+    static std::chrono::microseconds poll_interval() {
+        SDL_DisplayMode mode;
+        int refresh_rate = 60;
+        if (SDL_GetDesktopDisplayMode(0, &mode) == 0 && mode.refresh_rate > 0) {
+            refresh_rate = mode.refresh_rate;
+        }
+        return std::chrono::microseconds(1000000 / refresh_rate);
+    }
+
     void init_event_source() {
-        rxcpp::observable<>::interval(std::chrono::milliseconds(100),
+        rxcpp::observable<>::interval(poll_interval(),
                                       this->coordination().get())
-            .flat_map([](auto) {
-                std::vector<shared_ptr<IEvent>> v;
-                while (true) {
-                    auto e = Event<SDLEvent>::make();
-                    if (SDL_PollEvent(&(*e)->e)) {
-                        switch ((*e)->e.type) {
-                        case SDL_QUIT:
-                            v.push_back(Event<QuitEvent>::make());
-                            break;
-                        default:
-                            v.push_back(e);
-                            break;
-                        }
-                    } else {
-                        break;
-                    }
-                }
-                return rx::observable<>::iterate(v);
-            })
-            .multicast(this->_event_source)
-            .connect();
+            .subscribe([this](auto) { this->_poll(); });
+    }
+
+    void _poll() {
+        MY_PROFILE_ZONE_C("window", "SDLWindowService::poll");
+        bool quit = false;
+        SDL_Event sdl_event;
+        while (SDL_PollEvent(&sdl_event)) {
+            if (sdl_event.type == SDL_QUIT) {
+                quit = true;
+            } else {
+                this->_coalescer.push(sdl_event);
+            }
+        }
+        this->_coalescer.flush(this->_polled);
+        this->_raw_events = this->_coalescer.stats().raw;
+        this->_delivered_events = this->_coalescer.stats().delivered;
+
+        auto subscriber = this->_event_source.get_subscriber();
+        auto bus = this->_bus.load(std::memory_order_acquire);
+        std::shared_ptr<Event<SDLEventBatch>> batch;
+        if (this->_batch) {
+            batch = Event<SDLEventBatch>::make();
+        }
+        for (const auto &polled : this->_polled) {
+            if (bus && polled.type == SDL_MOUSEMOTION) {
+                this->_dispatch_motion(bus, polled.motion);
+            } else if (batch) {
+                (*batch)->events.push_back(polled);
+            } else {
+                auto e = Event<SDLEvent>::make();
+                (*e)->e = polled;
+                subscriber.on_next(e);
+            }
+        }
+        this->_polled.clear();
+        if (batch && !(*batch)->events.empty()) {
+            subscriber.on_next(batch);
+            ++this->_batches;
+        }
+        if (quit) {
+            subscriber.on_next(Event<QuitEvent>::make());
+        }
+    }
+
+    void _dispatch_motion(EventBus *bus, const SDL_MouseMotionEvent &motion) {
+        auto it = this->_windows.find(motion.windowID);
+        if (it == this->_windows.end()) {
+            return;
+        }
+        auto win = it->second.lock();
+        if (!win) {
+            this->_windows.erase(it);
+            return;
+        }
+        bus->dispatch<MouseMotionEvent>(
+            win, IPoint2D::Make(motion.x, motion.y),
+            ISize2D::Make(motion.xrel, motion.yrel), motion.state);
     }
 };
 std::unique_ptr<WindowService> WindowService::create() {
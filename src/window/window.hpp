@@ -6,3 +6,4 @@
 #include <window/event.hpp>
 #include <window/window_service.hpp>
 #include <window/sdl/sdl_window_service.hpp>
+#include <window/headless/headless_window_service.hpp>
@@ -38,7 +38,7 @@ class Window : public Observable, public Observer {
 using WindowPtr = shared_ptr<Window>;
 struct GetWindowPtr {
     GetWindowPtr(WindowPtr ptr) : _ptr(ptr) {}
-    WindowPtr window_ptr() { return this->_ptr; }
+    WindowPtr window_ptr() const { return this->_ptr; }
 
   private:
     WindowPtr _ptr;
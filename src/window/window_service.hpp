@@ -12,6 +12,28 @@ struct DisplayMode {
     int refresh_rate;
 };
 
+/**
+ * @brief      opt-in processing of high rate input between two polls
+ */
+struct InputOptions {
+    // keep the latest motion per window and mouse, summing relative motion
+    bool coalesce_motion{false};
+    // sum consecutive wheel deltas per window and mouse
+    bool coalesce_wheel{false};
+    // windows post the events of a poll as one WindowEventBatch instead of
+    // one by one
+    bool batch{false};
+};
+
+struct InputStats {
+    // events read from the platform
+    uint64_t raw{};
+    // events left after coalescing
+    uint64_t delivered{};
+    // batches posted
+    uint64_t batches{};
+};
+
 class WindowService : public BasicService, public Observable, public Observer {
   public:
     virtual ~WindowService() = default;
@@ -20,10 +42,33 @@ class WindowService : public BasicService, public Observable, public Observer {
     create_window(const std::string &title, const ISize2D &size) = 0;
 
     virtual future<DisplayMode> display_mode() = 0;
+
+    virtual future<void> input_options(const InputOptions &options) = 0;
+    virtual InputStats input_stats() = 0;
     // virtual future<Keymod> key_mod() = 0;
     // virtual future<MouseState> mouse_state() = 0;
 
+    // await()-able variants, inside the service the calls above complete
+    // before they return
+
+    Async<WindowPtr> async_create_window(const std::string &title,
+                                         const ISize2D &size) {
+        return this->async<WindowPtr>([this, title, size]() {
+            return this->create_window(title, size).get();
+        });
+    }
+
+    Async<DisplayMode> async_display_mode() {
+        return this->async<DisplayMode>(
+            [this]() { return this->display_mode().get(); });
+    }
+
     static unique_ptr<WindowService> create();
+    /**
+     * @brief      windows in memory and scripted input, no display needed
+     */
+    static unique_ptr<WindowService>
+    create_headless(const DisplayMode &mode = {0, {1920, 1080}, 0});
 };
 
 } // namespace my
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+
+#include <core/async.hpp>
+#include <storage/resource_service.hpp>
+
+namespace {
+
+class EchoService : public my::BasicService {
+public:
+  // on its own thread
+  EchoService() = default;
+  // on a strand of executor
+  explicit EchoService(my::Executor &executor) : BasicService(executor) {}
+
+  my::Async<int> echo(int v) {
+    return this->async<int>([this, v]() {
+      ++this->calls;
+      if (v < 0) {
+        throw std::invalid_argument("negative");
+      }
+      return v;
+    });
+  }
+
+  std::atomic<int> calls{0};
+};
+
+// a call which never completes
+my::Async<void> never() {
+  return my::Async<void>([](auto) {});
+}
+
+struct Text : my::Resource {
+  std::string text;
+  size_t used_mem() override { return this->text.size(); }
+};
+
+class TempFile {
+public:
+  explicit TempFile(std::string const &text)
+      : path(my::fs::temp_directory_path() /
+             ("async_test_" + std::to_string(::getpid()))) {
+    std::ofstream(this->path) << text;
+  }
+  ~TempFile() { my::fs::remove(this->path); }
+
+  my::fs::path path;
+};
+
+} // namespace
+
+namespace my {
+template <> class ResourceProvider<Text> {
+public:
+  static shared_ptr<Text> load(const ResourceFileProvideInfo &info) {
+    auto is = make_ifstream(info.path);
+    auto text = std::make_shared<Text>();
+    text->text.assign(std::istreambuf_iterator<char>(*is), {});
+    return text;
+  }
+  static shared_ptr<Text> load(const ResourceStreamProvideInfo &) {
+    return nullptr;
+  }
+};
+} // namespace my
+
+TEST(AsyncTest, one_strand_keeps_many_fibers_waiting) {
+  constexpr int kFibers = 300;
+  my::Executor executor(2);
+  EchoService service(executor);
+  auto caller = my::Strand::make(executor);
+
+  std::vector<std::future<int>> results;
+  for (int i = 0; i < kFibers; ++i) {
+    results.push_back(my::Fiber::spawn(caller, [&service, caller, i]() {
+      auto a = my::await(service.echo(i));
+      EXPECT_TRUE(caller->running_in_this_thread());
+      auto b = my::await(service.echo(a + 1));
+      EXPECT_TRUE(caller->running_in_this_thread());
+      return b;
+    }));
+  }
+  for (int i = 0; i < kFibers; ++i) {
+    EXPECT_EQ(results[i].get(), i + 1);
+  }
+  EXPECT_EQ(service.calls, 2 * kFibers);
+}
+
+TEST(AsyncTest, await_rethrows) {
+  my::Executor executor(2);
+  EchoService service(executor);
+  auto f = my::Fiber::spawn(executor, [&service]() {
+    EXPECT_THROW(my::await(service.echo(-1)), std::invalid_argument);
+    return my::await(service.echo(7));
+  });
+  EXPECT_EQ(f.get(), 7);
+}
+
+TEST(AsyncTest, await_outside_fiber_throws) {
+  my::Executor executor(1);
+  EchoService service(executor);
+  EXPECT_THROW(my::await(service.echo(1)), my::AsyncError);
+  EXPECT_EQ(service.calls, 0);
+}
+
+TEST(AsyncTest, then_runs_on_the_service_thread) {
+  EchoService service;
+  std::promise<std::thread::id> p;
+  service.echo(5).then([&](my::AsyncResult<int> &r) {
+    EXPECT_EQ(r.get(), 5);
+    p.set_value(std::this_thread::get_id());
+  });
+  EXPECT_EQ(p.get_future().get(),
+            service.coordination().get_thread_info().thread_id);
+}
+
+TEST(AsyncTest, dropped_fiber_unwinds) {
+  my::Executor executor(1);
+  auto alive = std::make_shared<int>(0);
+  std::weak_ptr<int> watch = alive;
+  auto f = my::Fiber::spawn(executor, [alive = std::move(alive)]() {
+    my::await(never());
+  });
+  EXPECT_THROW(f.get(), std::future_error);
+  EXPECT_TRUE(watch.expired());
+}
+
+TEST(AsyncTest, resource_service_loads_and_caches) {
+  TempFile file("hello");
+  my::ResourceService resources;
+  auto uri = my::FSResourceLocator::make(file.path)->get_id();
+  my::Executor executor(2);
+  auto f = my::Fiber::spawn(executor, [&]() {
+    EXPECT_FALSE(my::await(resources.async_exist(uri)));
+    auto text = my::await(resources.async_load<Text>(file.path));
+    EXPECT_EQ(text->text, "hello");
+    EXPECT_TRUE(my::await(resources.async_exist(uri)));
+    // the cached resource, the file is not read again
+    my::fs::remove(file.path);
+    return my::await(resources.async_load<Text>(file.path)) == text;
+  });
+  EXPECT_TRUE(f.get());
+}
+
+TEST(AsyncTest, resource_service_load_failure_is_rethrown) {
+  my::ResourceService resources;
+  my::Executor executor(1);
+  auto f = my::Fiber::spawn(executor, [&]() {
+    EXPECT_ANY_THROW(my::await(resources.async_load<Text>(
+        my::fs::temp_directory_path() / "async_test_missing")));
+    return my::await(resources.async_exist("file://missing"));
+  });
+  EXPECT_FALSE(f.get());
+}
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <future>
+
+#include <core/executor.hpp>
+
+namespace {
+
+struct Counted {
+  static inline int alive = 0;
+  Counted() { ++alive; }
+  Counted(Counted &&) noexcept { ++alive; }
+  ~Counted() { --alive; }
+};
+
+} // namespace
+
+TEST(ExecutorTest, task_stores_small_callables_inline) {
+  std::unique_ptr<int> owned = std::make_unique<int>(3);
+  int seen = 0;
+  auto small = [&seen, owned = std::move(owned)]() { seen = *owned; };
+  static_assert(my::Task::is_inline<decltype(small)>());
+
+  std::array<char, 128> big{};
+  big[0] = 5;
+  auto large = [&seen, big]() { seen += big[0]; };
+  static_assert(!my::Task::is_inline<decltype(large)>());
+
+  my::Task a(std::move(small));
+  my::Task b(large);
+  my::Task moved(std::move(a));
+  EXPECT_FALSE(a);
+  moved();
+  EXPECT_EQ(seen, 3);
+  b();
+  EXPECT_EQ(seen, 8);
+  b = std::move(moved);
+  EXPECT_FALSE(moved);
+  b();
+  EXPECT_EQ(seen, 3);
+
+  Counted::alive = 0;
+  {
+    my::Task inline_task([c = Counted()]() {});
+    my::Task heap_task([c = Counted(), big]() {});
+    EXPECT_EQ(Counted::alive, 2);
+  }
+  EXPECT_EQ(Counted::alive, 0);
+}
+
+TEST(ExecutorTest, runs_tasks_posted_from_anywhere) {
+  constexpr int kTasks = 10000;
+  std::atomic<int> done{0};
+  {
+    my::Executor executor(4);
+    std::vector<std::thread> posters;
+    for (int t = 0; t < 2; ++t) {
+      posters.emplace_back([&]() {
+        for (int i = 0; i < kTasks; ++i) {
+          // half of them fan out from inside a worker
+          executor.post([&]() {
+            if (executor.running_in_this_thread()) {
+              executor.post([&]() { ++done; });
+            }
+          });
+        }
+      });
+    }
+    for (auto &poster : posters) {
+      poster.join();
+    }
+    EXPECT_FALSE(executor.running_in_this_thread());
+  }
+  EXPECT_EQ(done, 2 * kTasks);
+}
+
+TEST(ExecutorTest, strand_is_serial_and_ordered) {
+  constexpr int kStrands = 8;
+  constexpr int kTasks = 2000;
+  my::Executor executor(4);
+  std::vector<std::shared_ptr<my::Strand>> strands;
+  std::vector<std::vector<int>> order(kStrands);
+  std::vector<std::atomic<int>> inside(kStrands);
+  std::atomic<bool> overlapped{false};
+  for (int s = 0; s < kStrands; ++s) {
+    strands.push_back(my::Strand::make(executor));
+  }
+
+  for (int i = 0; i < kTasks; ++i) {
+    for (int s = 0; s < kStrands; ++s) {
+      strands[s]->post([&, s, i]() {
+        if (inside[s]++ != 0 || !strands[s]->running_in_this_thread()) {
+          overlapped = true;
+        }
+        order[s].push_back(i);
+        --inside[s];
+      });
+    }
+  }
+
+  std::vector<std::future<void>> idle;
+  for (auto &strand : strands) {
+    auto p = std::make_shared<std::promise<void>>();
+    idle.push_back(p->get_future());
+    strand->post([p]() { p->set_value(); });
+  }
+  for (auto &f : idle) {
+    f.get();
+  }
+
+  EXPECT_FALSE(overlapped);
+  for (auto &o : order) {
+    ASSERT_EQ(o.size(), size_t(kTasks));
+    for (int i = 0; i < kTasks; ++i) {
+      EXPECT_EQ(o[i], i);
+    }
+  }
+}
+
+TEST(ExecutorTest, closed_strand_drops_tasks) {
+  my::Executor executor(2);
+  auto strand = my::Strand::make(executor);
+  std::promise<void> first;
+  auto dropped = std::make_shared<std::promise<void>>();
+  auto dropped_f = dropped->get_future();
+
+  strand->post([&]() {
+    strand->close();
+    first.set_value();
+  });
+  first.get_future().get();
+  strand->post([dropped]() { dropped->set_value(); });
+  dropped.reset();
+  EXPECT_THROW(dropped_f.get(), std::future_error);
+}
+
+TEST(ExecutorTest, parallel_for_runs_every_index_once) {
+  my::Executor executor(4);
+  std::array<std::atomic<int>, 1000> runs{};
+  my::parallel_for(executor, runs.size(), 8,
+                   [&](size_t i) { runs[i].fetch_add(1); });
+  for (auto &run : runs) {
+    EXPECT_EQ(run.load(), 1);
+  }
+}
+
+TEST(ExecutorTest, parallel_for_does_not_wait_for_queued_helpers) {
+  my::Executor executor(1);
+  // the only worker is busy, no helper starts before the caller is done
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  executor.post([released]() { released.wait(); });
+
+  std::vector<int> runs(64);
+  my::parallel_for(executor, runs.size(), 4, [&](size_t i) { ++runs[i]; });
+  EXPECT_EQ(runs, std::vector<int>(64, 1));
+  release.set_value();
+}
+
+TEST(ExecutorTest, parallel_for_rethrows_the_job_exception) {
+  my::Executor executor(2);
+  EXPECT_THROW(my::parallel_for(executor, 100, 3,
+                                [](size_t i) {
+                                  if (i == 42) {
+                                    throw std::runtime_error("job");
+                                  }
+                                }),
+               std::runtime_error);
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+#include <core/logger.hpp>
+
+namespace {
+
+class CaptureOutput : public my::Logger::LoggerOutput {
+public:
+  CaptureOutput() : my::Logger::LoggerOutput(my::Logger::kDebug) {}
+
+  void operator()(const my::Logger::LogMsg &msg) override {
+    this->lines.push_back(msg.msg);
+  }
+  void flush() override { ++this->flushes; }
+
+  std::vector<std::string> lines;
+  int flushes{0};
+};
+
+int evaluated = 0;
+int count_evaluation() { return ++evaluated; }
+
+} // namespace
+
+TEST(LoggerTest, delivers_records_of_all_threads) {
+  auto output = std::make_shared<CaptureOutput>();
+  my::Logger logger({output});
+  constexpr int kThreads = 4;
+  constexpr int kRecords = 500;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&logger, t]() {
+      for (int i = 0; i < kRecords; ++i) {
+        LOG_W(&logger, "%1% %2%", t, i);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  logger.flush();
+
+  ASSERT_EQ(output->lines.size(), size_t(kThreads * kRecords));
+  std::vector<int> next(kThreads, 0);
+  for (auto &line : output->lines) {
+    int t, i;
+    ASSERT_EQ(std::sscanf(line.c_str(), "%d %d", &t, &i), 2);
+    EXPECT_EQ(i, next[t]++);
+  }
+  EXPECT_LT(output->flushes, kThreads * kRecords);
+}
+
+TEST(LoggerTest, filtered_calls_skip_their_arguments) {
+  auto output = std::make_shared<CaptureOutput>();
+  my::Logger logger({output});
+  logger.set_level(my::Logger::kInfo);
+  evaluated = 0;
+  LOG_D(&logger, "%d", count_evaluation());
+  LOG_I(&logger, "%d", count_evaluation());
+  logger.flush();
+  EXPECT_EQ(evaluated, 1);
+  EXPECT_EQ(output->lines, (std::vector<std::string>{"1"}));
+}
+
+TEST(LoggerTest, copies_transient_strings) {
+  auto output = std::make_shared<CaptureOutput>();
+  my::Logger logger({output});
+  char buffer[16];
+  std::strcpy(buffer, "first");
+  std::string dynamic_fmt = "%s!";
+  LOG_I(&logger, dynamic_fmt, buffer);
+  LOG_I(&logger, buffer);
+  std::strcpy(buffer, "second");
+  dynamic_fmt = "changed";
+  logger.flush();
+  EXPECT_EQ(output->lines, (std::vector<std::string>{"first!", "first"}));
+}
+
+TEST(LoggerTest, survives_bad_format_strings) {
+  auto output = std::make_shared<CaptureOutput>();
+  my::Logger logger({output});
+  LOG_I(&logger, "%d %d", 1);
+  LOG_I(&logger, "ok");
+  logger.flush();
+  ASSERT_EQ(output->lines.size(), 2u);
+  EXPECT_EQ(output->lines[1], "ok");
+}
+
+TEST(LoggerTest, errors_reach_the_outputs_before_returning) {
+  auto output = std::make_shared<CaptureOutput>();
+  my::Logger logger({output});
+  LOG_I(&logger, "before");
+  LOG_E(&logger, "fatal");
+  EXPECT_EQ(output->lines, (std::vector<std::string>{"before", "fatal"}));
+}
+
+TEST(LoggerTest, outputs_may_log) {
+  // logs once from the logger thread, while writing its first line
+  class EchoOutput : public CaptureOutput {
+  public:
+    void operator()(const my::Logger::LogMsg &msg) override {
+      CaptureOutput::operator()(msg);
+      if (this->logger && msg.msg == "outer") {
+        LOG_W(this->logger, "inner");
+        LOG_E(this->logger, "error");
+      }
+    }
+    my::Logger *logger{};
+  };
+  auto output = std::make_shared<EchoOutput>();
+  my::Logger logger({output});
+  output->logger = &logger;
+  LOG_I(&logger, "outer");
+  logger.flush();
+  logger.flush();
+  EXPECT_EQ(output->lines,
+            (std::vector<std::string>{"outer", "inner", "error"}));
+}
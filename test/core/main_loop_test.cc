@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <core/coordination.hpp>
+
+namespace {
+
+using ms = std::chrono::milliseconds;
+
+} // namespace
+
+TEST(MainLoopTest, high_lane_runs_first_and_idle_last) {
+  my::main_loop loop;
+  std::vector<std::string> order;
+  loop.post([&]() { order.push_back("n1"); });
+  loop.post(
+      [&]() {
+        order.push_back("i1");
+        loop.quit();
+      },
+      my::Lane::kIdle);
+  loop.post([&]() { order.push_back("h1"); }, my::Lane::kHigh);
+  loop.post([&]() {
+    order.push_back("n2");
+    loop.post([&]() { order.push_back("n3"); });
+    loop.post([&]() { order.push_back("h2"); }, my::Lane::kHigh);
+  });
+  loop.run();
+  EXPECT_EQ(order, (std::vector<std::string>{"h1", "n1", "n2", "h2", "n3",
+                                             "i1"}));
+}
+
+TEST(MainLoopTest, idle_tasks_yield_after_the_budget) {
+  my::main_loop loop;
+  loop.idle_budget(ms(2));
+  std::vector<std::string> order;
+  // the timer becomes due while i1 runs, past the budget the loop fires
+  // it before i2
+  loop.post_after(ms(1), [&]() { order.push_back("timer"); });
+  loop.post(
+      [&]() {
+        order.push_back("i1");
+        std::this_thread::sleep_for(ms(5));
+      },
+      my::Lane::kIdle);
+  loop.post(
+      [&]() {
+        order.push_back("i2");
+        loop.quit();
+      },
+      my::Lane::kIdle);
+  loop.run();
+  EXPECT_EQ(order, (std::vector<std::string>{"i1", "timer", "i2"}));
+}
+
+TEST(MainLoopTest, post_after_wakes_a_sleeping_loop) {
+  my::main_loop loop;
+  std::thread thread([&]() { loop.run(); });
+  // let the loop park without any deadline
+  std::this_thread::sleep_for(ms(10));
+
+  std::promise<my::main_loop::clock::time_point> fired;
+  auto start = my::main_loop::clock::now();
+  loop.post_after(ms(10), [&]() {
+    fired.set_value(my::main_loop::clock::now());
+    loop.quit();
+  });
+  auto f = fired.get_future();
+  ASSERT_EQ(f.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+  EXPECT_GE(f.get() - start, ms(10));
+  thread.join();
+}
+
+TEST(MainLoopTest, posts_from_other_threads_wake_the_loop) {
+  my::main_loop loop;
+  std::thread thread([&]() { loop.run(); });
+
+  // one task in flight at a time, so the loop parks before every post; a
+  // lost wakeup hangs a round
+  for (int i = 0; i < 2000; ++i) {
+    std::promise<void> done;
+    loop.post([&]() { done.set_value(); },
+              i % 2 ? my::Lane::kHigh : my::Lane::kNormal);
+    ASSERT_EQ(done.get_future().wait_for(std::chrono::seconds(5)),
+              std::future_status::ready)
+        << i;
+  }
+
+  loop.quit();
+  thread.join();
+  EXPECT_EQ(loop.stats(my::Lane::kHigh).dispatched, 1000u);
+  EXPECT_EQ(loop.stats(my::Lane::kNormal).dispatched, 1000u);
+}
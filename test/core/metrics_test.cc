@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <core/metrics.hpp>
+
+TEST(MetricsTest, histogram_buckets_are_contiguous) {
+  for (size_t i = 1; i < my::Histogram::kBuckets; ++i) {
+    auto lower = my::Histogram::upper_bound_of(i - 1) + 1;
+    ASSERT_EQ(my::Histogram::index_of(lower), i);
+    ASSERT_EQ(my::Histogram::index_of(my::Histogram::upper_bound_of(i)), i);
+  }
+  EXPECT_EQ(my::Histogram::index_of(~uint64_t(0)),
+            my::Histogram::kBuckets - 1);
+}
+
+TEST(MetricsTest, histogram_percentiles_within_bucket_error) {
+  my::Histogram histogram;
+  for (uint64_t v = 1; v <= 10000; ++v) {
+    histogram.record(v);
+  }
+  auto summary = histogram.summary();
+  EXPECT_EQ(summary.count, 10000);
+  EXPECT_DOUBLE_EQ(summary.mean, 5000.5);
+  EXPECT_EQ(summary.max, 10000);
+  for (auto [p, expected] : {std::make_pair(50.0, 5000.0),
+                             std::make_pair(99.0, 9900.0)}) {
+    auto v = double(histogram.percentile(p));
+    EXPECT_GE(v, expected);
+    EXPECT_LE(v, expected * (1 + 1.0 / my::Histogram::kSubBuckets));
+  }
+}
+
+TEST(MetricsTest, concurrent_updates_are_counted) {
+  my::Metrics metrics;
+  auto &counter = metrics.counter("test.events");
+  auto &histogram = metrics.histogram("test.latency_us");
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&metrics, &counter, &histogram]() {
+      for (int i = 0; i < 1000; ++i) {
+        counter.add();
+        histogram.record(uint64_t(i));
+        metrics.gauge("test.depth").set(i);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto snapshot = metrics.snapshot();
+  EXPECT_EQ(snapshot.counters.at("test.events"), 4000);
+  EXPECT_EQ(snapshot.gauges.at("test.depth"), 999);
+  EXPECT_EQ(snapshot.histograms.at("test.latency_us").count, 4000);
+  EXPECT_EQ(snapshot.histograms.at("test.latency_us").max, 999);
+}
+
+TEST(MetricsTest, names_keep_their_kind) {
+  my::Metrics metrics;
+  auto &counter = metrics.counter("test.hits");
+  EXPECT_EQ(&metrics.counter("test.hits"), &counter);
+  EXPECT_THROW(metrics.gauge("test.hits"), my::MetricsError);
+}
+
+TEST(MetricsTest, snapshot_as_json_line) {
+  my::Metrics metrics;
+  metrics.counter("resource.cache_hits").add(3);
+  metrics.gauge("logger.pending").set(-1);
+  metrics.histogram("canvas.render_us").record(7);
+
+  std::ostringstream os;
+  metrics.snapshot().write_json(os);
+  auto json = os.str();
+  EXPECT_NE(json.find("\"counters\":{\"resource.cache_hits\":3}"),
+            std::string::npos);
+  EXPECT_NE(json.find("\"gauges\":{\"logger.pending\":-1}"),
+            std::string::npos);
+  EXPECT_NE(json.find("\"canvas.render_us\":{\"count\":1,\"mean\":7.000,"
+                      "\"p50\":7,\"p90\":7,\"p99\":7,\"max\":7}"),
+            std::string::npos);
+  EXPECT_EQ(json.back(), '\n');
+  EXPECT_EQ(json.find('\n'), json.size() - 1);
+}
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <thread>
+
+#include <core/profiler.hpp>
+
+namespace {
+
+size_t count(const std::string &s, const std::string &what) {
+  size_t n = 0;
+  for (auto pos = s.find(what); pos != std::string::npos;
+       pos = s.find(what, pos + 1)) {
+    ++n;
+  }
+  return n;
+}
+
+} // namespace
+
+TEST(ProfilerTest, records_nothing_outside_a_capture) {
+  auto profiler = my::Profiler::get();
+  profiler->start();
+  profiler->stop();
+  { MY_PROFILE_ZONE("outside"); }
+  profiler->collect();
+  EXPECT_EQ(profiler->size(), 0);
+}
+
+TEST(ProfilerTest, nested_zones_of_all_threads) {
+  auto profiler = my::Profiler::get();
+  profiler->start();
+  {
+    MY_PROFILE_ZONE("outer");
+    MY_PROFILE_ZONE_C("test", "inner");
+  }
+  std::thread([]() {
+    MY_PROFILE_THREAD("profiled worker");
+    MY_PROFILE_ZONE("worker");
+  }).join();
+  profiler->stop();
+
+  std::ostringstream os;
+  profiler->write_chrome_trace(os);
+  auto trace = os.str();
+  EXPECT_EQ(trace.rfind("{\"traceEvents\":[", 0), 0);
+  EXPECT_EQ(count(trace, "\"ph\":\"X\""), 3);
+  EXPECT_EQ(count(trace, "\"name\":\"outer\""), 1);
+  EXPECT_EQ(count(trace, "\"name\":\"inner\",\"cat\":\"test\""), 1);
+  EXPECT_EQ(count(trace, "\"name\":\"profiled worker\""), 1);
+  EXPECT_EQ(profiler->dropped(), 0);
+}
+
+TEST(ProfilerTest, a_new_capture_drops_the_old_one) {
+  auto profiler = my::Profiler::get();
+  profiler->start();
+  { MY_PROFILE_ZONE("first"); }
+  profiler->stop();
+  EXPECT_EQ(profiler->size(), 1);
+
+  profiler->start();
+  { MY_PROFILE_ZONE("second"); }
+  profiler->stop();
+  std::ostringstream os;
+  profiler->write_chrome_trace(os);
+  EXPECT_EQ(count(os.str(), "\"name\":\"first\""), 0);
+  EXPECT_EQ(count(os.str(), "\"name\":\"second\""), 1);
+}
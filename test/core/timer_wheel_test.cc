@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include <core/lane_queue.hpp>
+#include <core/timer_wheel.hpp>
+
+namespace {
+
+using ms = std::chrono::milliseconds;
+using Wheel = my::TimerWheel<int>;
+
+} // namespace
+
+TEST(TimerWheelTest, fires_each_timer_once_and_never_early) {
+  auto start = Wheel::clock::time_point{};
+  Wheel wheel(ms(1), start);
+  std::mt19937 rng(7);
+  // spread over all levels, including past the top wheel
+  std::uniform_int_distribution<int> delay(1, 1 << 25);
+  std::vector<int> due;
+  for (int i = 0; i < 2000; ++i) {
+    due.push_back(i < 1000 ? i % 300 + 1 : delay(rng));
+    wheel.add(start + ms(due.back()), i);
+  }
+
+  std::vector<int> fired_at(due.size(), -1);
+  auto now = start;
+  while (!wheel.empty()) {
+    auto next = wheel.next_deadline();
+    ASSERT_TRUE(next);
+    ASSERT_GT(*next, now);
+    now = *next;
+    auto tick = int(std::chrono::duration_cast<ms>(now - start).count());
+    wheel.advance(now, [&](int i) {
+      EXPECT_EQ(fired_at[i], -1);
+      fired_at[i] = tick;
+    });
+  }
+  for (size_t i = 0; i < due.size(); ++i) {
+    EXPECT_EQ(fired_at[i], due[i]) << i;
+  }
+}
+
+TEST(TimerWheelTest, cancel_and_reuse) {
+  auto start = Wheel::clock::time_point{};
+  Wheel wheel(ms(1), start);
+  auto a = wheel.add(start + ms(5), 1);
+  auto b = wheel.add(start + ms(5), 2);
+  auto c = wheel.add(start + ms(500), 3);
+  EXPECT_TRUE(wheel.cancel(a));
+  EXPECT_FALSE(wheel.cancel(a));
+  EXPECT_TRUE(wheel.cancel(c));
+  EXPECT_EQ(wheel.size(), 1u);
+
+  // the freed node is reused, the stale id must not cancel the new timer
+  auto d = wheel.add(start + ms(6), 4);
+  EXPECT_FALSE(wheel.cancel(a));
+
+  std::vector<int> fired;
+  wheel.advance(start + ms(10), [&](int v) { fired.push_back(v); });
+  EXPECT_EQ(fired, (std::vector<int>{2, 4}));
+  EXPECT_FALSE(wheel.cancel(b));
+  EXPECT_FALSE(wheel.cancel(d));
+  EXPECT_TRUE(wheel.empty());
+  EXPECT_FALSE(wheel.next_deadline());
+}
+
+TEST(TimerWheelTest, rounds_deadlines_up) {
+  auto start = Wheel::clock::time_point{};
+  Wheel wheel(ms(10), start);
+  wheel.add(start + ms(11), 1);
+  int fired = 0;
+  wheel.advance(start + ms(19), [&](int) { ++fired; });
+  EXPECT_EQ(fired, 0);
+  EXPECT_EQ(*wheel.next_deadline(), start + ms(20));
+  wheel.advance(start + ms(20), [&](int) { ++fired; });
+  EXPECT_EQ(fired, 1);
+}
+
+TEST(LaneQueueTest, keeps_order_through_overflow) {
+  my::LaneQueue lane;
+  std::vector<int> order;
+  constexpr int kTasks = 2000;
+  for (int i = 0; i < kTasks; ++i) {
+    lane.push([&order, i]() { order.push_back(i); });
+  }
+  EXPECT_EQ(lane.depth(), size_t(kTasks));
+
+  my::Task task;
+  while (lane.try_pop(task)) {
+    task();
+  }
+  ASSERT_EQ(order.size(), size_t(kTasks));
+  for (int i = 0; i < kTasks; ++i) {
+    EXPECT_EQ(order[i], i);
+  }
+
+  auto stats = lane.stats();
+  EXPECT_EQ(stats.posted, uint64_t(kTasks));
+  EXPECT_EQ(stats.dispatched, uint64_t(kTasks));
+  EXPECT_EQ(stats.depth, 0u);
+  EXPECT_EQ(stats.max_depth, size_t(kTasks));
+  EXPECT_LE(stats.latency_p50_us, stats.latency_p99_us);
+}
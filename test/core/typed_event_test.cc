@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
+#include <core/typed_event.hpp>
+
+namespace {
+
+struct Motion {
+  int x, y;
+};
+
+struct Wheel {
+  int delta;
+};
+
+struct Key {
+  int code;
+};
+
+struct Counted {
+  static inline int alive = 0;
+  static inline int constructed = 0;
+  int value;
+
+  Counted(int value) : value(value) {
+    ++alive;
+    ++constructed;
+  }
+  Counted(const Counted &other) : value(other.value) {
+    ++alive;
+    ++constructed;
+  }
+  ~Counted() { --alive; }
+};
+
+} // namespace
+
+TEST(TypedEventTest, delivers_by_type) {
+  my::TypedDispatcher dispatcher;
+  int motions = 0, wheels = 0;
+  dispatcher.subscribe<Motion>([&](const my::TypedEvent<Motion> &e) {
+    EXPECT_EQ(e->x, 3);
+    ++motions;
+  });
+  dispatcher.subscribe<Motion>(
+      [&](const my::TypedEvent<Motion> &e) { motions += e->y; });
+  dispatcher.subscribe<Wheel>([&](const auto &e) { wheels += e->delta; });
+
+  EXPECT_EQ(dispatcher.post<Motion>(3, 10), 2u);
+  EXPECT_EQ(dispatcher.post<Wheel>(-2), 1u);
+  EXPECT_EQ(motions, 11);
+  EXPECT_EQ(wheels, -2);
+  EXPECT_EQ(dispatcher.subscriber_count<Motion>(), 2u);
+}
+
+TEST(TypedEventTest, unsubscribed_types_are_not_constructed) {
+  my::TypedDispatcher dispatcher;
+  Counted::constructed = 0;
+  EXPECT_EQ(dispatcher.post<Counted>(1), 0u);
+  EXPECT_EQ(Counted::constructed, 0);
+
+  auto id = dispatcher.subscribe<Counted>([](const auto &) {});
+  EXPECT_EQ(dispatcher.post<Counted>(1), 1u);
+  EXPECT_EQ(Counted::constructed, 1);
+
+  dispatcher.unsubscribe(id);
+  EXPECT_EQ(dispatcher.post<Counted>(1), 0u);
+  EXPECT_EQ(Counted::constructed, 1);
+}
+
+TEST(TypedEventTest, nodes_are_reused) {
+  my::TypedDispatcher dispatcher;
+  std::vector<const Motion *> payloads;
+  dispatcher.subscribe<Motion>(
+      [&](const my::TypedEvent<Motion> &e) { payloads.push_back(&e.data()); });
+  for (int i = 0; i < 8; ++i) {
+    dispatcher.post<Motion>(i, i);
+  }
+  ASSERT_EQ(payloads.size(), 8u);
+  for (auto p : payloads) {
+    EXPECT_EQ(p, payloads.front());
+  }
+}
+
+TEST(TypedEventTest, kept_events_outlive_dispatch) {
+  my::TypedDispatcher dispatcher;
+  Counted::alive = 0;
+  my::TypedEvent<Counted> kept;
+  dispatcher.subscribe<Counted>(
+      [&](const my::TypedEvent<Counted> &e) { kept = e; });
+
+  dispatcher.post<Counted>(42);
+  EXPECT_EQ(Counted::alive, 1);
+  EXPECT_EQ(kept->value, 42);
+
+  // redelivering the kept event does not copy the payload
+  int seen = 0;
+  dispatcher.subscribe<Counted>([&](const auto &e) { seen = e->value; });
+  dispatcher.post_event(kept);
+  EXPECT_EQ(seen, 42);
+  EXPECT_EQ(Counted::alive, 1);
+
+  kept.reset();
+  EXPECT_EQ(Counted::alive, 0);
+}
+
+TEST(TypedEventTest, concurrent_post_and_subscribe) {
+  my::TypedDispatcher dispatcher;
+  std::atomic<int> delivered{0};
+  dispatcher.subscribe<Motion>([&](const auto &) { ++delivered; });
+
+  std::vector<std::thread> posters;
+  for (int t = 0; t < 4; ++t) {
+    posters.emplace_back([&, t]() {
+      for (int i = 0; i < 10000; ++i) {
+        dispatcher.post<Motion>(i, t);
+      }
+    });
+  }
+  for (int i = 0; i < 100; ++i) {
+    auto id = dispatcher.subscribe<Motion>([](const auto &) {});
+    dispatcher.unsubscribe(id);
+  }
+  for (auto &poster : posters) {
+    poster.join();
+  }
+  EXPECT_EQ(delivered, 40000);
+}
+
+TEST(TypedEventTest, cross_thread_release_returns_to_the_producer) {
+  constexpr int kEvents = 10000;
+  constexpr size_t kDepth = 8;
+  std::mutex lock;
+  std::condition_variable cv;
+  std::deque<my::TypedEvent<Key>> queue;
+  size_t steady_allocations = 0;
+  my::TypedEvent<Key> kept;
+
+  std::thread producer([&]() {
+    {
+      // more free nodes than can ever be in flight
+      std::vector<my::TypedEvent<Key>> warm;
+      for (size_t i = 0; i < 2 * kDepth; ++i) {
+        warm.push_back(my::TypedEvent<Key>::make(int(i)));
+      }
+    }
+    auto allocated = my::detail::TypedEventPool<Key>::allocated();
+    for (int i = 0; i < kEvents; ++i) {
+      auto e = my::TypedEvent<Key>::make(i);
+      std::unique_lock<std::mutex> l_lock(lock);
+      cv.wait(l_lock, [&]() { return queue.size() < kDepth; });
+      queue.push_back(std::move(e));
+      cv.notify_all();
+    }
+    steady_allocations =
+        my::detail::TypedEventPool<Key>::allocated() - allocated;
+  });
+
+  for (int i = 0; i < kEvents; ++i) {
+    my::TypedEvent<Key> e;
+    {
+      std::unique_lock<std::mutex> l_lock(lock);
+      cv.wait(l_lock, [&]() { return !queue.empty(); });
+      e = std::move(queue.front());
+      queue.pop_front();
+      cv.notify_all();
+    }
+    EXPECT_EQ(e->code, i);
+    if (i == kEvents - 1) {
+      kept = e;
+    }
+  }
+  producer.join();
+  EXPECT_EQ(steady_allocations, 0u);
+  // the producer's pool outlives its thread until this node is released
+  EXPECT_EQ(kept->code, kEvents - 1);
+  kept.reset();
+}
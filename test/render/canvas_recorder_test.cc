@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+#include <render/back/back2/raster_canvas.hpp>
+
+namespace {
+
+boost::gil::rgba8_pixel_t pixel(my::RasterCanvas &canvas, int x, int y) {
+  return boost::gil::const_view(canvas.image())(x, y);
+}
+
+} // namespace
+
+TEST(CanvasRecorderTest, order_decides_between_threads) {
+  auto canvas = my::RasterCanvas::make(8, 8);
+  // the later order is drawn over, whichever thread recorded first
+  std::thread([&]() {
+    canvas->recorder(2).fill_rect({0, 0}, {8, 8}, {255, 0, 0, 255});
+  }).join();
+  std::thread([&]() {
+    canvas->recorder(1).fill_rect({0, 0}, {8, 8}, {0, 0, 255, 255});
+  }).join();
+  canvas->render();
+  EXPECT_EQ(pixel(*canvas, 4, 4), boost::gil::rgba8_pixel_t(255, 0, 0, 255));
+}
+
+TEST(CanvasRecorderTest, one_list_per_thread_and_order) {
+  auto canvas = my::RasterCanvas::make(8, 8);
+  auto &a = canvas->recorder();
+  EXPECT_EQ(&canvas->recorder(0), &a);
+  EXPECT_NE(&canvas->recorder(1), &a);
+  EXPECT_EQ(canvas->recorder(1).order(), 1);
+
+  my::DrawList *other = nullptr;
+  std::thread([&]() { other = &canvas->recorder(); }).join();
+  EXPECT_NE(other, &a);
+
+  // a new canvas never sees the lists of a destroyed one
+  canvas.reset();
+  auto next = my::RasterCanvas::make(8, 8);
+  EXPECT_TRUE(next->recorder().empty());
+}
+
+TEST(CanvasRecorderTest, threads_past_the_slots_still_record) {
+  constexpr int kThreads = 96;
+  auto canvas = my::RasterCanvas::make(kThreads, 1);
+  std::mutex lock;
+  std::condition_variable cv;
+  int recorded = 0;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back([&, i]() {
+      canvas->recorder(i).fill_rect({float(i), 0}, {float(i + 1), 1},
+                                    {0, 255, 0, 255});
+      // all threads stay alive, so each holds its own thread index
+      std::unique_lock<std::mutex> l_lock(lock);
+      ++recorded;
+      cv.notify_all();
+      cv.wait(l_lock, [&]() { return recorded == kThreads; });
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  canvas->render();
+  for (int i = 0; i < kThreads; ++i) {
+    EXPECT_EQ(pixel(*canvas, i, 0)[1], 255) << i;
+  }
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <render/frame_scheduler.hpp>
+
+namespace {
+
+using namespace std::chrono_literals;
+using clock_type = my::FrameScheduler::clock;
+
+} // namespace
+
+TEST(FrameSchedulerTest, idle_until_requested) {
+  my::FrameScheduler frames(100);
+  EXPECT_EQ(frames.period(), 10ms);
+  EXPECT_FALSE(frames.pending());
+
+  clock_type::time_point t{};
+  EXPECT_TRUE(frames.request());
+  // folded into the pending frame
+  EXPECT_FALSE(frames.request());
+  EXPECT_EQ(frames.deadline(t), t);
+
+  frames.begin_frame(t);
+  EXPECT_FALSE(frames.end_frame(t + 2ms));
+  EXPECT_FALSE(frames.pending());
+
+  auto stats = frames.stats();
+  EXPECT_EQ(stats.frames, 1);
+  EXPECT_EQ(stats.requests, 2);
+  EXPECT_EQ(stats.missed, 0);
+  EXPECT_EQ(stats.frame_time_us.max, 2000);
+}
+
+TEST(FrameSchedulerTest, paced_by_the_refresh_rate) {
+  my::FrameScheduler frames(100);
+  clock_type::time_point t{};
+  frames.request();
+  frames.begin_frame(t);
+
+  // requested while drawing, scheduled once the frame ends
+  EXPECT_FALSE(frames.request());
+  EXPECT_TRUE(frames.end_frame(t + 3ms));
+  EXPECT_EQ(frames.deadline(t + 3ms), t + 10ms);
+
+  // after an idle period a frame starts at once
+  frames.begin_frame(t + 10ms);
+  frames.end_frame(t + 13ms);
+  EXPECT_TRUE(frames.request());
+  EXPECT_EQ(frames.deadline(t + 50ms), t + 50ms);
+}
+
+TEST(FrameSchedulerTest, jitter_and_missed_frames) {
+  my::FrameScheduler frames(100);
+  clock_type::time_point t{};
+  // presents 1ms off the grid, then one skipping a vsync
+  frames.request();
+  frames.begin_frame(t);
+  frames.end_frame(t + 10ms);
+  frames.request();
+  frames.begin_frame(t + 10ms);
+  frames.end_frame(t + 21ms);
+  frames.request();
+  frames.begin_frame(t + 21ms);
+  frames.end_frame(t + 40ms);
+
+  auto stats = frames.stats();
+  EXPECT_EQ(stats.frames, 3);
+  EXPECT_EQ(stats.missed, 1);
+  EXPECT_EQ(stats.jitter_us.count, 2);
+  EXPECT_EQ(stats.jitter_us.max, 1000);
+
+  // an unknown rate falls back to the default
+  frames.refresh_rate(0);
+  EXPECT_EQ(frames.refresh_rate(), my::FrameScheduler::kDefaultRefreshRate);
+}
+
+TEST(FrameSchedulerTest, uncapped_frames_start_at_once) {
+  my::FrameScheduler frames(my::FrameScheduler::kUncapped);
+  EXPECT_EQ(frames.period(), clock_type::duration::zero());
+  clock_type::time_point t{};
+  for (int i = 0; i < 3; ++i) {
+    frames.request();
+    EXPECT_EQ(frames.deadline(t), t);
+    frames.begin_frame(t);
+    t += 50ms;
+    frames.end_frame(t);
+  }
+
+  auto stats = frames.stats();
+  EXPECT_EQ(stats.frames, 3);
+  EXPECT_EQ(stats.missed, 0);
+  EXPECT_EQ(stats.jitter_us.count, 0);
+}
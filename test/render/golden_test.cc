@@ -0,0 +1,290 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+
+#include <OpenImageIO/imageio.h>
+
+#include <render/back/back2/raster_canvas.hpp>
+#include <storage/image.hpp>
+#include <tool/bench/bench.hpp>
+
+// every heap allocation of the process is counted, the per frame delta is
+// part of the report
+#include <tool/bench/alloc_counter.hpp>
+
+#include "scenes.hpp"
+
+namespace {
+
+namespace fs = std::filesystem;
+using clock_type = my::bench::clock;
+using my::RGBAImage;
+
+constexpr int kWarmupFrames = 3;
+constexpr int kFrames = 30;
+// pixelmatch style YIQ threshold and the share of pixels allowed above it
+constexpr double kPixelThreshold = 0.1;
+constexpr double kMaxMismatchRatio = 0.001;
+
+struct SceneResult {
+  std::string name;
+  uint32_t width{};
+  uint32_t height{};
+  size_t triangles{};
+  std::vector<double> record_ms;
+  std::vector<double> render_ms;
+  std::vector<double> frame_ms;
+  std::vector<size_t> allocations;
+  std::vector<size_t> allocated_bytes;
+  size_t mismatched{};
+  double max_delta{};
+  bool golden_found{};
+  bool passed{};
+};
+
+std::vector<SceneResult> &results() {
+  static std::vector<SceneResult> results;
+  return results;
+}
+
+std::string env_or(const char *name, const std::string &fallback) {
+  auto value = std::getenv(name);
+  return value && *value ? value : fallback;
+}
+
+bool write_png(const fs::path &path, RGBAImage::const_view_t view) {
+  auto out = OIIO::ImageOutput::create(path.string());
+  if (!out) {
+    return false;
+  }
+  OIIO::ImageSpec spec(view.width(), view.height(), 4, OIIO::TypeDesc::UINT8);
+  return out->open(path.string(), spec) &&
+         out->write_image(OIIO::TypeDesc::UINT8,
+                          boost::gil::interleaved_view_get_raw_data(view),
+                          OIIO::AutoStride, view.pixels().row_size()) &&
+         out->close();
+}
+
+bool read_png(const fs::path &path, RGBAImage &image) {
+  auto in = OIIO::ImageInput::open(path.string());
+  if (!in || in->spec().nchannels != 4) {
+    return false;
+  }
+  const auto &spec = in->spec();
+  image.recreate(spec.width, spec.height);
+  auto view = boost::gil::view(image);
+  return in->read_image(OIIO::TypeDesc::UINT8,
+                        boost::gil::interleaved_view_get_raw_data(view),
+                        OIIO::AutoStride, view.pixels().row_size()) &&
+         in->close();
+}
+
+std::shared_ptr<my::Image> make_image(const RGBAImage &pixels) {
+  // Image only decodes encoded blobs, round trip the pixels through a png
+  auto path = fs::temp_directory_path() / "my_gui_golden_scroll.png";
+  if (!write_png(path, boost::gil::const_view(pixels))) {
+    return nullptr;
+  }
+  std::ifstream in(path, std::ios::binary);
+  std::vector<char> bytes((std::istreambuf_iterator<char>(in)),
+                          std::istreambuf_iterator<char>());
+  fs::remove(path);
+  return my::Image::make(my::Blob::make(bytes.data(), bytes.size()));
+}
+
+// perceived colour distance from "Measuring perceived color difference
+// using YIQ NTSC transmission color space", normalized to 0..1
+double yiq_delta(const boost::gil::rgba8_pixel_t &a,
+                 const boost::gil::rgba8_pixel_t &b) {
+  auto blend = [](const boost::gil::rgba8_pixel_t &p, int c) {
+    // composite over white so transparent pixels compare by appearance
+    return 255 + (p[c] - 255) * p[3] / 255.0;
+  };
+  double r = blend(a, 0) - blend(b, 0);
+  double g = blend(a, 1) - blend(b, 1);
+  double bl = blend(a, 2) - blend(b, 2);
+  double y = r * 0.29889531 + g * 0.58662247 + bl * 0.11448223;
+  double i = r * 0.59597799 - g * 0.27417610 - bl * 0.32180189;
+  double q = r * 0.21147017 - g * 0.52261711 + bl * 0.31114694;
+  return (0.5053 * y * y + 0.299 * i * i + 0.1957 * q * q) / 35215.0;
+}
+
+void compare(const RGBAImage &actual, const RGBAImage &golden,
+             SceneResult &result, RGBAImage &diff) {
+  auto a = boost::gil::const_view(actual);
+  auto g = boost::gil::const_view(golden);
+  diff.recreate(a.width(), a.height());
+  auto d = boost::gil::view(diff);
+  const double threshold = kPixelThreshold * kPixelThreshold;
+  for (int y = 0; y < a.height(); ++y) {
+    for (int x = 0; x < a.width(); ++x) {
+      double delta = yiq_delta(a(x, y), g(x, y));
+      result.max_delta = std::max(result.max_delta, std::sqrt(delta));
+      uint8_t gray = static_cast<uint8_t>(
+          (a(x, y)[0] * 77 + a(x, y)[1] * 150 + a(x, y)[2] * 29) >> 10);
+      if (delta > threshold) {
+        ++result.mismatched;
+        d(x, y) = boost::gil::rgba8_pixel_t(255, 0, 0, 255);
+      } else {
+        d(x, y) = boost::gil::rgba8_pixel_t(gray, gray, gray, 255);
+      }
+    }
+  }
+}
+
+struct Fixture {
+  my::test::TestFont font;
+  RGBAImage scroll_pixels{my::test::make_scroll_pixels()};
+  std::vector<my::test::Scene> scenes;
+
+  Fixture() {
+    auto image = make_image(this->scroll_pixels);
+    this->scenes = my::test::make_scenes(image, this->scroll_pixels.width(),
+                                         this->scroll_pixels.height());
+  }
+
+  static Fixture &get() {
+    static Fixture fixture;
+    return fixture;
+  }
+};
+
+void run_scene(const std::string &name) {
+  auto &fixture = Fixture::get();
+  auto it = std::find_if(fixture.scenes.begin(), fixture.scenes.end(),
+                         [&name](const auto &s) { return s.name == name; });
+  ASSERT_NE(it, fixture.scenes.end());
+  const auto &scene = *it;
+
+  SceneResult result;
+  result.name = scene.name;
+  result.width = scene.width;
+  result.height = scene.height;
+
+  auto canvas =
+      my::RasterCanvas::make(scene.width, scene.height, &fixture.font);
+
+  // golden frame
+  scene.draw(*canvas, 0);
+  canvas->render();
+  result.triangles = canvas->stats().triangles;
+  const auto &actual = canvas->image();
+
+  const fs::path golden_dir = env_or("MY_GUI_GOLDEN_DIR", MY_GUI_GOLDEN_DIR);
+  const fs::path out_dir = env_or("MY_GUI_RENDER_OUT", ".");
+  const auto golden_path = golden_dir / (scene.name + ".png");
+
+  if (std::getenv("MY_GUI_UPDATE_GOLDEN")) {
+    ASSERT_TRUE(write_png(golden_path, boost::gil::const_view(actual)))
+        << golden_path;
+  }
+
+  RGBAImage golden;
+  result.golden_found = read_png(golden_path, golden);
+  if (result.golden_found &&
+      golden.dimensions() == actual.dimensions()) {
+    RGBAImage diff;
+    compare(actual, golden, result, diff);
+    double ratio =
+        double(result.mismatched) / (scene.width * scene.height);
+    result.passed = ratio <= kMaxMismatchRatio;
+    if (!result.passed) {
+      write_png(out_dir / (scene.name + ".actual.png"),
+                boost::gil::const_view(actual));
+      write_png(out_dir / (scene.name + ".diff.png"),
+                boost::gil::const_view(diff));
+    }
+    EXPECT_TRUE(result.passed)
+        << scene.name << ": " << result.mismatched
+        << " pixels differ, max delta " << result.max_delta;
+  } else {
+    write_png(out_dir / (scene.name + ".actual.png"),
+              boost::gil::const_view(actual));
+    ADD_FAILURE() << "no matching golden " << golden_path
+                  << ", run with MY_GUI_UPDATE_GOLDEN=1 to create it";
+  }
+
+  // timed frames, the content changes every frame like an animation would
+  for (int frame = 1; frame <= kWarmupFrames + kFrames; ++frame) {
+    auto allocs = my::bench::allocations();
+    auto bytes = my::bench::allocated_bytes();
+    auto begin = clock_type::now();
+    scene.draw(*canvas, frame);
+    double record = my::bench::elapsed_ms(begin);
+    auto render_begin = clock_type::now();
+    canvas->render();
+    double render = my::bench::elapsed_ms(render_begin);
+    if (frame <= kWarmupFrames) {
+      continue;
+    }
+    result.record_ms.push_back(record);
+    result.render_ms.push_back(render);
+    result.frame_ms.push_back(record + render);
+    result.allocations.push_back(my::bench::allocations() - allocs);
+    result.allocated_bytes.push_back(my::bench::allocated_bytes() - bytes);
+  }
+
+  results().push_back(std::move(result));
+}
+
+void write_stats(std::ostream &out, const char *key,
+                 std::vector<double> samples) {
+  using my::bench::percentile;
+  out << "      \"" << key << "\": {\"median\": " << percentile(samples, 50)
+      << ", \"p95\": " << percentile(samples, 95)
+      << ", \"max\": " << percentile(samples, 100) << "},\n";
+}
+
+template <typename T> double mean(const std::vector<T> &samples) {
+  double sum = 0;
+  for (auto s : samples) {
+    sum += s;
+  }
+  return samples.empty() ? 0 : sum / samples.size();
+}
+
+/**
+ * @brief      writes the machine readable report once every scene ran
+ */
+class ReportEnvironment : public ::testing::Environment {
+public:
+  void TearDown() override {
+    const auto path = env_or("MY_GUI_RENDER_REPORT", "render_report.json");
+    std::ofstream out(path);
+    out << "{\n  \"frames\": " << kFrames << ",\n  \"scenes\": [\n";
+    for (size_t i = 0; i < results().size(); ++i) {
+      const auto &r = results()[i];
+      out << "    {\n      \"name\": \"" << r.name << "\",\n"
+          << "      \"width\": " << r.width << ",\n"
+          << "      \"height\": " << r.height << ",\n"
+          << "      \"triangles\": " << r.triangles << ",\n";
+      write_stats(out, "frame_ms", r.frame_ms);
+      write_stats(out, "record_ms", r.record_ms);
+      write_stats(out, "render_ms", r.render_ms);
+      out << "      \"allocations_per_frame\": " << mean(r.allocations)
+          << ",\n      \"allocated_bytes_per_frame\": "
+          << mean(r.allocated_bytes) << ",\n"
+          << "      \"golden\": {\"found\": "
+          << (r.golden_found ? "true" : "false")
+          << ", \"passed\": " << (r.passed ? "true" : "false")
+          << ", \"mismatched_pixels\": " << r.mismatched
+          << ", \"max_delta\": " << r.max_delta << "}\n"
+          << "    }" << (i + 1 < results().size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+  }
+};
+
+auto *const report_env =
+    ::testing::AddGlobalTestEnvironment(new ReportEnvironment);
+
+} // namespace
+
+TEST(RenderGoldenTest, text_dialog) { run_scene("text_dialog"); }
+
+TEST(RenderGoldenTest, icon_grid) { run_scene("icon_grid"); }
+
+TEST(RenderGoldenTest, image_scroll) { run_scene("image_scroll"); }
+
+TEST(RenderGoldenTest, path_chart) { run_scene("path_chart"); }
@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#include <render/render_service.hpp>
+#include <window/headless/headless_window_service.hpp>
+
+#include <skia/include/core/SkPictureRecorder.h>
+
+namespace {
+
+void expect_filled(my::HeadlessWindow &win, my::ISize2D size, SkColor color) {
+  win.with_frame_buffer([&](my::HeadlessWindow::FrameBuffer &fb) {
+    ASSERT_EQ(fb.size, size);
+    ASSERT_EQ(fb.pixels.size(), size_t(size.width() * size.height()));
+    for (auto pixel : fb.pixels) {
+      ASSERT_EQ(pixel, color);
+    }
+  });
+}
+
+} // namespace
+
+TEST(HeadlessRenderTest, frames_are_copied_into_the_frame_buffer) {
+  auto windows = my::WindowService::create_headless();
+  auto win = std::dynamic_pointer_cast<my::HeadlessWindow>(
+      windows->create_window("test", my::ISize2D::Make(32, 16)).get());
+  ASSERT_TRUE(win);
+  auto render = my::RenderService::make(win);
+
+  // the first frame needs no request, an empty scene is cleared white
+  win->wait_presents(1);
+  expect_filled(*win, my::ISize2D::Make(32, 16), SK_ColorWHITE);
+
+  SkPictureRecorder recorder;
+  recorder.beginRecording(SkRect::MakeWH(64, 64))->clear(SK_ColorRED);
+  my::SceneSnapshot snapshot;
+  snapshot.picture = recorder.finishRecordingAsPicture();
+  snapshot.sequence = 1;
+  render->submit(std::move(snapshot));
+  win->wait_presents(2);
+  expect_filled(*win, my::ISize2D::Make(32, 16), SK_ColorRED);
+
+  // the frame buffer is reallocated, a frame at the new size follows
+  win->size(my::ISize2D::Make(48, 20));
+  win->wait_presents(3);
+  expect_filled(*win, my::ISize2D::Make(48, 20), SK_ColorRED);
+
+  // as for a scripted resize
+  my::HeadlessInput resize;
+  resize.type = my::HeadlessInput::kResize;
+  resize.window = win->window_id();
+  resize.size = my::ISize2D::Make(24, 12);
+  dynamic_cast<my::HeadlessWindowService &>(*windows).inject(resize).get();
+  win->wait_presents(4);
+  expect_filled(*win, my::ISize2D::Make(24, 12), SK_ColorRED);
+}
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include <render/back/back2/raster_canvas.hpp>
+
+namespace {
+
+std::shared_ptr<my::RGBAImage> solid(int w, int h, uint8_t r, uint8_t g,
+                                     uint8_t b) {
+  auto image = std::make_shared<my::RGBAImage>(w, h);
+  boost::gil::fill_pixels(boost::gil::view(*image),
+                          boost::gil::rgba8_pixel_t(r, g, b, 255));
+  return image;
+}
+
+boost::gil::rgba8_pixel_t pixel(my::RasterCanvas &canvas, int x, int y) {
+  return boost::gil::const_view(canvas.image())(x, y);
+}
+
+} // namespace
+
+TEST(ImageDataTest, readback_resolves_after_render) {
+  auto canvas = my::RasterCanvas::make(32, 32);
+  canvas->fill_rect({0, 0}, {16, 32}, {255, 0, 0, 255});
+
+  auto result = canvas->get_image_data(my::IPoint2D::Make(8, 8),
+                                       my::ISize2D::Make(16, 40));
+  EXPECT_EQ(result.wait_for(std::chrono::seconds(0)),
+            std::future_status::timeout);
+
+  canvas->render();
+  ASSERT_EQ(result.wait_for(std::chrono::seconds(0)),
+            std::future_status::ready);
+  auto image = result.get();
+  // clipped to the canvas
+  ASSERT_EQ(image->width(), 16);
+  ASSERT_EQ(image->height(), 24);
+  auto view = boost::gil::const_view(*image);
+  // the fill is anti-aliased across x = 16
+  EXPECT_EQ(view(6, 0)[0], 255);
+  EXPECT_EQ(view(10, 0)[0], 0);
+}
+
+TEST(ImageDataTest, readback_outside_is_empty) {
+  auto canvas = my::RasterCanvas::make(32, 32);
+  auto result = canvas->get_image_data(my::IPoint2D::Make(40, 0),
+                                       my::ISize2D::Make(8, 8));
+  canvas->render();
+  EXPECT_EQ(result.get()->width(), 0);
+  EXPECT_EQ(canvas->image_data_stats().readback_reads, 0u);
+}
+
+TEST(ImageDataTest, close_readbacks_share_one_read) {
+  auto canvas = my::RasterCanvas::make(64, 64);
+  canvas->put_image_data(solid(64, 64, 0, 0, 255), my::IPoint2D::Make(0, 0));
+  auto a = canvas->get_image_data(my::IPoint2D::Make(0, 0),
+                                  my::ISize2D::Make(16, 16));
+  auto b = canvas->get_image_data(my::IPoint2D::Make(16, 0),
+                                  my::ISize2D::Make(16, 16));
+  canvas->render();
+  EXPECT_EQ(canvas->image_data_stats().readbacks, 2u);
+  EXPECT_EQ(canvas->image_data_stats().readback_reads, 1u);
+  EXPECT_EQ(boost::gil::const_view(*a.get())(3, 3)[2], 255);
+  EXPECT_EQ(boost::gil::const_view(*b.get())(3, 3)[2], 255);
+
+  // far apart corners are read separately
+  a = canvas->get_image_data(my::IPoint2D::Make(0, 0),
+                             my::ISize2D::Make(4, 4));
+  b = canvas->get_image_data(my::IPoint2D::Make(60, 60),
+                             my::ISize2D::Make(4, 4));
+  canvas->render();
+  EXPECT_EQ(canvas->image_data_stats().readback_reads, 2u);
+  EXPECT_EQ(a.get()->width(), 4);
+  EXPECT_EQ(b.get()->width(), 4);
+}
+
+TEST(ImageDataTest, adjacent_uploads_are_coalesced) {
+  auto canvas = my::RasterCanvas::make(64, 64);
+  for (int y = 0; y < 4; ++y) {
+    for (int x = 0; x < 4; ++x) {
+      canvas->put_image_data(solid(16, 16, x * 60, y * 60, 0),
+                             my::IPoint2D::Make(x * 16, y * 16));
+    }
+  }
+  EXPECT_EQ(pixel(*canvas, 20, 40)[0], 0);
+  canvas->render();
+
+  EXPECT_EQ(canvas->image_data_stats().uploads, 16u);
+  EXPECT_EQ(canvas->image_data_stats().upload_writes, 1u);
+  for (int y = 0; y < 4; ++y) {
+    for (int x = 0; x < 4; ++x) {
+      auto p = pixel(*canvas, x * 16 + 5, y * 16 + 9);
+      EXPECT_EQ(p[0], x * 60) << x << "," << y;
+      EXPECT_EQ(p[1], y * 60) << x << "," << y;
+    }
+  }
+}
+
+TEST(ImageDataTest, overlapping_uploads_keep_their_order) {
+  auto canvas = my::RasterCanvas::make(32, 32);
+  // hidden by the next upload
+  canvas->put_image_data(solid(8, 8, 255, 0, 0), my::IPoint2D::Make(4, 4));
+  canvas->put_image_data(solid(16, 16, 0, 255, 0), my::IPoint2D::Make(0, 0));
+  canvas->put_image_data(solid(16, 16, 0, 0, 255), my::IPoint2D::Make(8, 8));
+  // clipped by the canvas edge
+  canvas->put_image_data(solid(16, 16, 255, 255, 0),
+                         my::IPoint2D::Make(24, -8));
+  canvas->render();
+
+  EXPECT_EQ(canvas->image_data_stats().upload_writes, 3u);
+  EXPECT_EQ(pixel(*canvas, 4, 4)[1], 255);
+  EXPECT_EQ(pixel(*canvas, 12, 12)[2], 255);
+  EXPECT_EQ(pixel(*canvas, 12, 12)[1], 0);
+  EXPECT_EQ(pixel(*canvas, 28, 0)[0], 255);
+  EXPECT_EQ(pixel(*canvas, 28, 0)[1], 255);
+}
+
+TEST(ImageDataTest, uploads_are_drawn_over) {
+  auto canvas = my::RasterCanvas::make(16, 16);
+  canvas->fill_rect({0, 0}, {8, 16}, {255, 0, 0, 255});
+  canvas->put_image_data(solid(16, 16, 0, 0, 255), my::IPoint2D::Make(0, 0));
+  canvas->render();
+  EXPECT_EQ(pixel(*canvas, 2, 2)[0], 255);
+  EXPECT_EQ(pixel(*canvas, 12, 2)[2], 255);
+}
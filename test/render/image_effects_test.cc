@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+
+#include <render/back/back2/image_effects.hpp>
+
+namespace {
+
+namespace gil = boost::gil;
+
+my::RGBAImage solid(int w, int h, gil::rgba8_pixel_t pixel) {
+  my::RGBAImage image(w, h);
+  gil::fill_pixels(gil::view(image), pixel);
+  return image;
+}
+
+// a white square of side pixels in the middle of a transparent image
+my::RGBAImage dot(int w, int h, int side = 1) {
+  auto image = solid(w, h, {0, 0, 0, 0});
+  gil::fill_pixels(gil::subimage_view(gil::view(image), (w - side) / 2,
+                                      (h - side) / 2, side, side),
+                   gil::rgba8_pixel_t(255, 255, 255, 255));
+  return image;
+}
+
+bool same(const my::RGBAImage &a, const my::RGBAImage &b) {
+  return gil::equal_pixels(gil::const_view(a), gil::const_view(b));
+}
+
+} // namespace
+
+TEST(ImageEffectsTest, premultiply_round_trips) {
+  my::ImageEffects effects({1});
+  auto image = solid(5, 3, {200, 100, 50, 128});
+  gil::view(image)(4, 2) = gil::rgba8_pixel_t(10, 20, 30, 0);
+  gil::view(image)(3, 2) = gil::rgba8_pixel_t(10, 20, 30, 255);
+
+  effects.apply(my::ImageEffect::premultiply(), gil::const_view(image),
+                gil::view(image));
+  auto view = gil::const_view(image);
+  EXPECT_EQ(view(0, 0), gil::rgba8_pixel_t(100, 50, 25, 128));
+  EXPECT_EQ(view(4, 2), gil::rgba8_pixel_t(0, 0, 0, 0));
+  EXPECT_EQ(view(3, 2), gil::rgba8_pixel_t(10, 20, 30, 255));
+
+  effects.apply(my::ImageEffect::unpremultiply(), gil::const_view(image),
+                gil::view(image));
+  EXPECT_EQ(view(0, 0), gil::rgba8_pixel_t(199, 100, 50, 128));
+  EXPECT_EQ(view(3, 2), gil::rgba8_pixel_t(10, 20, 30, 255));
+}
+
+TEST(ImageEffectsTest, color_matrix) {
+  my::ImageEffects effects({1});
+  auto image = solid(3, 3, {255, 0, 0, 200});
+  auto gray = image;
+  effects.apply(my::ImageEffect::color_matrix(my::ColorMatrix::saturation(0)),
+                gil::const_view(image), gil::view(gray));
+  // Rec. 709 luma of red, alpha kept
+  EXPECT_EQ(gil::const_view(gray)(1, 1), gil::rgba8_pixel_t(54, 54, 54, 200));
+
+  auto tinted = image;
+  effects.apply(my::ImageEffect::color_matrix(
+                    my::ColorMatrix::tint({0, 0, 255, 255}, 0.5f)),
+                gil::const_view(image), gil::view(tinted));
+  EXPECT_EQ(gil::const_view(tinted)(0, 0),
+            gil::rgba8_pixel_t(128, 0, 128, 200));
+
+  // the product applies both
+  auto both = image;
+  effects.apply(
+      my::ImageEffect::color_matrix(my::ColorMatrix::saturation(0) *
+                                    my::ColorMatrix::tint({0, 0, 255, 255},
+                                                          0.5f)),
+      gil::const_view(image), gil::view(both));
+  auto twice = tinted;
+  effects.apply(my::ImageEffect::color_matrix(my::ColorMatrix::saturation(0)),
+                gil::const_view(tinted), gil::view(twice));
+  auto a = gil::const_view(both)(0, 0);
+  auto b = gil::const_view(twice)(0, 0);
+  for (int ch = 0; ch < 4; ++ch) {
+    EXPECT_NEAR(a[ch], b[ch], 1);
+  }
+}
+
+TEST(ImageEffectsTest, blurs_spread_and_keep_flat_areas) {
+  my::ImageEffects effects({1});
+  // wide blurs fade a single pixel away in 8 bits
+  std::pair<my::ImageEffect, int> cases[] = {
+      {my::ImageEffect::box_blur(2), 1},
+      {my::ImageEffect::gaussian_blur(1.5f), 1},
+      {my::ImageEffect::gaussian_blur(12), 21}};
+  for (auto [effect, side] : cases) {
+    auto flat = solid(37, 29, {40, 80, 120, 200});
+    auto expected = flat;
+    effects.apply(effect, gil::const_view(flat), gil::view(flat));
+    EXPECT_TRUE(same(flat, expected));
+
+    auto image = dot(101, 101, side);
+    effects.apply(effect, gil::const_view(image), gil::view(image));
+    auto view = gil::const_view(image);
+    // spread evenly around the dot, brightest at its center
+    EXPECT_LT(view(50, 50)[3], 255);
+    EXPECT_GT(view(50 + side, 50)[3], 0);
+    EXPECT_EQ(view(49, 50), view(51, 50));
+    EXPECT_EQ(view(50, 49), view(50, 51));
+    EXPECT_EQ(view(48, 52), view(52, 48));
+    EXPECT_GE(view(50, 50)[3], view(51, 50)[3]);
+    EXPECT_EQ(view(0, 0)[3], 0);
+  }
+
+  // a box blur of radius 1 averages 3 x 3 pixels
+  auto image = dot(9, 9);
+  effects.apply(my::ImageEffect::box_blur(1), gil::const_view(image),
+                gil::view(image));
+  EXPECT_EQ(gil::const_view(image)(3, 3)[0], 28);
+  EXPECT_EQ(gil::const_view(image)(2, 2)[0], 0);
+}
+
+TEST(ImageEffectsTest, threads_give_the_same_pixels) {
+  auto source = solid(300, 200, {0, 0, 0, 255});
+  for (int y = 0; y < 200; ++y) {
+    for (int x = 0; x < 300; ++x) {
+      gil::view(source)(x, y) = gil::rgba8_pixel_t(
+          uint8_t(x * 7 + y), uint8_t(x ^ y), uint8_t(y * 3), 255);
+    }
+  }
+  my::Executor executor(4);
+  my::ImageEffects serial({1}, executor);
+  my::ImageEffects parallel({4}, executor);
+  for (auto effect : {my::ImageEffect::box_blur(5),
+                      my::ImageEffect::gaussian_blur(1.5f),
+                      my::ImageEffect::gaussian_blur(9),
+                      my::ImageEffect::premultiply()}) {
+    auto a = source;
+    auto b = source;
+    serial.apply(effect, gil::const_view(source), gil::view(a));
+    parallel.apply(effect, gil::const_view(source), gil::view(b));
+    EXPECT_TRUE(same(a, b));
+  }
+}
+
+TEST(ImageEffectsTest, caches_by_image_and_effects) {
+  my::ImageEffects effects({1, 2 * 64 * 64 * 4});
+  auto image = dot(64, 64);
+  auto id = my::uuid_gen();
+  std::vector<my::ImageEffect> blur{my::ImageEffect::premultiply(),
+                                    my::ImageEffect::gaussian_blur(2),
+                                    my::ImageEffect::unpremultiply()};
+
+  auto first = effects.apply(id, gil::const_view(image), blur);
+  EXPECT_EQ(effects.apply(id, gil::const_view(image), blur), first);
+  // the source is left alone
+  EXPECT_EQ(gil::const_view(image)(31, 32)[3], 0);
+  EXPECT_GT(gil::const_view(*first)(31, 32)[3], 0);
+
+  blur[1] = my::ImageEffect::gaussian_blur(3);
+  auto second = effects.apply(id, gil::const_view(image), blur);
+  EXPECT_NE(second, first);
+  auto stats = effects.stats();
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.misses, 2u);
+  EXPECT_EQ(stats.entries, 2u);
+
+  // over budget, the least recently used goes
+  effects.apply(my::uuid_gen(), gil::const_view(image), blur);
+  stats = effects.stats();
+  EXPECT_EQ(stats.evictions, 1u);
+  EXPECT_EQ(stats.entries, 2u);
+  EXPECT_EQ(stats.bytes, 2u * 64 * 64 * 4);
+  EXPECT_EQ(effects.apply(id, gil::const_view(image), blur), second);
+}
+
+TEST(ImageEffectsTest, instances_add_up_in_the_bytes_metric) {
+  auto &metric = my::Metrics::get()->gauge("render.effect_bytes");
+  auto before = metric.value();
+  auto image = dot(16, 16);
+  std::vector<my::ImageEffect> premultiply{my::ImageEffect::premultiply()};
+  {
+    my::ImageEffects a({1});
+    my::ImageEffects b({1});
+    a.apply(my::uuid_gen(), gil::const_view(image), premultiply);
+    b.apply(my::uuid_gen(), gil::const_view(image), premultiply);
+    EXPECT_EQ(metric.value(), before + 2 * 16 * 16 * 4);
+    a.clear();
+    EXPECT_EQ(metric.value(), before + 16 * 16 * 4);
+  }
+  EXPECT_EQ(metric.value(), before);
+}
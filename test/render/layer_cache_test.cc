@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+
+#include <render/layer_cache.hpp>
+
+namespace {
+
+class CountingView : public my::NodeView {
+public:
+  static my::shared_ptr<CountingView> make(my::IRect const &rect,
+                                           bool cached = false) {
+    auto view = my::shared_ptr<CountingView>(new CountingView());
+    view->rect(rect);
+    view->cached(cached);
+    return view;
+  }
+
+  void paint(SkCanvas &) override { ++this->paints; }
+
+  int paints{0};
+};
+
+struct LayerCacheTest : public ::testing::Test {
+  sk_sp<SkSurface> surface{SkSurface::MakeRasterN32Premul(200, 200)};
+  my::LayerCache cache;
+
+  my::LayerStats const &frame(my::Node &root) {
+    this->cache.draw(*this->surface->getCanvas(), root);
+    return this->cache.frame_stats();
+  }
+};
+
+} // namespace
+
+TEST_F(LayerCacheTest, redraws_only_changed_layers) {
+  auto root = CountingView::make(my::IRect::MakeWH(200, 200));
+  auto layer = CountingView::make(my::IRect::MakeXYWH(10, 10, 50, 50), true);
+  auto content = CountingView::make(my::IRect::MakeXYWH(5, 5, 10, 10));
+  root->append_child(layer);
+  layer->append_child(content);
+
+  EXPECT_EQ(this->frame(*root).misses, 1);
+  EXPECT_EQ(this->frame(*root).hits, 1);
+  EXPECT_EQ(root->paints, 2);
+  EXPECT_EQ(layer->paints, 1);
+  EXPECT_EQ(content->paints, 1);
+  EXPECT_EQ(this->cache.bytes(), 50 * 50 * 4);
+
+  // moving the layer composites it elsewhere
+  layer->rect(my::IRect::MakeXYWH(100, 100, 50, 50));
+  EXPECT_EQ(this->frame(*root).hits, 1);
+  EXPECT_EQ(layer->paints, 1);
+
+  content->invalidate();
+  EXPECT_EQ(this->frame(*root).misses, 1);
+  EXPECT_EQ(layer->paints, 2);
+  EXPECT_EQ(content->paints, 2);
+
+  layer->append_child(CountingView::make(my::IRect::MakeWH(5, 5)));
+  EXPECT_EQ(this->frame(*root).misses, 1);
+
+  layer->rect(my::IRect::MakeXYWH(100, 100, 60, 60));
+  EXPECT_EQ(this->frame(*root).misses, 1);
+  EXPECT_EQ(this->cache.bytes(), 60 * 60 * 4);
+  EXPECT_EQ(layer->paints, 4);
+}
+
+TEST_F(LayerCacheTest, nested_layers) {
+  auto root = CountingView::make(my::IRect::MakeWH(200, 200));
+  auto outer = CountingView::make(my::IRect::MakeWH(100, 100), true);
+  auto inner = CountingView::make(my::IRect::MakeWH(20, 20), true);
+  root->append_child(outer);
+  outer->append_child(inner);
+
+  EXPECT_EQ(this->frame(*root).misses, 2);
+
+  outer->invalidate();
+  auto stats = this->frame(*root);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(inner->paints, 1);
+
+  inner->invalidate();
+  EXPECT_EQ(this->frame(*root).misses, 2);
+  EXPECT_EQ(outer->paints, 3);
+  EXPECT_EQ(inner->paints, 2);
+}
+
+TEST_F(LayerCacheTest, layers_stay_in_budget) {
+  this->cache.budget(2 * 10 * 10 * 4);
+  auto root = CountingView::make(my::IRect::MakeWH(200, 200));
+  std::vector<my::shared_ptr<CountingView>> layers;
+  for (int i = 0; i < 3; ++i) {
+    layers.push_back(
+        CountingView::make(my::IRect::MakeXYWH(i * 10, 0, 10, 10), true));
+    root->append_child(layers.back());
+  }
+
+  auto stats = this->frame(*root);
+  EXPECT_EQ(stats.misses, 2);
+  EXPECT_EQ(stats.uncached, 1);
+  EXPECT_EQ(stats.bytes, 2 * 10 * 10 * 4);
+  for (auto &layer : layers) {
+    EXPECT_EQ(layer->paints, 1);
+  }
+
+  // a layer unused by the frame makes room
+  layers[0]->detach();
+  stats = this->frame(*root);
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.evictions, 1);
+
+  this->cache.budget(10 * 10 * 4);
+  EXPECT_EQ(this->cache.size(), 1);
+}
+
+TEST_F(LayerCacheTest, idle_layers_are_dropped) {
+  auto root = CountingView::make(my::IRect::MakeWH(200, 200));
+  auto layer = CountingView::make(my::IRect::MakeWH(10, 10), true);
+  root->append_child(layer);
+  this->frame(*root);
+  EXPECT_EQ(this->cache.size(), 1);
+
+  layer->detach();
+  for (uint64_t i = 0; i < my::LayerCache::kIdleFrames; ++i) {
+    this->frame(*root);
+  }
+  EXPECT_EQ(this->cache.size(), 1);
+  EXPECT_EQ(this->frame(*root).evictions, 1);
+  EXPECT_EQ(this->cache.size(), 0);
+}
+
+TEST_F(LayerCacheTest, metrics_are_kept_per_prefix) {
+  auto &bytes = my::Metrics::get()->gauge("test.layer_bytes");
+  auto &hits = my::Metrics::get()->counter("test.layer_hits");
+  auto root = CountingView::make(my::IRect::MakeWH(200, 200));
+  root->append_child(CountingView::make(my::IRect::MakeWH(10, 10), true));
+  {
+    my::LayerCache a(64 << 20, "test.layer");
+    my::LayerCache b(64 << 20, "test.layer");
+    a.draw(*this->surface->getCanvas(), *root);
+    b.draw(*this->surface->getCanvas(), *root);
+    b.draw(*this->surface->getCanvas(), *root);
+    EXPECT_EQ(bytes.value(), 2 * 10 * 10 * 4);
+    EXPECT_EQ(hits.value(), 1u);
+
+    b.clear();
+    EXPECT_EQ(bytes.value(), 10 * 10 * 4);
+    // the default cache publishes elsewhere
+    this->frame(*root);
+    EXPECT_EQ(bytes.value(), 10 * 10 * 4);
+  }
+  EXPECT_EQ(bytes.value(), 0);
+}
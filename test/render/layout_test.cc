@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+
+#include <render/layout.hpp>
+#include <render/node_view.hpp>
+
+namespace {
+
+using my::FlexAlign;
+using my::FlexDirection;
+using my::FlexJustify;
+using my::IRect;
+using my::LayoutStyle;
+
+class Label : public my::NodeView {
+public:
+  static my::shared_ptr<Label> make(int32_t width, int32_t height,
+                                    LayoutStyle const &style = {}) {
+    auto label = my::shared_ptr<Label>(new Label());
+    label->layout_style(style);
+    label->text(width, height);
+    return label;
+  }
+
+  // stands for setting a text of that size
+  void text(int32_t width, int32_t height) {
+    this->_text = my::ISize2D::Make(width, height);
+    this->invalidate();
+  }
+
+  my::ISize2D measure(int32_t max_width, int32_t) override {
+    ++this->measures;
+    return my::ISize2D::Make(std::min(this->_text.width(), max_width),
+                             this->_text.height());
+  }
+
+  int measures{0};
+
+private:
+  my::ISize2D _text{0, 0};
+};
+
+my::shared_ptr<my::NodeView> box(LayoutStyle const &style) {
+  auto view = my::NodeView::make();
+  view->layout_style(style);
+  return view;
+}
+
+LayoutStyle row() {
+  LayoutStyle style;
+  style.direction = FlexDirection::kRow;
+  return style;
+}
+
+} // namespace
+
+TEST(LayoutTest, row_grows_and_stretches) {
+  auto style = row();
+  style.padding = my::Edges::all(10);
+  style.gap = 5;
+  auto root = box(style);
+
+  LayoutStyle fixed;
+  fixed.width = 50;
+  LayoutStyle grow_1, grow_2;
+  grow_1.grow = 1;
+  grow_2.grow = 2;
+  auto a = box(fixed);
+  auto b = box(grow_1);
+  auto c = box(grow_2);
+  root->append_child(a);
+  root->append_child(b);
+  root->append_child(c);
+
+  my::FlexLayout layout;
+  layout.compute(*root, my::ISize2D::Make(300, 100));
+  EXPECT_EQ(root->rect(), IRect::MakeWH(300, 100));
+  EXPECT_EQ(a->rect(), IRect::MakeXYWH(10, 10, 50, 80));
+  EXPECT_EQ(b->rect(), IRect::MakeXYWH(65, 10, 73, 80));
+  EXPECT_EQ(c->rect(), IRect::MakeXYWH(143, 10, 147, 80));
+}
+
+TEST(LayoutTest, children_shrink_by_their_basis) {
+  auto root = box(row());
+  LayoutStyle wide, wider;
+  wide.width = 100;
+  wider.width = 300;
+  auto a = box(wide);
+  auto b = box(wider);
+  root->append_child(a);
+  root->append_child(b);
+
+  my::FlexLayout layout;
+  layout.compute(*root, my::ISize2D::Make(200, 10));
+  EXPECT_EQ(a->rect(), IRect::MakeXYWH(0, 0, 50, 10));
+  EXPECT_EQ(b->rect(), IRect::MakeXYWH(50, 0, 150, 10));
+
+  // min sizes win over shrinking
+  wider.min_width = 200;
+  b->layout_style(wider);
+  layout.compute(*root, my::ISize2D::Make(200, 10));
+  EXPECT_EQ(b->rect().width(), 200);
+}
+
+TEST(LayoutTest, content_sizes_and_alignment) {
+  LayoutStyle column;
+  column.justify = FlexJustify::kCenter;
+  column.align = FlexAlign::kCenter;
+  auto root = box(column);
+
+  // a row sized by its labels and their margins
+  auto line_style = row();
+  line_style.align = FlexAlign::kEnd;
+  auto line = box(line_style);
+  LayoutStyle spaced;
+  spaced.margin = {2, 0, 2, 0};
+  line->append_child(Label::make(40, 10, spaced));
+  line->append_child(Label::make(20, 16, spaced));
+  root->append_child(line);
+
+  LayoutStyle capped;
+  capped.max_width = 30;
+  auto long_label = Label::make(100, 12, capped);
+  root->append_child(long_label);
+
+  my::FlexLayout layout;
+  layout.compute(*root, my::ISize2D::Make(200, 100));
+  // 40 + 20 wide plus margins, centered in 200
+  EXPECT_EQ(line->rect(), IRect::MakeXYWH(66, 36, 68, 16));
+  EXPECT_EQ(my::Node::from(*line->store(),
+                           line->store()->first_child(line->handle()))
+                ->rect(),
+            IRect::MakeXYWH(2, 6, 40, 10));
+  EXPECT_EQ(long_label->rect(), IRect::MakeXYWH(85, 52, 30, 12));
+}
+
+TEST(LayoutTest, space_between) {
+  auto style = row();
+  style.justify = FlexJustify::kSpaceBetween;
+  auto root = box(style);
+  LayoutStyle fixed;
+  fixed.width = 10;
+  auto a = box(fixed);
+  auto b = box(fixed);
+  auto c = box(fixed);
+  root->append_child(a);
+  root->append_child(b);
+  root->append_child(c);
+
+  my::FlexLayout layout;
+  layout.compute(*root, my::ISize2D::Make(110, 10));
+  EXPECT_EQ(a->rect().left(), 0);
+  EXPECT_EQ(b->rect().left(), 50);
+  EXPECT_EQ(c->rect().left(), 100);
+}
+
+TEST(LayoutTest, only_changed_subtrees_are_laid_out_again) {
+  auto root = box({});
+  std::vector<my::shared_ptr<Label>> labels;
+  for (int i = 0; i < 10; ++i) {
+    auto line = box(row());
+    for (int j = 0; j < 10; ++j) {
+      labels.push_back(Label::make(10, 10));
+      line->append_child(labels.back());
+    }
+    root->append_child(line);
+  }
+
+  my::FlexLayout layout;
+  layout.compute(*root, my::ISize2D::Make(200, 200));
+  EXPECT_EQ(layout.stats().laid_out, 111);
+  auto untouched = labels[10]->measures;
+
+  layout.compute(*root, my::ISize2D::Make(200, 200));
+  EXPECT_EQ(layout.stats().laid_out, 0);
+  EXPECT_EQ(layout.stats().measured, 0);
+
+  // one label: its line and the root
+  auto measures = labels[0]->measures;
+  labels[0]->text(30, 10);
+  layout.compute(*root, my::ISize2D::Make(200, 200));
+  EXPECT_EQ(layout.stats().laid_out, 3);
+  EXPECT_GT(labels[0]->measures, measures);
+  EXPECT_EQ(labels[0]->rect().width(), 30);
+  EXPECT_EQ(labels[1]->rect().left(), 30);
+  EXPECT_EQ(labels[10]->measures, untouched);
+
+  // a wider window stretches the lines, the labels keep their sizes
+  layout.compute(*root, my::ISize2D::Make(300, 200));
+  EXPECT_EQ(layout.stats().laid_out, 11);
+  EXPECT_EQ(labels[10]->measures, untouched);
+}
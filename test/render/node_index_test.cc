@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include <render/node_index.hpp>
+
+namespace {
+
+// the topmost node at p by walking the whole tree
+my::NodeHandle brute_hit(my::NodeStore const &store, my::NodeHandle node,
+                         my::Matrix const &parent_world,
+                         my::IRect const &clip, my::Point2D p) {
+  auto world = my::Matrix::Concat(parent_world, store.local_transform(node));
+  auto const &rect = store.rect(node);
+  auto child_clip = clip;
+  my::NodeHandle hit;
+  if (!rect.isEmpty()) {
+    child_clip = world
+                     .mapRect(my::Rect::MakeWH(float(rect.width()),
+                                               float(rect.height())))
+                     .roundOut();
+    if (!child_clip.intersect(clip)) {
+      return {};
+    }
+    my::Matrix inverse;
+    world.invert(&inverse);
+    auto local = inverse.mapXY(p.x(), p.y());
+    if (child_clip.contains(int32_t(p.x()), int32_t(p.y())) &&
+        local.x() >= 0 && local.y() >= 0 && local.x() < rect.width() &&
+        local.y() < rect.height()) {
+      hit = node;
+    }
+  }
+  for (auto child = store.first_child(node); child;
+       child = store.next_sibling(child)) {
+    if (auto h = brute_hit(store, child, world, child_clip, p)) {
+      hit = h;
+    }
+  }
+  return hit;
+}
+
+// nodes with visible bounds
+size_t visible(my::NodeStore const &store, my::NodeHandle node,
+               my::Matrix const &parent_world, my::IRect const &clip) {
+  auto world = my::Matrix::Concat(parent_world, store.local_transform(node));
+  auto const &rect = store.rect(node);
+  auto child_clip = clip;
+  size_t n = 0;
+  if (!rect.isEmpty()) {
+    child_clip = world
+                     .mapRect(my::Rect::MakeWH(float(rect.width()),
+                                               float(rect.height())))
+                     .roundOut();
+    if (!child_clip.intersect(clip)) {
+      return 0;
+    }
+    n = 1;
+  }
+  for (auto child = store.first_child(node); child;
+       child = store.next_sibling(child)) {
+    n += visible(store, child, world, child_clip);
+  }
+  return n;
+}
+
+my::NodeHandle hit(my::NodeIndex const &index, float x, float y) {
+  auto h = index.hit_test({x, y});
+  return h ? h->node : my::NodeHandle{};
+}
+
+struct NodeIndexTest : public ::testing::Test {
+  my::NodeStore store;
+  my::NodeIndex index{16};
+  my::NodeHandle root{store.create()};
+
+  my::NodeHandle add(my::NodeHandle parent, my::IRect const &rect) {
+    auto node = this->store.create();
+    this->store.rect(node, rect);
+    this->store.append_child(parent, node);
+    return node;
+  }
+
+  void SetUp() override {
+    this->store.rect(this->root, my::IRect::MakeWH(400, 300));
+  }
+};
+
+} // namespace
+
+TEST_F(NodeIndexTest, topmost_node_wins) {
+  auto a = this->add(root, my::IRect::MakeXYWH(10, 10, 100, 100));
+  auto b = this->add(a, my::IRect::MakeXYWH(20, 20, 30, 30));
+  auto c = this->add(root, my::IRect::MakeXYWH(50, 50, 100, 100));
+  this->index.sync(this->store, this->root);
+  EXPECT_EQ(this->index.size(), 4);
+
+  auto h = this->index.hit_test({15, 16});
+  ASSERT_TRUE(h);
+  EXPECT_EQ(h->node, a);
+  EXPECT_FLOAT_EQ(h->local.x(), 5);
+  EXPECT_FLOAT_EQ(h->local.y(), 6);
+
+  EXPECT_EQ(hit(this->index, 35, 35), b);
+  // a later sibling is drawn over the subtree of an earlier one
+  EXPECT_EQ(hit(this->index, 55, 55), c);
+  EXPECT_EQ(hit(this->index, 5, 5), this->root);
+  EXPECT_EQ(hit(this->index, 500, 5), my::NodeHandle{});
+}
+
+TEST_F(NodeIndexTest, children_are_clipped) {
+  auto a = this->add(root, my::IRect::MakeXYWH(10, 10, 100, 100));
+  auto d = this->add(a, my::IRect::MakeXYWH(90, 90, 50, 50));
+  this->index.sync(this->store, this->root);
+
+  EXPECT_EQ(hit(this->index, 105, 105), d);
+  EXPECT_EQ(hit(this->index, 120, 120), this->root);
+  EXPECT_EQ(this->index.bounds(d), my::IRect::MakeLTRB(100, 100, 110, 110));
+}
+
+TEST_F(NodeIndexTest, changes_show_after_sync) {
+  auto a = this->add(root, my::IRect::MakeXYWH(10, 10, 100, 100));
+  auto b = this->add(a, my::IRect::MakeXYWH(0, 0, 10, 10));
+  this->index.sync(this->store, this->root);
+
+  this->store.rect(a, my::IRect::MakeXYWH(200, 100, 100, 100));
+  EXPECT_EQ(hit(this->index, 25, 25), a);
+  this->index.sync(this->store, this->root);
+  EXPECT_EQ(hit(this->index, 25, 25), this->root);
+  EXPECT_EQ(hit(this->index, 205, 105), b);
+
+  this->store.transform(a, my::Matrix::Scale(2, 2));
+  this->index.sync(this->store, this->root);
+  EXPECT_EQ(hit(this->index, 215, 115), b);
+  EXPECT_EQ(this->index.hit_test({215, 115})->local.x(), 7.5f);
+
+  // destroyed nodes never hit, detached ones once synced
+  this->store.destroy(b);
+  EXPECT_EQ(hit(this->index, 205, 105), a);
+  this->store.detach(a);
+  this->index.sync(this->store, this->root);
+  EXPECT_EQ(hit(this->index, 250, 150), this->root);
+  EXPECT_EQ(this->index.size(), 1);
+}
+
+TEST_F(NodeIndexTest, hover_reports_changes) {
+  auto a = this->add(root, my::IRect::MakeXYWH(10, 10, 100, 100));
+  this->index.sync(this->store, this->root);
+
+  EXPECT_TRUE(this->index.hover({20, 20}));
+  EXPECT_EQ(this->index.hovered(), a);
+  EXPECT_FALSE(this->index.hover({30, 30}));
+  EXPECT_TRUE(this->index.hover({5, 5}));
+  EXPECT_EQ(this->index.hovered(), this->root);
+
+  this->index.hover({20, 20});
+  this->store.destroy(a);
+  this->index.sync(this->store, this->root);
+  EXPECT_EQ(this->index.hovered(), my::NodeHandle{});
+}
+
+TEST_F(NodeIndexTest, matches_a_full_walk) {
+  std::mt19937 rng(7);
+  auto coord = [&rng](int n) {
+    return std::uniform_int_distribution<int>(0, n - 1)(rng);
+  };
+  std::vector<my::NodeHandle> nodes{this->root};
+  auto random_rect = [&]() {
+    return my::IRect::MakeXYWH(coord(300) - 50, coord(250) - 50,
+                               coord(120) + 1, coord(120) + 1);
+  };
+  for (int i = 0; i < 200; ++i) {
+    nodes.push_back(this->add(nodes[coord(int(nodes.size()))], random_rect()));
+  }
+
+  for (int round = 0; round < 30; ++round) {
+    for (int op = 0; op < 20; ++op) {
+      auto node = nodes[1 + coord(int(nodes.size()) - 1)];
+      if (!this->store.valid(node)) {
+        continue;
+      }
+      switch (coord(5)) {
+      case 0:
+        this->store.rect(node, random_rect());
+        break;
+      case 1:
+        this->store.transform(node, my::Matrix::Scale(0.5f + coord(3), 1));
+        break;
+      case 2: {
+        auto parent = nodes[coord(int(nodes.size()))];
+        if (this->store.valid(parent) && parent != node &&
+            !this->store.is_ancestor(node, parent)) {
+          this->store.append_child(parent, node);
+        }
+        break;
+      }
+      case 3:
+        this->store.destroy(node);
+        break;
+      default:
+        nodes.push_back(this->add(this->root, random_rect()));
+      }
+    }
+    this->index.sync(this->store, this->root);
+    ASSERT_EQ(this->index.size(),
+              visible(this->store, this->root, my::Matrix::I(),
+                      my::IRect::MakeWH(400, 300)));
+
+    for (int i = 0; i < 200; ++i) {
+      my::Point2D p{coord(400) + 0.5f, coord(300) + 0.5f};
+      ASSERT_EQ(hit(this->index, p.x(), p.y()),
+                brute_hit(this->store, this->root, my::Matrix::I(),
+                          my::IRect::MakeWH(400, 300), p))
+          << "round " << round << " at " << p.x() << ", " << p.y();
+    }
+  }
+}
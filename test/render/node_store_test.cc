@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <render/node_store.hpp>
+
+TEST(NodeStoreTest, stale_handles_are_detected) {
+  my::NodeStore store;
+  auto root = store.create();
+  auto child = store.create();
+  store.append_child(root, child);
+  store.destroy(child);
+  EXPECT_FALSE(store.valid(child));
+  EXPECT_THROW(store.rect(child), my::NodeError);
+
+  // the slot is reused with a new generation
+  auto reused = store.create();
+  EXPECT_EQ(reused.index, child.index);
+  EXPECT_NE(reused, child);
+  EXPECT_FALSE(store.first_child(root));
+  EXPECT_EQ(store.size(), 2);
+}
+
+TEST(NodeStoreTest, destroy_frees_the_subtree) {
+  my::NodeStore store;
+  auto root = store.create();
+  auto a = store.create();
+  auto b = store.create();
+  auto c = store.create();
+  store.append_child(root, a);
+  store.append_child(a, b);
+  store.append_child(root, c);
+
+  store.destroy(a);
+  EXPECT_FALSE(store.valid(b));
+  EXPECT_EQ(store.first_child(root), c);
+  EXPECT_FALSE(store.prev_sibling(c));
+  EXPECT_EQ(store.size(), 2);
+}
+
+TEST(NodeStoreTest, world_transforms_follow_the_hierarchy) {
+  my::NodeStore store;
+  auto root = store.create();
+  auto child = store.create();
+  auto grandchild = store.create();
+  store.append_child(root, child);
+  store.append_child(child, grandchild);
+  store.transform(root, my::Matrix::Translate(10, 0));
+  store.transform(child, my::Matrix::Translate(0, 5));
+  store.transform(grandchild, my::Matrix::Translate(1, 1));
+
+  store.update_world_transforms(root);
+  EXPECT_EQ(store.world_transform(grandchild), my::Matrix::Translate(11, 6));
+
+  store.transform(child, my::Matrix::I());
+  store.update_world_transforms(child);
+  EXPECT_EQ(store.world_transform(grandchild), my::Matrix::Translate(11, 1));
+
+  // a rect offsets the node's local space
+  store.rect(child, my::IRect::MakeXYWH(100, 200, 10, 10));
+  store.update_world_transforms(root);
+  EXPECT_EQ(store.world_transform(grandchild),
+            my::Matrix::Translate(111, 201));
+}
+
+TEST(NodeStoreTest, traversal_orders) {
+  my::NodeStore store;
+  std::vector<my::NodeHandle> n;
+  for (int i = 0; i < 6; ++i) {
+    n.push_back(store.create());
+  }
+  // 0 -> (1 -> (3, 4), 2 -> (5))
+  store.append_child(n[0], n[1]);
+  store.append_child(n[0], n[2]);
+  store.append_child(n[1], n[3]);
+  store.append_child(n[1], n[4]);
+  store.append_child(n[2], n[5]);
+
+  std::vector<uint32_t> pre, post;
+  store.pre_order(n[0], [&pre](my::NodeHandle h) { pre.push_back(h.index); });
+  store.post_order(n[0],
+                   [&post](my::NodeHandle h) { post.push_back(h.index); });
+  EXPECT_EQ(pre, (std::vector<uint32_t>{0, 1, 3, 4, 2, 5}));
+  EXPECT_EQ(post, (std::vector<uint32_t>{3, 4, 1, 5, 2, 0}));
+
+  // a subtree traversal stays inside it
+  pre.clear();
+  store.pre_order(n[1], [&pre](my::NodeHandle h) { pre.push_back(h.index); });
+  EXPECT_EQ(pre, (std::vector<uint32_t>{1, 3, 4}));
+}
+
+TEST(NodeStoreTest, versions_follow_changes) {
+  my::NodeStore store;
+  auto root = store.create();
+  auto a = store.create();
+  auto b = store.create();
+  store.append_child(root, a);
+  store.append_child(a, b);
+
+  auto versions = [&]() {
+    return std::vector<uint64_t>{store.version(root), store.version(a),
+                                 store.version(b)};
+  };
+  auto before = versions();
+
+  // touching a node changes it and its ancestors
+  store.touch(b);
+  auto after = versions();
+  EXPECT_NE(after[0], before[0]);
+  EXPECT_NE(after[1], before[1]);
+  EXPECT_NE(after[2], before[2]);
+
+  // moving a node changes its parent, not the node
+  before = after;
+  store.rect(b, my::IRect::MakeXYWH(1, 1, 2, 2));
+  after = versions();
+  EXPECT_NE(after[1], before[1]);
+  EXPECT_EQ(after[2], before[2]);
+
+  // setting an unchanged value changes nothing
+  before = after;
+  store.rect(b, my::IRect::MakeXYWH(1, 1, 2, 2));
+  EXPECT_EQ(versions(), before);
+
+  store.detach(b);
+  after = versions();
+  EXPECT_NE(after[0], before[0]);
+  EXPECT_EQ(after[2], before[2]);
+}
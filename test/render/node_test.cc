@@ -2,6 +2,23 @@
 
 #include <render/node.hpp>
 
+namespace {
+
+std::string names(my::shared_ptr<my::Node> const &root, bool pre_order) {
+  std::string s;
+  auto add = [&s](my::shared_ptr<my::Node> const &node) {
+    s += std::string(node->depth(), ' ') + node->name() + ";";
+  };
+  if (pre_order) {
+    root->pre_order(add);
+  } else {
+    root->post_order(add);
+  }
+  return s;
+}
+
+} // namespace
+
 TEST(RenderNodeTest, node_build) {
 
   auto root = my::Node::make_root("head");
@@ -30,9 +47,61 @@ TEST(RenderNodeTest, node_build) {
     }
   }
 
-  root->post_order([](my::shared_ptr<my::Node> const &node) {
-    for (int i = 0; i < node->depth(); ++i)
-      std::cout << " ";
-    std::cout << node->name() << std::endl;
-  });
+  EXPECT_EQ(names(root, true), "head; 1; 2; 3;  3-1;  3-2;  3-3; 4;  4-1;"
+                               "   4-1-1;   4-1-2;");
+  EXPECT_EQ(names(root, false), " 1; 2;  3-1;  3-2;  3-3; 3;   4-1-1;"
+                                "   4-1-2;  4-1; 4;head;");
+  EXPECT_EQ(root->store()->size(), 11);
+}
+
+TEST(RenderNodeTest, subtrees_built_apart_move_into_the_tree) {
+  auto root = my::Node::make_root("root");
+  auto branch = my::Node::make("branch");
+  auto leaf = my::Node::make("leaf");
+  branch->append_child(leaf);
+  leaf->rect(my::IRect::MakeXYWH(1, 2, 3, 4));
+
+  root->append_child(branch);
+  EXPECT_EQ(branch->store(), root->store());
+  EXPECT_EQ(leaf->parent(), branch);
+  EXPECT_EQ(leaf->root(), root);
+  EXPECT_EQ(leaf->depth(), 2);
+  EXPECT_EQ(leaf->rect(), my::IRect::MakeXYWH(1, 2, 3, 4));
+  EXPECT_FALSE(branch->is_root());
+}
+
+TEST(RenderNodeTest, reparent_and_detach) {
+  auto root = my::Node::make_root("root");
+  auto a = my::Node::make("a");
+  auto b = my::Node::make("b");
+  root->append_child(a);
+  root->append_child(b);
+  a->append_child(my::Node::make("a-1"));
+
+  b->append_child(a);
+  EXPECT_EQ(names(root, true), "root; b;  a;   a-1;");
+  EXPECT_THROW(a->append_child(root), my::NodeError);
+  EXPECT_THROW(a->append_child(b), my::NodeError);
+
+  a->detach();
+  EXPECT_TRUE(a->is_root());
+  EXPECT_EQ(names(root, true), "root; b;");
+  EXPECT_EQ(names(a, true), "a; a-1;");
+  EXPECT_EQ(root->store()->size(), 2);
+}
+
+TEST(RenderNodeTest, dropping_the_root_detaches_held_nodes) {
+  std::weak_ptr<my::Node> unheld;
+  auto held = my::Node::make("held");
+  {
+    auto root = my::Node::make_root("root");
+    root->append_child(held);
+    auto other = my::Node::make("other");
+    unheld = other;
+    root->append_child(other);
+  }
+  EXPECT_TRUE(unheld.expired());
+  EXPECT_TRUE(held->is_root());
+  EXPECT_EQ(held->store(), nullptr);
+  EXPECT_EQ(held->parent(), nullptr);
 }
@@ -0,0 +1,328 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include <render/back/back2/path_tessellator.hpp>
+
+namespace {
+
+const my::ColorRGBAub kWhite{255, 255, 255, 255};
+
+struct Mesh {
+  std::vector<my::DrawVert> vtx;
+  std::vector<uint32_t> idx;
+
+  size_t triangles() const { return this->idx.size() / 3; }
+
+  // sum of the triangle areas, the covered area when none overlap
+  float area() const {
+    float sum = 0.0f;
+    for (size_t i = 0; i + 2 < this->idx.size(); i += 3) {
+      sum += std::abs(cross(this->vtx[this->idx[i]].pos,
+                            this->vtx[this->idx[i + 1]].pos,
+                            this->vtx[this->idx[i + 2]].pos)) /
+             2.0f;
+    }
+    return sum;
+  }
+
+  bool covers(glm::vec2 p) const {
+    for (size_t i = 0; i + 2 < this->idx.size(); i += 3) {
+      auto a = this->vtx[this->idx[i]].pos;
+      auto b = this->vtx[this->idx[i + 1]].pos;
+      auto c = this->vtx[this->idx[i + 2]].pos;
+      auto d0 = cross(a, b, p);
+      auto d1 = cross(b, c, p);
+      auto d2 = cross(c, a, p);
+      if ((d0 >= 0 && d1 >= 0 && d2 >= 0) ||
+          (d0 <= 0 && d1 <= 0 && d2 <= 0)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // alpha of p blended over transparent, in 0..1, and the number of
+  // triangles drawn there
+  float alpha(glm::vec2 p, int *layers = nullptr) const {
+    float dst = 0.0f;
+    int count = 0;
+    for (size_t i = 0; i + 2 < this->idx.size(); i += 3) {
+      auto const &a = this->vtx[this->idx[i]];
+      auto const &b = this->vtx[this->idx[i + 1]];
+      auto const &c = this->vtx[this->idx[i + 2]];
+      auto area = cross(a.pos, b.pos, c.pos);
+      if (area == 0.0f) {
+        continue;
+      }
+      auto wa = cross(b.pos, c.pos, p) / area;
+      auto wb = cross(c.pos, a.pos, p) / area;
+      auto wc = 1.0f - wa - wb;
+      if (wa < 0.0f || wb < 0.0f || wc < 0.0f) {
+        continue;
+      }
+      auto src = (wa * a.col.a + wb * b.col.a + wc * c.col.a) / 255.0f;
+      dst = src + dst * (1.0f - src);
+      ++count;
+    }
+    if (layers) {
+      *layers = count;
+    }
+    return dst;
+  }
+
+  static float cross(glm::vec2 a, glm::vec2 b, glm::vec2 c) {
+    return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+  }
+};
+
+// without anti-aliasing every triangle is opaque geometry
+my::PathTessellator make_tessellator(float tolerance = 0.25f,
+                                     float aa_width = 0.0f) {
+  my::PathTessellator::Options options;
+  options.tolerance = tolerance;
+  options.aa_width = aa_width;
+  return my::PathTessellator(options);
+}
+
+Mesh fill(my::DrawPath const &path, my::FillRule rule,
+          float tolerance = 0.25f) {
+  Mesh mesh;
+  make_tessellator(tolerance).fill(path, kWhite, rule, mesh.vtx, mesh.idx);
+  return mesh;
+}
+
+Mesh fill_aa(my::DrawPath const &path, my::FillRule rule,
+             my::ColorRGBAub const &col) {
+  Mesh mesh;
+  make_tessellator(0.25f, 1.0f).fill(path, col, rule, mesh.vtx, mesh.idx);
+  return mesh;
+}
+
+Mesh stroke(my::DrawPath const &path, my::StrokeStyle const &style) {
+  Mesh mesh;
+  make_tessellator().stroke(path, kWhite, style, mesh.vtx, mesh.idx);
+  return mesh;
+}
+
+// an L with its corner at (50, 0), the outer side of the join up right
+my::DrawPath corner() {
+  my::DrawPath path({0.0f, 0.0f});
+  path.line_to({50.0f, 0.0f}).line_to({50.0f, 50.0f});
+  return path;
+}
+
+my::DrawPath segment() {
+  my::DrawPath path({10.0f, 50.0f});
+  path.line_to({90.0f, 50.0f});
+  return path;
+}
+
+my::StrokeStyle style(my::LineJoin join, my::LineCap cap) {
+  my::StrokeStyle s;
+  s.width = 10.0f;
+  s.join = join;
+  s.cap = cap;
+  return s;
+}
+
+} // namespace
+
+TEST(PathTessellatorTest, curves_stay_within_the_tolerance) {
+  constexpr float kRadius = 50.0f;
+  const float exact = float(M_PI) * kRadius * kRadius;
+  size_t last_vertices = 0;
+  for (float tolerance : {1.0f, 0.25f, 0.05f}) {
+    my::DrawPath circle({150.0f, 100.0f});
+    circle.arc({100.0f, 100.0f}, kRadius, 0.0f, float(2 * M_PI)).close();
+    auto mesh = fill(circle, my::FillRule::kNonZero, tolerance);
+
+    // the polyline is inscribed, it loses at most a band of the tolerance
+    // along the outline
+    EXPECT_LE(mesh.area(), exact + 1.0f) << tolerance;
+    EXPECT_GE(mesh.area(), exact - 2 * float(M_PI) * kRadius * tolerance)
+        << tolerance;
+    // points lie on the curve, arcs are cubics a little off the circle
+    for (auto const &v : mesh.vtx) {
+      EXPECT_NEAR(std::hypot(v.pos.x - 100.0f, v.pos.y - 100.0f), kRadius,
+                  kRadius * 0.001f);
+    }
+    // a finer tolerance takes more points
+    EXPECT_GT(mesh.vtx.size(), last_vertices) << tolerance;
+    last_vertices = mesh.vtx.size();
+  }
+
+  // a parabolic segment covers 2/3 of its bounding box
+  my::DrawPath quad({0.0f, 0.0f});
+  quad.quad_to({50.0f, 100.0f}, {100.0f, 0.0f}).close();
+  auto mesh = fill(quad, my::FillRule::kNonZero, 0.25f);
+  EXPECT_LE(mesh.area(), 100.0f * 50.0f * 2.0f / 3.0f + 1.0f);
+  EXPECT_GE(mesh.area(), 100.0f * 50.0f * 2.0f / 3.0f - 250.0f * 0.25f);
+}
+
+TEST(PathTessellatorTest, miter_join_reaches_the_tip) {
+  auto mesh = stroke(corner(), style(my::LineJoin::kMiter, my::LineCap::kButt));
+  EXPECT_TRUE(mesh.covers({54.5f, -4.5f}));
+  EXPECT_TRUE(mesh.covers({52.0f, -2.0f}));
+  EXPECT_FALSE(mesh.covers({55.5f, -5.5f}));
+}
+
+TEST(PathTessellatorTest, round_join_is_an_arc) {
+  auto mesh = stroke(corner(), style(my::LineJoin::kRound, my::LineCap::kButt));
+  EXPECT_TRUE(mesh.covers({53.0f, -3.0f}));
+  EXPECT_FALSE(mesh.covers({54.5f, -4.5f}));
+}
+
+TEST(PathTessellatorTest, bevel_join_cuts_the_corner) {
+  auto mesh = stroke(corner(), style(my::LineJoin::kBevel, my::LineCap::kButt));
+  EXPECT_TRUE(mesh.covers({52.0f, -2.0f}));
+  EXPECT_FALSE(mesh.covers({53.0f, -3.0f}));
+  EXPECT_FALSE(mesh.covers({54.5f, -4.5f}));
+}
+
+TEST(PathTessellatorTest, miter_limit_falls_back_to_bevel) {
+  // a 10 degree turn back, far past the limit of 4
+  my::DrawPath path({0.0f, 0.0f});
+  path.line_to({50.0f, 0.0f})
+      .line_to({50.0f - 50.0f * std::cos(0.17f), 50.0f * std::sin(0.17f)});
+  auto mesh = stroke(path, style(my::LineJoin::kMiter, my::LineCap::kButt));
+  EXPECT_TRUE(mesh.covers({50.0f, -2.0f}));
+  EXPECT_FALSE(mesh.covers({60.0f, -1.0f}));
+}
+
+TEST(PathTessellatorTest, butt_cap_ends_at_the_point) {
+  auto mesh =
+      stroke(segment(), style(my::LineJoin::kMiter, my::LineCap::kButt));
+  EXPECT_NEAR(mesh.area(), 80.0f * 10.0f, 0.01f);
+  EXPECT_TRUE(mesh.covers({12.0f, 54.0f}));
+  EXPECT_FALSE(mesh.covers({8.0f, 50.0f}));
+  EXPECT_FALSE(mesh.covers({92.0f, 50.0f}));
+}
+
+TEST(PathTessellatorTest, square_cap_extends_half_the_width) {
+  auto mesh =
+      stroke(segment(), style(my::LineJoin::kMiter, my::LineCap::kSquare));
+  EXPECT_NEAR(mesh.area(), 90.0f * 10.0f, 0.01f);
+  EXPECT_TRUE(mesh.covers({6.0f, 54.0f}));
+  EXPECT_TRUE(mesh.covers({94.0f, 46.0f}));
+  EXPECT_FALSE(mesh.covers({4.0f, 50.0f}));
+}
+
+TEST(PathTessellatorTest, round_cap_is_a_half_disc) {
+  auto mesh =
+      stroke(segment(), style(my::LineJoin::kMiter, my::LineCap::kRound));
+  // two half discs, inscribed polygons
+  const float exact = 80.0f * 10.0f + float(M_PI) * 25.0f;
+  EXPECT_LE(mesh.area(), exact + 0.01f);
+  EXPECT_GE(mesh.area(), exact - 2 * float(M_PI) * 5.0f * 0.25f);
+  EXPECT_TRUE(mesh.covers({5.5f, 50.0f}));
+  EXPECT_FALSE(mesh.covers({6.0f, 54.0f}));
+  EXPECT_FALSE(mesh.covers({94.0f, 46.0f}));
+}
+
+TEST(PathTessellatorTest, convex_fill_is_a_fan) {
+  my::DrawPath square;
+  square.rect({0.0f, 0.0f}, {10.0f, 10.0f});
+  auto mesh = fill(square, my::FillRule::kEvenOdd);
+  EXPECT_EQ(mesh.triangles(), 2u);
+  EXPECT_NEAR(mesh.area(), 100.0f, 0.01f);
+}
+
+TEST(PathTessellatorTest, fill_rule_decides_nested_contours) {
+  // both squares wound the same way
+  my::DrawPath path;
+  path.rect({0.0f, 0.0f}, {100.0f, 100.0f});
+  path.rect({25.0f, 25.0f}, {75.0f, 75.0f});
+
+  auto nonzero = fill(path, my::FillRule::kNonZero);
+  EXPECT_NEAR(nonzero.area(), 100.0f * 100.0f, 0.01f);
+  EXPECT_TRUE(nonzero.covers({50.0f, 50.0f}));
+
+  auto evenodd = fill(path, my::FillRule::kEvenOdd);
+  EXPECT_NEAR(evenodd.area(), 100.0f * 100.0f - 50.0f * 50.0f, 0.01f);
+  EXPECT_FALSE(evenodd.covers({50.0f, 50.0f}));
+  EXPECT_TRUE(evenodd.covers({10.0f, 50.0f}));
+
+  // a span running through all slabs is one quad, even-odd splits the
+  // middle slab in two spans
+  EXPECT_EQ(nonzero.triangles(), 2u);
+  EXPECT_EQ(evenodd.triangles(), 8u);
+}
+
+TEST(PathTessellatorTest, fill_rule_decides_self_intersections) {
+  // a pentagram, its center is wound twice
+  my::DrawPath star;
+  for (int i = 0; i < 5; ++i) {
+    auto angle = float(-M_PI / 2 + i * 4 * M_PI / 5);
+    glm::vec2 p{50.0f + 40.0f * std::cos(angle),
+                50.0f + 40.0f * std::sin(angle)};
+    if (i == 0) {
+      star.move_to(p);
+    } else {
+      star.line_to(p);
+    }
+  }
+  star.close();
+
+  auto nonzero = fill(star, my::FillRule::kNonZero);
+  auto evenodd = fill(star, my::FillRule::kEvenOdd);
+  EXPECT_TRUE(nonzero.covers({50.0f, 50.0f}));
+  EXPECT_FALSE(evenodd.covers({50.0f, 50.0f}));
+  // the tips are covered by both
+  EXPECT_TRUE(evenodd.covers({50.0f, 15.0f}));
+  EXPECT_GT(nonzero.area(), evenodd.area());
+}
+
+TEST(PathTessellatorTest, fringe_is_centered_on_the_outline) {
+  my::DrawPath square;
+  square.rect({10.0f, 10.0f}, {20.0f, 20.0f});
+  auto mesh = fill_aa(square, my::FillRule::kNonZero, kWhite);
+  // half covered on the outline, the area is not inflated
+  EXPECT_NEAR(mesh.alpha({10.0f, 15.0f}), 0.5f, 0.01f);
+  EXPECT_NEAR(mesh.alpha({20.0f, 15.0f}), 0.5f, 0.01f);
+  EXPECT_NEAR(mesh.alpha({10.5f, 15.0f}), 1.0f, 0.01f);
+  EXPECT_NEAR(mesh.alpha({9.5f, 15.0f}), 0.0f, 0.01f);
+  EXPECT_NEAR(mesh.alpha({15.0f, 15.0f}), 1.0f, 0.01f);
+}
+
+TEST(PathTessellatorTest, overlapping_translucent_fill_blends_once) {
+  const my::ColorRGBAub half{255, 255, 255, 128};
+  // both squares wound the same way, the edges inside the other square
+  // are not outline
+  my::DrawPath path;
+  path.rect({0.0f, 0.0f}, {60.0f, 60.0f});
+  path.rect({40.0f, 40.0f}, {100.0f, 100.0f});
+  auto mesh = fill_aa(path, my::FillRule::kNonZero, half);
+
+  auto inside = [](float x, float y) {
+    auto in = [&](float lo, float hi) {
+      return x > lo + 1 && x < hi - 1 && y > lo + 1 && y < hi - 1;
+    };
+    return in(0, 60) || in(40, 100);
+  };
+  for (float y = 0.37f; y < 100.0f; y += 1.0f) {
+    for (float x = 0.61f; x < 100.0f; x += 1.0f) {
+      if (!inside(x, y)) {
+        continue;
+      }
+      int layers = 0;
+      EXPECT_NEAR(mesh.alpha({x, y}, &layers), 128.0f / 255.0f, 0.01f)
+          << x << " " << y;
+      EXPECT_EQ(layers, 1) << x << " " << y;
+    }
+  }
+  // the outline still fades, also where it turns from one square onto
+  // the other
+  EXPECT_NEAR(mesh.alpha({100.0f, 70.0f}), 64.0f / 255.0f, 0.01f);
+  EXPECT_NEAR(mesh.alpha({0.0f, 30.0f}), 64.0f / 255.0f, 0.01f);
+  // no gap and no overlap around the corner
+  for (float dy : {-0.43f, -0.17f, 0.21f, 0.38f}) {
+    for (float dx : {-0.41f, -0.19f, 0.23f, 0.36f}) {
+      int layers = 0;
+      auto alpha = mesh.alpha({60.0f + dx, 40.0f + dy}, &layers);
+      EXPECT_EQ(layers, 1) << dx << " " << dy;
+      EXPECT_GT(alpha, 0.0f) << dx << " " << dy;
+      EXPECT_LE(alpha, 128.0f / 255.0f + 0.01f) << dx << " " << dy;
+    }
+  }
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+
+#include <render/back/back2/rasterizer.hpp>
+
+namespace {
+
+struct Target {
+  uint32_t w, h;
+  std::vector<uint8_t> pixels;
+
+  Target(uint32_t w, uint32_t h, uint8_t value = 255)
+      : w(w), h(h), pixels(w * h * 4, value) {}
+
+  my::Rasterizer::TargetView view() { return {pixels.data(), w, h, w * 4}; }
+
+  const uint8_t *at(uint32_t x, uint32_t y) const {
+    return &pixels[(y * w + x) * 4];
+  }
+};
+
+void add_quad(my::DrawData &data, const glm::vec2 &a, const glm::vec2 &c,
+              const my::ColorRGBAub &col) {
+  auto base = static_cast<uint32_t>(data.vtx_list.size());
+  auto idx_offset = static_cast<uint32_t>(data.idx_list.size());
+  data.vtx_list.push_back({a, {0, 0}, col});
+  data.vtx_list.push_back({{c.x, a.y}, {0, 0}, col});
+  data.vtx_list.push_back({c, {0, 0}, col});
+  data.vtx_list.push_back({{a.x, c.y}, {0, 0}, col});
+  data.idx_list.insert(data.idx_list.end(), {base, base + 1, base + 2, base,
+                                             base + 2, base + 3});
+  data.cmd_list.push_back({{}, 6, idx_offset, base});
+}
+
+} // namespace
+
+TEST(RasterizerTest, opaque_quad_covers_pixel_centers) {
+  my::DrawData data;
+  add_quad(data, {2, 3}, {10.4f, 7.6f}, {255, 0, 0, 255});
+
+  Target target(16, 16, 0);
+  my::Rasterizer rasterizer({8, 1});
+  rasterizer.draw(data, target.view());
+
+  for (uint32_t y = 0; y < 16; ++y) {
+    for (uint32_t x = 0; x < 16; ++x) {
+      bool inside = x >= 2 && x < 10 && y >= 3 && y < 8;
+      EXPECT_EQ(target.at(x, y)[0], inside ? 255 : 0) << x << "," << y;
+    }
+  }
+}
+
+TEST(RasterizerTest, shared_edge_is_blended_once) {
+  my::DrawData data;
+  add_quad(data, {0.3f, 0.7f}, {29.1f, 23.9f}, {0, 0, 0, 128});
+
+  Target target(32, 32);
+  my::Rasterizer rasterizer({16, 1});
+  rasterizer.draw(data, target.view());
+
+  auto expected = target.at(5, 5)[0];
+  EXPECT_NEAR(expected, 127, 1);
+  for (uint32_t y = 1; y < 24; ++y) {
+    for (uint32_t x = 0; x < 29; ++x) {
+      EXPECT_EQ(target.at(x, y)[0], expected) << x << "," << y;
+    }
+  }
+}
+
+TEST(RasterizerTest, submission_order_across_tiles) {
+  my::DrawData data;
+  add_quad(data, {0, 0}, {40, 40}, {255, 0, 0, 255});
+  add_quad(data, {10, 10}, {30, 30}, {0, 0, 255, 255});
+
+  Target target(40, 40, 0);
+  my::Rasterizer rasterizer({8, 4});
+  rasterizer.draw(data, target.view());
+
+  EXPECT_EQ(target.at(20, 20)[2], 255);
+  EXPECT_EQ(target.at(20, 20)[0], 0);
+  EXPECT_EQ(target.at(5, 5)[0], 255);
+  EXPECT_EQ(rasterizer.stats().triangles, 4u);
+}
+
+TEST(RasterizerTest, thread_count_does_not_change_output) {
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> pos(-20, 276);
+  std::uniform_int_distribution<int> byte(0, 255);
+
+  my::DrawList list;
+  for (int i = 0; i < 3000; ++i) {
+    my::ColorRGBAub col(byte(rng), byte(rng), byte(rng), byte(rng));
+    glm::vec2 c{pos(rng), pos(rng)};
+    if (i % 2) {
+      list.begin_path(c).arc(c, 4 + i % 30, 0, 2 * float(M_PI)).fill(col);
+    } else {
+      list.begin_path(c)
+          .line_to({pos(rng), pos(rng)})
+          .line_to({pos(rng), pos(rng)})
+          .stroke(col, 1 + i % 5);
+    }
+  }
+  my::DrawData data;
+  data.merge({&list});
+
+  Target single(256, 256);
+  my::Rasterizer({32, 1}).draw(data, single.view());
+
+  for (uint32_t threads : {2u, 4u, 8u}) {
+    Target multi(256, 256);
+    my::Rasterizer({32, threads}).draw(data, multi.view());
+    EXPECT_EQ(single.pixels, multi.pixels) << threads;
+  }
+}
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include <render/scene_recorder.hpp>
+#include <util/triple_buffer.hpp>
+
+namespace {
+
+class CountingView : public my::NodeView {
+public:
+  static my::shared_ptr<CountingView> make(my::IRect const &rect,
+                                           bool cached = false) {
+    auto view = my::shared_ptr<CountingView>(new CountingView());
+    view->rect(rect);
+    view->cached(cached);
+    return view;
+  }
+
+  void paint(SkCanvas &) override { ++this->paints; }
+
+  int paints{0};
+};
+
+} // namespace
+
+TEST(SceneRecorderTest, records_only_changes) {
+  auto root = CountingView::make(my::IRect::MakeWH(200, 100));
+  auto layer = CountingView::make(my::IRect::MakeXYWH(10, 10, 50, 50), true);
+  root->append_child(layer);
+
+  my::SceneRecorder recorder;
+  auto first = recorder.record(*root);
+  ASSERT_TRUE(first.picture);
+  EXPECT_EQ(first.sequence, 1);
+  EXPECT_EQ(first.picture->cullRect().width(), 200);
+  EXPECT_EQ(root->paints, 1);
+
+  EXPECT_EQ(recorder.record(*root).picture, first.picture);
+  EXPECT_EQ(root->paints, 1);
+
+  // the cached layer is replayed as an image
+  layer->rect(my::IRect::MakeXYWH(20, 10, 50, 50));
+  EXPECT_EQ(recorder.record(*root).sequence, 2);
+  EXPECT_EQ(root->paints, 2);
+  EXPECT_EQ(layer->paints, 1);
+  EXPECT_EQ(recorder.layer_cache().frame_stats().hits, 1);
+
+  // the root's own rect counts too
+  root->rect(my::IRect::MakeWH(300, 100));
+  EXPECT_EQ(recorder.record(*root).sequence, 3);
+}
+
+TEST(SceneRecorderTest, snapshots_cross_threads) {
+  my::TripleBuffer<my::SceneSnapshot> buffer;
+  std::thread ui([&buffer]() {
+    auto root = CountingView::make(my::IRect::MakeWH(100, 100));
+    my::SceneRecorder recorder;
+    for (int i = 1; i <= 100; ++i) {
+      root->rect(my::IRect::MakeWH(100 + i, 100));
+      buffer.back() = recorder.record(*root);
+      buffer.publish();
+    }
+  });
+  ui.join();
+
+  ASSERT_TRUE(buffer.acquire());
+  EXPECT_EQ(buffer.front().sequence, 100);
+  EXPECT_EQ(buffer.front().picture->cullRect().width(), 200);
+}
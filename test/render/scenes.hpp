@@ -0,0 +1,329 @@
+#pragma once
+
+#include <cmath>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <render/back/back2/basic_canvas.hpp>
+#include <storage/font_mgr.h>
+
+namespace my::test {
+
+/**
+ * @brief      5x7 pixel font generated at runtime, so scenes with text do not
+ *             depend on a font file being installed
+ */
+class TestFont : public my::Font {
+public:
+  static constexpr int kAtlasW = 128;
+  static constexpr int kAtlasH = 64;
+  static constexpr wchar_t kFirst = 0x20;
+  static constexpr wchar_t kLast = 0x7e;
+
+  TestFont() : _rgba(kAtlasW * kAtlasH * 4, 0), _alpha(kAtlasW * kAtlasH, 0) {
+    for (wchar_t ch = kFirst; ch <= kLast; ++ch) {
+      int index = ch - kFirst;
+      int cx = (index % 16) * 8;
+      int cy = (index / 16) * 8;
+      // splitmix64 of the code point, mirrored so glyphs look letter like
+      uint64_t bits = (ch + 0x9e3779b97f4a7c15ull) * 0xbf58476d1ce4e5b9ull;
+      bits = (bits ^ (bits >> 27)) * 0x94d049bb133111ebull;
+      for (int y = 0; y < 7 && ch != ' '; ++y) {
+        for (int x = 0; x < 3; ++x) {
+          if (bits >> (y * 3 + x) & 1) {
+            this->_set(cx + 1 + x, cy + y);
+            this->_set(cx + 5 - x, cy + y);
+          }
+        }
+      }
+      this->_glyphs.push_back(
+          {ch, 6, 5, 7, {0, 7},
+           {(cx + 1) / float(kAtlasW), cy / float(kAtlasH)},
+           {(cx + 6) / float(kAtlasW), (cy + 7) / float(kAtlasH)}});
+    }
+    for (int y = kAtlasH - 4; y < kAtlasH; ++y) {
+      for (int x = kAtlasW - 4; x < kAtlasW; ++x) {
+        this->_set(x, y);
+      }
+    }
+  }
+
+  const my::FontGlyph &get_glyph(wchar_t ch) override {
+    if (ch < kFirst || ch > kLast) {
+      ch = '?';
+    }
+    return this->_glyphs[ch - kFirst];
+  }
+
+  unsigned char *get_tex_as_rgb32(int *out_w, int *out_h) override {
+    this->_size(out_w, out_h);
+    return this->_rgba.data();
+  }
+
+  unsigned char *get_tex_as_alpha(int *out_w, int *out_h) override {
+    this->_size(out_w, out_h);
+    return this->_alpha.data();
+  }
+
+  uint32_t font_size() const override { return 8; }
+
+  glm::vec2 white_pixels_uv() override {
+    return {(kAtlasW - 2) / float(kAtlasW), (kAtlasH - 2) / float(kAtlasH)};
+  }
+
+private:
+  std::vector<unsigned char> _rgba;
+  std::vector<unsigned char> _alpha;
+  std::vector<my::FontGlyph> _glyphs;
+
+  void _set(int x, int y) {
+    auto p = &this->_rgba[(y * kAtlasW + x) * 4];
+    p[0] = p[1] = p[2] = p[3] = 255;
+    this->_alpha[y * kAtlasW + x] = 255;
+  }
+
+  void _size(int *out_w, int *out_h) {
+    if (out_w) {
+      *out_w = kAtlasW;
+    }
+    if (out_h) {
+      *out_h = kAtlasH;
+    }
+  }
+};
+
+struct Scene {
+  std::string name;
+  uint32_t width;
+  uint32_t height;
+  // records frame number `frame`, frame 0 is the golden image
+  std::function<void(my::BasicCanvas &, int frame)> draw;
+};
+
+inline my::BasicCanvas &rounded_rect(my::BasicCanvas &canvas,
+                                     const glm::vec2 &a, const glm::vec2 &c,
+                                     float r) {
+  return canvas.begin_path({a.x + r, a.y})
+      .arc_to({c.x, a.y}, c, r)
+      .arc_to(c, {a.x, c.y}, r)
+      .arc_to({a.x, c.y}, a, r)
+      .arc_to(a, {c.x, a.y}, r)
+      .close_path();
+}
+
+/**
+ * @brief      pixels of the large image scrolled by the image_scroll scene
+ */
+inline RGBAImage make_scroll_pixels(uint32_t w = 2048, uint32_t h = 2048) {
+  RGBAImage image(w, h);
+  auto view = boost::gil::view(image);
+  for (uint32_t y = 0; y < h; ++y) {
+    auto row = view.row_begin(y);
+    for (uint32_t x = 0; x < w; ++x) {
+      bool check = ((x / 64) + (y / 64)) % 2;
+      uint8_t r = static_cast<uint8_t>(x * 255 / w);
+      uint8_t g = static_cast<uint8_t>(y * 255 / h);
+      uint8_t b = check ? 200 : 60;
+      row[x] = boost::gil::rgba8_pixel_t(r, g, b, 255);
+    }
+  }
+  return image;
+}
+
+inline void draw_text_dialog(my::BasicCanvas &canvas, int frame) {
+  static const char *lines[] = {
+      "The quick brown fox jumps over the lazy dog.",
+      "Pack my box with five dozen liquor jugs!",
+      "How vexingly quick daft zebras jump; 0123456789",
+      "Sphinx of black quartz, judge my vow? (a+b)*c",
+      "Jackdaws love my big sphinx of quartz: [ok] {no}",
+      "Waltz, bad nymph, for quick jigs vex. #42 @home",
+  };
+  const int kLines = sizeof(lines) / sizeof(lines[0]);
+
+  canvas.fill_rect({0, 0}, {640, 480}, {236, 239, 244, 255});
+  rounded_rect(canvas, {60, 40}, {580, 440}, 8).fill({255, 255, 255, 255});
+  rounded_rect(canvas, {60, 40}, {580, 440}, 8).stroke({160, 166, 176, 255}, 1);
+  canvas.fill_rect({61, 41}, {579, 72}, {52, 101, 164, 255});
+  canvas.fill_text("Settings - Render Options", {72, 46}, nullptr, 16,
+                   {255, 255, 255, 255});
+
+  for (int i = 0; i < 24; ++i) {
+    float size = i % 6 == 0 ? 12 : 10;
+    canvas.fill_text(lines[(i + frame) % kLines], {96, 84 + i * 13.5f},
+                     nullptr, size, {40, 44, 52, 255});
+    glm::vec2 box{76, 86 + i * 13.5f};
+    canvas.stroke_rect(box, box + glm::vec2{9, 9}, {90, 96, 106, 255}, 1);
+    if ((i + frame) % 3 == 0) {
+      canvas.begin_path(box + glm::vec2{2, 4.5f})
+          .line_to(box + glm::vec2{4, 7})
+          .line_to(box + glm::vec2{7.5f, 2})
+          .stroke({52, 101, 164, 255}, 1.5f);
+    }
+  }
+
+  for (int i = 0; i < 2; ++i) {
+    glm::vec2 a{400 + i * 90.0f, 404};
+    rounded_rect(canvas, a, a + glm::vec2{80, 26}, 5)
+        .fill(i ? my::ColorRGBAub{52, 101, 164, 255}
+                : my::ColorRGBAub{225, 228, 233, 255});
+    canvas.fill_text(i ? "Apply" : "Cancel", a + glm::vec2{18, 5}, nullptr, 12,
+                     i ? my::ColorRGBAub{255, 255, 255, 255}
+                       : my::ColorRGBAub{40, 44, 52, 255});
+  }
+}
+
+inline void draw_icon_grid(my::BasicCanvas &canvas, int frame) {
+  canvas.fill_rect({0, 0}, {640, 480}, {32, 34, 40, 255});
+  for (int row = 0; row < 7; ++row) {
+    for (int col = 0; col < 10; ++col) {
+      int i = row * 10 + col;
+      glm::vec2 o{14 + col * 62.0f, 12 + row * 66.0f};
+      uint8_t hue = static_cast<uint8_t>((i * 37 + frame * 5) % 256);
+      my::ColorRGBAub bg{hue, static_cast<uint8_t>(255 - hue), 160, 255};
+      rounded_rect(canvas, o, o + glm::vec2{48, 48}, 10).fill(bg);
+
+      glm::vec2 c = o + glm::vec2{24, 24};
+      canvas.begin_path(c + glm::vec2{16, 0})
+          .arc(c, 16, 0, 2 * float(M_PI))
+          .close_path()
+          .stroke({255, 255, 255, 220}, 2);
+
+      switch (i % 3) {
+      case 0: {
+        canvas.begin_path(c + glm::vec2{0, -10});
+        for (int k = 1; k < 5; ++k) {
+          float a = k * 4 * float(M_PI) / 5;
+          canvas.line_to(c + glm::vec2{10 * std::sin(a), -10 * std::cos(a)});
+        }
+        canvas.close_path().fill({255, 255, 255, 255}, my::FillRule::kEvenOdd);
+        break;
+      }
+      case 1:
+        canvas.begin_path(c + glm::vec2{0, 9})
+            .bezier_to(c + glm::vec2{-14, -2}, c + glm::vec2{-6, -14}, c)
+            .bezier_to(c + glm::vec2{6, -14}, c + glm::vec2{14, -2},
+                       c + glm::vec2{0, 9})
+            .close_path()
+            .fill({250, 80, 90, 255});
+        break;
+      default:
+        canvas.line_join(my::LineJoin::kRound)
+            .line_cap(my::LineCap::kRound)
+            .begin_path(c + glm::vec2{-8, 0})
+            .line_to(c + glm::vec2{-2, 6})
+            .line_to(c + glm::vec2{9, -7})
+            .stroke({255, 255, 255, 255}, 3);
+        canvas.line_join(my::LineJoin::kMiter).line_cap(my::LineCap::kButt);
+        break;
+      }
+      canvas.fill_text("icon " + std::to_string(i), o + glm::vec2{4, 49},
+                       nullptr, 8, {210, 214, 222, 255});
+    }
+  }
+}
+
+inline std::function<void(my::BasicCanvas &, int)>
+image_scroll(std::shared_ptr<my::Image> image, uint32_t image_w,
+             uint32_t image_h) {
+  return [image, image_w, image_h](my::BasicCanvas &canvas, int frame) {
+    canvas.fill_rect({0, 0}, {640, 480}, {18, 18, 20, 255});
+    float sy = static_cast<float>((frame * 13) % (image_h - 400));
+    canvas.draw_image(image, {0, 0}, {600, 400}, {0, sy / image_h},
+                      {600.0f / image_w, (sy + 400) / image_h});
+
+    // scroll bar
+    canvas.fill_rect({606, 0}, {640, 400}, {40, 40, 44, 255});
+    float thumb = 400 * 400.0f / image_h;
+    float ty = sy / image_h * 400;
+    rounded_rect(canvas, {610, ty + 2}, {636, ty + thumb - 2}, 4)
+        .fill({150, 150, 160, 255});
+
+    // thumbnails, scaled down and translucent
+    for (int i = 0; i < 8; ++i) {
+      glm::vec2 a{8 + i * 79.0f, 410};
+      float u = (i * 256.0f) / image_w;
+      canvas.draw_image(image, a, a + glm::vec2{72, 62}, {u, 0},
+                        {u + 0.125f, 0.125f}, i == frame % 8 ? 255 : 160);
+      canvas.stroke_rect(a, a + glm::vec2{72, 62}, {90, 90, 100, 255}, 1);
+    }
+  };
+}
+
+inline void draw_path_chart(my::BasicCanvas &canvas, int frame) {
+  canvas.fill_rect({0, 0}, {640, 480}, {255, 255, 255, 255});
+
+  const glm::vec2 origin{50, 440};
+  const glm::vec2 size{570, 400};
+  for (int i = 0; i <= 10; ++i) {
+    float x = origin.x + size.x * i / 10;
+    float y = origin.y - size.y * i / 10;
+    canvas.begin_path({x, origin.y}).line_to({x, origin.y - size.y})
+        .stroke({228, 230, 234, 255}, 1);
+    canvas.begin_path({origin.x, y}).line_to({origin.x + size.x, y})
+        .stroke({228, 230, 234, 255}, 1);
+    canvas.fill_text(std::to_string(i * 10), {origin.x - 28, y - 6}, nullptr,
+                     8, {90, 96, 106, 255});
+  }
+  canvas.begin_path({origin.x, origin.y - size.y})
+      .line_to(origin)
+      .line_to({origin.x + size.x, origin.y})
+      .stroke({40, 44, 52, 255}, 1.5f);
+
+  const my::ColorRGBAub colors[] = {
+      {52, 101, 164, 255}, {204, 72, 64, 255}, {76, 154, 82, 255}};
+  std::mt19937 rng(42 + frame);
+  std::normal_distribution<float> noise(0, 6);
+  for (int s = 0; s < 3; ++s) {
+    std::vector<glm::vec2> pts;
+    float v = size.y * (0.3f + 0.2f * s);
+    for (int i = 0; i < 400; ++i) {
+      v = std::clamp(v + noise(rng), 10.0f, size.y - 10);
+      pts.push_back({origin.x + size.x * i / 399, origin.y - v});
+    }
+
+    if (s == 0) {
+      canvas.begin_path(origin);
+      for (const auto &p : pts) {
+        canvas.line_to(p);
+      }
+      auto area = colors[s];
+      area.a = 60;
+      canvas.line_to({origin.x + size.x, origin.y}).close_path().fill(area);
+    }
+
+    canvas.line_join(my::LineJoin::kRound).begin_path(pts.front());
+    for (const auto &p : pts) {
+      canvas.line_to(p);
+    }
+    canvas.stroke(colors[s], 2);
+    canvas.line_join(my::LineJoin::kMiter);
+
+    for (size_t i = 0; i < pts.size(); i += 25) {
+      canvas.begin_path(pts[i] + glm::vec2{3, 0})
+          .arc(pts[i], 3, 0, 2 * float(M_PI))
+          .close_path()
+          .fill(colors[s]);
+    }
+
+    glm::vec2 legend{470, 52 + s * 16.0f};
+    canvas.fill_rect(legend, legend + glm::vec2{10, 10}, colors[s]);
+    canvas.fill_text("series " + std::to_string(s + 1),
+                     legend + glm::vec2{16, 0}, nullptr, 10,
+                     {40, 44, 52, 255});
+  }
+}
+
+inline std::vector<Scene> make_scenes(std::shared_ptr<my::Image> image,
+                                      uint32_t image_w, uint32_t image_h) {
+  return {
+      {"text_dialog", 640, 480, draw_text_dialog},
+      {"icon_grid", 640, 480, draw_icon_grid},
+      {"image_scroll", 640, 480, image_scroll(image, image_w, image_h)},
+      {"path_chart", 640, 480, draw_path_chart},
+  };
+}
+
+} // namespace my::test
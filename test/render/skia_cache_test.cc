@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include <render/skia_cache.hpp>
+
+#include <skia/include/core/SkGraphics.h>
+
+namespace {
+
+// the limits are process-wide, later tests see Skia's own again
+struct SkiaCachesTest : public ::testing::Test {
+  size_t font_bytes{SkGraphics::GetFontCacheLimit()};
+  int font_glyphs{SkGraphics::GetFontCacheCountLimit()};
+  int font_point_size{SkGraphics::GetFontCachePointSizeLimit()};
+  size_t resource_bytes{SkGraphics::GetResourceCacheTotalByteLimit()};
+  size_t single_allocation_bytes{
+      SkGraphics::GetResourceCacheSingleAllocationByteLimit()};
+
+  void TearDown() override {
+    SkGraphics::SetFontCacheLimit(this->font_bytes);
+    SkGraphics::SetFontCacheCountLimit(this->font_glyphs);
+    SkGraphics::SetFontCachePointSizeLimit(this->font_point_size);
+    SkGraphics::SetResourceCacheTotalByteLimit(this->resource_bytes);
+    SkGraphics::SetResourceCacheSingleAllocationByteLimit(
+        this->single_allocation_bytes);
+  }
+};
+
+} // namespace
+
+TEST_F(SkiaCachesTest, applies_limits_and_publishes_usage) {
+  auto default_glyphs = this->font_glyphs;
+  auto default_resource_bytes = this->resource_bytes;
+
+  my::SkiaCacheOptions options;
+  options.font_cache_bytes = 8 << 20;
+  options.font_point_size_limit = 64;
+  my::SkiaCaches caches(options);
+  EXPECT_EQ(SkGraphics::GetFontCacheLimit(), 8u << 20);
+  EXPECT_EQ(SkGraphics::GetFontCachePointSizeLimit(), 64);
+  // unset limits keep Skia's
+  EXPECT_EQ(SkGraphics::GetFontCacheCountLimit(), default_glyphs);
+  EXPECT_EQ(SkGraphics::GetResourceCacheTotalByteLimit(),
+            default_resource_bytes);
+
+  auto stats = caches.sample();
+  EXPECT_EQ(stats.font_bytes_limit, 8u << 20);
+  EXPECT_EQ(stats.font_glyphs_limit, default_glyphs);
+  EXPECT_EQ(stats.gpu_bytes, 0u);
+  EXPECT_EQ(my::Metrics::get()->gauge("render.skia.font_bytes_limit").value(),
+            8 << 20);
+
+  auto purges = my::Metrics::get()->counter("render.skia.purges").value();
+  caches.purge();
+  EXPECT_EQ(my::Metrics::get()->counter("render.skia.purges").value(),
+            purges + 1);
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include <render/tiled_rasterizer.hpp>
+
+#include <skia/include/core/SkPictureRecorder.h>
+#include <skia/include/core/SkSurface.h>
+
+TEST(TiledRasterizerTest, bands_cover_every_row) {
+  auto bands = my::TiledRasterizer::split(my::ISize2D::Make(10, 11), 4);
+  ASSERT_EQ(bands.size(), 4);
+  EXPECT_EQ(bands[0], my::IRect::MakeXYWH(0, 0, 10, 3));
+  EXPECT_EQ(bands[1], my::IRect::MakeXYWH(0, 3, 10, 3));
+  EXPECT_EQ(bands[2], my::IRect::MakeXYWH(0, 6, 10, 3));
+  EXPECT_EQ(bands[3], my::IRect::MakeXYWH(0, 9, 10, 2));
+
+  // never more bands than rows
+  EXPECT_EQ(my::TiledRasterizer::split(my::ISize2D::Make(10, 2), 4).size(), 2);
+  EXPECT_TRUE(my::TiledRasterizer::split(my::ISize2D::Make(0, 2), 4).empty());
+}
+
+TEST(TiledRasterizerTest, bands_fill_the_pixels) {
+  my::Executor executor(3);
+  my::TiledRasterizer tiler(4, executor);
+
+  SkPictureRecorder recorder;
+  recorder.beginRecording(SkRect::MakeWH(64, 37))->clear(SK_ColorBLACK);
+  auto picture = recorder.finishRecordingAsPicture();
+
+  auto info = SkImageInfo::MakeN32Premul(64, 37);
+  std::vector<uint32_t> pixels(64 * 37, 0);
+  for (int frame = 0; frame < 10; ++frame) {
+    tiler.draw(*picture, info, pixels.data(), info.minRowBytes());
+  }
+  for (auto pixel : pixels) {
+    ASSERT_EQ(pixel, SK_ColorBLACK);
+  }
+}
+
+TEST(TiledRasterizerTest, bands_match_a_single_surface) {
+  my::Executor executor(3);
+  my::TiledRasterizer tiler(4, executor);
+
+  // every row differs and the rects cross band edges, a band drawn at the
+  // wrong offset changes the output
+  constexpr int kWidth = 64;
+  constexpr int kHeight = 37;
+  SkPictureRecorder recorder;
+  auto canvas = recorder.beginRecording(SkRect::MakeWH(kWidth, kHeight));
+  canvas->clear(SK_ColorBLACK);
+  SkPaint paint;
+  for (int y = 0; y < kHeight; ++y) {
+    paint.setColor(SkColorSetARGB(0xFF, uint8_t(y * 7), 0, uint8_t(255 - y)));
+    canvas->drawRect(SkRect::MakeXYWH(0, float(y), float(y + 1), 1), paint);
+  }
+  paint.setColor(SK_ColorWHITE);
+  canvas->drawRect(SkRect::MakeXYWH(40, 5, 10, 25), paint);
+  auto picture = recorder.finishRecordingAsPicture();
+
+  auto info = SkImageInfo::MakeN32Premul(kWidth, kHeight);
+  std::vector<uint32_t> expected(kWidth * kHeight, 0);
+  picture->playback(
+      SkSurface::MakeRasterDirect(info, expected.data(), info.minRowBytes())
+          ->getCanvas());
+
+  std::vector<uint32_t> pixels(kWidth * kHeight, 0);
+  tiler.draw(*picture, info, pixels.data(), info.minRowBytes());
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x) {
+      ASSERT_EQ(pixels[y * kWidth + x], expected[y * kWidth + x])
+          << x << ", " << y;
+    }
+  }
+}
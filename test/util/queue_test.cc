@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <util/queue.hpp>
+
+namespace {
+
+template <my::QueueKind kind> void fifo_order() {
+  my::Queue<int, 5, kind> queue;
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 5; ++i) {
+      EXPECT_TRUE(queue.try_push(i));
+    }
+    EXPECT_FALSE(queue.try_push(5));
+    EXPECT_EQ(queue.size(), 5u);
+    int v;
+    for (int i = 0; i < 5; ++i) {
+      ASSERT_TRUE(queue.try_pop(v));
+      EXPECT_EQ(v, i);
+    }
+    EXPECT_FALSE(queue.try_pop(v));
+    EXPECT_TRUE(queue.empty());
+  }
+}
+
+struct Tracked {
+  static inline int alive = 0;
+  Tracked() noexcept { ++alive; }
+  Tracked(Tracked &&) noexcept { ++alive; }
+  Tracked &operator=(Tracked &&) = default;
+  ~Tracked() { --alive; }
+};
+
+struct ThrowingCtor {
+  int v{0};
+  ThrowingCtor() = default;
+  explicit ThrowingCtor(int v) : v(v) {
+    if (v < 0) {
+      throw std::invalid_argument("negative");
+    }
+  }
+};
+
+} // namespace
+
+TEST(QueueTest, fifo_order_mpmc) { fifo_order<my::QueueKind::kMPMC>(); }
+
+TEST(QueueTest, fifo_order_spsc) { fifo_order<my::QueueKind::kSPSC>(); }
+
+TEST(QueueTest, move_only_elements) {
+  my::Queue<std::unique_ptr<int>, 4> queue;
+  queue.push(std::make_unique<int>(7));
+  EXPECT_TRUE(queue.try_emplace(new int(8)));
+  EXPECT_EQ(*queue.pop(), 7);
+  std::unique_ptr<int> v;
+  ASSERT_TRUE(queue.try_pop(v));
+  EXPECT_EQ(*v, 8);
+}
+
+TEST(QueueTest, destroys_remaining_elements) {
+  Tracked::alive = 0;
+  {
+    my::Queue<Tracked, 8> mpmc;
+    my::Queue<Tracked, 8, my::QueueKind::kSPSC> spsc;
+    for (int i = 0; i < 3; ++i) {
+      mpmc.try_emplace();
+      spsc.try_emplace();
+    }
+    EXPECT_EQ(Tracked::alive, 6);
+  }
+  EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(QueueTest, throwing_constructor_keeps_queue_usable) {
+  my::Queue<ThrowingCtor, 4> queue;
+  EXPECT_TRUE(queue.try_emplace(1));
+  EXPECT_THROW(queue.try_emplace(-1), std::invalid_argument);
+  EXPECT_TRUE(queue.try_emplace(2));
+  EXPECT_EQ(queue.size(), 2u);
+  EXPECT_EQ(queue.pop().v, 1);
+  EXPECT_EQ(queue.pop().v, 2);
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(QueueTest, spsc_front_peeks) {
+  my::Queue<int, 4, my::QueueKind::kSPSC> queue;
+  EXPECT_EQ(queue.try_front(), nullptr);
+  std::thread producer([&]() {
+    for (int i = 0; i < 1000; ++i) {
+      queue.push(i);
+    }
+  });
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(queue.front(), i);
+    EXPECT_EQ(queue.pop(), i);
+  }
+  producer.join();
+}
+
+TEST(QueueTest, blocking_mpmc_delivers_everything_once) {
+  constexpr int kThreads = 4;
+  constexpr int kItems = 20000;
+  my::Queue<int, 16> queue;
+  std::vector<std::thread> threads;
+  std::vector<long> sums(kThreads, 0);
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&queue, t]() {
+      for (int i = 1; i <= kItems; ++i) {
+        queue.push(i * kThreads + t);
+      }
+    });
+    threads.emplace_back([&queue, &sums, t]() {
+      for (int i = 0; i < kItems; ++i) {
+        sums[t] += queue.pop();
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  long total = 0;
+  for (auto sum : sums) {
+    total += sum;
+  }
+  long expected = 0;
+  for (int t = 0; t < kThreads; ++t) {
+    for (long i = 1; i <= kItems; ++i) {
+      expected += i * kThreads + t;
+    }
+  }
+  EXPECT_EQ(total, expected);
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(QueueTest, sleeping_pop_is_woken_by_push) {
+  my::Queue<int, 2> queue;
+  std::thread consumer([&queue]() {
+    EXPECT_EQ(queue.pop(), 1);
+    EXPECT_EQ(queue.pop(), 2);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  queue.push(1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  queue.push(2);
+  consumer.join();
+}
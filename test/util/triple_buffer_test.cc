@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include <util/triple_buffer.hpp>
+
+TEST(TripleBufferTest, reader_gets_the_latest_value) {
+  my::TripleBuffer<int> buffer;
+  EXPECT_FALSE(buffer.acquire());
+
+  buffer.back() = 1;
+  buffer.publish();
+  buffer.back() = 2;
+  buffer.publish();
+  EXPECT_TRUE(buffer.acquire());
+  EXPECT_EQ(buffer.front(), 2);
+  EXPECT_FALSE(buffer.acquire());
+  EXPECT_EQ(buffer.front(), 2);
+
+  // the writer never gets the slot the reader holds
+  for (int i = 3; i < 10; ++i) {
+    buffer.back() = i;
+    buffer.publish();
+    EXPECT_EQ(buffer.front(), 2);
+  }
+  EXPECT_TRUE(buffer.acquire());
+  EXPECT_EQ(buffer.front(), 9);
+}
+
+TEST(TripleBufferTest, values_are_whole_across_threads) {
+  struct Frame {
+    int seq{0};
+    std::vector<int> data;
+  };
+  my::TripleBuffer<Frame> buffer;
+  constexpr int kFrames = 20000;
+
+  std::thread writer([&buffer]() {
+    for (int i = 1; i <= kFrames; ++i) {
+      auto &frame = buffer.back();
+      frame.seq = i;
+      frame.data.assign(16, i);
+      buffer.publish();
+    }
+  });
+
+  int last = 0;
+  while (last < kFrames) {
+    if (!buffer.acquire()) {
+      std::this_thread::yield();
+      continue;
+    }
+    auto const &frame = buffer.front();
+    ASSERT_GT(frame.seq, last);
+    for (auto v : frame.data) {
+      ASSERT_EQ(v, frame.seq);
+    }
+    last = frame.seq;
+  }
+  writer.join();
+}
@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <util/uuid.hpp>
+
+TEST(UuidTest, random_version_and_variant) {
+  for (int i = 0; i < 1000; ++i) {
+    auto id = my::uuid_gen();
+    ASSERT_EQ(id.version(), my::uuid::version_random_number_based);
+    ASSERT_EQ(id.variant(), my::uuid::variant_rfc_4122);
+  }
+}
+
+TEST(UuidTest, unique_across_threads) {
+  constexpr int kThreads = 4;
+  constexpr int kIds = 20000;
+  std::vector<std::vector<my::uuid>> ids(kThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&ids, t]() {
+      for (int i = 0; i < kIds; ++i) {
+        ids[t].push_back(my::uuid_gen());
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::set<my::uuid> all;
+  for (auto &thread_ids : ids) {
+    all.insert(thread_ids.begin(), thread_ids.end());
+  }
+  EXPECT_EQ(all.size(), size_t(kThreads * kIds));
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <future>
+#include <sstream>
+
+#include <window/headless/headless_window_service.hpp>
+
+namespace {
+
+struct Button {
+  my::WindowID window;
+  my::MouseButtonEvent::ButtonState state;
+  my::IPoint2D pos;
+};
+
+std::unique_ptr<my::HeadlessWindowService> make_service() {
+  return std::make_unique<my::HeadlessWindowService>(
+      my::DisplayMode{0, my::ISize2D::Make(1920, 1080), 60});
+}
+
+std::shared_ptr<my::HeadlessWindow> make_window(my::HeadlessWindowService &s,
+                                                my::ISize2D size) {
+  return std::dynamic_pointer_cast<my::HeadlessWindow>(
+      s.create_window("test", size).get());
+}
+
+} // namespace
+
+TEST(HeadlessWindowTest, input_reaches_the_bus_as_button_events) {
+  auto service = make_service();
+  auto first = make_window(*service, my::ISize2D::Make(64, 64));
+  auto second = make_window(*service, my::ISize2D::Make(64, 64));
+
+  my::EventBus bus;
+  bus.subscribe(first.get());
+  bus.subscribe(second.get());
+  std::mutex lock;
+  std::vector<Button> buttons;
+  auto sub = my::on_event<my::MouseButtonEvent>(&bus).subscribe([&](auto e) {
+    std::unique_lock<std::mutex> l_lock(lock);
+    buttons.push_back(
+        {(*e)->window_ptr()->window_id(), (*e)->button_state(), (*e)->pos()});
+  });
+
+  my::HeadlessInput input;
+  input.window = second->window_id();
+  input.pos = my::IPoint2D::Make(3, 4);
+  service->inject(input).get();
+  // window 0 is the first window
+  std::istringstream is("click 5 6\n");
+  service->play(my::InputScript::parse(is)).get();
+
+  std::unique_lock<std::mutex> l_lock(lock);
+  ASSERT_EQ(buttons.size(), 3u);
+  EXPECT_EQ(buttons[0].window, second->window_id());
+  EXPECT_EQ(buttons[0].state, my::MouseButtonEvent::kPressed);
+  EXPECT_EQ(buttons[0].pos, my::IPoint2D::Make(3, 4));
+  EXPECT_EQ(buttons[1].window, first->window_id());
+  EXPECT_EQ(buttons[1].state, my::MouseButtonEvent::kPressed);
+  EXPECT_EQ(buttons[2].window, first->window_id());
+  EXPECT_EQ(buttons[2].state, my::MouseButtonEvent::kReleased);
+  EXPECT_EQ(buttons[2].pos, my::IPoint2D::Make(5, 6));
+  sub.unsubscribe();
+}
+
+TEST(HeadlessWindowTest, resize_is_clamped) {
+  auto service = make_service();
+  auto win = make_window(*service, my::ISize2D::Make(100, 100));
+  int resizes = 0;
+  win->on_resize([&]() { ++resizes; });
+  win->min_size(my::ISize2D::Make(50, 60));
+  // a max of 0 leaves the height unlimited
+  win->max_size(my::ISize2D::Make(80, 0));
+
+  my::HeadlessInput input;
+  input.type = my::HeadlessInput::kResize;
+  input.size = my::ISize2D::Make(10, 1000);
+  service->inject(input).get();
+  EXPECT_EQ(win->size(), my::ISize2D::Make(50, 1000));
+  win->with_frame_buffer([](my::HeadlessWindow::FrameBuffer &fb) {
+    EXPECT_EQ(fb.size, my::ISize2D::Make(50, 1000));
+    EXPECT_EQ(fb.pixels.size(), 50u * 1000u);
+  });
+
+  input.size = my::ISize2D::Make(500, 5);
+  service->inject(input).get();
+  EXPECT_EQ(win->size(), my::ISize2D::Make(80, 60));
+  // the min size changed nothing at 100x100, the max size did
+  EXPECT_EQ(resizes, 3);
+  // clamped to the current size
+  win->size(my::ISize2D::Make(90, 60));
+  EXPECT_EQ(resizes, 3);
+}
+
+TEST(HeadlessWindowTest, quit_posts_a_quit_event) {
+  auto service = make_service();
+  make_window(*service, my::ISize2D::Make(64, 64));
+
+  my::EventBus bus;
+  bus.subscribe(service.get());
+  std::promise<void> quit;
+  auto sub = my::on_event<my::QuitEvent>(&bus).subscribe(
+      [&](auto) { quit.set_value(); });
+
+  my::HeadlessInput input;
+  input.type = my::HeadlessInput::kQuit;
+  service->inject(input).get();
+  EXPECT_EQ(quit.get_future().wait_for(std::chrono::seconds(0)),
+            std::future_status::ready);
+  sub.unsubscribe();
+}
+
+TEST(HeadlessWindowTest, windows_can_be_awaited) {
+  auto service = make_service();
+  my::Executor executor(1);
+  auto f = my::Fiber::spawn(executor, [&service]() {
+    auto mode = my::await(service->async_display_mode());
+    EXPECT_EQ(mode.refresh_rate, 60);
+    return my::await(
+        service->async_create_window("test", my::ISize2D::Make(20, 10)));
+  });
+  auto win = f.get();
+  ASSERT_TRUE(win);
+  EXPECT_EQ(win->size(), my::ISize2D::Make(20, 10));
+}
@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include <window/headless/input_script.hpp>
+
+namespace {
+
+my::InputScript parse(std::string const &text) {
+  std::istringstream is(text);
+  return my::InputScript::parse(is);
+}
+
+} // namespace
+
+TEST(InputScriptTest, parses_commands) {
+  auto script = parse("# a click after a frame\n"
+                      "wait 16\n"
+                      "click 10 20 right\n"
+                      "window 2\n"
+                      "wait 5 \n"
+                      "down 1 2  # pressed\n"
+                      "resize 640 480\n"
+                      "quit\n");
+  auto const &inputs = script.inputs;
+  ASSERT_EQ(inputs.size(), 5);
+
+  EXPECT_EQ(inputs[0].type, my::HeadlessInput::kMouseDown);
+  EXPECT_EQ(inputs[0].delay.count(), 16);
+  EXPECT_EQ(inputs[0].pos, my::IPoint2D::Make(10, 20));
+  EXPECT_EQ(inputs[0].button, my::HeadlessInput::kRight);
+  EXPECT_EQ(inputs[0].window, 0);
+  EXPECT_EQ(inputs[1].type, my::HeadlessInput::kMouseUp);
+  EXPECT_EQ(inputs[1].delay.count(), 0);
+
+  EXPECT_EQ(inputs[2].window, 2);
+  EXPECT_EQ(inputs[2].delay.count(), 5);
+  EXPECT_EQ(inputs[2].button, my::HeadlessInput::kLeft);
+  EXPECT_EQ(inputs[3].type, my::HeadlessInput::kResize);
+  EXPECT_EQ(inputs[3].size, my::ISize2D::Make(640, 480));
+  EXPECT_EQ(inputs[4].type, my::HeadlessInput::kQuit);
+}
+
+TEST(InputScriptTest, repeat_plays_everything_so_far) {
+  auto script = parse("click 1 1\nwait 2\nrepeat 3\n");
+  EXPECT_EQ(script.inputs.size(), 6);
+}
+
+TEST(InputScriptTest, bad_lines_are_reported) {
+  for (auto text : {"wait\n", "wait -1\n", "click 1\n", "click 1 2 thumb\n",
+                    "resize 0 10\n", "quit now\n", "jump\n"}) {
+    EXPECT_THROW(parse(text), my::WindowServiceError) << text;
+  }
+  try {
+    parse("wait 1\n\nfly 2\n");
+    FAIL() << "fly 2 parsed";
+  } catch (my::WindowServiceError const &e) {
+    EXPECT_STREQ(e.what(), "input script line 3: fly 2");
+  }
+}
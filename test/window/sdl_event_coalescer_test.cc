@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <window/sdl/sdl_event_coalescer.hpp>
+
+namespace {
+
+SDL_Event motion(Uint32 window, Sint32 x, Sint32 y, Sint32 xrel, Sint32 yrel,
+                 Uint32 which = 0) {
+  SDL_Event e{};
+  e.motion.type = SDL_MOUSEMOTION;
+  e.motion.windowID = window;
+  e.motion.which = which;
+  e.motion.x = x;
+  e.motion.y = y;
+  e.motion.xrel = xrel;
+  e.motion.yrel = yrel;
+  return e;
+}
+
+SDL_Event wheel(Uint32 window, Sint32 y,
+                Uint32 direction = SDL_MOUSEWHEEL_NORMAL) {
+  SDL_Event e{};
+  e.wheel.type = SDL_MOUSEWHEEL;
+  e.wheel.windowID = window;
+  e.wheel.y = y;
+  e.wheel.direction = direction;
+  return e;
+}
+
+SDL_Event button(Uint32 window, Sint32 x, Sint32 y) {
+  SDL_Event e{};
+  e.button.type = SDL_MOUSEBUTTONDOWN;
+  e.button.windowID = window;
+  e.button.x = x;
+  e.button.y = y;
+  return e;
+}
+
+} // namespace
+
+TEST(SDLEventCoalescerTest, keeps_latest_motion_per_window) {
+  my::SDLEventCoalescer coalescer;
+  for (int i = 1; i <= 100; ++i) {
+    coalescer.push(motion(1, i, 2 * i, 1, 2));
+    coalescer.push(motion(2, -i, 0, -1, 0));
+  }
+  std::vector<SDL_Event> events;
+  coalescer.flush(events);
+
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[0].motion.windowID, 1u);
+  EXPECT_EQ(events[0].motion.x, 100);
+  EXPECT_EQ(events[0].motion.y, 200);
+  EXPECT_EQ(events[0].motion.xrel, 100);
+  EXPECT_EQ(events[0].motion.yrel, 200);
+  EXPECT_EQ(events[1].motion.x, -100);
+  EXPECT_EQ(events[1].motion.xrel, -100);
+  EXPECT_EQ(coalescer.stats().raw, 200u);
+  EXPECT_EQ(coalescer.stats().delivered, 2u);
+}
+
+TEST(SDLEventCoalescerTest, other_events_end_a_run) {
+  my::SDLEventCoalescer coalescer;
+  coalescer.push(motion(1, 1, 1, 1, 1));
+  coalescer.push(motion(1, 2, 2, 1, 1));
+  coalescer.push(button(1, 2, 2));
+  coalescer.push(motion(1, 3, 3, 1, 1));
+  coalescer.push(wheel(1, 1));
+  coalescer.push(wheel(1, 2));
+  coalescer.push(motion(1, 4, 4, 1, 1));
+  std::vector<SDL_Event> events;
+  coalescer.flush(events);
+
+  ASSERT_EQ(events.size(), 5u);
+  EXPECT_EQ(events[0].motion.x, 2);
+  EXPECT_EQ(events[0].motion.xrel, 2);
+  EXPECT_EQ(events[1].type, Uint32(SDL_MOUSEBUTTONDOWN));
+  EXPECT_EQ(events[2].motion.x, 3);
+  EXPECT_EQ(events[3].wheel.y, 3);
+  EXPECT_EQ(events[4].motion.x, 4);
+}
+
+TEST(SDLEventCoalescerTest, wheel_direction_and_mouse_are_kept_apart) {
+  my::SDLEventCoalescer coalescer;
+  coalescer.push(wheel(1, 1));
+  coalescer.push(wheel(1, 1, SDL_MOUSEWHEEL_FLIPPED));
+  coalescer.push(wheel(1, 1));
+  coalescer.push(motion(1, 0, 0, 1, 1, 0));
+  coalescer.push(motion(1, 0, 0, 1, 1, 1));
+  std::vector<SDL_Event> events;
+  coalescer.flush(events);
+
+  ASSERT_EQ(events.size(), 4u);
+  EXPECT_EQ(events[0].wheel.y, 2);
+  EXPECT_EQ(events[1].wheel.direction, Uint32(SDL_MOUSEWHEEL_FLIPPED));
+}
+
+TEST(SDLEventCoalescerTest, disabled_kinds_pass_through) {
+  my::SDLEventCoalescer coalescer({false, true});
+  for (int i = 0; i < 10; ++i) {
+    coalescer.push(motion(1, i, i, 1, 1));
+  }
+  coalescer.push(wheel(1, 1));
+  coalescer.push(wheel(1, 1));
+  std::vector<SDL_Event> events;
+  coalescer.flush(events);
+  EXPECT_EQ(events.size(), 11u);
+
+  // a flush starts a new poll, nothing merges across it
+  coalescer.push(wheel(1, 1));
+  coalescer.flush(events);
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].wheel.y, 1);
+  EXPECT_EQ(coalescer.stats().raw, 13u);
+  EXPECT_EQ(coalescer.stats().delivered, 12u);
+}
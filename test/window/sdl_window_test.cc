@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <future>
+
+#include <window/sdl/sdl_window_service.hpp>
+
+namespace {
+
+// stands in for SDLWindowService
+struct Source : my::Subject {};
+
+SDL_Event motion(Uint32 window, Sint32 x, Sint32 y) {
+  SDL_Event e{};
+  e.motion.type = SDL_MOUSEMOTION;
+  e.motion.windowID = window;
+  e.motion.x = x;
+  e.motion.y = y;
+  e.motion.xrel = 1;
+  return e;
+}
+
+SDL_Event button(Uint32 window) {
+  SDL_Event e{};
+  e.button.type = SDL_MOUSEBUTTONDOWN;
+  e.button.windowID = window;
+  e.button.button = SDL_BUTTON_LEFT;
+  e.button.state = SDL_PRESSED;
+  return e;
+}
+
+// without a platform window SDL reports the id 0
+std::shared_ptr<my::SDLWindow> make_window(Source &source) {
+  auto win = std::make_shared<my::SDLWindow>(nullptr);
+  win->subscribe(&source);
+  return win;
+}
+
+} // namespace
+
+TEST(SDLWindowTest, maps_single_events_of_its_window) {
+  Source source;
+  auto win = make_window(source);
+  std::vector<my::dynamic_event_type> events;
+  auto sub = win->event_source().subscribe(
+      [&](my::dynamic_event_type e) { events.push_back(e); });
+
+  source.post<my::SDLEvent>(my::SDLEvent{motion(0, 3, 4)});
+  source.post<my::SDLEvent>(my::SDLEvent{motion(7, 5, 6)});
+  source.post<my::SDLEvent>(my::SDLEvent{button(0)});
+
+  ASSERT_EQ(events.size(), 2u);
+  ASSERT_TRUE(events[0]->is<my::MouseMotionEvent>());
+  auto moved =
+      std::dynamic_pointer_cast<my::Event<my::MouseMotionEvent>>(events[0]);
+  EXPECT_EQ((*moved)->pos, my::IPoint2D::Make(3, 4));
+  EXPECT_EQ((*moved)->window_ptr(), win);
+  EXPECT_TRUE(events[1]->is<my::MouseButtonEvent>());
+  sub.unsubscribe();
+}
+
+TEST(SDLWindowTest, delivers_a_poll_as_one_batch) {
+  Source source;
+  auto win = make_window(source);
+  std::vector<my::dynamic_event_type> events;
+  auto sub = win->event_source().subscribe(
+      [&](my::dynamic_event_type e) { events.push_back(e); });
+
+  my::SDLEventBatch batch;
+  batch.events = {motion(0, 1, 1), motion(7, 2, 2), button(0),
+                  motion(0, 3, 3)};
+  source.post<my::SDLEventBatch>(batch);
+  // nothing for this window, nothing posted
+  batch.events = {motion(7, 4, 4)};
+  source.post<my::SDLEventBatch>(batch);
+
+  ASSERT_EQ(events.size(), 1u);
+  ASSERT_TRUE(events[0]->is<my::WindowEventBatch>());
+  auto const &window_events =
+      (*std::dynamic_pointer_cast<my::Event<my::WindowEventBatch>>(events[0]))
+          ->events;
+  ASSERT_EQ(window_events.size(), 3u);
+  EXPECT_TRUE(window_events[0]->is<my::MouseMotionEvent>());
+  EXPECT_TRUE(window_events[1]->is<my::MouseButtonEvent>());
+  EXPECT_TRUE(window_events[2]->is<my::MouseMotionEvent>());
+  sub.unsubscribe();
+}
+
+TEST(SDLWindowServiceTest, dispatches_motion_on_the_typed_channel) {
+  setenv("SDL_VIDEODRIVER", "dummy", 1);
+  my::EventBus bus;
+  auto service = my::WindowService::create();
+  service->subscribe(&bus);
+  auto win = service->create_window("test", {64, 64}).get();
+
+  std::promise<my::TypedEvent<my::MouseMotionEvent>> moved;
+  bus.on_dispatch<my::MouseMotionEvent>(
+      [&](const my::TypedEvent<my::MouseMotionEvent> &e) {
+        moved.set_value(e);
+      });
+  std::promise<void> pressed;
+  int rx_motion = 0;
+  auto sub = win->event_source().subscribe([&](my::dynamic_event_type e) {
+    if (e->is<my::MouseMotionEvent>()) {
+      ++rx_motion;
+    } else if (e->is<my::MouseButtonEvent>()) {
+      pressed.set_value();
+    }
+  });
+
+  auto e = motion(win->window_id(), 5, 6);
+  SDL_PushEvent(&e);
+  e = button(win->window_id());
+  SDL_PushEvent(&e);
+
+  auto moved_f = moved.get_future();
+  ASSERT_EQ(moved_f.wait_for(std::chrono::seconds(5)),
+            std::future_status::ready);
+  ASSERT_EQ(pressed.get_future().wait_for(std::chrono::seconds(5)),
+            std::future_status::ready);
+  auto event = moved_f.get();
+  EXPECT_EQ(event->pos, my::IPoint2D::Make(5, 6));
+  EXPECT_EQ(event->window_ptr(), win);
+  EXPECT_EQ(rx_motion, 0);
+  sub.unsubscribe();
+}